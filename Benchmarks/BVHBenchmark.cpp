@@ -0,0 +1,294 @@
+// MeshBVH and SceneBVH build times and ray casts per second on multi-million triangle GeometryGenerator meshes
+// usage: BVHBenchmark [scale]
+// mesh:  a 1024 x 1024 sphere and a 1025 x 1025 grid of about 2M triangles each, the scale multiplies the triangle counts
+//   build: MeshBVH::Build from the vertex buffer, the best of 3
+//   rays:  aimed at random points of the mesh's box from a sphere around it (mostly hits),
+//          or from random points around the mesh in random directions (mostly misses)
+//   1 thr / jobs: rays per second on one thread and with ParallelFor on the default job system
+// scene: SceneBVH over 4096 rotated and scaled instances of both meshes, the picking case
+// the first k_check_ray_count rays of each row are checked against testing every triangle (every instance for the scene),
+// the job system has to return the same hits as one thread
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include "Benchmark.h"
+#include "Mesh/GeometryGenerator.h"
+#include "Scene/MeshBVH.h"
+#include "Scene/SceneBVH.h"
+#include "Utility/JobSystem.h"
+
+static const uint32_t k_ray_count = 1000000;
+static const uint32_t k_check_ray_count = 64;
+static const uint32_t k_instance_grid = 64;
+
+// fixed seed so every run casts the same rays
+class Random
+{
+public:
+    float Next(float min, float max)
+    {
+        m_state = m_state * 1664525u + 1013904223u;
+        return min + (max - min) * (float)(m_state >> 8) / (float)(1u << 24);
+    }
+
+    Vector3 NextDirection()
+    {
+        // rejection sampled in the unit ball so directions are uniform
+        while(true)
+        {
+            Vector3 v(Next(-1.0f, 1.0f), Next(-1.0f, 1.0f), Next(-1.0f, 1.0f));
+            float length_squared = v.x * v.x + v.y * v.y + v.z * v.z;
+            if(length_squared > 1e-4f && length_squared <= 1.0f)
+            {
+                float inv_length = 1.0f / std::sqrt(length_squared);
+                return Vector3(v.x * inv_length, v.y * inv_length, v.z * inv_length);
+            }
+        }
+    }
+
+private:
+    uint32_t m_state = 12345;
+};
+
+static Vector3 GetCenter(const AABB& box)
+{
+    return Vector3((box.min.x + box.max.x) * 0.5f, (box.min.y + box.max.y) * 0.5f, (box.min.z + box.max.z) * 0.5f);
+}
+
+static float GetRadius(const AABB& box)
+{
+    Vector3 size(box.max.x - box.min.x, box.max.y - box.min.y, box.max.z - box.min.z);
+    return 0.5f * std::sqrt(size.x * size.x + size.y * size.y + size.z * size.z);
+}
+
+static std::vector<Ray> MakeAimedRays(const AABB& box, uint32_t count)
+{
+    Random random;
+    Vector3 center = GetCenter(box);
+    float radius = GetRadius(box);
+    std::vector<Ray> rays(count);
+    for(Ray& ray : rays)
+    {
+        Vector3 from = random.NextDirection();
+        ray.origin = Vector3(center.x + from.x * radius * 2.0f, center.y + from.y * radius * 2.0f, center.z + from.z * radius * 2.0f);
+        Vector3 target(random.Next(box.min.x, box.max.x), random.Next(box.min.y, box.max.y), random.Next(box.min.z, box.max.z));
+        Vector3 direction(target.x - ray.origin.x, target.y - ray.origin.y, target.z - ray.origin.z);
+        float inv_length = 1.0f / std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+        ray.direction = Vector3(direction.x * inv_length, direction.y * inv_length, direction.z * inv_length);
+    }
+    return rays;
+}
+
+static std::vector<Ray> MakeRandomRays(const AABB& box, uint32_t count)
+{
+    Random random;
+    Vector3 center = GetCenter(box);
+    float radius = GetRadius(box);
+    std::vector<Ray> rays(count);
+    for(Ray& ray : rays)
+    {
+        ray.origin = Vector3(center.x + random.Next(-2.0f, 2.0f) * radius, center.y + random.Next(-2.0f, 2.0f) * radius, center.z + random.Next(-2.0f, 2.0f) * radius);
+        ray.direction = random.NextDirection();
+    }
+    return rays;
+}
+
+// distance of the closest hit by testing every triangle in double precision, -1 for a miss
+static double BruteForce(const GeometryGenerator::MeshData& mesh, const Ray& ray)
+{
+    double closest = -1.0;
+    for(size_t i=0; i<mesh.Indices32.size(); i+=3)
+    {
+        const DirectX::XMFLOAT3& p0 = mesh.Vertices[mesh.Indices32[i]].Position;
+        const DirectX::XMFLOAT3& p1 = mesh.Vertices[mesh.Indices32[i + 1]].Position;
+        const DirectX::XMFLOAT3& p2 = mesh.Vertices[mesh.Indices32[i + 2]].Position;
+        double d[3] = { ray.direction.x, ray.direction.y, ray.direction.z };
+        double e1[3] = { (double)p1.x - p0.x, (double)p1.y - p0.y, (double)p1.z - p0.z };
+        double e2[3] = { (double)p2.x - p0.x, (double)p2.y - p0.y, (double)p2.z - p0.z };
+        double p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+        double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+        if(det == 0.0)
+        {
+            continue;
+        }
+        double s[3] = { (double)ray.origin.x - p0.x, (double)ray.origin.y - p0.y, (double)ray.origin.z - p0.z };
+        double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) / det;
+        double q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+        double v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) / det;
+        double t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) / det;
+        if(u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t >= 0.0 && (closest < 0.0 || t < closest))
+        {
+            closest = t;
+        }
+    }
+    return closest;
+}
+
+static bool SameDistance(double expected, float distance)
+{
+    return expected < 0.0 ? distance < 0.0f : distance >= 0.0f && std::abs(distance - expected) <= 1e-3 * std::max(1.0, expected);
+}
+
+struct RayTimes
+{
+    double single_seconds = 0.0;
+    double jobs_seconds = 0.0;
+    uint32_t hit_count = 0;
+    bool b_identical = true;
+};
+
+// cast(ray) returns the hit distance or -1, every ray once on one thread then with the job system
+template<typename CastFunc>
+static RayTimes TimeRays(const std::vector<Ray>& rays, CastFunc&& cast)
+{
+    RayTimes times;
+    std::vector<float> single_distances(rays.size());
+    std::vector<float> jobs_distances(rays.size());
+    times.single_seconds = MeasureSeconds(3, [&]()
+    {
+        for(size_t i=0; i<rays.size(); i++)
+        {
+            single_distances[i] = cast(rays[i]);
+        }
+    });
+    times.jobs_seconds = MeasureSeconds(3, [&]()
+    {
+        JobSystem::GetDefault().ParallelFor((uint32_t)rays.size(), 1024, [&](uint32_t begin, uint32_t end)
+        {
+            for(uint32_t i=begin; i<end; i++)
+            {
+                jobs_distances[i] = cast(rays[i]);
+            }
+        });
+    });
+
+    for(size_t i=0; i<rays.size(); i++)
+    {
+        times.hit_count += single_distances[i] >= 0.0f;
+        times.b_identical &= single_distances[i] == jobs_distances[i];
+    }
+    return times;
+}
+
+static void PrintRow(const char* name, uint64_t triangles, uint32_t nodes, double build_seconds, const char* ray_name,
+    uint32_t ray_count, const RayTimes& times, bool b_checked)
+{
+    printf("%6s %10llu %9u %10.1f | %6s %6.1f %12.2f %12.2f%s%s\n", name, (unsigned long long)triangles, nodes, build_seconds * 1e3,
+        ray_name, 100.0 * times.hit_count / ray_count, ray_count / times.single_seconds * 1e-6, ray_count / times.jobs_seconds * 1e-6,
+        b_checked ? "" : "  HITS DIFFER FROM BRUTE FORCE", times.b_identical ? "" : "  JOBS DIFFER");
+}
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    uint32_t resolution = std::max<uint32_t>((uint32_t)(1024 * std::sqrt(scale)), 8);
+    uint32_t ray_count = std::max<uint32_t>((uint32_t)(k_ray_count * scale), k_check_ray_count);
+
+    GeometryGenerator generator;
+    GeometryGenerator::MeshData meshes[2] = {
+        generator.CreateSphere(1.0f, resolution, resolution),
+        generator.CreateGrid(100.0f, 100.0f, resolution + 1, resolution + 1),
+    };
+    const char* mesh_names[2] = { "sphere", "grid" };
+    MeshBVH bvhs[2];
+
+    printf("%u cores, %u rays per row\n", JobSystem::GetDefault().GetWorkerCount() + 1, ray_count);
+    printf("%6s %10s %9s %10s | %6s %6s %12s %12s\n", "mesh", "triangles", "nodes", "build (ms)", "rays", "hit %", "1 thr (Mr/s)", "jobs (Mr/s)");
+    bool b_all_passed = true;
+    for(int m=0; m<2; m++)
+    {
+        const GeometryGenerator::MeshData& mesh = meshes[m];
+        MeshBVH& bvh = bvhs[m];
+        double build_seconds = MeasureSeconds(3, [&]()
+        {
+            bvh.Build(&mesh.Vertices[0].Position.x, sizeof(Vertex), mesh.Indices32.data(), (uint32_t)mesh.Indices32.size());
+        });
+
+        const char* ray_names[2] = { "aimed", "random" };
+        std::vector<Ray> ray_sets[2] = { MakeAimedRays(bvh.GetBounds(), ray_count), MakeRandomRays(bvh.GetBounds(), ray_count) };
+        for(int r=0; r<2; r++)
+        {
+            const std::vector<Ray>& rays = ray_sets[r];
+            auto cast = [&](const Ray& ray)
+            {
+                MeshRayHit hit;
+                return bvh.RayCast(ray, hit) ? hit.distance : -1.0f;
+            };
+            RayTimes times = TimeRays(rays, cast);
+
+            bool b_checked = true;
+            for(uint32_t i=0; i<k_check_ray_count; i++)
+            {
+                b_checked &= SameDistance(BruteForce(mesh, rays[i]), cast(rays[i]));
+            }
+            b_all_passed &= b_checked && times.b_identical;
+            PrintRow(mesh_names[m], bvh.GetTriangleCount(), bvh.GetNodeCount(), build_seconds, ray_names[r], ray_count, times, b_checked);
+        }
+    }
+
+    // a grid of instances alternating the two meshes, turned, scaled and spread over the grid mesh's size
+    Random random;
+    std::vector<Matrix> worlds;
+    SceneBVH scene;
+    uint64_t scene_triangles = 0;
+    for(uint32_t i=0; i<k_instance_grid * k_instance_grid; i++)
+    {
+        float size = i % 2 ? random.Next(0.05f, 0.2f) : random.Next(5.0f, 20.0f);
+        Matrix world = Matrix::CreateScale(Vector3(size, size, size))
+            * Matrix::CreateFromYawPitchRoll(random.Next(0.0f, 6.28f), random.Next(-1.5f, 1.5f), random.Next(0.0f, 6.28f))
+            * Matrix::CreateTranslation((i % k_instance_grid) * 50.0f, random.Next(-20.0f, 20.0f), (i / k_instance_grid) * 50.0f);
+        worlds.push_back(world);
+        scene_triangles += bvhs[i % 2].GetTriangleCount();
+    }
+    double scene_build_seconds = MeasureSeconds(3, [&]()
+    {
+        scene.Clear();
+        for(uint32_t i=0; i<(uint32_t)worlds.size(); i++)
+        {
+            scene.AddInstance(&bvhs[i % 2], worlds[i], i);
+        }
+        scene.Build();
+    });
+
+    AABB scene_box = { Vector3(0.0f, -40.0f, 0.0f), Vector3(k_instance_grid * 50.0f, 40.0f, k_instance_grid * 50.0f) };
+    const char* ray_names[2] = { "aimed", "random" };
+    std::vector<Ray> ray_sets[2] = { MakeAimedRays(scene_box, ray_count), MakeRandomRays(scene_box, ray_count) };
+    for(int r=0; r<2; r++)
+    {
+        const std::vector<Ray>& rays = ray_sets[r];
+        RayTimes times = TimeRays(rays, [&](const Ray& ray)
+        {
+            RayHit hit;
+            return scene.RayCast(ray, hit) ? hit.distance : -1.0f;
+        });
+
+        // every instance's mesh bvh without the top level, the ray moved to mesh space like SceneBVH does
+        bool b_checked = true;
+        for(uint32_t i=0; i<k_check_ray_count; i++)
+        {
+            const Ray& ray = rays[i];
+            float closest = FLT_MAX;
+            for(uint32_t instance=0; instance<(uint32_t)worlds.size(); instance++)
+            {
+                Matrix m = worlds[instance].Invert();
+                Vector3 origin(
+                    ray.origin.x * m._11 + ray.origin.y * m._21 + ray.origin.z * m._31 + m._41,
+                    ray.origin.x * m._12 + ray.origin.y * m._22 + ray.origin.z * m._32 + m._42,
+                    ray.origin.x * m._13 + ray.origin.y * m._23 + ray.origin.z * m._33 + m._43);
+                Vector3 direction(
+                    ray.direction.x * m._11 + ray.direction.y * m._21 + ray.direction.z * m._31,
+                    ray.direction.x * m._12 + ray.direction.y * m._22 + ray.direction.z * m._32,
+                    ray.direction.x * m._13 + ray.direction.y * m._23 + ray.direction.z * m._33);
+                MeshRayHit hit;
+                bvhs[instance % 2].RayCast(BVHRay(origin, direction), closest, hit);
+            }
+            RayHit hit;
+            bool b_hit = scene.RayCast(ray, hit);
+            b_checked &= SameDistance(closest < FLT_MAX ? closest : -1.0, b_hit ? hit.distance : -1.0f);
+        }
+        b_all_passed &= b_checked && times.b_identical;
+        PrintRow("scene", scene_triangles, scene.GetNodeCount(), scene_build_seconds, ray_names[r], ray_count, times, b_checked);
+    }
+    return b_all_passed ? 0 : 1;
+}
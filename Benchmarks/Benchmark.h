@@ -0,0 +1,37 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// helpers shared by the benchmark targets, each target is one executable printing a plain text table
+// run them from a release build, e.g. xmake f -m release && xmake run ShaderCompileBenchmark
+
+// seconds taken by func, the best of repeats runs so one descheduled run does not skew the result
+template<typename Func>
+double MeasureSeconds(int repeats, Func&& func)
+{
+    double best = 1e30;
+    for(int i=0; i<repeats; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        func();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        best = seconds < best ? seconds : best;
+    }
+    return best;
+}
+
+// keeps the compiler from dropping a computation whose result is otherwise unused
+template<typename T>
+inline void DoNotOptimize(const T& value)
+{
+    static volatile const T* s_sink;
+    s_sink = &value;
+}
+
+// optional first command line argument scaling the problem sizes, 1 by default
+inline double GetBenchmarkScale(int argc, char** argv)
+{
+    return argc > 1 ? atof(argv[1]) : 1.0;
+}
@@ -0,0 +1,221 @@
+// iterates 10k - 1M entities stored in World's archetype chunks against the component layout GameObject had
+// before, a vector of unique_ptr<Component> per object found with dynamic_cast
+// usage: ECSIterationBenchmark [scale]
+// every entity has a position, every other one a velocity too:
+//   read:   sum of all positions
+//   update: position += velocity * dt for the entities having both
+// the old layout is timed twice, scanning the component vector in place and through GetComponentsOfClass,
+// which allocated the returned vector on every call
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "Benchmark.h"
+#include "ECS/World.h"
+
+struct Position
+{
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+
+struct Velocity
+{
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+
+// the old layout, as Component and GameObject were before the ECS
+class LegacyComponent
+{
+public:
+    virtual ~LegacyComponent() = default;
+};
+
+class LegacyPositionComponent : public LegacyComponent
+{
+public:
+    Position value;
+};
+
+class LegacyVelocityComponent : public LegacyComponent
+{
+public:
+    Velocity value;
+};
+
+class LegacyGameObject
+{
+public:
+    LegacyGameObject() { m_components.push_back(std::make_unique<LegacyComponent>()); } // the root component
+
+    template<typename T>
+    T* AddComponent()
+    {
+        m_components.push_back(std::make_unique<T>());
+        return static_cast<T*>(m_components.back().get());
+    }
+
+    template<typename T>
+    T* FindComponentOfClass() const
+    {
+        for(const auto& component : m_components)
+        {
+            if(T* result = dynamic_cast<T*>(component.get()))
+            {
+                return result;
+            }
+        }
+        return nullptr;
+    }
+
+    template<typename T>
+    std::vector<T*> GetComponentsOfClass() const
+    {
+        std::vector<T*> result;
+        for(const auto& component : m_components)
+        {
+            if(T* component_of_class = dynamic_cast<T*>(component.get()))
+            {
+                result.push_back(component_of_class);
+            }
+        }
+        return result;
+    }
+
+private:
+    std::vector<std::unique_ptr<LegacyComponent>> m_components;
+};
+
+static const float k_dt = 1.0f / 60.0f;
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    const uint32_t entity_counts[] = { 10000, 100000, 1000000 };
+
+    printf("%9s | %10s %10s %10s %8s | %10s %10s %10s %8s\n", "", "read (ms)", "", "", "", "update (ms)", "", "", "");
+    printf("%9s | %10s %10s %10s %8s | %10s %10s %10s %8s\n", "entities",
+        "ecs", "old scan", "old get", "speedup", "ecs", "old scan", "old get", "speedup");
+
+    bool b_all_identical = true;
+    for(uint32_t base_count : entity_counts)
+    {
+        uint32_t entity_count = std::max<uint32_t>((uint32_t)(base_count * scale), 1);
+
+        World world;
+        std::vector<std::unique_ptr<LegacyGameObject>> objects;
+        objects.reserve(entity_count);
+        for(uint32_t i=0; i<entity_count; i++)
+        {
+            EntityID entity = world.CreateEntity();
+            world.AddComponent<Position>(entity, Position{ (float)i, 0.0f, 0.0f });
+
+            auto object = std::make_unique<LegacyGameObject>();
+            object->AddComponent<LegacyPositionComponent>()->value = Position{ (float)i, 0.0f, 0.0f };
+            if(i % 2 == 0)
+            {
+                world.AddComponent<Velocity>(entity, Velocity{ 1.0f, 2.0f, 3.0f });
+                object->AddComponent<LegacyVelocityComponent>()->value = Velocity{ 1.0f, 2.0f, 3.0f };
+            }
+            objects.push_back(std::move(object));
+        }
+
+        double ecs_sum = 0.0, scan_sum = 0.0, get_sum = 0.0;
+        double ecs_read = MeasureSeconds(5, [&]()
+        {
+            ecs_sum = 0.0;
+            world.ForEachChunk<Position>([&](uint32_t count, const EntityID*, Position* positions)
+            {
+                for(uint32_t i=0; i<count; i++)
+                {
+                    ecs_sum += positions[i].x + positions[i].y + positions[i].z;
+                }
+            });
+        });
+        double scan_read = MeasureSeconds(5, [&]()
+        {
+            scan_sum = 0.0;
+            for(const auto& object : objects)
+            {
+                const Position& position = object->FindComponentOfClass<LegacyPositionComponent>()->value;
+                scan_sum += position.x + position.y + position.z;
+            }
+        });
+        double get_read = MeasureSeconds(5, [&]()
+        {
+            get_sum = 0.0;
+            for(const auto& object : objects)
+            {
+                for(LegacyPositionComponent* component : object->GetComponentsOfClass<LegacyPositionComponent>())
+                {
+                    get_sum += component->value.x + component->value.y + component->value.z;
+                }
+            }
+        });
+
+        double ecs_update = MeasureSeconds(5, [&]()
+        {
+            world.ForEach<Position, Velocity>([](Position& position, const Velocity& velocity)
+            {
+                position.x += velocity.x * k_dt;
+                position.y += velocity.y * k_dt;
+                position.z += velocity.z * k_dt;
+            });
+        });
+        double scan_update = MeasureSeconds(5, [&]()
+        {
+            for(const auto& object : objects)
+            {
+                LegacyVelocityComponent* velocity = object->FindComponentOfClass<LegacyVelocityComponent>();
+                if(velocity)
+                {
+                    Position& position = object->FindComponentOfClass<LegacyPositionComponent>()->value;
+                    position.x += velocity->value.x * k_dt;
+                    position.y += velocity->value.y * k_dt;
+                    position.z += velocity->value.z * k_dt;
+                }
+            }
+        });
+        double get_update = MeasureSeconds(5, [&]()
+        {
+            for(const auto& object : objects)
+            {
+                std::vector<LegacyVelocityComponent*> velocities = object->GetComponentsOfClass<LegacyVelocityComponent>();
+                if(!velocities.empty())
+                {
+                    Position& position = object->GetComponentsOfClass<LegacyPositionComponent>()[0]->value;
+                    position.x += velocities[0]->value.x * k_dt;
+                    position.y += velocities[0]->value.y * k_dt;
+                    position.z += velocities[0]->value.z * k_dt;
+                }
+            }
+        });
+
+        // the old layout was updated by both of its loops, catch the ecs up and compare the positions
+        bool b_identical = ecs_sum == scan_sum && ecs_sum == get_sum;
+        for(int run=0; run<5; run++)
+        {
+            world.ForEach<Position, Velocity>([](Position& position, const Velocity& velocity)
+            {
+                position.x += velocity.x * k_dt;
+                position.y += velocity.y * k_dt;
+                position.z += velocity.z * k_dt;
+            });
+        }
+        ecs_sum = 0.0;
+        world.ForEach<Position>([&](const Position& position) { ecs_sum += position.x + position.y + position.z; });
+        scan_sum = 0.0;
+        for(const auto& object : objects)
+        {
+            const Position& position = object->FindComponentOfClass<LegacyPositionComponent>()->value;
+            scan_sum += position.x + position.y + position.z;
+        }
+        // summed in another order, the ecs walks the archetypes one after the other
+        b_identical &= std::abs(ecs_sum - scan_sum) <= 1e-9 * std::abs(scan_sum);
+        b_all_identical &= b_identical;
+
+        printf("%9u | %10.3f %10.3f %10.3f %7.1fx | %10.3f %10.3f %10.3f %7.1fx%s\n", entity_count,
+            ecs_read * 1e3, scan_read * 1e3, get_read * 1e3, scan_read / ecs_read,
+            ecs_update * 1e3, scan_update * 1e3, get_update * 1e3, scan_update / ecs_update,
+            b_identical ? "" : "  RESULTS DIFFER");
+    }
+    return b_all_identical ? 0 : 1;
+}
@@ -0,0 +1,284 @@
+// frame throughput of BoxApp's game thread / render thread split on a headless device, with and without the overlap
+// usage: FramePipelineBenchmark [scale]
+// a frame is the same work as in BoxApp:
+//   game thread:   every object's local transform is set, the hierarchy updated and the proxies extracted
+//   render thread: frustum culling, sorting, then one draw per visible object with the per draw constants
+//                  written to render owned material instances, executed and waited for
+// serial waits for each frame to be rendered before simulating the next, like k_pipelined_frames = false,
+// pipelined simulates frame N + 1 while frame N is recorded, so it should approach max(game, render) per frame
+#include <algorithm>
+#include <chrono>
+#include "Benchmark.h"
+#include "Tests/TempDirectory.h"
+#include "D3DRHI/HeadlessDevice.h"
+#include "D3DRHI/PSOManager.h"
+#include "Material/Material.h"
+#include "Material/ShaderCache.h"
+#include "Mesh/Mesh.h"
+#include "Renderer/RenderProxy.h"
+#include "Renderer/RenderQueue.h"
+#include "Renderer/RenderThread.h"
+#include "Scene/SceneHierarchy.h"
+#include "Utility/JobSystem.h"
+
+// nothing is rasterized, the draws have no render target and the vertices come from SV_VertexID
+static const char* const k_shader_source = R"(
+cbuffer cbPerObject : register(b0)
+{
+    float4x4 gWorldViewProj;
+};
+
+float4 VS(uint vertex_id : SV_VertexID) : SV_POSITION
+{
+    return mul(float4((float)(vertex_id & 1), (float)(vertex_id >> 1), 0.0f, 1.0f), gWorldViewProj);
+}
+)";
+
+static const uint32_t k_grid_width = 100;   // objects per row, rows go away from the camera
+
+typedef std::chrono::steady_clock Clock;
+
+class PipelineScene
+{
+public:
+    PipelineScene(const std::string& shader_path, uint32_t object_count)
+    {
+        ID3D12Device* device = m_headless_device.GetDevice();
+
+        ShaderInfo shader_info;
+        shader_info.shader_name = "FramePipeline";
+        shader_info.file_name = shader_path;
+        shader_info.b_create_VS = true;
+        m_shader = std::make_unique<Shader>(shader_info, device);
+
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC pso_desc = {};
+        pso_desc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
+        pso_desc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
+        pso_desc.DepthStencilState.DepthEnable = FALSE;
+        pso_desc.SampleMask = UINT_MAX;
+        pso_desc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+        pso_desc.SampleDesc.Count = 1;
+        m_pso_manager.CreatePSO("framePipelinePSO", pso_desc, m_shader.get(), device);
+        m_pso_id = m_pso_manager.GetPSOID("framePipelinePSO");
+
+        m_descriptor_cache = std::make_unique<DescriptorCacheGPU>(device);
+        m_material_template = std::make_unique<MaterialTemplate>(m_shader.get(), device);
+        m_material_template->AddOverride("gWorldViewProj");
+        m_world_view_proj_handle = m_material_template->GetVariableHandle("gWorldViewProj");
+
+        // a unit cube, only its bounds are used
+        std::vector<Vertex> vertices(8);
+        for(int i=0; i<8; i++)
+        {
+            vertices[i].Position = DirectX::XMFLOAT3(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f);
+        }
+        m_mesh.SetVerticesCPU(vertices);
+
+        // roots only, so the game thread's hierarchy update is split over the job system
+        std::vector<uint32_t> parents(object_count, k_invalid_scene_node);
+        m_nodes.resize(object_count);
+        m_hierarchy.AppendNodes(object_count, parents.data(), m_nodes.data());
+        for(uint32_t i=0; i<object_count; i++)
+        {
+            m_materials.push_back(m_material_template->CreateInstance());
+        }
+
+        // camera at the origin looking down +z at the grid, about half of it is in view
+        for(RenderFrameData& frame_data : m_frame_data)
+        {
+            frame_data.view.view = Matrix::CreateLookAt(Vector3::Zero, Vector3::UnitZ, Vector3::UnitY);
+            frame_data.view.proj = Matrix::CreatePerspectiveFieldOfView(Math::DegreesToRadians(60.0f), 1.0f, 0.1f, 1000.0f);
+            frame_data.view.look = Vector3::UnitZ;
+            frame_data.view.far_z = 1000.0f;
+            frame_data.view.frustum = ExtractFrustum(frame_data.view.view * frame_data.view.proj);
+        }
+    }
+
+    ~PipelineScene()
+    {
+        for(MaterialInstance* material : m_materials)
+        {
+            m_material_template->DestroyInstance(material);
+        }
+        for(MaterialInstance* material : m_draw_materials)
+        {
+            m_material_template->DestroyInstance(material);
+        }
+    }
+
+    RenderFrameData& GetFrameData(uint32_t frame_index) { return m_frame_data[frame_index]; }
+
+    // game thread, see BoxApp::Update and BoxApp::ExtractRenderProxies
+    void Simulate(uint32_t frame, RenderFrameData& frame_data)
+    {
+        for(uint32_t i=0; i<m_nodes.size(); i++)
+        {
+            Transform transform;
+            transform.Location = Vector3((float)(i % k_grid_width) * 2.0f - k_grid_width, 0.0f, 5.0f + (float)(i / k_grid_width) * 2.0f);
+            transform.Rotation = Quaternion::CreateFromYawPitchRoll(0.01f * (float)(frame + i), 0.0f, 0.0f);
+            m_hierarchy.SetLocalTransform(m_nodes[i], transform);
+        }
+        m_hierarchy.UpdateWorldMatrices(&JobSystem::GetDefault());
+
+        frame_data.proxies.Clear();
+        frame_data.proxies.Reserve(m_nodes.size());
+        for(uint32_t i=0; i<m_nodes.size(); i++)
+        {
+            frame_data.proxies.Add(i, m_hierarchy.GetWorldMatrix(m_nodes[i]), &m_mesh, m_materials[i], m_pso_id);
+        }
+    }
+
+    // render thread, see BoxApp::RenderFrame
+    void Render(const RenderFrameData& frame_data)
+    {
+        const RenderProxyList& proxies = frame_data.proxies;
+        m_headless_device.BeginCommandList();
+        ID3D12GraphicsCommandList* cmd_list = m_headless_device.GetCommandList();
+        m_descriptor_cache->ResetCachedHeap();
+        ID3D12DescriptorHeap* heaps[] = { m_descriptor_cache->GetCachedCbvSrvUavDescriptorHeap() };
+        cmd_list->SetDescriptorHeaps(_countof(heaps), heaps);
+        D3D12_VIEWPORT viewport = { 0.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f };
+        D3D12_RECT scissor = { 0, 0, 64, 64 };
+        cmd_list->RSSetViewports(1, &viewport);
+        cmd_list->RSSetScissorRects(1, &scissor);
+        cmd_list->SetPipelineState(m_pso_manager.GetPSO(m_pso_id));
+        cmd_list->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+        m_visible_proxies.resize(proxies.GetCount());
+        uint32_t visible_count = m_frustum_culler.Cull(&JobSystem::GetDefault(), frame_data.view.frustum,
+            proxies.GetCullBounds(), CullShape::k_sphere, m_visible_proxies.data());
+
+        m_render_queue.Clear();
+        float inv_far_z = 1.0f / frame_data.view.far_z;
+        for(uint32_t visible_index=0; visible_index<visible_count; visible_index++)
+        {
+            uint32_t i = m_visible_proxies[visible_index];
+            float depth = (proxies.GetWorldMatrix(i).Translation() - frame_data.view.position).Dot(frame_data.view.look) * inv_far_z;
+            m_render_queue.Push(RenderQueue::MakeKey(RenderPass::k_opaque, proxies.GetPSOID(i),
+                m_material_template->GetMaterialID(), 0, depth), i);
+        }
+        m_render_queue.Sort();
+
+        Matrix view_proj = frame_data.view.view * frame_data.view.proj;
+        for(size_t draw=0; draw<m_render_queue.GetCount(); draw++)
+        {
+            if(draw == m_draw_materials.size())
+            {
+                m_draw_materials.push_back(m_material_template->CreateInstance());
+            }
+            uint32_t i = m_render_queue.GetItem(draw);
+            MaterialInstance* draw_material = m_draw_materials[draw];
+            draw_material->CopyOverrides(proxies.GetMaterial(i));
+            draw_material->SetParameter(m_world_view_proj_handle, (proxies.GetWorldMatrix(i) * view_proj).Transpose());
+            draw_material->PassParametersToShader(cmd_list, m_descriptor_cache.get());
+            cmd_list->DrawInstanced(3, 1, 0, 0);
+        }
+        m_headless_device.ExecuteCommandList();
+        m_draw_count = (uint32_t)m_render_queue.GetCount();
+    }
+
+    uint32_t GetDrawCount() const { return m_draw_count; }
+
+private:
+    HeadlessDevice m_headless_device;
+    std::unique_ptr<Shader> m_shader;
+    PSOManager m_pso_manager;
+    uint16_t m_pso_id = 0;
+    std::unique_ptr<DescriptorCacheGPU> m_descriptor_cache;
+    std::unique_ptr<MaterialTemplate> m_material_template;
+    MaterialVariableHandle m_world_view_proj_handle;
+    Mesh m_mesh;
+
+    // game thread
+    SceneHierarchy m_hierarchy;
+    std::vector<SceneNodeID> m_nodes;
+    std::vector<MaterialInstance*> m_materials;
+
+    RenderFrameData m_frame_data[2];
+
+    // render thread
+    FrustumCuller m_frustum_culler;
+    std::vector<uint32_t> m_visible_proxies;
+    RenderQueue m_render_queue;
+    std::vector<MaterialInstance*> m_draw_materials;
+    uint32_t m_draw_count = 0;
+};
+
+struct PipelineTimes
+{
+    double frame_seconds = 0.0;     // wall clock per frame
+    double game_seconds = 0.0;      // per frame, simulation and extraction
+    double render_seconds = 0.0;    // per frame, on the render thread
+};
+
+// the frame loop of BoxApp::Draw
+static PipelineTimes RunFrames(PipelineScene& scene, uint32_t frame_count, bool b_pipelined)
+{
+    double render_seconds = 0.0;
+    RenderThread render_thread([&scene, &render_seconds](uint32_t frame_index)
+    {
+        Clock::time_point begin = Clock::now();
+        scene.Render(scene.GetFrameData(frame_index));
+        render_seconds += std::chrono::duration<double>(Clock::now() - begin).count();
+    });
+
+    // one warm up frame grows the render thread's instances and the queues
+    scene.Simulate(0, scene.GetFrameData(0));
+    render_thread.Kick(0);
+    render_thread.WaitIdle();
+    render_seconds = 0.0;
+
+    double game_seconds = 0.0;
+    uint32_t game_frame_index = 1;
+    Clock::time_point begin = Clock::now();
+    for(uint32_t frame=1; frame<=frame_count; frame++)
+    {
+        Clock::time_point game_begin = Clock::now();
+        scene.Simulate(frame, scene.GetFrameData(game_frame_index));
+        game_seconds += std::chrono::duration<double>(Clock::now() - game_begin).count();
+
+        render_thread.WaitIdle();
+        render_thread.Kick(game_frame_index);
+        game_frame_index = (game_frame_index + 1) % 2;
+        if(!b_pipelined)
+        {
+            render_thread.WaitIdle();
+        }
+    }
+    render_thread.WaitIdle();
+
+    PipelineTimes times;
+    times.frame_seconds = std::chrono::duration<double>(Clock::now() - begin).count() / frame_count;
+    times.game_seconds = game_seconds / frame_count;
+    times.render_seconds = render_seconds / frame_count;
+    return times;
+}
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    const uint32_t object_counts[] = { 1000, 10000, 50000 };
+    const uint32_t frame_count = 100;
+
+    TempDirectory temp_directory("FramePipelineBenchmark");
+    ShaderCache::SetCacheDirectory("");
+    std::string shader_path = temp_directory.WriteFile("frame_pipeline.hlsl", k_shader_source);
+
+    printf("%u frames each, times per frame\n", frame_count);
+    printf("%8s %7s | %9s %11s | %11s %11s | %11s %11s %8s\n", "objects", "draws",
+        "game (ms)", "render (ms)", "serial (ms)", "serial fps", "piped (ms)", "piped fps", "speedup");
+    for(uint32_t base_count : object_counts)
+    {
+        uint32_t object_count = std::max<uint32_t>((uint32_t)(base_count * scale), 1);
+        PipelineScene scene(shader_path, object_count);
+        PipelineTimes serial = RunFrames(scene, frame_count, false);
+        PipelineTimes pipelined = RunFrames(scene, frame_count, true);
+
+        printf("%8u %7u | %9.3f %11.3f | %11.3f %11.1f | %11.3f %11.1f %7.2fx\n", object_count, scene.GetDrawCount(),
+            serial.game_seconds * 1e3, serial.render_seconds * 1e3,
+            serial.frame_seconds * 1e3, 1.0 / serial.frame_seconds,
+            pipelined.frame_seconds * 1e3, 1.0 / pipelined.frame_seconds,
+            serial.frame_seconds / pipelined.frame_seconds);
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+// JobSystem scaling, ParallelFor over 1M items with 1 - 64 workers against a plain loop on one thread
+// usage: JobSystemBenchmark [scale]
+// worker counts double up to the hardware threads minus one, the thread calling ParallelFor works too
+//   uniform:    every item costs the same
+//   imbalanced: the cost grows with the index, the last items take twice the average, so ranges have to be stolen
+// speedup is against the plain loop, efficiency divides it by the threads (workers + 1)
+// every run has to produce the plain loop's results
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "Utility/JobSystem.h"
+
+static const uint32_t k_item_count = 1000000;
+static const uint32_t k_average_iterations = 200;
+static const uint32_t k_min_grain = 256;
+
+// a few hundred dependent integer ops the compiler cannot fold
+static uint32_t Work(uint32_t index, uint32_t iterations)
+{
+    uint32_t state = index * 2654435761u + 1;
+    for(uint32_t i=0; i<iterations; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+    }
+    return state;
+}
+
+static uint32_t GetIterations(bool b_imbalanced, uint32_t index, uint32_t count)
+{
+    return b_imbalanced ? 1 + (uint32_t)((uint64_t)index * 2 * k_average_iterations / count) : k_average_iterations;
+}
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    uint32_t item_count = std::max<uint32_t>((uint32_t)(k_item_count * scale), 1);
+    unsigned int hardware_threads = std::max(std::thread::hardware_concurrency(), 2u);
+
+    std::vector<unsigned int> worker_counts;
+    for(unsigned int workers=1; workers<=64 && workers<hardware_threads; workers*=2)
+    {
+        worker_counts.push_back(workers);
+    }
+    if(worker_counts.back() < std::min(hardware_threads - 1, 64u))
+    {
+        worker_counts.push_back(std::min(hardware_threads - 1, 64u));
+    }
+
+    printf("%u items, %u hardware threads\n", item_count, std::thread::hardware_concurrency());
+    printf("%11s %8s %8s | %10s %8s %10s\n", "workload", "workers", "threads", "time (ms)", "speedup", "efficiency");
+    bool b_all_identical = true;
+    for(bool b_imbalanced : { false, true })
+    {
+        const char* workload = b_imbalanced ? "imbalanced" : "uniform";
+        std::vector<uint32_t> expected(item_count), results(item_count);
+        double serial_seconds = MeasureSeconds(5, [&]()
+        {
+            for(uint32_t i=0; i<item_count; i++)
+            {
+                expected[i] = Work(i, GetIterations(b_imbalanced, i, item_count));
+            }
+        });
+        DoNotOptimize(expected);
+        printf("%11s %8s %8u | %10.3f %8.2f %10.2f\n", workload, "-", 1u, serial_seconds * 1e3, 1.0, 1.0);
+
+        for(unsigned int worker_count : worker_counts)
+        {
+            JobSystem job_system(worker_count);
+            std::fill(results.begin(), results.end(), 0);
+            double seconds = MeasureSeconds(5, [&]()
+            {
+                job_system.ParallelFor(item_count, k_min_grain, [&](uint32_t begin, uint32_t end)
+                {
+                    for(uint32_t i=begin; i<end; i++)
+                    {
+                        results[i] = Work(i, GetIterations(b_imbalanced, i, item_count));
+                    }
+                });
+            });
+
+            bool b_identical = results == expected;
+            b_all_identical &= b_identical;
+            unsigned int thread_count = worker_count + 1;
+            double speedup = serial_seconds / seconds;
+            printf("%11s %8u %8u | %10.3f %8.2f %10.2f%s\n", workload, worker_count, thread_count,
+                seconds * 1e3, speedup, speedup / thread_count, b_identical ? "" : "  RESULTS DIFFER");
+        }
+    }
+    return b_all_identical ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+// resource registry lookups, the old std::string keyed unordered_map against the NameID keyed FlatHashMap
+// usage: LookupBenchmark [scale]
+// registries of 16 - 4096 resources named like asset paths, 1M lookups in random order
+//   hit:     runtime names, the old path hashes and compares the string, the new one a NameID hashed where the name entered
+//   miss:    runtime names that are not registered
+//   literal: GetMesh("box") style call sites, the old path builds a std::string each call, the NameID is hashed at compile time
+// both have to find the same resources
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Benchmark.h"
+#include "Utility/FlatHashMap.h"
+#include "Utility/NameID.h"
+
+static const uint32_t k_lookup_count = 1000000;
+
+struct Resource
+{
+    uint32_t id;
+};
+
+template<typename Map, typename Key, typename FindFunc>
+static double TimeLookups(const Map& map, const std::vector<Key>& keys, FindFunc&& find, uint64_t& checksum)
+{
+    return MeasureSeconds(5, [&]()
+    {
+        checksum = 0;
+        for(const Key& key : keys)
+        {
+            const Resource* resource = find(map, key);
+            checksum += resource ? resource->id + 1 : 0;
+        }
+    });
+}
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    uint32_t lookup_count = std::max<uint32_t>((uint32_t)(k_lookup_count * scale), 1);
+    const uint32_t registry_sizes[] = { 16, 256, 4096 };
+    const char* const literal_names[] = { "box", "sphere", "crate", "default" };
+
+    auto find_old = [](const std::unordered_map<std::string, Resource*>& map, const std::string& name) -> const Resource*
+    {
+        auto iter = map.find(name);
+        return iter == map.end() ? nullptr : iter->second;
+    };
+    auto find_new = [](const FlatHashMap<NameID, Resource*>& map, const NameID& name) -> const Resource*
+    {
+        Resource* const* resource = map.Find(name);
+        return resource ? *resource : nullptr;
+    };
+
+    printf("%u lookups\n", lookup_count);
+    printf("%9s %8s | %10s %10s %8s\n", "resources", "lookup", "old (ns)", "new (ns)", "speedup");
+    bool b_all_identical = true;
+    for(uint32_t registry_size : registry_sizes)
+    {
+        std::vector<Resource> resources(registry_size);
+        std::vector<std::string> names;
+        for(uint32_t i=0; i<registry_size; i++)
+        {
+            resources[i].id = i;
+            names.push_back(i < 4 ? std::string(literal_names[i]) : "Resources/Models/model_" + std::to_string(i) + ".fbx");
+        }
+
+        std::unordered_map<std::string, Resource*> old_map;
+        FlatHashMap<NameID, Resource*> new_map;
+        for(uint32_t i=0; i<registry_size; i++)
+        {
+            old_map[names[i]] = &resources[i];
+            new_map.Insert(NameID::Register(names[i]), &resources[i]);
+        }
+
+        // fixed seed so every run looks up the same names
+        std::mt19937 random(1234);
+        std::vector<std::string> hit_names(lookup_count), miss_names(lookup_count);
+        std::vector<NameID> hit_ids(lookup_count), miss_ids(lookup_count);
+        for(uint32_t i=0; i<lookup_count; i++)
+        {
+            hit_names[i] = names[random() % registry_size];
+            miss_names[i] = "Resources/Models/missing_" + std::to_string(random() % 4096) + ".fbx";
+            hit_ids[i] = NameID(hit_names[i]);
+            miss_ids[i] = NameID(miss_names[i]);
+        }
+
+        uint64_t old_checksum = 0, new_checksum = 0;
+        const char* lookup_names[] = { "hit", "miss", "literal" };
+        double old_seconds[3], new_seconds[3];
+        bool b_identical[3];
+        old_seconds[0] = TimeLookups(old_map, hit_names, find_old, old_checksum);
+        new_seconds[0] = TimeLookups(new_map, hit_ids, find_new, new_checksum);
+        b_identical[0] = old_checksum == new_checksum;
+        old_seconds[1] = TimeLookups(old_map, miss_names, find_old, old_checksum);
+        new_seconds[1] = TimeLookups(new_map, miss_ids, find_new, new_checksum);
+        b_identical[1] = old_checksum == new_checksum;
+
+        // the literals are spelled out in the loops like at the call sites
+        old_seconds[2] = MeasureSeconds(5, [&]()
+        {
+            old_checksum = 0;
+            for(uint32_t i=0; i<lookup_count; i+=4)
+            {
+                old_checksum += find_old(old_map, "box")->id + find_old(old_map, "sphere")->id
+                    + find_old(old_map, "crate")->id + find_old(old_map, "default")->id;
+            }
+        });
+        new_seconds[2] = MeasureSeconds(5, [&]()
+        {
+            new_checksum = 0;
+            for(uint32_t i=0; i<lookup_count; i+=4)
+            {
+                new_checksum += find_new(new_map, NameID("box"))->id + find_new(new_map, NameID("sphere"))->id
+                    + find_new(new_map, NameID("crate"))->id + find_new(new_map, NameID("default"))->id;
+            }
+        });
+        b_identical[2] = old_checksum == new_checksum;
+
+        for(int i=0; i<3; i++)
+        {
+            b_all_identical &= b_identical[i];
+            printf("%9u %8s | %10.2f %10.2f %7.1fx%s\n", registry_size, lookup_names[i], old_seconds[i] * 1e9 / lookup_count,
+                new_seconds[i] * 1e9 / lookup_count, old_seconds[i] / new_seconds[i], b_identical[i] ? "" : "  RESULTS DIFFER");
+        }
+    }
+    return b_all_identical ? 0 : 1;
+}
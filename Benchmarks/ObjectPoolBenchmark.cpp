@@ -0,0 +1,165 @@
+// game object create / destroy churn, ObjectPool slabs against a std::make_unique per object
+// usage: ObjectPoolBenchmark [scale]
+// 1k - 100k objects stay alive, each frame the oldest tenth is destroyed and as many are created, 1M creates per row
+// the world matrices are updated between frames, outside the timing, so destroyed scene nodes are compacted like in the app
+//   shared: every object is named "projectile", the name stays interned
+//   unique: names cycle through twice the live count, each create interns a name released a while ago
+//   heap: std::make_unique<GameObject>, one allocation per object on top of what the world and the name table do
+//   pool: ObjectPool<GameObject>, allocates only when a slab is added
+// allocs/obj counts operator new calls per created object after a warm up run, throughput is creates + destroys per ms
+// both have to end with the live object count, entity count and names they started with
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "GameObject/GameObject.h"
+#include "Utility/ObjectPool.h"
+
+// every operator new of the process goes through here, see ShaderBindingTests
+static std::atomic<uint64_t> s_new_calls{0};
+
+void* operator new(size_t size)
+{
+    s_new_calls++;
+    void* memory = malloc(size > 0 ? size : 1);
+    if(memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    s_new_calls++;
+    void* memory = _aligned_malloc(size > 0 ? size : 1, (size_t)alignment);
+    if(memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { _aligned_free(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { _aligned_free(memory); }
+
+static const uint32_t k_create_count = 1000000;
+
+struct ChurnResult
+{
+    double seconds = 0.0;
+    uint64_t allocations = 0;
+};
+
+// live_count objects are created, then replace(slot, name) destroys the object in slot and creates one named name
+// in its place, a frame at a time, only the replacing is timed and counted
+template<typename Replace>
+static ChurnResult RunChurn(World& world, uint32_t live_count, uint32_t create_count, const std::vector<std::string>& names, Replace&& replace)
+{
+    uint32_t frame_size = std::max(live_count / 10, 1u);
+    uint32_t next_slot = 0;
+    uint32_t next_name = 0;
+    ChurnResult result;
+    for(uint32_t created=0; created<create_count; created+=frame_size)
+    {
+        uint64_t new_calls_before = s_new_calls.load();
+        auto begin = std::chrono::steady_clock::now();
+        uint32_t frame_creates = std::min(frame_size, create_count - created);
+        for(uint32_t i=0; i<frame_creates; i++)
+        {
+            replace(next_slot, names[next_name]);
+            next_slot = next_slot + 1 == live_count ? 0 : next_slot + 1;
+            next_name = next_name + 1 == names.size() ? 0 : next_name + 1;
+        }
+        result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        result.allocations += s_new_calls.load() - new_calls_before;
+
+        world.GetSceneHierarchy().UpdateWorldMatrices();
+    }
+    return result;
+}
+
+// best time of repeats runs after a warm up run, the allocations of the last run
+template<typename Replace>
+static ChurnResult MeasureChurn(World& world, uint32_t live_count, uint32_t create_count, const std::vector<std::string>& names, Replace&& replace)
+{
+    RunChurn(world, live_count, live_count, names, replace);
+    ChurnResult best;
+    best.seconds = 1e30;
+    for(int repeat=0; repeat<3; repeat++)
+    {
+        ChurnResult result = RunChurn(world, live_count, create_count, names, replace);
+        best.seconds = std::min(best.seconds, result.seconds);
+        best.allocations = result.allocations;
+    }
+    return best;
+}
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    const uint32_t live_counts[] = { 1000, 10000, 100000 };
+    uint32_t create_count = std::max<uint32_t>((uint32_t)(k_create_count * scale), 1);
+    uint32_t base_name_count = NameTable::GetDefault().GetCount();
+
+    printf("%u creates per row\n", create_count);
+    printf("%7s %7s | %10s %10s | %12s %12s | %8s\n", "live", "names", "heap alloc", "pool alloc", "heap ops/ms", "pool ops/ms", "speedup");
+    bool b_all_consistent = true;
+    for(uint32_t base_live_count : live_counts)
+    {
+        uint32_t live_count = std::max<uint32_t>((uint32_t)(base_live_count * scale), 1);
+        for(bool b_unique_names : { false, true })
+        {
+            std::vector<std::string> names;
+            for(uint32_t i=0; i<(b_unique_names ? 2 * live_count : 1); i++)
+            {
+                names.push_back(b_unique_names ? "projectile_" + std::to_string(i) : std::string("projectile"));
+            }
+
+            World world;
+            std::vector<std::unique_ptr<GameObject>> heap_objects;
+            for(uint32_t i=0; i<live_count; i++)
+            {
+                heap_objects.push_back(std::make_unique<GameObject>(names[i % names.size()], &world));
+            }
+            ChurnResult heap = MeasureChurn(world, live_count, create_count, names, [&](uint32_t slot, const std::string& name)
+            {
+                heap_objects[slot].reset();
+                heap_objects[slot] = std::make_unique<GameObject>(name, &world);
+            });
+            bool b_consistent = world.GetEntityCount() == live_count;
+            heap_objects.clear();
+
+            ObjectPool<GameObject> pool;
+            std::vector<PoolHandle<GameObject>> pool_objects;
+            for(uint32_t i=0; i<live_count; i++)
+            {
+                pool_objects.push_back(pool.Create(names[i % names.size()], &world));
+            }
+            ChurnResult pooled = MeasureChurn(world, live_count, create_count, names, [&](uint32_t slot, const std::string& name)
+            {
+                pool.Destroy(pool_objects[slot]);
+                pool_objects[slot] = pool.Create(name, &world);
+            });
+            b_consistent &= world.GetEntityCount() == live_count && pool.GetCount() == live_count;
+            pool.Clear();
+            b_consistent &= world.GetEntityCount() == 0 && NameTable::GetDefault().GetCount() == base_name_count;
+            b_all_consistent &= b_consistent;
+
+            // a create and a destroy per replaced object
+            double heap_ops = 2.0 * create_count / (heap.seconds * 1e3);
+            double pool_ops = 2.0 * create_count / (pooled.seconds * 1e3);
+            printf("%7u %7s | %10.2f %10.2f | %12.0f %12.0f | %7.2fx%s\n", live_count, b_unique_names ? "unique" : "shared",
+                (double)heap.allocations / create_count, (double)pooled.allocations / create_count,
+                heap_ops, pool_ops, pool_ops / heap_ops, b_consistent ? "" : "  OBJECTS OR NAMES LEAKED");
+        }
+    }
+    return b_all_consistent ? 0 : 1;
+}
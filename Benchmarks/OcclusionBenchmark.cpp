@@ -0,0 +1,221 @@
+// OcclusionCuller on generated scenes, large box occluders hiding many small occludee boxes
+// usage: OcclusionBenchmark [scale]
+//   city:   a grid of buildings, the camera stands at street level looking down a street, the occludees are props along the streets
+//   indoor: a grid of rooms whose walls have door gaps, the camera stands in a corner room, the occludees are furniture
+// setup:  BeginFrame and AddOccluder for every occluder
+// raster: Rasterize on one thread and with the default job system, both have to produce the same depth buffer
+// test:   CullVisible over the occludees FrustumCuller kept, "occluded" are the ones it dropped
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Benchmark.h"
+#include "Renderer/OcclusionCuller.h"
+#include "Utility/JobSystem.h"
+
+// unit box, its own occluder mesh like the crates of the app
+static const float k_box_positions[] = {
+    -0.5f, -0.5f, -0.5f,   0.5f, -0.5f, -0.5f,   0.5f,  0.5f, -0.5f,  -0.5f,  0.5f, -0.5f,
+    -0.5f, -0.5f,  0.5f,   0.5f, -0.5f,  0.5f,   0.5f,  0.5f,  0.5f,  -0.5f,  0.5f,  0.5f,
+};
+static const uint16_t k_box_indices[] = {
+    0, 2, 1, 0, 3, 2,   4, 5, 6, 4, 6, 7,   0, 1, 5, 0, 5, 4,
+    3, 6, 2, 3, 7, 6,   0, 4, 7, 0, 7, 3,   1, 2, 6, 1, 6, 5,
+};
+
+// fixed seed so every run sees the same scene
+class Random
+{
+public:
+    float Next(float min, float max)
+    {
+        m_state = m_state * 1664525u + 1013904223u;
+        return min + (max - min) * (float)(m_state >> 8) / (float)(1u << 24);
+    }
+
+private:
+    uint32_t m_state = 12345;
+};
+
+struct OcclusionScene
+{
+    const char* name = nullptr;
+    Matrix view_proj;
+    std::vector<Matrix> occluders;      // world matrices of unit boxes
+    std::vector<float> soa[6];          // occludee centers and extents
+    CullBounds bounds;
+
+    void AddOccluder(const Vector3& center, const Vector3& extents)
+    {
+        occluders.push_back(Matrix::CreateScale(Vector3(extents.x * 2.0f, extents.y * 2.0f, extents.z * 2.0f)) * Matrix::CreateTranslation(center));
+    }
+
+    void AddOccludee(const Vector3& center, const Vector3& extents)
+    {
+        const float values[6] = { center.x, center.y, center.z, extents.x, extents.y, extents.z };
+        for(int i=0; i<6; i++)
+        {
+            soa[i].push_back(values[i]);
+        }
+    }
+
+    void SetCamera(const Vector3& position, const Vector3& target, float far_z)
+    {
+        Matrix view = Matrix::CreateLookAt(position, target, Vector3::UnitY);
+        Matrix proj = Matrix::CreatePerspectiveFieldOfView(Math::DegreesToRadians(60.0f),
+            (float)OcclusionCuller::k_width / OcclusionCuller::k_height, 0.1f, far_z);
+        view_proj = view * proj;
+    }
+
+    // FrustumCuller::Cull reads the radius only for spheres, the occludees are culled as boxes
+    void FinishBounds()
+    {
+        bounds.center_x = soa[0].data();
+        bounds.center_y = soa[1].data();
+        bounds.center_z = soa[2].data();
+        bounds.extent_x = soa[3].data();
+        bounds.extent_y = soa[4].data();
+        bounds.extent_z = soa[5].data();
+        bounds.count = (uint32_t)soa[0].size();
+    }
+};
+
+static OcclusionScene MakeCity(uint32_t occludee_count)
+{
+    const int blocks = 24;
+    const float pitch = 40.0f;
+    const float street = 10.0f;
+
+    OcclusionScene scene;
+    scene.name = "city";
+    Random random;
+    for(int z=0; z<blocks; z++)
+    {
+        for(int x=0; x<blocks; x++)
+        {
+            float height = random.Next(10.0f, 80.0f);
+            float half_size = (pitch - street) * 0.5f;
+            scene.AddOccluder(Vector3((x + 0.5f) * pitch, height * 0.5f, (z + 0.5f) * pitch), Vector3(half_size, height * 0.5f, half_size));
+        }
+    }
+
+    // half of the props along the streets running in x, half along the ones running in z
+    for(uint32_t i=0; i<occludee_count; i++)
+    {
+        float line = (float)(int)random.Next(0.0f, (float)blocks + 1.0f) * pitch + random.Next(-street * 0.4f, street * 0.4f);
+        float along = random.Next(0.0f, blocks * pitch);
+        Vector3 extents(random.Next(0.5f, 2.0f), random.Next(0.5f, 2.0f), random.Next(0.5f, 2.0f));
+        scene.AddOccludee(i % 2 ? Vector3(along, extents.y, line) : Vector3(line, extents.y, along), extents);
+    }
+    scene.FinishBounds();
+
+    // down the street at x = 4 blocks, from the near edge of the city
+    scene.SetCamera(Vector3(4.0f * pitch, 1.8f, -5.0f), Vector3(4.0f * pitch + 20.0f, 1.8f, 100.0f), blocks * pitch * 1.5f);
+    return scene;
+}
+
+static OcclusionScene MakeIndoor(uint32_t occludee_count)
+{
+    const int rooms = 16;
+    const float room_size = 10.0f;
+    const float door_half_width = 0.75f;
+    const float wall_half_height = 1.5f;
+    const float wall_half_thickness = 0.1f;
+
+    OcclusionScene scene;
+    scene.name = "indoor";
+    // every wall line between and around the rooms, split by a door in the middle of each room side
+    for(int line=0; line<=rooms; line++)
+    {
+        for(int room=0; room<rooms; room++)
+        {
+            float begin = room * room_size;
+            float door = begin + room_size * 0.5f;
+            float segment_half = (room_size * 0.5f - door_half_width) * 0.5f;
+            float centers[2] = { begin + segment_half, door + door_half_width + segment_half };
+            for(float along : centers)
+            {
+                scene.AddOccluder(Vector3(along, wall_half_height, line * room_size), Vector3(segment_half, wall_half_height, wall_half_thickness));
+                scene.AddOccluder(Vector3(line * room_size, wall_half_height, along), Vector3(wall_half_thickness, wall_half_height, segment_half));
+            }
+        }
+    }
+
+    Random random;
+    for(uint32_t i=0; i<occludee_count; i++)
+    {
+        Vector3 extents(random.Next(0.2f, 0.8f), random.Next(0.2f, 0.8f), random.Next(0.2f, 0.8f));
+        scene.AddOccludee(Vector3(random.Next(0.5f, rooms * room_size - 0.5f), extents.y, random.Next(0.5f, rooms * room_size - 0.5f)), extents);
+    }
+    scene.FinishBounds();
+
+    // from a corner of the first room across the building
+    scene.SetCamera(Vector3(1.0f, 1.7f, 1.0f), Vector3(room_size, 1.2f, room_size * 0.7f), rooms * room_size * 1.5f);
+    return scene;
+}
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    const uint32_t occludee_counts[] = { 10000, 100000 };
+    JobSystem& job_system = JobSystem::GetDefault();
+
+    printf("%u cores, %ux%u depth buffer\n", job_system.GetWorkerCount() + 1, OcclusionCuller::k_width, OcclusionCuller::k_height);
+    printf("%6s %8s | %9s %9s %9s | %10s %10s %10s %10s | %10s\n", "scene", "objects", "triangles", "frustum", "occluded",
+        "setup (ms)", "1 thr (ms)", "jobs (ms)", "test (ms)", "test (ns)");
+    bool b_all_identical = true;
+    for(uint32_t base_count : occludee_counts)
+    {
+        uint32_t occludee_count = std::max<uint32_t>((uint32_t)(base_count * scale), 1);
+        OcclusionScene scenes[] = { MakeCity(occludee_count), MakeIndoor(occludee_count) };
+        for(OcclusionScene& scene : scenes)
+        {
+            OcclusionCuller culler;
+            double setup_seconds = MeasureSeconds(5, [&]()
+            {
+                culler.BeginFrame(scene.view_proj);
+                for(const Matrix& world : scene.occluders)
+                {
+                    culler.AddOccluder(k_box_positions, sizeof(float) * 3, k_box_indices, (uint32_t)(sizeof(k_box_indices) / sizeof(k_box_indices[0])), world);
+                }
+            });
+
+            double single_seconds = MeasureSeconds(5, [&]() { culler.Rasterize(nullptr); });
+            std::vector<float> single_depth;
+            for(uint32_t y=0; y<OcclusionCuller::k_height; y++)
+            {
+                for(uint32_t x=0; x<OcclusionCuller::k_width; x++)
+                {
+                    single_depth.push_back(culler.GetDepth(x, y));
+                }
+            }
+
+            double jobs_seconds = MeasureSeconds(5, [&]() { culler.Rasterize(&job_system); });
+            bool b_identical = true;
+            for(uint32_t y=0; y<OcclusionCuller::k_height; y++)
+            {
+                for(uint32_t x=0; x<OcclusionCuller::k_width; x++)
+                {
+                    b_identical &= culler.GetDepth(x, y) == single_depth[y * OcclusionCuller::k_width + x];
+                }
+            }
+            b_all_identical &= b_identical;
+
+            // CullVisible compacts in place, every run starts again from the frustum culled indices
+            std::vector<uint32_t> frustum_indices(scene.bounds.count);
+            uint32_t frustum_count = FrustumCuller::Cull(ExtractFrustum(scene.view_proj), scene.bounds, CullShape::k_box, 0, scene.bounds.count, frustum_indices.data());
+            std::vector<uint32_t> indices(frustum_count);
+            uint32_t visible_count = 0;
+            double test_seconds = MeasureSeconds(5, [&]()
+            {
+                std::copy(frustum_indices.begin(), frustum_indices.begin() + frustum_count, indices.begin());
+                visible_count = culler.CullVisible(scene.bounds, indices.data(), frustum_count);
+            });
+
+            printf("%6s %8u | %9u %9u %9u | %10.3f %10.3f %10.3f %10.3f | %10.1f%s\n", scene.name, occludee_count,
+                culler.GetStats().occluder_triangles, frustum_count, frustum_count - visible_count,
+                setup_seconds * 1e3, single_seconds * 1e3, jobs_seconds * 1e3, test_seconds * 1e3,
+                test_seconds * 1e9 / std::max<uint32_t>(frustum_count, 1), b_identical ? "" : "  DEPTH DIFFERS");
+        }
+    }
+    return b_all_identical ? 0 : 1;
+}
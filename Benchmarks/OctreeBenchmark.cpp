@@ -0,0 +1,287 @@
+// LooseOctree against brute force over 100k moving bounding spheres
+// usage: OctreeBenchmark [scale]
+// update: every object moves each frame, the octree moves its handles while brute force only rewrites its array,
+//         also timed with a tenth of the objects moving
+// queries: random frustums, spheres, boxes and rays over the scene, brute force tests every object with the same
+//          test the octree applies to the objects of the cells it visits, so both have to return the same objects
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Benchmark.h"
+#include "Scene/LooseOctree.h"
+
+static const float k_world_half_size = 512.0f;
+static const uint32_t k_query_count = 200;
+static const uint32_t k_frame_count = 10;
+
+// fixed seed so every run sees the same scene
+class Random
+{
+public:
+    float Next(float min, float max)
+    {
+        m_state = m_state * 1664525u + 1013904223u;
+        return min + (max - min) * (float)(m_state >> 8) / (float)(1u << 24);
+    }
+
+private:
+    uint32_t m_state = 12345;
+};
+
+// 60 degree pyramid from position looking along yaw, planes pointing inside like ExtractFrustum's
+static Frustum MakeFrustum(const Vector3& position, float yaw, float far_z)
+{
+    const float half_angle = Math::DegreesToRadians(30.0f);
+    const float sin_half = std::sin(half_angle);
+    const float cos_half = std::cos(half_angle);
+    const Vector3 forward(std::sin(yaw), 0.0f, std::cos(yaw));
+    const Vector3 right(std::cos(yaw), 0.0f, -std::sin(yaw));
+    const Vector3 up(0.0f, 1.0f, 0.0f);
+
+    const Vector3 normals[Frustum::k_plane_count] = {
+        Vector3(right.x * cos_half + forward.x * sin_half, right.y * cos_half + forward.y * sin_half, right.z * cos_half + forward.z * sin_half),
+        Vector3(-right.x * cos_half + forward.x * sin_half, -right.y * cos_half + forward.y * sin_half, -right.z * cos_half + forward.z * sin_half),
+        Vector3(up.x * cos_half + forward.x * sin_half, up.y * cos_half + forward.y * sin_half, up.z * cos_half + forward.z * sin_half),
+        Vector3(-up.x * cos_half + forward.x * sin_half, -up.y * cos_half + forward.y * sin_half, -up.z * cos_half + forward.z * sin_half),
+        forward,
+        Vector3(-forward.x, -forward.y, -forward.z),
+    };
+
+    Frustum frustum;
+    for(int i=0; i<Frustum::k_plane_count; i++)
+    {
+        frustum.planes[i].normal = normals[i];
+        frustum.planes[i].d = -(normals[i].x * position.x + normals[i].y * position.y + normals[i].z * position.z);
+    }
+    frustum.planes[4].d -= 0.1f;     // near
+    frustum.planes[5].d += far_z;    // far
+    return frustum;
+}
+
+// the object tests of LooseOctree's queries
+static bool InFrustum(const Frustum& frustum, const BoundingSphere& bounds)
+{
+    for(const Plane& plane : frustum.planes)
+    {
+        if(plane.GetDistance(bounds.center) < -bounds.radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool InSphere(const BoundingSphere& sphere, const BoundingSphere& bounds)
+{
+    float dx = bounds.center.x - sphere.center.x;
+    float dy = bounds.center.y - sphere.center.y;
+    float dz = bounds.center.z - sphere.center.z;
+    float radius = bounds.radius + sphere.radius;
+    return dx * dx + dy * dy + dz * dz <= radius * radius;
+}
+
+static bool InAABB(const AABB& box, const BoundingSphere& bounds)
+{
+    float dx = bounds.center.x - std::min(std::max(bounds.center.x, box.min.x), box.max.x);
+    float dy = bounds.center.y - std::min(std::max(bounds.center.y, box.min.y), box.max.y);
+    float dz = bounds.center.z - std::min(std::max(bounds.center.z, box.min.z), box.max.z);
+    return dx * dx + dy * dy + dz * dz <= bounds.radius * bounds.radius;
+}
+
+static bool OnRay(const Ray& ray, const BoundingSphere& bounds)
+{
+    Vector3 offset(bounds.center.x - ray.origin.x, bounds.center.y - ray.origin.y, bounds.center.z - ray.origin.z);
+    float t = offset.x * ray.direction.x + offset.y * ray.direction.y + offset.z * ray.direction.z;
+    t = std::min(std::max(t, 0.0f), ray.max_distance);
+    float dx = offset.x - ray.direction.x * t;
+    float dy = offset.y - ray.direction.y * t;
+    float dz = offset.z - ray.direction.z * t;
+    return dx * dx + dy * dy + dz * dz <= bounds.radius * bounds.radius;
+}
+
+struct QueryShapes
+{
+    std::vector<Frustum> frustums;
+    std::vector<BoundingSphere> spheres;
+    std::vector<AABB> boxes;
+    std::vector<Ray> rays;
+};
+
+static QueryShapes MakeQueryShapes(Random& random)
+{
+    QueryShapes shapes;
+    for(uint32_t i=0; i<k_query_count; i++)
+    {
+        Vector3 position(random.Next(-k_world_half_size, k_world_half_size), random.Next(-k_world_half_size, k_world_half_size),
+            random.Next(-k_world_half_size, k_world_half_size));
+        shapes.frustums.push_back(MakeFrustum(position, random.Next(0.0f, 6.2831853f), 200.0f));
+
+        BoundingSphere sphere;
+        sphere.center = position;
+        sphere.radius = 32.0f;
+        shapes.spheres.push_back(sphere);
+
+        AABB box;
+        box.min = Vector3(position.x - 32.0f, position.y - 32.0f, position.z - 32.0f);
+        box.max = Vector3(position.x + 32.0f, position.y + 32.0f, position.z + 32.0f);
+        shapes.boxes.push_back(box);
+
+        Ray ray;
+        ray.origin = position;
+        Vector3 direction(random.Next(-1.0f, 1.0f), random.Next(-1.0f, 1.0f), random.Next(-1.0f, 1.0f));
+        float inv_length = 1.0f / std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+        ray.direction = Vector3(direction.x * inv_length, direction.y * inv_length, direction.z * inv_length);
+        ray.max_distance = 1000.0f;
+        shapes.rays.push_back(ray);
+    }
+    return shapes;
+}
+
+// runs every query of one kind with both, returns false when a query's objects differ
+template<typename Shape, typename OctreeQuery, typename ObjectTest>
+static bool CompareQueries(const char* name, const std::vector<Shape>& shapes, const LooseOctree& octree,
+    const std::vector<BoundingSphere>& bounds, OctreeQuery&& octree_query, ObjectTest&& object_test)
+{
+    std::vector<OctreeHandle> octree_results;
+    std::vector<uint32_t> brute_force_results;
+    uint64_t result_count = 0;
+    double octree_seconds = MeasureSeconds(3, [&]()
+    {
+        result_count = 0;
+        for(const Shape& shape : shapes)
+        {
+            octree_results.clear();
+            octree_query(shape, octree_results);
+            result_count += octree_results.size();
+        }
+    });
+    double brute_force_seconds = MeasureSeconds(3, [&]()
+    {
+        for(const Shape& shape : shapes)
+        {
+            brute_force_results.clear();
+            for(uint32_t i=0; i<bounds.size(); i++)
+            {
+                if(object_test(shape, bounds[i]))
+                {
+                    brute_force_results.push_back(i);
+                }
+            }
+            DoNotOptimize(brute_force_results.size());
+        }
+    });
+
+    // user data is the object index
+    bool b_identical = true;
+    for(const Shape& shape : shapes)
+    {
+        octree_results.clear();
+        octree_query(shape, octree_results);
+        std::vector<uint32_t> objects;
+        for(OctreeHandle handle : octree_results)
+        {
+            objects.push_back(octree.GetUserData(handle));
+        }
+        std::sort(objects.begin(), objects.end());
+
+        brute_force_results.clear();
+        for(uint32_t i=0; i<bounds.size(); i++)
+        {
+            if(object_test(shape, bounds[i]))
+            {
+                brute_force_results.push_back(i);
+            }
+        }
+        b_identical &= objects == brute_force_results;
+    }
+
+    uint32_t query_count = (uint32_t)shapes.size();
+    printf("%8s | %10.1f | %14.2f %16.2f %8.1fx%s\n", name, (double)result_count / query_count,
+        octree_seconds * 1e6 / query_count, brute_force_seconds * 1e6 / query_count, brute_force_seconds / octree_seconds,
+        b_identical ? "" : "  RESULTS DIFFER");
+    return b_identical;
+}
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    uint32_t object_count = std::max<uint32_t>((uint32_t)(100000 * scale), 1);
+
+    Random random;
+    std::vector<BoundingSphere> bounds(object_count);
+    std::vector<Vector3> velocities(object_count);
+    for(uint32_t i=0; i<object_count; i++)
+    {
+        bounds[i].center = Vector3(random.Next(-k_world_half_size, k_world_half_size), random.Next(-k_world_half_size, k_world_half_size),
+            random.Next(-k_world_half_size, k_world_half_size));
+        bounds[i].radius = random.Next(0.5f, 4.0f);
+        velocities[i] = Vector3(random.Next(-2.0f, 2.0f), random.Next(-2.0f, 2.0f), random.Next(-2.0f, 2.0f));
+    }
+
+    LooseOctree octree(Vector3::Zero, k_world_half_size);
+    std::vector<OctreeHandle> handles(object_count);
+    for(uint32_t i=0; i<object_count; i++)
+    {
+        handles[i] = octree.Insert(bounds[i], i);
+    }
+
+    // objects bounce off the world bounds so they stay in the root cell
+    auto move = [&](uint32_t i)
+    {
+        float* center = &bounds[i].center.x;
+        float* velocity = &velocities[i].x;
+        for(int axis=0; axis<3; axis++)
+        {
+            center[axis] += velocity[axis];
+            if(std::abs(center[axis]) > k_world_half_size)
+            {
+                velocity[axis] = -velocity[axis];
+                center[axis] += 2.0f * velocity[axis];
+            }
+        }
+    };
+
+    printf("%u objects, %u nodes\n", object_count, octree.GetNodeCount());
+    printf("%8s | %18s %18s\n", "moving", "octree (ms/frame)", "brute (ms/frame)");
+    const uint32_t moving_strides[] = { 10, 1 };
+    for(uint32_t stride : moving_strides)
+    {
+        double octree_seconds = MeasureSeconds(k_frame_count, [&]()
+        {
+            for(uint32_t i=0; i<object_count; i+=stride)
+            {
+                move(i);
+                octree.Move(handles[i], bounds[i]);
+            }
+        });
+        double brute_force_seconds = MeasureSeconds(k_frame_count, [&]()
+        {
+            for(uint32_t i=0; i<object_count; i+=stride)
+            {
+                move(i);
+            }
+        });
+        DoNotOptimize(bounds.data());
+        printf("%7u%% | %18.3f %18.3f\n", 100 / stride, octree_seconds * 1e3, brute_force_seconds * 1e3);
+    }
+
+    // the brute force pass moved the objects again, the octree catches up before the queries compare
+    for(uint32_t i=0; i<object_count; i++)
+    {
+        octree.Move(handles[i], bounds[i]);
+    }
+
+    QueryShapes shapes = MakeQueryShapes(random);
+    printf("\n%u queries each\n", k_query_count);
+    printf("%8s | %10s | %14s %16s %9s\n", "query", "results", "octree (us)", "brute (us)", "speedup");
+    bool b_all_identical = true;
+    b_all_identical &= CompareQueries("frustum", shapes.frustums, octree, bounds,
+        [&octree](const Frustum& frustum, std::vector<OctreeHandle>& results) { octree.QueryFrustum(frustum, results); }, InFrustum);
+    b_all_identical &= CompareQueries("sphere", shapes.spheres, octree, bounds,
+        [&octree](const BoundingSphere& sphere, std::vector<OctreeHandle>& results) { octree.QuerySphere(sphere, results); }, InSphere);
+    b_all_identical &= CompareQueries("aabb", shapes.boxes, octree, bounds,
+        [&octree](const AABB& box, std::vector<OctreeHandle>& results) { octree.QueryAABB(box, results); }, InAABB);
+    b_all_identical &= CompareQueries("ray", shapes.rays, octree, bounds,
+        [&octree](const Ray& ray, std::vector<OctreeHandle>& results) { octree.QueryRay(ray, results); }, OnRay);
+    return b_all_identical ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+// per draw parameter binding cost of the string lookups against handles resolved once, see ShaderParamHandle
+// and MaterialVariableHandle
+// usage: ParameterBindingBenchmark [scale]
+// every draw sets two shader cbuffers and three material variables the way a draw loop does, only the
+// setters are timed, BindParameters does the same work on both paths
+#include "Benchmark.h"
+#include "Tests/TempDirectory.h"
+#include "D3DRHI/HeadlessDevice.h"
+#include "Material/Material.h"
+#include "Material/ShaderCache.h"
+
+// cbuffers above RootSignatureOptimizer::k_max_root_constant_dwords so they stay root descriptors
+static const char* const k_shader_source = R"(
+cbuffer cbPerObject : register(b0)
+{
+    float4x4 gWorldViewProj;
+    float4 gColor;
+    float gRoughness;
+};
+cbuffer cbPerFrame : register(b1)
+{
+    float4x4 gViewProj;
+    float4 gTime;
+};
+cbuffer cbLight : register(b2)
+{
+    float4x4 gLightViewProj;
+    float4 gLightColor;
+};
+cbuffer cbRarely : register(b3)
+{
+    float4x4 gShadowViewProj;
+    float4 gFogColor;
+};
+
+float4 VS(float3 pos : POSITION) : SV_POSITION
+{
+    float4 pos_h = mul(mul(float4(pos, 1.0f), gWorldViewProj), gViewProj);
+    return pos_h + mul(pos_h, gLightViewProj) * gTime + mul(pos_h, gShadowViewProj);
+}
+
+float4 PS(float4 pos : SV_POSITION) : SV_Target
+{
+    return gColor * gRoughness + gLightColor + gFogColor;
+}
+)";
+
+static const uint32_t k_instance_count = 64;
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    uint32_t draw_count = (uint32_t)(100000 * scale);
+    draw_count = draw_count > 0 ? draw_count : 1;
+
+    TempDirectory temp_directory("ParameterBindingBenchmark");
+    ShaderCache::SetCacheDirectory("");
+
+    HeadlessDevice headless_device;
+    ID3D12Device* device = headless_device.GetDevice();
+
+    ShaderInfo shader_info;
+    shader_info.shader_name = "ParameterBinding";
+    shader_info.file_name = temp_directory.WriteFile("binding.hlsl", k_shader_source);
+    shader_info.b_create_VS = true;
+    shader_info.b_create_PS = true;
+    Shader shader(shader_info, device);
+
+    MaterialTemplate material_template(&shader, device);
+    material_template.AddOverride("gWorldViewProj");
+    material_template.AddOverride("gColor");
+    material_template.AddOverride("gRoughness");
+    std::vector<MaterialInstance*> instances;
+    for(uint32_t i=0; i<k_instance_count; i++)
+    {
+        instances.push_back(material_template.CreateInstance());
+    }
+
+    // two of each so every draw changes the bound address
+    std::unique_ptr<D3D12ConstantBuffer> frame_cbs[2];
+    std::unique_ptr<D3D12ConstantBuffer> light_cbs[2];
+    for(int i=0; i<2; i++)
+    {
+        frame_cbs[i] = std::make_unique<D3D12ConstantBuffer>(device, 256);
+        light_cbs[i] = std::make_unique<D3D12ConstantBuffer>(device, 256);
+    }
+
+    Matrix world_view_proj = Matrix::CreateTranslation(1.0f, 2.0f, 3.0f);
+    Vector4 color(1.0f, 0.5f, 0.25f, 1.0f);
+
+    double string_seconds = MeasureSeconds(5, [&]()
+    {
+        for(uint32_t draw=0; draw<draw_count; draw++)
+        {
+            MaterialInstance* instance = instances[draw % k_instance_count];
+            shader.SetParameter("cbPerFrame", frame_cbs[draw & 1].get());
+            shader.SetParameter("cbLight", light_cbs[draw & 1].get());
+            instance->SetParameter("gWorldViewProj", world_view_proj);
+            instance->SetParameter("gColor", color);
+            instance->SetParameter("gRoughness", (float)draw);
+        }
+    });
+
+    const ShaderParamHandle frame_cb_handle = shader.GetParameterHandle("cbPerFrame");
+    const ShaderParamHandle light_cb_handle = shader.GetParameterHandle("cbLight");
+    const MaterialVariableHandle world_view_proj_handle = material_template.GetVariableHandle("gWorldViewProj");
+    const MaterialVariableHandle color_handle = material_template.GetVariableHandle("gColor");
+    const MaterialVariableHandle roughness_handle = material_template.GetVariableHandle("gRoughness");
+    assert(frame_cb_handle.IsValid() && light_cb_handle.IsValid() && !shader.IsRootConstants(frame_cb_handle));
+
+    double handle_seconds = MeasureSeconds(5, [&]()
+    {
+        for(uint32_t draw=0; draw<draw_count; draw++)
+        {
+            MaterialInstance* instance = instances[draw % k_instance_count];
+            shader.SetParameter(frame_cb_handle, frame_cbs[draw & 1].get());
+            shader.SetParameter(light_cb_handle, light_cbs[draw & 1].get());
+            instance->SetParameter(world_view_proj_handle, world_view_proj);
+            instance->SetParameter(color_handle, color);
+            instance->SetParameter(roughness_handle, (float)draw);
+        }
+    });
+
+    for(MaterialInstance* instance : instances)
+    {
+        material_template.DestroyInstance(instance);
+    }
+
+    printf("%u draws, 2 shader cbuffers and 3 material variables each\n", draw_count);
+    printf("%8s %12s %14s\n", "path", "time (ms)", "ns per draw");
+    printf("%8s %12.2f %14.1f\n", "string", string_seconds * 1e3, string_seconds * 1e9 / draw_count);
+    printf("%8s %12.2f %14.1f\n", "handle", handle_seconds * 1e3, handle_seconds * 1e9 / draw_count);
+    printf("handles are %.1fx faster\n", string_seconds / handle_seconds);
+    return 0;
+}
@@ -0,0 +1,93 @@
+// sorts 100k - 1M draw keys with RenderQueue's radix sort and reports the state changes a draw loop
+// issues in submission order and in sorted order, std::sort of the same keys is the reference
+// usage: RenderQueueBenchmark [scale]
+// draws are generated in random order over 4096 meshes, each drawn with one of 4 materials out of 1024,
+// each material using one of 64 psos, 10% transparent
+#include <algorithm>
+#include <random>
+#include "Benchmark.h"
+#include "Renderer/RenderQueue.h"
+
+static const uint32_t k_pso_count = 64;
+static const uint32_t k_material_count = 1024;
+static const uint32_t k_mesh_count = 4096;
+
+static std::vector<uint64_t> GenerateKeys(uint32_t count)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+
+    std::vector<uint64_t> keys(count);
+    for(uint64_t& key : keys)
+    {
+        RenderPass pass = random() % 10 == 0 ? RenderPass::k_transparent : RenderPass::k_opaque;
+        uint32_t mesh_id = random() % k_mesh_count;
+        uint32_t material_id = (mesh_id * 7 + random() % 4) % k_material_count;
+        key = RenderQueue::MakeKey(pass, material_id % k_pso_count, material_id, mesh_id, depth(random));
+    }
+    return keys;
+}
+
+static void FillQueue(RenderQueue& queue, const std::vector<uint64_t>& keys)
+{
+    queue.Clear();
+    for(uint32_t i=0; i<(uint32_t)keys.size(); i++)
+    {
+        queue.Push(keys[i], i);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    const uint32_t draw_counts[] = { 100000, 250000, 500000, 1000000 };
+
+    printf("%9s %11s %11s %9s | %22s | %22s | %22s\n", "draws", "radix (ms)", "std (ms)", "Mkeys/s",
+        "pso changes", "material changes", "mesh changes");
+    printf("%9s %11s %11s %9s | %10s %11s | %10s %11s | %10s %11s\n", "", "", "", "",
+        "unsorted", "sorted", "unsorted", "sorted", "unsorted", "sorted");
+
+    bool b_all_identical = true;
+    for(uint32_t base_count : draw_counts)
+    {
+        uint32_t draw_count = std::max<uint32_t>((uint32_t)(base_count * scale), 1);
+        std::vector<uint64_t> keys = GenerateKeys(draw_count);
+
+        // only the sort is timed, the queue is refilled in submission order before each run
+        RenderQueue queue;
+        queue.Reserve(draw_count);
+        double radix_seconds = 1e30;
+        for(int run=0; run<5; run++)
+        {
+            FillQueue(queue, keys);
+            radix_seconds = std::min(radix_seconds, MeasureSeconds(1, [&]() { queue.Sort(); }));
+        }
+
+        std::vector<uint64_t> reference;
+        double std_seconds = 1e30;
+        for(int run=0; run<5; run++)
+        {
+            reference = keys;
+            std_seconds = std::min(std_seconds, MeasureSeconds(1, [&]() { std::sort(reference.begin(), reference.end()); }));
+        }
+
+        // stable, equal keys keep submission order
+        bool b_identical = true;
+        for(size_t i=0; i<queue.GetCount(); i++)
+        {
+            b_identical &= queue.GetKey(i) == reference[i] && keys[queue.GetItem(i)] == queue.GetKey(i);
+            b_identical &= i == 0 || queue.GetKey(i) != queue.GetKey(i - 1) || queue.GetItem(i) > queue.GetItem(i - 1);
+        }
+        b_all_identical &= b_identical;
+
+        const RenderQueueStats& unsorted = queue.GetUnsortedStats();
+        const RenderQueueStats& sorted = queue.GetSortedStats();
+        printf("%9u %11.2f %11.2f %9.1f | %10llu %11llu | %10llu %11llu | %10llu %11llu%s\n",
+            draw_count, radix_seconds * 1e3, std_seconds * 1e3, draw_count / radix_seconds * 1e-6,
+            (unsigned long long)unsorted.pso_changes, (unsigned long long)sorted.pso_changes,
+            (unsigned long long)unsorted.material_changes, (unsigned long long)sorted.material_changes,
+            (unsigned long long)unsorted.mesh_changes, (unsigned long long)sorted.mesh_changes,
+            b_identical ? "" : "  ORDER DIFFERS");
+    }
+    return b_all_identical ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+// updates and destroys nodes of a SceneHierarchy holding 100k nodes
+// usage: SceneHierarchyBenchmark [scale]
+//   deep: chains of k_chain_depth nodes, a dirty node drags its whole chain below it along
+//   wide: roots with k_wide_children direct children each
+// update: local transforms of 1% - 100% of the nodes are set, then UpdateWorldMatrices is timed, single threaded
+//         and with the default job system, "updated" is how many nodes it recomputed
+// destroy: 1% - 100% of the nodes are destroyed in random order, then UpdateWorldMatrices compacts the arrays once,
+//          the total stays around one pass over the arrays where compacting per destroyed node was destroyed x node count
+#include <algorithm>
+#include <vector>
+#include "Benchmark.h"
+#include "Scene/SceneHierarchy.h"
+#include "Utility/JobSystem.h"
+
+static const uint32_t k_chain_depth = 64;
+static const uint32_t k_wide_children = 1023;
+
+// depth first parents for AppendNodes, each group is a root followed by group_size - 1 nodes
+static std::vector<uint32_t> MakeParents(uint32_t node_count, uint32_t group_size, bool b_chain)
+{
+    std::vector<uint32_t> parents(node_count);
+    for(uint32_t i=0; i<node_count; i++)
+    {
+        uint32_t root = i - i % group_size;
+        parents[i] = i == root ? k_invalid_scene_node : b_chain ? i - 1 : root;
+    }
+    return parents;
+}
+
+// fixed seed so every run touches the same nodes
+static std::vector<SceneNodeID> Shuffled(const std::vector<SceneNodeID>& nodes)
+{
+    std::vector<SceneNodeID> result = nodes;
+    uint32_t state = 12345;
+    for(uint32_t i=(uint32_t)result.size(); i-- > 1; )
+    {
+        state = state * 1664525u + 1013904223u;
+        std::swap(result[i], result[state % (i + 1)]);
+    }
+    return result;
+}
+
+static Transform MakeLocalTransform(uint32_t i)
+{
+    Transform transform;
+    transform.Location = Vector3((float)(i % 7), 1.0f, 0.5f);
+    transform.Rotation = Quaternion::CreateFromYawPitchRoll(0.01f * (float)(i % 13), 0.02f, 0.0f);
+    transform.Scale = Vector3(1.0f, 1.0f, 1.0f);
+    return transform;
+}
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    uint32_t node_count = std::max<uint32_t>((uint32_t)(100000 * scale), k_wide_children + 1);
+    const uint32_t percents[] = { 1, 10, 50, 100 };
+    const char* shape_names[] = { "deep", "wide" };
+
+    bool b_all_valid = true;
+    printf("update, %u nodes\n", node_count);
+    printf("%6s %6s | %10s %14s %10s\n", "shape", "dirty", "updated", "1 thread (ms)", "jobs (ms)");
+    for(int shape=0; shape<2; shape++)
+    {
+        bool b_chain = shape == 0;
+        std::vector<uint32_t> parents = MakeParents(node_count, b_chain ? k_chain_depth : k_wide_children + 1, b_chain);
+        SceneHierarchy hierarchy;
+        std::vector<SceneNodeID> nodes(node_count);
+        hierarchy.AppendNodes(node_count, parents.data(), nodes.data());
+        hierarchy.UpdateWorldMatrices();
+        std::vector<SceneNodeID> order = Shuffled(nodes);
+
+        for(uint32_t percent : percents)
+        {
+            uint32_t dirty_count = std::max<uint32_t>(node_count / 100 * percent, 1);
+            double times[2] = { 1e30, 1e30 };
+            for(int run=0; run<10; run++)
+            {
+                for(uint32_t i=0; i<dirty_count; i++)
+                {
+                    hierarchy.SetLocalTransform(order[i], MakeLocalTransform(i + run));
+                }
+                JobSystem* job_system = run % 2 ? &JobSystem::GetDefault() : nullptr;
+                times[run % 2] = std::min(times[run % 2], MeasureSeconds(1, [&]() { hierarchy.UpdateWorldMatrices(job_system); }));
+            }
+            DoNotOptimize(hierarchy.GetWorldMatrices());
+            b_all_valid &= hierarchy.GetUpdatedCount() >= dirty_count;
+
+            printf("%6s %5u%% | %10u %14.3f %10.3f\n", shape_names[shape], percent, hierarchy.GetUpdatedCount(), times[0] * 1e3, times[1] * 1e3);
+        }
+    }
+
+    printf("\ndestroy, %u nodes\n", node_count);
+    printf("%6s %9s | %10s %12s\n", "shape", "destroyed", "total (ms)", "per node (ns)");
+    for(int shape=0; shape<2; shape++)
+    {
+        bool b_chain = shape == 0;
+        std::vector<uint32_t> parents = MakeParents(node_count, b_chain ? k_chain_depth : k_wide_children + 1, b_chain);
+        for(uint32_t percent : percents)
+        {
+            uint32_t destroy_count = std::max<uint32_t>(node_count / 100 * percent, 1);
+            double best = 1e30;
+            for(int run=0; run<5; run++)
+            {
+                SceneHierarchy hierarchy;
+                std::vector<SceneNodeID> nodes(node_count);
+                hierarchy.AppendNodes(node_count, parents.data(), nodes.data());
+                hierarchy.UpdateWorldMatrices();
+                std::vector<SceneNodeID> order = Shuffled(nodes);
+
+                best = std::min(best, MeasureSeconds(1, [&]()
+                {
+                    for(uint32_t i=0; i<destroy_count; i++)
+                    {
+                        hierarchy.DestroyNode(order[i]);
+                    }
+                    hierarchy.UpdateWorldMatrices();
+                }));
+                b_all_valid &= hierarchy.GetNodeCount() == node_count - destroy_count;
+            }
+
+            printf("%6s %8u%% | %10.3f %12.1f\n", shape_names[shape], percent, best * 1e3, best * 1e9 / destroy_count);
+        }
+    }
+
+    if(!b_all_valid)
+    {
+        printf("UNEXPECTED NODE COUNTS\n");
+    }
+    return b_all_valid ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+// loads a 1M object scene file into a SceneHierarchy, against building the same scene object by object in code
+// usage: SceneLoadBenchmark [scale]
+// the scene is SceneWriter's: groups of one root and k_group_size - 1 children, written once to a temporary file
+//   code: what building the scene in code costs, one heap object with its name strings per object
+//         and one CreateNode and SetLocalTransform per node, CreateNode under a parent reorders the arrays
+//         so the cost per object grows with the scene, it is timed on the first k_code_object_count objects
+//         and its time per object is a lower bound for the whole scene
+//   file: SceneFile::Open maps and validates the file (it is in the OS cache after writing, so no disk reads),
+//         then BoxApp::LoadScene's hierarchy part: AppendNodes, GetLocalTransforms and SetLocalTransform
+// both end with UpdateWorldMatrices and have to produce the same world matrices for the objects both built
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+#include "Scene/SceneFile.h"
+#include "Scene/SceneHierarchy.h"
+
+static const uint32_t k_group_size = 8;
+static const float k_spacing = 4.0f;
+static const uint32_t k_code_object_count = 10000;
+static const char* const k_path = "SceneLoadBenchmark.scene";
+
+// the objects of the scenes built in code
+struct CodeObject
+{
+    std::string name;
+    std::string mesh;
+    std::string material;
+    SceneNodeID node = k_invalid_scene_node;
+};
+
+static Transform MakeLocalTransform(uint32_t i, uint32_t grid_size)
+{
+    Transform transform;
+    uint32_t group_object = i % k_group_size;
+    if(group_object == 0)
+    {
+        uint32_t group = i / k_group_size;
+        transform.Location = Vector3((group % grid_size) * k_spacing * 2.0f, -8.0f, 40.0f + (group / grid_size) * k_spacing * 2.0f);
+    }
+    else
+    {
+        float angle = group_object * 6.2831853f / (k_group_size - 1);
+        transform.Location = Vector3(std::cos(angle) * k_spacing, 2.0f, std::sin(angle) * k_spacing);
+        transform.Scale = Vector3(0.5f, 0.5f, 0.5f);
+    }
+    return transform;
+}
+
+// of the first count nodes, both are in the depth first order of the file
+static bool SameWorldMatrices(const SceneHierarchy& a, const SceneHierarchy& b, uint32_t count)
+{
+    if(a.GetNodeCount() < count || b.GetNodeCount() < count)
+    {
+        return false;
+    }
+    const float* a_values = &a.GetWorldMatrices()[0]._11;
+    const float* b_values = &b.GetWorldMatrices()[0]._11;
+    for(size_t i=0; i<(size_t)count * 16; i++)
+    {
+        if(std::abs(a_values[i] - b_values[i]) > 1e-4f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    uint32_t object_count = std::max<uint32_t>((uint32_t)(1000000 * scale), k_group_size);
+    uint32_t group_count = (object_count + k_group_size - 1) / k_group_size;
+    uint32_t grid_size = (uint32_t)std::ceil(std::sqrt((float)group_count));
+
+    SceneFileWriter writer;
+    uint32_t root = SceneFileView::k_no_parent;
+    double write_seconds = MeasureSeconds(1, [&]()
+    {
+        for(uint32_t i=0; i<object_count; i++)
+        {
+            uint32_t parent = i % k_group_size == 0 ? SceneFileView::k_no_parent : root;
+            uint32_t object = writer.AddObject("object_" + std::to_string(i), parent, MakeLocalTransform(i, grid_size), (i % 2) ? "sphere" : "box", "default");
+            root = i % k_group_size == 0 ? object : root;
+        }
+    });
+    if(!writer.Write(k_path))
+    {
+        printf("cannot write %s\n", k_path);
+        return 1;
+    }
+    size_t file_size = writer.Finish().size();
+
+    // each run starts from an empty hierarchy, the best of 3 like the other benchmarks
+    uint32_t code_object_count = std::min(object_count, k_code_object_count);
+    std::unique_ptr<SceneHierarchy> code_hierarchy;
+    std::vector<std::unique_ptr<CodeObject>> code_objects;
+    double code_seconds = 1e30;
+    for(int run=0; run<3; run++)
+    {
+        code_objects.clear();
+        code_hierarchy = std::make_unique<SceneHierarchy>();
+        code_seconds = std::min(code_seconds, MeasureSeconds(1, [&]()
+        {
+            SceneNodeID root_node = k_invalid_scene_node;
+            for(uint32_t i=0; i<code_object_count; i++)
+            {
+                std::unique_ptr<CodeObject> object = std::make_unique<CodeObject>();
+                object->name = "object_" + std::to_string(i);
+                object->mesh = (i % 2) ? "sphere" : "box";
+                object->material = "default";
+                object->node = code_hierarchy->CreateNode(i % k_group_size == 0 ? k_invalid_scene_node : root_node);
+                code_hierarchy->SetLocalTransform(object->node, MakeLocalTransform(i, grid_size));
+                root_node = i % k_group_size == 0 ? object->node : root_node;
+                code_objects.push_back(std::move(object));
+            }
+            code_hierarchy->UpdateWorldMatrices();
+        }));
+    }
+
+    std::unique_ptr<SceneHierarchy> file_hierarchy;
+    double times[4] = { 1e30, 1e30, 1e30, 1e30 };     // open, transforms, hierarchy, total
+    for(int run=0; run<3; run++)
+    {
+        SceneFile scene_file;
+        file_hierarchy = std::make_unique<SceneHierarchy>();
+        std::vector<SceneNodeID> nodes;
+        std::vector<Transform> local_transforms;
+        double open_seconds = MeasureSeconds(1, [&]()
+        {
+            if(!scene_file.Open(k_path))
+            {
+                printf("cannot load %s back\n", k_path);
+                exit(1);
+            }
+        });
+        const SceneFileView& scene = scene_file.GetView();
+        double transform_seconds = MeasureSeconds(1, [&]()
+        {
+            local_transforms.resize(scene.GetObjectCount());
+            scene.GetLocalTransforms(0, scene.GetObjectCount(), local_transforms.data());
+        });
+        double hierarchy_seconds = MeasureSeconds(1, [&]()
+        {
+            nodes.resize(scene.GetObjectCount());
+            file_hierarchy->AppendNodes(scene.GetObjectCount(), scene.GetParents(), nodes.data());
+            for(uint32_t i=0; i<scene.GetObjectCount(); i++)
+            {
+                file_hierarchy->SetLocalTransform(nodes[i], local_transforms[i]);
+            }
+            file_hierarchy->UpdateWorldMatrices();
+        });
+
+        const double run_times[4] = { open_seconds, transform_seconds, hierarchy_seconds, open_seconds + transform_seconds + hierarchy_seconds };
+        for(int i=0; i<4; i++)
+        {
+            times[i] = std::min(times[i], run_times[i]);
+        }
+    }
+    std::remove(k_path);
+
+    bool b_identical = SameWorldMatrices(*code_hierarchy, *file_hierarchy, code_object_count);
+    printf("%u objects, %.1f MB file, written in %.1f ms\n", object_count, file_size / (1024.0 * 1024.0), write_seconds * 1e3);
+    printf("%6s | %10s %15s %15s | %10s %15s\n", "path", "open (ms)", "transforms (ms)", "hierarchy (ms)", "total (ms)", "per object (ns)");
+    printf("%6s | %10s %15s %15s | %10s %15.1f  (%u objects in %.1f ms)\n", "code", "-", "-", "-", "-",
+        code_seconds * 1e9 / code_object_count, code_object_count, code_seconds * 1e3);
+    printf("%6s | %10.1f %15.1f %15.1f | %10.1f %15.1f\n", "file", times[0] * 1e3, times[1] * 1e3, times[2] * 1e3, times[3] * 1e3, times[3] * 1e9 / object_count);
+    printf("file load is at least %.1fx faster per object%s\n", (code_seconds / code_object_count) / (times[3] / object_count),
+        b_identical ? "" : "  WORLD MATRICES DIFFER");
+    return b_identical ? 0 : 1;
+}
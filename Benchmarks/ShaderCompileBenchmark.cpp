@@ -0,0 +1,104 @@
+// compiles N shader variants through a stub compiler on ThreadPool, the way Shader::CreateShaders dispatches
+// one job per stage x permutation and joins them in input order, and reports the scaling across thread counts
+// usage: ShaderCompileBenchmark [scale]
+// the stub burns a fixed amount of cpu per stage and hashes its input, so the joined output has to be
+// bit identical for every thread count
+#include <cstring>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "Utility/ThreadPool.h"
+
+static const uint32_t k_stub_compile_rounds = 200000;   // about a millisecond per stage
+static const char* const k_stage_names[] = { "VS", "PS" };
+
+// deterministic stand-in for D3DCompileFromFile, the "bytecode" only depends on the source and the defines
+static std::vector<uint8_t> StubCompile(const std::string& source, const std::string& defines, const char* stage)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const std::string& text)
+    {
+        for(char c : text)
+        {
+            hash = (hash ^ (uint8_t)c) * 1099511628211ull;
+        }
+    };
+    mix(source);
+    mix(defines);
+    mix(stage);
+
+    std::vector<uint8_t> bytecode(256);
+    for(uint32_t round=0; round<k_stub_compile_rounds; round++)
+    {
+        hash ^= hash << 13;
+        hash ^= hash >> 7;
+        hash ^= hash << 17;
+        bytecode[round & 255] ^= (uint8_t)hash;
+    }
+    return bytecode;
+}
+
+static std::vector<uint8_t> CompileVariants(ThreadPool& pool, const std::string& source, uint32_t variant_count)
+{
+    std::vector<std::future<std::vector<uint8_t>>> jobs;
+    jobs.reserve(variant_count * 2);
+    for(uint32_t variant=0; variant<variant_count; variant++)
+    {
+        std::string defines = "VARIANT=" + std::to_string(variant);
+        for(const char* stage : k_stage_names)
+        {
+            jobs.push_back(pool.Submit([&source, defines, stage]() { return StubCompile(source, defines, stage); }));
+        }
+    }
+
+    // joined in dispatch order like Shader::FinishInitialize, whichever job finished first
+    std::vector<uint8_t> output;
+    for(auto& job : jobs)
+    {
+        std::vector<uint8_t> bytecode = job.get();
+        output.insert(output.end(), bytecode.begin(), bytecode.end());
+    }
+    return output;
+}
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    uint32_t variant_count = (uint32_t)(256 * scale);
+    variant_count = variant_count > 0 ? variant_count : 1;
+    const std::string source = "cbuffer cbPerObject : register(b0) { float4x4 gWorldViewProj; };";
+
+    unsigned int hardware_threads = std::thread::hardware_concurrency();
+    hardware_threads = hardware_threads > 0 ? hardware_threads : 1;
+
+    printf("%u variants x %u stages through the stub compiler\n", variant_count, (uint32_t)(sizeof(k_stage_names) / sizeof(k_stage_names[0])));
+    printf("%8s %12s %10s %12s %s\n", "threads", "time (ms)", "speedup", "efficiency", "output");
+
+    std::vector<uint8_t> reference;
+    double single_thread_seconds = 0.0;
+    bool b_all_identical = true;
+    for(unsigned int thread_count=1; ; thread_count = thread_count * 2 < hardware_threads ? thread_count * 2 : hardware_threads)
+    {
+        ThreadPool pool(thread_count);
+        std::vector<uint8_t> output;
+        double seconds = MeasureSeconds(3, [&]() { output = CompileVariants(pool, source, variant_count); });
+        if(thread_count == 1)
+        {
+            reference = output;
+            single_thread_seconds = seconds;
+        }
+
+        bool b_identical = output.size() == reference.size() && memcmp(output.data(), reference.data(), output.size()) == 0;
+        b_all_identical &= b_identical;
+        double speedup = single_thread_seconds / seconds;
+        printf("%8u %12.2f %9.2fx %11.0f%% %s\n", thread_count, seconds * 1e3, speedup, 100.0 * speedup / thread_count, b_identical ? "identical" : "DIFFERS");
+
+        if(thread_count == hardware_threads)
+        {
+            break;
+        }
+    }
+    return b_all_identical ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+// world matrices of 1k - 1M transforms, the batched SoA kernels against building them object by object
+// usage: TransformBenchmark [scale]
+// random locations, rotations in [-360, 360] degrees per axis and scales in [0.1, 10]
+//   euler:  the per object path before quaternions, S * R * T with Matrix::CreateFromYawPitchRoll of the Rotator in degrees
+//   object: Transform::GetTransformMatrixLH per object, built from the quaternion
+//   batch:  Transform::GetTransformMatricesLH over SoA arrays of the same transforms
+//   euler batch: RotatorsToQuaternions then GetTransformMatricesLH, the batched path from Rotator degrees like scene loading
+// every path has to produce the euler matrices within k_tolerance, relative to the largest value of each row
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Benchmark.h"
+#include "Math/Transform.h"
+
+static const float k_tolerance = 1e-5f;
+
+// fixed seed so every run builds the same transforms
+class Random
+{
+public:
+    float Next(float min, float max)
+    {
+        m_state = m_state * 1664525u + 1013904223u;
+        return min + (max - min) * (float)(m_state >> 8) / (float)(1u << 24);
+    }
+
+private:
+    uint32_t m_state = 12345;
+};
+
+// the transforms in both layouts, Transform for the per object paths and SoA arrays for the batches
+struct TransformSet
+{
+    std::vector<Transform> transforms;
+    std::vector<Rotator> rotators;
+    std::vector<float> soa[10];         // location xyz, rotation xyzw, scale xyz
+    std::vector<float> degrees[3];      // roll, pitch, yaw
+    TransformArrays arrays;
+
+    explicit TransformSet(uint32_t count)
+    {
+        Random random;
+        for(uint32_t i=0; i<count; i++)
+        {
+            Rotator rotator(random.Next(-360.0f, 360.0f), random.Next(-360.0f, 360.0f), random.Next(-360.0f, 360.0f));
+            Transform transform;
+            transform.Location = Vector3(random.Next(-100.0f, 100.0f), random.Next(-100.0f, 100.0f), random.Next(-100.0f, 100.0f));
+            transform.SetRotator(rotator);
+            transform.Scale = Vector3(random.Next(0.1f, 10.0f), random.Next(0.1f, 10.0f), random.Next(0.1f, 10.0f));
+            transforms.push_back(transform);
+            rotators.push_back(rotator);
+
+            const float values[10] = { transform.Location.x, transform.Location.y, transform.Location.z,
+                transform.Rotation.x, transform.Rotation.y, transform.Rotation.z, transform.Rotation.w,
+                transform.Scale.x, transform.Scale.y, transform.Scale.z };
+            for(int j=0; j<10; j++)
+            {
+                soa[j].push_back(values[j]);
+            }
+            degrees[0].push_back(rotator.Roll);
+            degrees[1].push_back(rotator.Pitch);
+            degrees[2].push_back(rotator.Yaw);
+        }
+
+        arrays.location_x = soa[0].data();
+        arrays.location_y = soa[1].data();
+        arrays.location_z = soa[2].data();
+        arrays.rotation_x = soa[3].data();
+        arrays.rotation_y = soa[4].data();
+        arrays.rotation_z = soa[5].data();
+        arrays.rotation_w = soa[6].data();
+        arrays.scale_x = soa[7].data();
+        arrays.scale_y = soa[8].data();
+        arrays.scale_z = soa[9].data();
+    }
+};
+
+// largest error of the matrices against the expected ones, relative to the largest value of each row
+static float GetMaxError(const std::vector<Matrix>& matrices, const std::vector<Matrix>& expected)
+{
+    float max_error = 0.0f;
+    for(size_t i=0; i<matrices.size(); i++)
+    {
+        const float* values = &matrices[i]._11;
+        const float* expected_values = &expected[i]._11;
+        for(int row=0; row<4; row++)
+        {
+            float row_scale = 1.0f;
+            for(int column=0; column<4; column++)
+            {
+                row_scale = std::max(row_scale, std::abs(expected_values[row * 4 + column]));
+            }
+            for(int column=0; column<4; column++)
+            {
+                max_error = std::max(max_error, std::abs(values[row * 4 + column] - expected_values[row * 4 + column]) / row_scale);
+            }
+        }
+    }
+    return max_error;
+}
+
+int main(int argc, char** argv)
+{
+    double scale = GetBenchmarkScale(argc, argv);
+    const uint32_t transform_counts[] = { 1000, 10000, 100000, 1000000 };
+#if defined(__AVX2__)
+    const char* path = "avx2";
+#elif defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+    const char* path = "sse2";
+#else
+    const char* path = "scalar";
+#endif
+
+    printf("%s batches, ns per transform\n", path);
+    printf("%8s | %8s %8s %8s %12s | %13s %13s | %9s\n", "count", "euler", "object", "batch", "euler batch", "batch speedup", "vs object", "max error");
+    bool b_all_accurate = true;
+    for(uint32_t base_count : transform_counts)
+    {
+        uint32_t count = std::max<uint32_t>((uint32_t)(base_count * scale), 1);
+        TransformSet set(count);
+        std::vector<Matrix> euler_matrices(count), object_matrices(count), batch_matrices(count), euler_batch_matrices(count);
+        // the euler batch writes its rotations to its own arrays, GetTransformMatricesLH reads them as SoA
+        std::vector<Quaternion> rotations(count);
+        std::vector<float> euler_rotations[4];
+        for(std::vector<float>& component : euler_rotations)
+        {
+            component.resize(count);
+        }
+        TransformArrays euler_arrays = set.arrays;
+        euler_arrays.rotation_x = euler_rotations[0].data();
+        euler_arrays.rotation_y = euler_rotations[1].data();
+        euler_arrays.rotation_z = euler_rotations[2].data();
+        euler_arrays.rotation_w = euler_rotations[3].data();
+        int repeats = count <= 100000 ? 10 : 3;
+
+        double euler_seconds = MeasureSeconds(repeats, [&]()
+        {
+            for(uint32_t i=0; i<count; i++)
+            {
+                const Transform& transform = set.transforms[i];
+                const Rotator& rotator = set.rotators[i];
+                Matrix S = Matrix::CreateScale(transform.Scale);
+                Matrix R = Matrix::CreateFromYawPitchRoll(Math::DegreesToRadians(rotator.Yaw), Math::DegreesToRadians(rotator.Pitch), Math::DegreesToRadians(rotator.Roll));
+                Matrix T = Matrix::CreateTranslation(transform.Location);
+                euler_matrices[i] = S * R * T;
+            }
+        });
+        double object_seconds = MeasureSeconds(repeats, [&]()
+        {
+            for(uint32_t i=0; i<count; i++)
+            {
+                object_matrices[i] = set.transforms[i].GetTransformMatrixLH();
+            }
+        });
+        double batch_seconds = MeasureSeconds(repeats, [&]()
+        {
+            Transform::GetTransformMatricesLH(set.arrays, count, batch_matrices.data());
+        });
+        double euler_batch_seconds = MeasureSeconds(repeats, [&]()
+        {
+            Transform::RotatorsToQuaternions(set.degrees[0].data(), set.degrees[1].data(), set.degrees[2].data(), count, rotations.data());
+            for(uint32_t i=0; i<count; i++)
+            {
+                euler_rotations[0][i] = rotations[i].x;
+                euler_rotations[1][i] = rotations[i].y;
+                euler_rotations[2][i] = rotations[i].z;
+                euler_rotations[3][i] = rotations[i].w;
+            }
+            Transform::GetTransformMatricesLH(euler_arrays, count, euler_batch_matrices.data());
+        });
+
+        float max_error = std::max({ GetMaxError(object_matrices, euler_matrices), GetMaxError(batch_matrices, euler_matrices),
+            GetMaxError(euler_batch_matrices, euler_matrices) });
+        b_all_accurate &= max_error <= k_tolerance;
+        printf("%8u | %8.2f %8.2f %8.2f %12.2f | %12.1fx %12.1fx | %9.2e%s\n", count, euler_seconds * 1e9 / count, object_seconds * 1e9 / count,
+            batch_seconds * 1e9 / count, euler_batch_seconds * 1e9 / count, euler_seconds / batch_seconds, object_seconds / batch_seconds,
+            max_error, max_error <= k_tolerance ? "" : "  MATRICES DIFFER");
+    }
+    return b_all_accurate ? 0 : 1;
+}
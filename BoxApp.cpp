@@ -8,14 +8,18 @@
 //   Hold the right mouse button down and move the mouse to zoom in and out.
 //***************************************************************************************
 #include "BoxApp.h"
+#include "Utility/FormatConvert.h"
 
 BoxApp::BoxApp(HINSTANCE hInstance)
-: D3DApp(hInstance) 
+: D3DApp(hInstance),
+  m_window_caption(mMainWndCaption)
 {
 }
 
 BoxApp::~BoxApp()
 {
+    // finish the frame in flight before the resources it uses go away
+    m_render_thread.reset();
 }
 
 bool BoxApp::Initialize()
@@ -27,12 +31,15 @@ bool BoxApp::Initialize()
     ThrowIfFailed(mCommandList->Reset(mDirectCmdListAlloc.Get(), nullptr));
  
     BuildDescriptorHeaps();
-	BuildMaterials();
     BuildShadersAndInputLayout();
     BuildBoxGeometry();
     BuildPSO();
 	LoadTexture();
 
+    m_shader_hot_reloader = std::make_unique<ShaderHotReloader>(&m_PSO_manager);
+    m_shader_hot_reloader->RegisterShader(m_shader.get());
+    m_shader_hot_reloader->RegisterShader(m_instanced_shader.get());
+
     // Execute the initialization commands.
     ThrowIfFailed(mCommandList->Close());
 	ID3D12CommandList* cmdsLists[] = { mCommandList.Get() };
@@ -44,14 +51,25 @@ bool BoxApp::Initialize()
 	m_texture_manager.ReleaseUploadBuffer();
     m_mesh_manager.ReleaseUploadBuffer();
     
-    SetMaterial();
+    BuildMaterials();
     SetGameObject();
 
+    LODSettings lod_settings;
+    lod_settings.triangle_budget = k_lod_triangle_budget;
+    m_lod_selector.SetSettings(lod_settings);
+
+    m_render_thread = std::make_unique<RenderThread>([this](uint32_t frame_index) { RenderFrame(frame_index); });
+
 	return true;
 }
 
 void BoxApp::OnResize()
 {
+    // the swap chain buffers are recreated, no frame may be recording
+    if(m_render_thread)
+    {
+        m_render_thread->WaitIdle();
+    }
 	D3DApp::OnResize();
 
     // The window resized, so update the aspect ratio and recompute the projection matrix.
@@ -61,18 +79,232 @@ void BoxApp::OnResize()
 
 void BoxApp::Update(const GameTimer& gt)
 {
+    // runs while the render thread records the previous frame, game state only
     Rotator rotate;
     m_chest_go->SetGameObjectRotation(Math::RadiansToDegrees(mPhi), 0, Math::RadiansToDegrees(mTheta));
+
+    // only the subtrees changed since the last frame are recomputed
+    World::GetDefault().GetSceneHierarchy().UpdateWorldMatrices(&JobSystem::GetDefault());
+    UpdateOctree();
+}
+
+bool BoxApp::LoadScene(const std::string& path)
+{
+    if(!m_scene_file.Open(path))
+    {
+        return false;
+    }
+    const SceneFileView& scene = m_scene_file.GetView();
+
+    // references are resolved once per mesh and material of the file, not per object
+    std::vector<Mesh*> meshes(scene.GetMeshCount());
+    for(uint32_t i=0; i<scene.GetMeshCount(); i++)
+    {
+        meshes[i] = m_mesh_manager.FindMesh(NameID(std::string_view(scene.GetMeshName(i))));
+    }
+    std::vector<MaterialTemplate*> material_templates(scene.GetMaterialCount());
+    for(uint32_t i=0; i<scene.GetMaterialCount(); i++)
+    {
+        material_templates[i] = std::string(scene.GetMaterialName(i)) == "default" ? m_material_template.get() : nullptr;
+    }
+    if(std::find(meshes.begin(), meshes.end(), nullptr) != meshes.end()
+        || std::find(material_templates.begin(), material_templates.end(), nullptr) != material_templates.end())
+    {
+        m_scene_file.Close();
+        return false;
+    }
+
+    // the file is depth first like the hierarchy, so the nodes are appended in one go
+    uint32_t object_count = scene.GetObjectCount();
+    SceneHierarchy& hierarchy = World::GetDefault().GetSceneHierarchy();
+    m_scene_nodes.resize(object_count);
+    hierarchy.AppendNodes(object_count, scene.GetParents(), m_scene_nodes.data());
+
+    std::vector<Transform> local_transforms(object_count);
+    scene.GetLocalTransforms(0, object_count, local_transforms.data());
+    const uint32_t* material_refs = scene.GetMaterialRefs();
+    m_scene_materials.resize(object_count);
+    for(uint32_t i=0; i<object_count; i++)
+    {
+        hierarchy.SetLocalTransform(m_scene_nodes[i], local_transforms[i]);
+        m_scene_materials[i] = material_templates[material_refs[i]]->CreateInstance();
+    }
+    m_scene_meshes = std::move(meshes);
+    return true;
+}
+
+void BoxApp::UpdateOctree()
+{
+    // objects are inserted once their world matrix exists and moved when it changed
+    const SceneHierarchy& hierarchy = World::GetDefault().GetSceneHierarchy();
+    const uint32_t* mesh_refs = m_scene_file.IsOpen() ? m_scene_file.GetView().GetMeshRefs() : nullptr;
+    uint32_t model_count = (uint32_t)m_model_gos.size();
+    for(uint32_t i=0; i<m_octree_handles.size(); i++)
+    {
+        SceneNodeID node;
+        const Mesh* mesh;
+        if(i < model_count)
+        {
+            const ModelGameObject* go = m_model_pool.Get(m_model_gos[i]);
+            node = go->GetSceneNode();
+            mesh = go->GetMesh();
+        }
+        else
+        {
+            node = m_scene_nodes[i - model_count];
+            mesh = m_scene_meshes[mesh_refs[i - model_count]];
+        }
+
+        OctreeHandle& handle = m_octree_handles[i];
+        if(handle != k_invalid_octree_handle && !hierarchy.WasUpdated(node))
+        {
+            continue;
+        }
+
+        BoundingSphere bounds = TransformBoundingSphere(mesh->GetBoundsCenter(), mesh->GetBoundsRadius(), hierarchy.GetWorldMatrix(node));
+        if(handle == k_invalid_octree_handle)
+        {
+            handle = m_octree->Insert(bounds, i);
+        }
+        else
+        {
+            m_octree->Move(handle, bounds);
+        }
+    }
+}
+
+uint32_t BoxApp::PickObject(int x, int y)
+{
+    // the instances share the meshes' bvh, only the top level is rebuilt
+    m_pick_bvh.Clear();
+    uint32_t model_count = (uint32_t)m_model_gos.size();
+    for(uint32_t i=0; i<model_count; i++)
+    {
+        const ModelGameObject* go = m_model_pool.Get(m_model_gos[i]);
+        if(go->GetMesh() != nullptr)
+        {
+            m_pick_bvh.AddInstance(&go->GetMesh()->GetBVH(), go->GetWorldMatrix(), i);
+        }
+    }
+    const SceneHierarchy& hierarchy = World::GetDefault().GetSceneHierarchy();
+    const uint32_t* mesh_refs = m_scene_file.IsOpen() ? m_scene_file.GetView().GetMeshRefs() : nullptr;
+    for(uint32_t i=0; i<m_scene_nodes.size(); i++)
+    {
+        m_pick_bvh.AddInstance(&m_scene_meshes[mesh_refs[i]]->GetBVH(), hierarchy.GetWorldMatrix(m_scene_nodes[i]), model_count + i);
+    }
+    m_pick_bvh.Build();
+
+    float ndc_x = 2.0f * x / mClientWidth - 1.0f;
+    float ndc_y = 1.0f - 2.0f * y / mClientHeight;
+    RayHit hit;
+    if(!m_pick_bvh.RayCast(m_camera->GetPickRay(ndc_x, ndc_y), hit))
+    {
+        return k_no_selection;
+    }
+    return hit.object;
+}
+
+void BoxApp::SelectObject(uint32_t object)
+{
+    m_selected_object = object;
+    mMainWndCaption = m_window_caption;
+    if(object == k_no_selection)
+    {
+        return;
+    }
+
+    // scene file objects have no game object, and so no name
+    uint32_t model_count = (uint32_t)m_model_gos.size();
+    std::string name = object < model_count ? m_model_pool.Get(m_model_gos[object])->GetName() : "scene object " + std::to_string(object - model_count);
+    mMainWndCaption += L"    selected: " + FormatConvert::StrToWStr(name);
 }
 
 void BoxApp::Draw(const GameTimer& gt)
 {
+    // the render thread still reads the other frame data
+    RenderFrameData& frame_data = m_frame_data[m_game_frame_index];
+    ExtractRenderProxies(frame_data);
+
+    // sync point, nothing below overlaps with recording
+    m_render_thread->WaitIdle();
+
+    // swap in edited shaders, the gpu is idle too because RenderFrame flushes the queue
+    if(!m_shader_hot_reloader->Update(md3dDevice.Get()).empty())
+    {
+        // cbuffer layout may have changed, resolve the handles again
+        m_material_template->Refresh(md3dDevice.Get());
+        m_instanced_material_template->Refresh(md3dDevice.Get());
+        m_world_view_proj_handle = m_material_template->GetVariableHandle("gWorldViewProj");
+        m_view_proj_handle = m_instanced_material_template->GetVariableHandle("gViewProj");
+        m_instance_offset_handle = m_instanced_material_template->GetVariableHandle("gInstanceOffset");
+    }
+
+    m_render_thread->Kick(m_game_frame_index);
+    m_game_frame_index = (m_game_frame_index + 1) % 2;
+
+    if(!k_pipelined_frames)
+    {
+        m_render_thread->WaitIdle();
+    }
+}
+
+void BoxApp::ExtractRenderProxies(RenderFrameData& frame_data)
+{
+    // only the objects the octree finds in the camera frustum are handed over, the render thread culls them exactly
+    // sorted so the proxies keep the same order from frame to frame
+    m_octree_results.clear();
+    m_octree->QueryFrustum(m_camera->GetFrustum(), m_octree_results);
+    m_extracted_objects.clear();
+    for(OctreeHandle handle : m_octree_results)
+    {
+        m_extracted_objects.push_back(m_octree->GetUserData(handle));
+    }
+    std::sort(m_extracted_objects.begin(), m_extracted_objects.end());
+
+    // scene file objects are read from the hierarchy and the mapped sections
+    const SceneHierarchy& hierarchy = World::GetDefault().GetSceneHierarchy();
+    const uint32_t* mesh_refs = m_scene_file.IsOpen() ? m_scene_file.GetView().GetMeshRefs() : nullptr;
+    uint16_t scene_pso_id = m_PSO_manager.GetPSOID("commonPSO");
+    uint32_t model_count = (uint32_t)m_model_gos.size();
+    frame_data.proxies.Clear();
+    frame_data.proxies.Reserve(m_extracted_objects.size());
+    for(uint32_t object : m_extracted_objects)
+    {
+        if(object < model_count)
+        {
+            const ModelGameObject* go = m_model_pool.Get(m_model_gos[object]);
+            frame_data.proxies.Add(object, go->GetWorldMatrix(), go->GetMesh(), go->GetMaterial(), go->GetPSOID(), go->GetOccluderMesh());
+        }
+        else
+        {
+            uint32_t i = object - model_count;
+            frame_data.proxies.Add(object, hierarchy.GetWorldMatrix(m_scene_nodes[i]), m_scene_meshes[mesh_refs[i]], m_scene_materials[i], scene_pso_id);
+        }
+    }
+
+    frame_data.view.view = m_camera->GetViewMatrix();
+    frame_data.view.proj = m_camera->GetProjMatrix();
+    frame_data.view.position = m_camera->GetPosition();
+    frame_data.view.look = m_camera->GetLook();
+    frame_data.view.far_z = m_camera->GetFarZ();
+    frame_data.view.fov_y = m_camera->GetFovY();
+    frame_data.view.viewport_height = (float)mClientHeight;
+    frame_data.view.frustum = m_camera->GetFrustum();
+}
+
+void BoxApp::RenderFrame(uint32_t frame_index)
+{
+    const RenderFrameData& frame_data = m_frame_data[frame_index];
+    const RenderProxyList& proxies = frame_data.proxies;
+
     // Reuse the memory associated with command recording.
     // We can only reset when the associated command lists have finished execution on the GPU.
 	ThrowIfFailed(mDirectCmdListAlloc->Reset());
 
 	// reset gpu cache descriptor
 	m_descriptor_cache->ResetCachedHeap();
+	Shader::ResetBindingStats(); // per frame counters
+	MaterialTemplate::ResetUploadStats();
 
 	// A command list can be reset after it has been added to the command queue via ExecuteCommandList.
     // Reusing the command list reuses memory.
@@ -95,8 +327,94 @@ void BoxApp::Draw(const GameTimer& gt)
 	ID3D12DescriptorHeap* descriptorHeaps[] = { m_descriptor_cache->GetCachedCbvSrvUavDescriptorHeap() };
 	mCommandList->SetDescriptorHeaps(1, descriptorHeaps);
 
-    // Draw
-    m_chest_go->Draw(m_camera.get(), mCommandList.Get(), m_descriptor_cache.get());
+    // cull against the camera frustum, large scenes are split over the job system
+    m_visible_proxies.resize(proxies.GetCount());
+    uint32_t visible_count = m_frustum_culler.Cull(&JobSystem::GetDefault(), frame_data.view.frustum,
+        proxies.GetCullBounds(), CullShape::k_sphere, m_visible_proxies.data());
+
+    // then against the depth of the visible occluders, a box is kept unless it is entirely behind them
+    m_occlusion_culler.BeginFrame(frame_data.view.view * frame_data.view.proj);
+    for(uint32_t visible_index=0; visible_index<visible_count; visible_index++)
+    {
+        uint32_t i = m_visible_proxies[visible_index];
+        Mesh* occluder_mesh = proxies.GetOccluderMesh(i);
+        if(occluder_mesh && !occluder_mesh->GetIndicesCPU().empty())
+        {
+            const std::vector<Vertex>& vertices = occluder_mesh->GetVerticesCPU();
+            const std::vector<uint16_t>& indices = occluder_mesh->GetIndicesCPU();
+            m_occlusion_culler.AddOccluder(&vertices[0].Position.x, sizeof(Vertex), indices.data(), (uint32_t)indices.size(), proxies.GetWorldMatrix(i));
+        }
+    }
+    m_occlusion_culler.Rasterize(&JobSystem::GetDefault());
+    visible_count = m_occlusion_culler.CullVisible(proxies.GetCullBounds(), m_visible_proxies.data(), visible_count);
+
+    // level of detail of what is left, the selected meshes replace the proxies' ones from here on
+    m_lod_selector.Select(frame_data.view, proxies, m_visible_proxies.data(), visible_count);
+
+    // Draw, sorted by state then front to back
+    m_render_queue.Clear();
+    float inv_far_z = 1.0f / frame_data.view.far_z;
+    for(uint32_t visible_index=0; visible_index<visible_count; visible_index++)
+    {
+        uint32_t i = m_visible_proxies[visible_index];
+        float depth = (proxies.GetWorldMatrix(i).Translation() - frame_data.view.position).Dot(frame_data.view.look) * inv_far_z;
+        uint64_t key = RenderQueue::MakeKey(RenderPass::k_opaque, proxies.GetPSOID(i),
+            proxies.GetMaterial(i)->GetTemplate()->GetMaterialID(), m_lod_selector.GetMesh(i)->GetMeshID(), depth);
+        m_render_queue.Push(key, i);
+    }
+    m_render_queue.Sort();
+
+    // runs sharing mesh, material template and pso become one instanced draw,
+    // instanced draws take their textures from the template so instances overriding one are drawn alone,
+    // and only instances with the same parameters share a batch, the world matrix goes to the instance data
+    const uint64_t per_instance_overrides = 1ull << m_world_view_proj_handle.override_index;
+    m_instance_batcher.Build(m_render_queue,
+        [&proxies](uint32_t item)
+        {
+            return !proxies.GetMaterial(item)->HasTextureOverrides();
+        },
+        [&proxies, per_instance_overrides](uint32_t first_item, uint32_t item)
+        {
+            return proxies.GetMaterial(item)->HasSameOverrides(proxies.GetMaterial(first_item), per_instance_overrides);
+        });
+
+    // the gpu is idle here, see FlushCommandQueue at the end of RenderFrame, so the instance buffer is simply rewritten
+    if(m_instance_buffer->Reserve((UINT)m_render_queue.GetCount()))
+    {
+        m_instanced_material_template->SetDefaultTexture("gInstanceData", m_instance_buffer->GetSRV());
+    }
+
+    uint32_t instanced_draw_index = 0;
+    uint32_t draw_index = 0;
+    uint16_t instanced_pso_id = m_PSO_manager.GetPSOID("instancedPSO");
+    ID3D12PipelineState* current_pso = m_PSO_manager.GetPSO("commonPSO"); // set by the command list reset
+    for(const InstanceBatch& batch : m_instance_batcher.GetBatches())
+    {
+        uint32_t first_proxy = m_instance_batcher.GetInstanceItem(batch.first_instance);
+        ID3D12PipelineState* pso = m_PSO_manager.GetPSO(batch.b_instanced ? instanced_pso_id : proxies.GetPSOID(first_proxy));
+        if(pso != current_pso)
+        {
+            current_pso = pso;
+            mCommandList->SetPipelineState(pso);
+        }
+
+        if(batch.b_instanced)
+        {
+            if(instanced_draw_index == m_batch_materials.size())
+            {
+                m_batch_materials.push_back(m_instanced_material_template->CreateInstance());
+            }
+            DrawInstanced(frame_data, batch, m_batch_materials[instanced_draw_index++]);
+        }
+        else
+        {
+            if(draw_index == m_draw_materials.size())
+            {
+                m_draw_materials.push_back(m_material_template->CreateInstance());
+            }
+            DrawProxy(frame_data, first_proxy, m_draw_materials[draw_index++]);
+        }
+    }
 	
     // Indicate a state transition on the resource usage.
 	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
@@ -125,9 +443,76 @@ void BoxApp::BuildDescriptorHeaps()
     m_descriptor_cache = std::make_unique<DescriptorCacheGPU>(md3dDevice.Get());
 }
 
+void BoxApp::DrawProxy(const RenderFrameData& frame_data, uint32_t proxy_index, MaterialInstance* draw_material)
+{
+    const RenderProxyList& proxies = frame_data.proxies;
+    const MaterialInstance* material = proxies.GetMaterial(proxy_index);
+    assert(material->GetTemplate() == m_material_template.get());
+
+    // the game object's parameters, then the mvp matrix, both written to the render thread's own instance
+    // this matrix class is designed for postmultiplying : pos * view, thus it should pass a transposed ViewMatrix to GPU
+    draw_material->CopyOverrides(material);
+    Matrix world_view_proj = proxies.GetWorldMatrix(proxy_index) * frame_data.view.view * frame_data.view.proj;
+    draw_material->SetParameter(m_world_view_proj_handle, world_view_proj.Transpose());
+
+    // issue draw cmd, the pso is set by the render queue loop and the root signature by the shader when it binds its parameters
+    Mesh* mesh = m_lod_selector.GetMesh(proxy_index);
+    mCommandList->IASetVertexBuffers(0, 1, mesh->GetVertexBufferView());
+    mCommandList->IASetIndexBuffer(mesh->GetIndexBufferView());
+    mCommandList->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    // update shader data
+    draw_material->PassParametersToShader(mCommandList.Get(), m_descriptor_cache.get());
+
+    mCommandList->DrawIndexedInstanced((UINT)mesh->GetIndicesCount(), 1, 0, 0, 0);
+}
+
+void BoxApp::DrawInstanced(const RenderFrameData& frame_data, const InstanceBatch& batch, MaterialInstance* batch_material)
+{
+    const RenderProxyList& proxies = frame_data.proxies;
+    InstanceData* instance_data = reinterpret_cast<InstanceData*>(m_instance_buffer->GetMappedData());
+    for(uint32_t i=0; i<batch.instance_count; i++)
+    {
+        uint32_t proxy_index = m_instance_batcher.GetInstanceItem(batch.first_instance + i);
+        InstanceData& instance = instance_data[batch.first_instance + i];
+        instance.world = proxies.GetWorldMatrix(proxy_index).Transpose();
+    }
+
+    // this matrix class is designed for postmultiplying, see DrawProxy
+    Matrix view_proj = frame_data.view.view * frame_data.view.proj;
+    batch_material->SetParameter(m_view_proj_handle, view_proj.Transpose());
+    batch_material->SetParameter(m_instance_offset_handle, batch.first_instance);
+
+    Mesh* mesh = m_lod_selector.GetMesh(m_instance_batcher.GetInstanceItem(batch.first_instance));
+    mCommandList->IASetVertexBuffers(0, 1, mesh->GetVertexBufferView());
+    mCommandList->IASetIndexBuffer(mesh->GetIndexBufferView());
+    mCommandList->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    batch_material->PassParametersToShader(mCommandList.Get(), m_descriptor_cache.get());
+
+    mCommandList->DrawIndexedInstanced((UINT)mesh->GetIndicesCount(), batch.instance_count, 0, 0, 0);
+}
+
 void BoxApp::BuildMaterials()
 {
-    m_material = std::make_unique<Material>();
+    // gWorldViewProj differs per object, the texture is shared unless an instance overrides it
+    m_material_template = std::make_unique<MaterialTemplate>(m_shader.get(), md3dDevice.Get());
+    m_material_template->AddOverride("gWorldViewProj");
+    m_material_template->AddTexture("gDiffuseMap", m_texture_manager.GetTexture("woodCrateTex")->m_srv.get());
+
+    m_chest_material = m_material_template->CreateInstance();
+    m_world_view_proj_handle = m_material_template->GetVariableHandle("gWorldViewProj");
+
+    // instanced variant, the per object data comes from the instance buffer
+    m_instance_buffer = std::make_unique<D3D12StructuredUploadBuffer>(md3dDevice.Get(), m_descriptor_manager.get(), (UINT)sizeof(InstanceData));
+    m_instance_buffer->Reserve(k_crate_grid_size * k_crate_grid_size + k_sphere_count + 1);
+    m_instanced_material_template = std::make_unique<MaterialTemplate>(m_instanced_shader.get(), md3dDevice.Get());
+    m_instanced_material_template->AddOverride("gViewProj");
+    m_instanced_material_template->AddOverride("gInstanceOffset");
+    m_instanced_material_template->AddTexture("gDiffuseMap", m_texture_manager.GetTexture("woodCrateTex")->m_srv.get());
+    m_instanced_material_template->AddTexture("gInstanceData", m_instance_buffer->GetSRV());
+    m_view_proj_handle = m_instanced_material_template->GetVariableHandle("gViewProj");
+    m_instance_offset_handle = m_instanced_material_template->GetVariableHandle("gInstanceOffset");
 }
 
 void BoxApp::BuildShadersAndInputLayout()
@@ -136,7 +521,13 @@ void BoxApp::BuildShadersAndInputLayout()
 	info.b_create_VS = true;
 	info.b_create_PS = true;
 	info.file_name = std::string("../../../Shaders/color.hlsl");
-	m_shader = std::make_unique<Shader>(info, md3dDevice.Get());
+
+	ShaderInfo instanced_info = info;
+	instanced_info.shader_defines.SetDefine("USE_INSTANCING", "1");
+
+	auto shaders = Shader::CreateShaders({ info, instanced_info }, md3dDevice.Get());
+	m_shader = std::move(shaders[0]);
+	m_instanced_shader = std::move(shaders[1]);
 }
 
 void BoxApp::BuildBoxGeometry()
@@ -150,17 +541,6 @@ void BoxApp::BuildPSO()
     ZeroMemory(&psoDesc, sizeof(D3D12_GRAPHICS_PIPELINE_STATE_DESC));
     std::vector<D3D12_INPUT_ELEMENT_DESC> input_layout(Vertex::GetVSInputLayout());
     psoDesc.InputLayout = { input_layout.data(), (UINT)input_layout.size() };
-    psoDesc.pRootSignature = m_shader->m_root_signature.Get();
-    psoDesc.VS = 
-	{ 
-		reinterpret_cast<BYTE*>(m_shader->m_shader_stage["VS"]->GetBufferPointer()), 
-		m_shader->m_shader_stage["VS"]->GetBufferSize() 
-	};
-    psoDesc.PS = 
-	{ 
-		reinterpret_cast<BYTE*>(m_shader->m_shader_stage["PS"]->GetBufferPointer()), 
-		m_shader->m_shader_stage["PS"]->GetBufferSize() 
-	};
     psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
     psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
     psoDesc.DepthStencilState = CD3DX12_DEPTH_STENCIL_DESC(D3D12_DEFAULT);
@@ -172,7 +552,8 @@ void BoxApp::BuildPSO()
     psoDesc.SampleDesc.Quality = m4xMsaaState ? (m4xMsaaQuality - 1) : 0;
     psoDesc.DSVFormat = mDepthStencilFormat;
 
-	m_PSO_manager.CreatePSO("commonPSO", psoDesc, md3dDevice.Get());
+	m_PSO_manager.CreatePSO("commonPSO", psoDesc, m_shader.get(), md3dDevice.Get()); // root signature and bytecode come from the shader
+	m_PSO_manager.CreatePSO("instancedPSO", psoDesc, m_instanced_shader.get(), md3dDevice.Get());
 }
 
 void BoxApp::LoadTexture()
@@ -190,22 +571,47 @@ void BoxApp::LoadTexture()
 	wood_tex->m_srv = std::make_unique<ShaderResourceView>(srvDesc, wood_tex->Resource.Get(), md3dDevice.Get(), m_descriptor_manager.get());
 }
 
-void BoxApp::SetMaterial()
-{   
-    m_material->SetShader(m_shader.get());
-    m_material->CreateCb(md3dDevice.Get());
-    m_material->SetParameter("gDiffuseMap", m_texture_manager.GetTexture("woodCrateTex")->m_srv.get());
-}
-
 void BoxApp::SetGameObject()
 {
     // world coord is Left hand coord
     // x right; y up; z inside the screen
-    m_chest_go = std::make_unique<ModelGameObject>(std::string("chest"));
-    m_chest_go->SetMaterial(m_material.get());
+    m_model_gos.push_back(m_model_pool.Create(std::string("chest")));
+    m_chest_go = m_model_pool.Get(m_model_gos.back());
+    m_chest_go->SetMaterial(m_chest_material);
+    m_chest_go->SetPSOID(m_PSO_manager.GetPSOID("commonPSO"));
+
+    // a grid of crates behind the chest, all sharing the box mesh and the material template
+    for(int x=0; x<k_crate_grid_size; x++)
+    {
+        for(int z=0; z<k_crate_grid_size; z++)
+        {
+            m_model_gos.push_back(m_model_pool.Create("crate_" + std::to_string(x) + "_" + std::to_string(z)));
+            ModelGameObject* crate = m_model_pool.Get(m_model_gos.back());
+            crate->SetMaterial(m_material_template->CreateInstance());
+            crate->SetMesh(m_mesh_manager.GetMesh("box"));
+            crate->SetPSOID(m_PSO_manager.GetPSOID("commonPSO"));
+            crate->SetOccluderMesh(m_mesh_manager.GetMesh("box"));
+            crate->SetGameObjectLocation((x - k_crate_grid_size / 2) * 4.0f, -4.0f, 20.0f + z * 4.0f);
+        }
+    }
+    // a row of spheres going away from the camera, drawn with coarser levels of their lod chain as they get far
+    for(int i=0; i<k_sphere_count; i++)
+    {
+        m_model_gos.push_back(m_model_pool.Create("sphere_" + std::to_string(i)));
+        ModelGameObject* sphere = m_model_pool.Get(m_model_gos.back());
+        sphere->SetMaterial(m_material_template->CreateInstance());
+        sphere->SetMesh(m_mesh_manager.GetMesh("sphere"));
+        sphere->SetPSOID(m_PSO_manager.GetPSOID("commonPSO"));
+        sphere->SetGameObjectLocation(8.0f, 2.0f, 10.0f * (1 << i));
+    }
     m_chest_go->SetMesh(m_mesh_manager.GetMesh("box"));
     m_chest_go->SetGameObjectLocation(0, 0, 5);
 
+    LoadScene(k_scene_path);
+
+    m_octree = std::make_unique<LooseOctree>(Vector3::Zero, k_scene_half_size);
+    m_octree_handles.assign(m_model_gos.size() + m_scene_nodes.size(), k_invalid_octree_handle);
+
     m_camera = std::make_unique<CameraGameObject>(std::string("camera"));
     m_camera->LookAt(Vector3::Zero, Vector3::UnitZ, Vector3::UnitY);
     m_camera->SetLens(Math::DegreesToRadians(60), (float)mClientWidth/mClientHeight, 0.00001f, 10000.0f);
@@ -217,6 +623,11 @@ void BoxApp::OnMouseDown(WPARAM btnState, int x, int y)
     mLastMousePos.x = x;
     mLastMousePos.y = y;
 
+    if((btnState & MK_LBUTTON) != 0)
+    {
+        SelectObject(PickObject(x, y));
+    }
+
     SetCapture(mhMainWnd);
 }
 
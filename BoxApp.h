@@ -8,9 +8,23 @@
 #include "Texture/TextureManager.h"
 #include "Mesh/MeshManager.h"
 #include "Material/Material.h"
+#include "Material/ShaderHotReloader.h"
 #include "Component/Component.h"
 #include "GameObject/ModelGameObject.h"
 #include "GameObject/CameraGameObject.h"
+#include "Renderer/RenderQueue.h"
+#include "Renderer/InstanceBatcher.h"
+#include "Renderer/InstanceData.h"
+#include "Renderer/RenderProxy.h"
+#include "Renderer/RenderThread.h"
+#include "Renderer/OcclusionCuller.h"
+#include "Renderer/LODSelector.h"
+#include "D3DRHI/D3D12StructuredUploadBuffer.h"
+#include "Utility/JobSystem.h"
+#include "Utility/ObjectPool.h"
+#include "Scene/LooseOctree.h"
+#include "Scene/SceneFile.h"
+#include "Scene/SceneBVH.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -42,23 +56,85 @@ private:
     void BuildPSO();
     void LoadTexture();
 
-    void SetMaterial();
     void SetGameObject();
+    // returns false if the file is missing or references an unknown mesh or material
+    bool LoadScene(const std::string& path);
+    void UpdateOctree();
+    // object under the cursor, numbered like the octree user data, k_no_selection if none
+    uint32_t PickObject(int x, int y);
+    // k_no_selection clears it, the selected object's name is shown in the window caption next to the frame stats
+    void SelectObject(uint32_t object);
+
+    // game thread, at the frame sync point
+    void ExtractRenderProxies(RenderFrameData& frame_data);
+    // render thread
+    void RenderFrame(uint32_t frame_index);
+    void DrawProxy(const RenderFrameData& frame_data, uint32_t proxy_index, MaterialInstance* draw_material);
+    void DrawInstanced(const RenderFrameData& frame_data, const InstanceBatch& batch, MaterialInstance* batch_material);
 
 private:
+    static const int k_crate_grid_size = 10;
+    static const int k_sphere_count = 8;
+    static const bool k_pipelined_frames = true; // false waits for each frame to be rendered before simulating the next
+    static constexpr float k_scene_half_size = 1024.0f; // octree root cell, objects outside it are kept in the root
+    static constexpr const char* k_scene_path = "Scenes/demo.scene"; // optional, see Tools/SceneWriter.cpp
+    static const uint32_t k_lod_triangle_budget = 500000; // of the selected lod levels per frame, see LODSettings
+    static const uint32_t k_no_selection = 0xffffffff;
+
     std::unique_ptr<DescriptorCacheGPU> m_descriptor_cache = nullptr; // used to bind texture to shader
     std::unique_ptr<DescriptorManager> m_descriptor_manager = nullptr; // used to create texture srv ...
 
-	std::unique_ptr<Material> m_material = nullptr;
+	std::unique_ptr<MaterialTemplate> m_material_template = nullptr;
+	MaterialInstance* m_chest_material = nullptr; // owned by m_material_template
+	MaterialVariableHandle m_world_view_proj_handle; // of m_material_template, resolved again after a hot reload
+	std::unique_ptr<MaterialTemplate> m_instanced_material_template = nullptr;
+	MaterialVariableHandle m_view_proj_handle; // of m_instanced_material_template, resolved again after a hot reload
+	MaterialVariableHandle m_instance_offset_handle;
+	std::vector<MaterialInstance*> m_batch_materials; // one per instanced draw of a frame, reused across frames
+	// of m_material_template, one per non instanced draw of a frame, reused across frames
+	// the render thread copies the proxy's material into one and sets the per draw constants there,
+	// the game objects' materials are only read while a frame is recorded
+	std::vector<MaterialInstance*> m_draw_materials;
 
     TextureManager m_texture_manager;
 	MeshManager m_mesh_manager;
 
     std::unique_ptr<Shader> m_shader = nullptr;
-
-    std::unique_ptr<ModelGameObject> m_chest_go;
+    std::unique_ptr<Shader> m_instanced_shader = nullptr; // color.hlsl with USE_INSTANCING
+    std::unique_ptr<ShaderHotReloader> m_shader_hot_reloader = nullptr;
+
+    ObjectPool<ModelGameObject> m_model_pool;
+    std::vector<PoolHandle<ModelGameObject>> m_model_gos; // in m_model_pool, m_model_gos[0] is the chest
+    ModelGameObject* m_chest_go = nullptr;
+    // objects of the scene file are not game objects, they stay as flat arrays indexed like the file's sections
+    SceneFile m_scene_file;
+    std::vector<SceneNodeID> m_scene_nodes;
+    std::vector<Mesh*> m_scene_meshes;              // per mesh of the file
+    std::vector<MaterialInstance*> m_scene_materials; // per object, owned by their template
+    // world bounds of m_model_gos then of the scene file objects, user data is the index in m_model_gos,
+    // or m_model_gos.size() + the index in m_scene_nodes, queried with the camera frustum when extracting the proxies
+    std::unique_ptr<LooseOctree> m_octree = nullptr;
+    std::vector<OctreeHandle> m_octree_handles; // by user data
+    std::vector<OctreeHandle> m_octree_results; // scratch for the extraction query
+    std::vector<uint32_t> m_extracted_objects;  // user data of m_octree_results, sorted
+    SceneBVH m_pick_bvh; // instances of m_model_gos and of the scene file objects, user data as in the octree, rebuilt on each pick
+    uint32_t m_selected_object = k_no_selection; // picked with the left button, numbered like the octree user data
+    std::wstring m_window_caption; // mMainWndCaption without the selection
+    FrustumCuller m_frustum_culler;
+    OcclusionCuller m_occlusion_culler;
+    LODSelector m_lod_selector;
+    std::vector<uint32_t> m_visible_proxies; // proxy indices, written by the cullers each frame
+    RenderQueue m_render_queue;
+    InstanceBatcher m_instance_batcher;
+    std::unique_ptr<D3D12StructuredUploadBuffer> m_instance_buffer = nullptr;
     std::unique_ptr<CameraGameObject> m_camera;
 
+    // frame N is rendered from m_frame_data[N % 2] while the game thread simulates N + 1
+    // and extracts it into the other one
+    RenderFrameData m_frame_data[2];
+    uint32_t m_game_frame_index = 0;
+    std::unique_ptr<RenderThread> m_render_thread = nullptr;
+
     //std::vector<D3D12_INPUT_ELEMENT_DESC> mInputLayout;
 
     //ComPtr<ID3D12PipelineState> mPSO = nullptr;
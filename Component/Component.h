@@ -1,46 +1,11 @@
 #pragma once
-#include "Math/Transform.h"
+#include "Scene/SceneHierarchy.h"
 
+// components are plain data stored in the ecs chunks, see ECS/World.h
+// they must be trivially copyable, they are moved between chunks with memcpy
 
-class Component
+// node of the game object in its world's SceneHierarchy, which owns the transforms
+struct TransformComponent
 {
-public:
-	Component() = default;
-
-	virtual ~Component() = default;
-
-public:
-	virtual void SetWorldLocation(const Vector3& Location)
-	{
-		WorldTransform.Location = Location;
-	}
-
-	Vector3 GetWorldLocation() const
-	{
-		return WorldTransform.Location;
-	}
-
-	virtual void SetWorldRotation(const Rotator& Rotation)
-	{
-		WorldTransform.Rotation = Rotation;
-	}
-
-	Rotator GetWorldRotation() const
-	{
-		return WorldTransform.Rotation;
-	}
-
-	void SetWorldTransform(const Transform& Transform)
-	{
-		WorldTransform = Transform;
-	}
-
-	Transform GetWorldTransform() const
-	{
-		return WorldTransform;
-	}
-
-protected:
-	Transform WorldTransform;
-
+	SceneNodeID Node = k_invalid_scene_node;
 };
@@ -21,6 +21,7 @@ public:
     ~D3D12ConstantBuffer();
 
     void CopyData(void* data, int size);
+    BYTE* GetMappedData() const { return m_mapped_data; } // persistently mapped, write only
 
 private:
     BYTE* m_mapped_data = nullptr;
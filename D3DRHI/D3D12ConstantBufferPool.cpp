@@ -0,0 +1,54 @@
+#include "D3D12ConstantBufferPool.h"
+
+D3D12ConstantBufferPool::D3D12ConstantBufferPool(ID3D12Device* device, UINT slot_size, UINT slots_per_page):
+    m_device(device),
+    m_slot_size(d3dUtil::CalcConstantBufferByteSize(slot_size)),
+    m_slots_per_page(slots_per_page)
+{
+    assert(slots_per_page > 0);
+}
+
+ConstantBufferSlot D3D12ConstantBufferPool::Allocate()
+{
+    uint32_t index;
+    if(!m_free_slots.empty())
+    {
+        index = m_free_slots.back();
+        m_free_slots.pop_back();
+    }
+    else
+    {
+        index = m_next_unused_slot++;
+        if(index / m_slots_per_page >= m_pages.size())
+        {
+            m_pages.push_back(std::make_unique<D3D12ConstantBuffer>(m_device, m_slot_size * m_slots_per_page));
+        }
+    }
+
+    m_allocated_count++;
+    return GetSlot(index);
+}
+
+void D3D12ConstantBufferPool::Free(ConstantBufferSlot& slot)
+{
+    if(!slot.IsValid())
+    {
+        return;
+    }
+
+    m_free_slots.push_back(slot.index);
+    m_allocated_count--;
+    slot = ConstantBufferSlot();
+}
+
+ConstantBufferSlot D3D12ConstantBufferPool::GetSlot(uint32_t index) const
+{
+    const D3D12ConstantBuffer* page = m_pages[index / m_slots_per_page].get();
+    UINT offset = (index % m_slots_per_page) * m_slot_size;
+
+    ConstantBufferSlot slot;
+    slot.index = index;
+    slot.mapped_data = page->GetMappedData() + offset;
+    slot.gpu_address = page->GetResource()->GetGPUVirtualAddress() + offset;
+    return slot;
+}
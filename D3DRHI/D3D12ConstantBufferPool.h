@@ -0,0 +1,47 @@
+#pragma once
+#include "D3D12Buffer.h"
+#include <memory>
+#include <vector>
+
+// one 256 byte aligned range of a D3D12ConstantBufferPool page
+struct ConstantBufferSlot
+{
+    uint32_t index = UINT32_MAX;
+    BYTE* mapped_data = nullptr;
+    D3D12_GPU_VIRTUAL_ADDRESS gpu_address = 0;
+
+    bool IsValid() const { return index != UINT32_MAX; }
+};
+
+// fixed size constant buffer slots carved out of a few large upload buffers,
+// freed slots are reused before a new page is created
+// the caller has to make sure the gpu is done with a slot before writing or freeing it
+class D3D12ConstantBufferPool
+{
+public:
+    D3D12ConstantBufferPool() = delete;
+    D3D12ConstantBufferPool(ID3D12Device* device, UINT slot_size, UINT slots_per_page = 256);
+    ~D3D12ConstantBufferPool() = default;
+
+    D3D12ConstantBufferPool(const D3D12ConstantBufferPool&) = delete;
+    D3D12ConstantBufferPool& operator=(const D3D12ConstantBufferPool&) = delete;
+
+    ConstantBufferSlot Allocate();
+    void Free(ConstantBufferSlot& slot);
+
+    UINT GetSlotSize() const { return m_slot_size; }
+    UINT GetAllocatedCount() const { return m_allocated_count; }
+
+private:
+    ConstantBufferSlot GetSlot(uint32_t index) const;
+
+private:
+    ID3D12Device* m_device;
+    UINT m_slot_size;
+    UINT m_slots_per_page;
+    UINT m_allocated_count = 0;
+    uint32_t m_next_unused_slot = 0;
+
+    std::vector<std::unique_ptr<D3D12ConstantBuffer>> m_pages;
+    std::vector<uint32_t> m_free_slots;
+};
@@ -0,0 +1,59 @@
+#include "D3D12StructuredUploadBuffer.h"
+
+D3D12StructuredUploadBuffer::D3D12StructuredUploadBuffer(ID3D12Device* device, DescriptorManager* descriptor_manager, UINT element_size):
+    m_device(device),
+    m_descriptor_manager(descriptor_manager),
+    m_element_size(element_size)
+{
+}
+
+D3D12StructuredUploadBuffer::~D3D12StructuredUploadBuffer()
+{
+    if(m_d3d_resource != nullptr)
+        m_d3d_resource->Unmap(0, nullptr);
+
+    m_mapped_data = nullptr;
+}
+
+bool D3D12StructuredUploadBuffer::Reserve(UINT element_count)
+{
+    if(element_count <= m_capacity)
+    {
+        return false;
+    }
+
+    UINT capacity = std::max(m_capacity * 2, std::max(element_count, 64u));
+
+    // release the old srv before its resource
+    m_srv.reset();
+    if(m_d3d_resource != nullptr)
+    {
+        m_d3d_resource->Unmap(0, nullptr);
+        m_d3d_resource.Reset();
+    }
+
+    auto heap_properties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+    auto desc = CD3DX12_RESOURCE_DESC::Buffer((UINT64)capacity * m_element_size);
+    ThrowIfFailed(m_device->CreateCommittedResource(
+        &heap_properties,
+        D3D12_HEAP_FLAG_NONE,
+        &desc,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(&m_d3d_resource)));
+
+    ThrowIfFailed(m_d3d_resource->Map(0, nullptr, reinterpret_cast<void**>(&m_mapped_data)));
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+    srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srv_desc.Format = DXGI_FORMAT_UNKNOWN;
+    srv_desc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    srv_desc.Buffer.FirstElement = 0;
+    srv_desc.Buffer.NumElements = capacity;
+    srv_desc.Buffer.StructureByteStride = m_element_size;
+    srv_desc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
+    m_srv = std::make_unique<ShaderResourceView>(srv_desc, m_d3d_resource.Get(), m_device, m_descriptor_manager);
+
+    m_capacity = capacity;
+    return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "D3D12Buffer.h"
+#include "ResourceView.h"
+#include <memory>
+
+// persistently mapped upload heap StructuredBuffer with one srv over the whole buffer,
+// for per frame data written by the cpu, e.g. instance data
+// the caller has to make sure the gpu is done with the previous contents before writing or growing
+class D3D12StructuredUploadBuffer : public D3D12Buffer
+{
+public:
+    D3D12StructuredUploadBuffer() = delete;
+    D3D12StructuredUploadBuffer(ID3D12Device* device, DescriptorManager* descriptor_manager, UINT element_size);
+    ~D3D12StructuredUploadBuffer();
+
+    // grows by doubling, returns true if the buffer and so the srv were recreated
+    bool Reserve(UINT element_count);
+
+    BYTE* GetMappedData() const { return m_mapped_data; }
+    ShaderResourceView* GetSRV() const { return m_srv.get(); }
+    UINT GetCapacity() const { return m_capacity; }
+
+private:
+    ID3D12Device* m_device;
+    DescriptorManager* m_descriptor_manager;
+    UINT m_element_size;
+    UINT m_capacity = 0;
+    BYTE* m_mapped_data = nullptr;
+    std::unique_ptr<ShaderResourceView> m_srv;
+};
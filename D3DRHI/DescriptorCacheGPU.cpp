@@ -40,13 +40,16 @@ void DescriptorCacheGPU::AppendRtvDescriptorsToHeap(const std::vector<D3D12_CPU_
 
 CD3DX12_GPU_DESCRIPTOR_HANDLE DescriptorCacheGPU::AppendCbvSrvUavDescriptorsToHeap(const std::vector<D3D12_CPU_DESCRIPTOR_HANDLE>& srv_descriptors)
 {
-    // get cpu descriptor number
-    uint32_t descriptor_num = srv_descriptors.size();
+    return AppendCbvSrvUavDescriptorsToHeap(srv_descriptors.data(), (uint32_t)srv_descriptors.size());
+}
+
+CD3DX12_GPU_DESCRIPTOR_HANDLE DescriptorCacheGPU::AppendCbvSrvUavDescriptorsToHeap(const D3D12_CPU_DESCRIPTOR_HANDLE* srv_descriptors, uint32_t descriptor_num)
+{
     assert(m_cbv_srv_uav_offset + descriptor_num < max_cbv_srv_uav_descriptor_count);
 
     // copy cpu descriptor to gpu descriptor
     auto dest_cpu_handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cbv_srv_uav_heap->GetCPUDescriptorHandleForHeapStart(), m_cbv_srv_uav_offset, m_cbv_srv_uav_descriptor_size);
-    m_device->CopyDescriptors(1, &dest_cpu_handle, &descriptor_num, descriptor_num, srv_descriptors.data(), nullptr, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    m_device->CopyDescriptors(1, &dest_cpu_handle, &descriptor_num, descriptor_num, srv_descriptors, nullptr, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
     // get gpu handle
     auto gpu_handle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_cbv_srv_uav_heap->GetGPUDescriptorHandleForHeapStart(), m_cbv_srv_uav_offset, m_cbv_srv_uav_descriptor_size);
@@ -59,6 +62,7 @@ CD3DX12_GPU_DESCRIPTOR_HANDLE DescriptorCacheGPU::AppendCbvSrvUavDescriptorsToHe
 
 void DescriptorCacheGPU::ResetCachedHeap()
 {
+    m_reset_count++;
     ResetCbvSrvUavHeap();
     ResetRtvHeap();
 }
@@ -12,7 +12,9 @@ public:
     ID3D12DescriptorHeap* GetCachedCbvSrvUavDescriptorHeap();
     void AppendRtvDescriptorsToHeap(const std::vector<D3D12_CPU_DESCRIPTOR_HANDLE>& rtv_descriptors, CD3DX12_GPU_DESCRIPTOR_HANDLE& out_gpu_handle, CD3DX12_CPU_DESCRIPTOR_HANDLE& out_cpu_handle);
     CD3DX12_GPU_DESCRIPTOR_HANDLE AppendCbvSrvUavDescriptorsToHeap(const std::vector<D3D12_CPU_DESCRIPTOR_HANDLE>& srv_descriptors);
+    CD3DX12_GPU_DESCRIPTOR_HANDLE AppendCbvSrvUavDescriptorsToHeap(const D3D12_CPU_DESCRIPTOR_HANDLE* srv_descriptors, uint32_t descriptor_num);
     void ResetCachedHeap();
+    uint64_t GetResetCount() const { return m_reset_count; } // tables appended before the last reset are stale
 
 private:
     ID3D12Device* m_device;
@@ -26,6 +28,8 @@ private:
     UINT m_rtv_descriptor_size;
     uint32_t m_rtv_offset = 0;
     static const int max_rtv_descriptor_count = 1024;
+
+    uint64_t m_reset_count = 0;
     
 private:
     void CreateCbvSrvUavHeap();
@@ -0,0 +1,62 @@
+#include "HeadlessDevice.h"
+
+using Microsoft::WRL::ComPtr;
+
+HeadlessDevice::HeadlessDevice()
+{
+    ThrowIfFailed(CreateDXGIFactory1(IID_PPV_ARGS(&m_dxgi_factory)));
+
+    HRESULT hardware_result = D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device));
+    if(FAILED(hardware_result))
+    {
+        ComPtr<IDXGIAdapter> warp_adapter;
+        ThrowIfFailed(m_dxgi_factory->EnumWarpAdapter(IID_PPV_ARGS(&warp_adapter)));
+        ThrowIfFailed(D3D12CreateDevice(warp_adapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device)));
+    }
+
+    ThrowIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
+
+    D3D12_COMMAND_QUEUE_DESC queue_desc = {};
+    queue_desc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+    queue_desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    ThrowIfFailed(m_device->CreateCommandQueue(&queue_desc, IID_PPV_ARGS(&m_command_queue)));
+    ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_command_allocator)));
+    ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_command_allocator.Get(), nullptr, IID_PPV_ARGS(&m_command_list)));
+
+    // closed like D3DApp's, BeginCommandList opens it
+    m_command_list->Close();
+}
+
+HeadlessDevice::~HeadlessDevice()
+{
+    FlushCommandQueue();
+}
+
+void HeadlessDevice::BeginCommandList()
+{
+    FlushCommandQueue();
+    ThrowIfFailed(m_command_allocator->Reset());
+    ThrowIfFailed(m_command_list->Reset(m_command_allocator.Get(), nullptr));
+}
+
+void HeadlessDevice::ExecuteCommandList()
+{
+    ThrowIfFailed(m_command_list->Close());
+    ID3D12CommandList* cmd_lists[] = { m_command_list.Get() };
+    m_command_queue->ExecuteCommandLists(_countof(cmd_lists), cmd_lists);
+    FlushCommandQueue();
+}
+
+void HeadlessDevice::FlushCommandQueue()
+{
+    m_current_fence++;
+    ThrowIfFailed(m_command_queue->Signal(m_fence.Get(), m_current_fence));
+
+    if(m_fence->GetCompletedValue() < m_current_fence)
+    {
+        HANDLE event_handle = CreateEventEx(nullptr, nullptr, false, EVENT_ALL_ACCESS);
+        ThrowIfFailed(m_fence->SetEventOnCompletion(m_current_fence, event_handle));
+        WaitForSingleObject(event_handle, INFINITE);
+        CloseHandle(event_handle);
+    }
+}
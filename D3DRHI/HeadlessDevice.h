@@ -0,0 +1,33 @@
+#pragma once
+#include "Common/d3dUtil.h"
+
+// device, direct queue and command list without a window or swap chain, for the tests and benchmarks
+// created like D3DApp::InitDirect3D, falls back to WARP when there is no hardware device
+class HeadlessDevice
+{
+public:
+    HeadlessDevice();
+    ~HeadlessDevice();
+
+    HeadlessDevice(const HeadlessDevice&) = delete;
+    HeadlessDevice& operator=(const HeadlessDevice&) = delete;
+
+    ID3D12Device* GetDevice() const { return m_device.Get(); }
+    ID3D12CommandQueue* GetCommandQueue() const { return m_command_queue.Get(); }
+    ID3D12GraphicsCommandList* GetCommandList() const { return m_command_list.Get(); }
+
+    // waits for the gpu, then resets the allocator and opens the command list
+    void BeginCommandList();
+    // closes and executes the command list, then waits for the gpu
+    void ExecuteCommandList();
+    void FlushCommandQueue();
+
+private:
+    Microsoft::WRL::ComPtr<IDXGIFactory4> m_dxgi_factory;
+    Microsoft::WRL::ComPtr<ID3D12Device> m_device;
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> m_command_queue;
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> m_command_allocator;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> m_command_list;
+    Microsoft::WRL::ComPtr<ID3D12Fence> m_fence;
+    UINT64 m_current_fence = 0;
+};
@@ -1,17 +1,72 @@
 #include "PSOManager.h"
+#include "Material/Shader.h"
 
-void PSOManager::CreatePSO(const std::string& name, D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ID3D12Device* device)
+void PSOManager::CreatePSO(NameID name, D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ID3D12Device* device)
 {
-    assert(m_pso_map.find(name) == m_pso_map.end());
+    CreatePSO(name, desc, nullptr, device);
+}
+
+void PSOManager::CreatePSO(NameID name, D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, Shader* shader, ID3D12Device* device)
+{
+    assert(!m_pso_ids.Contains(name));
+
+    auto record = std::make_unique<PSORecord>();
+    record->desc = desc;
+    record->input_layout.assign(desc.InputLayout.pInputElementDescs, desc.InputLayout.pInputElementDescs + desc.InputLayout.NumElements);
+    record->shader = shader;
+    record->id = (uint16_t)m_pso_records.size();
+    m_pso_ids.Insert(name, record->id);
+
+    record->pso = BuildPSO(*record, shader, device);
+    m_pso_records.push_back(std::move(record));
+}
 
-    std::pair<std::string, ComPtr<ID3D12PipelineState>> element;
-    element.first = name;
-    ThrowIfFailed(device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&element.second)));
+uint16_t PSOManager::GetPSOID(NameID name) const
+{
+    const uint16_t* pso_id = m_pso_ids.Find(name);
+    assert(pso_id);
+    return *pso_id;
+}
+
+void PSOManager::RebuildPSOs(Shader* shader, const Shader& source, ID3D12Device* device)
+{
+    std::vector<std::pair<PSORecord*, ComPtr<ID3D12PipelineState>>> rebuilt_psos;
+    for(auto& record : m_pso_records)
+    {
+        if(record->shader == shader)
+        {
+            rebuilt_psos.emplace_back(record.get(), BuildPSO(*record, &source, device));
+        }
+    }
 
-    m_pso_map.insert(element);
+    for(auto& rebuilt : rebuilt_psos)
+    {
+        rebuilt.first->pso = rebuilt.second;
+    }
 }
 
-ID3D12PipelineState *PSOManager::GetPSO(const std::string &name)
+ComPtr<ID3D12PipelineState> PSOManager::BuildPSO(const PSORecord& record, const Shader* source, ID3D12Device* device)
 {
-    return m_pso_map[name].Get();
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = record.desc;
+    desc.InputLayout = { record.input_layout.data(), (UINT)record.input_layout.size() };
+
+    if(source != nullptr)
+    {
+        static constexpr NameID k_vs_name = "VS";
+        static constexpr NameID k_ps_name = "PS";
+        auto& shader_stage = source->m_shader_stage;
+        desc.pRootSignature = source->m_root_signature.Get();
+        if(auto* vs = shader_stage.Find(k_vs_name))
+        {
+            desc.VS = { reinterpret_cast<BYTE*>((*vs)->GetBufferPointer()), (*vs)->GetBufferSize() };
+        }
+        if(auto* ps = shader_stage.Find(k_ps_name))
+        {
+            desc.PS = { reinterpret_cast<BYTE*>((*ps)->GetBufferPointer()), (*ps)->GetBufferSize() };
+        }
+    }
+
+    ComPtr<ID3D12PipelineState> pso;
+    ThrowIfFailed(device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pso)));
+    return pso;
 }
@@ -1,20 +1,46 @@
 #pragma once
+#include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 #include "Common/d3dUtil.h"
+#include "Utility/NameID.h"
+#include "Utility/FlatHashMap.h"
 
 using Microsoft::WRL::ComPtr;
 
+class Shader;
+
 class PSOManager
 {
 public:
     PSOManager() = default;
     ~PSOManager() = default;
 
-    void CreatePSO(const std::string& name, D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ID3D12Device* device);
-    ID3D12PipelineState* GetPSO(const std::string& name);
+    void CreatePSO(NameID name, D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ID3D12Device* device);
+    // root signature and VS/PS bytecode are taken from shader, the pso follows the shader when it is hot reloaded
+    void CreatePSO(NameID name, D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, Shader* shader, ID3D12Device* device);
+    ID3D12PipelineState* GetPSO(NameID name) const { return GetPSO(GetPSOID(name)); }
+    // small dense ids in creation order, used in render queue sort keys
+    uint16_t GetPSOID(NameID name) const;
+    ID3D12PipelineState* GetPSO(uint16_t pso_id) const { return m_pso_records[pso_id]->pso.Get(); }
+
+    // recreate every pso built from shader with the bytecode and root signature of source, e.g. a hot reloaded copy
+    // all of them are built before any is replaced, when one build throws the old psos stay
+    void RebuildPSOs(Shader* shader, const Shader& source, ID3D12Device* device);
+
+private:
+    struct PSORecord
+    {
+        ComPtr<ID3D12PipelineState> pso;
+        D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = {};
+        std::vector<D3D12_INPUT_ELEMENT_DESC> input_layout; // desc.InputLayout points into the caller's memory, keep a copy
+        Shader* shader = nullptr;
+        uint16_t id = 0;
+    };
+
+    static ComPtr<ID3D12PipelineState> BuildPSO(const PSORecord& record, const Shader* source, ID3D12Device* device);
 
 private:
-    
-    std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> m_pso_map;
-};
\ No newline at end of file
+    std::vector<std::unique_ptr<PSORecord>> m_pso_records; // by id
+    FlatHashMap<NameID, uint16_t> m_pso_ids;
+};
@@ -0,0 +1,95 @@
+#include "Archetype.h"
+#include <cstring>
+
+static uint32_t AlignUp(uint32_t value, uint32_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+Archetype::Archetype(ComponentMask mask):
+    m_mask(mask)
+{
+    uint32_t row_size = sizeof(EntityID);
+    for(ComponentTypeID type=0; type<k_max_component_types; type++)
+    {
+        m_column_offsets[type] = k_no_column;
+        if(mask & (1ull << type))
+        {
+            m_types.push_back(type);
+            row_size += ComponentTypeRegistry::GetInfo(type).size;
+        }
+    }
+
+    // the entity ids come first, then one aligned array per type
+    // start from the unpadded estimate and shrink until the padding fits as well
+    m_chunk_capacity = k_chunk_size / row_size;
+    while(true)
+    {
+        uint32_t offset = m_chunk_capacity * sizeof(EntityID);
+        for(ComponentTypeID type : m_types)
+        {
+            const ComponentTypeInfo& info = ComponentTypeRegistry::GetInfo(type);
+            offset = AlignUp(offset, info.alignment);
+            m_column_offsets[type] = offset;
+            offset += m_chunk_capacity * info.size;
+        }
+        if(offset <= k_chunk_size)
+        {
+            break;
+        }
+        m_chunk_capacity--;
+    }
+    assert(m_chunk_capacity > 0);
+}
+
+uint32_t Archetype::GetChunkEntityCount(uint32_t chunk) const
+{
+    // every chunk but the last one is full
+    if(chunk + 1 < m_chunks.size())
+    {
+        return m_chunk_capacity;
+    }
+    return m_entity_count - chunk * m_chunk_capacity;
+}
+
+EntityLocation Archetype::Allocate(EntityID entity)
+{
+    EntityLocation location;
+    location.chunk = m_entity_count / m_chunk_capacity;
+    location.row = m_entity_count % m_chunk_capacity;
+    if(location.chunk == m_chunks.size())
+    {
+        m_chunks.push_back(m_spare_chunk ? std::move(m_spare_chunk) : std::make_unique<Chunk>());
+    }
+
+    GetEntities(location.chunk)[location.row] = entity;
+    m_entity_count++;
+    return location;
+}
+
+EntityID Archetype::Remove(EntityLocation location)
+{
+    assert(m_entity_count > 0);
+    m_entity_count--;
+    EntityLocation last;
+    last.chunk = m_entity_count / m_chunk_capacity;
+    last.row = m_entity_count % m_chunk_capacity;
+
+    EntityID moved_entity;
+    if(last.chunk != location.chunk || last.row != location.row)
+    {
+        moved_entity = GetEntities(last.chunk)[last.row];
+        GetEntities(location.chunk)[location.row] = moved_entity;
+        for(ComponentTypeID type : m_types)
+        {
+            memcpy(GetComponent(location, type), GetComponent(last, type), ComponentTypeRegistry::GetInfo(type).size);
+        }
+    }
+
+    if(last.row == 0)
+    {
+        m_spare_chunk = std::move(m_chunks.back());
+        m_chunks.pop_back();
+    }
+    return moved_entity;
+}
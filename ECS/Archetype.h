@@ -0,0 +1,76 @@
+#pragma once
+#include <cassert>
+#include <memory>
+#include <vector>
+#include "ComponentType.h"
+#include "Entity.h"
+
+// where an entity's components live inside its archetype
+struct EntityLocation
+{
+    uint32_t chunk = 0;
+    uint32_t row = 0;
+};
+
+// all entities with exactly the same component set
+// entities are stored in fixed size chunks, each chunk holds one array per component type (SoA)
+// followed by nothing else, so iterating one component type walks contiguous memory
+// rows are kept dense: removing an entity moves the archetype's last entity into its row
+class Archetype
+{
+public:
+    static const uint32_t k_chunk_size = 16 * 1024;
+
+    explicit Archetype(ComponentMask mask);
+    ~Archetype() = default;
+
+    Archetype(const Archetype&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
+
+    ComponentMask GetMask() const { return m_mask; }
+    bool HasComponent(ComponentTypeID type) const { return m_column_offsets[type] != k_no_column; }
+
+    uint32_t GetChunkCapacity() const { return m_chunk_capacity; }
+    uint32_t GetChunkCount() const { return (uint32_t)m_chunks.size(); }
+    uint32_t GetChunkEntityCount(uint32_t chunk) const;
+    uint32_t GetEntityCount() const { return m_entity_count; }
+
+    EntityID* GetEntities(uint32_t chunk) { return reinterpret_cast<EntityID*>(m_chunks[chunk]->data); }
+    void* GetComponentArray(uint32_t chunk, ComponentTypeID type)
+    {
+        assert(HasComponent(type));
+        return m_chunks[chunk]->data + m_column_offsets[type];
+    }
+    template<typename T>
+    T* GetComponentArray(uint32_t chunk) { return reinterpret_cast<T*>(GetComponentArray(chunk, ComponentTypeRegistry::GetID<T>())); }
+
+    void* GetComponent(EntityLocation location, ComponentTypeID type)
+    {
+        return static_cast<char*>(GetComponentArray(location.chunk, type)) + (size_t)location.row * ComponentTypeRegistry::GetInfo(type).size;
+    }
+
+    // appends a row, the components are left uninitialized
+    EntityLocation Allocate(EntityID entity);
+    // returns the entity moved into the freed row, invalid if the removed row was the last one
+    EntityID Remove(EntityLocation location);
+
+private:
+    struct alignas(64) Chunk
+    {
+        char data[k_chunk_size];
+    };
+
+    static const uint32_t k_no_column = 0xffffffff;
+
+private:
+    ComponentMask m_mask = 0;
+    std::vector<ComponentTypeID> m_types;
+    uint32_t m_column_offsets[k_max_component_types];  // byte offset of each type's array in a chunk
+    uint32_t m_chunk_capacity = 0;
+
+    std::vector<std::unique_ptr<Chunk>> m_chunks;
+    // the last chunk freed by Remove, so an entity passing through (e.g. every new one through the empty archetype)
+    // does not allocate and free a chunk each time
+    std::unique_ptr<Chunk> m_spare_chunk;
+    uint32_t m_entity_count = 0;
+};
@@ -0,0 +1,29 @@
+#include "ComponentType.h"
+#include <atomic>
+#include <cassert>
+
+// fixed storage so GetInfo never races with a registration on another thread
+static ComponentTypeInfo s_type_infos[k_max_component_types];
+static std::atomic<uint32_t> s_type_count{ 0 };
+
+ComponentTypeID ComponentTypeRegistry::Register(uint32_t size, uint32_t alignment, void (*construct)(void* dest))
+{
+    ComponentTypeID id = s_type_count.fetch_add(1);
+    assert(id < k_max_component_types);
+
+    s_type_infos[id].size = size;
+    s_type_infos[id].alignment = alignment;
+    s_type_infos[id].construct = construct;
+    return id;
+}
+
+const ComponentTypeInfo& ComponentTypeRegistry::GetInfo(ComponentTypeID id)
+{
+    assert(id < s_type_count);
+    return s_type_infos[id];
+}
+
+uint32_t ComponentTypeRegistry::GetTypeCount()
+{
+    return s_type_count;
+}
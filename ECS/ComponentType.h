@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+typedef uint32_t ComponentTypeID;
+typedef uint64_t ComponentMask;     // one bit per ComponentTypeID
+
+static const uint32_t k_max_component_types = 64;
+
+// size and default construction of a component type, components are moved between chunks with memcpy
+struct ComponentTypeInfo
+{
+    uint32_t size = 0;
+    uint32_t alignment = 0;
+    void (*construct)(void* dest) = nullptr;
+};
+
+// dense ids handed out on first use of a component type, no rtti involved
+class ComponentTypeRegistry
+{
+public:
+    template<typename T>
+    static ComponentTypeID GetID()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "components are moved with memcpy");
+        static_assert(std::is_trivially_destructible<T>::value, "components are never destructed");
+        static const ComponentTypeID id = Register(sizeof(T), alignof(T), [](void* dest) { new(dest) T(); });
+        return id;
+    }
+
+    static const ComponentTypeInfo& GetInfo(ComponentTypeID id);
+    static uint32_t GetTypeCount();
+
+private:
+    static ComponentTypeID Register(uint32_t size, uint32_t alignment, void (*construct)(void* dest));
+};
+
+template<typename T>
+ComponentMask GetComponentMask()
+{
+    return 1ull << ComponentTypeRegistry::GetID<T>();
+}
+
+template<typename... Ts>
+ComponentMask MakeComponentMask()
+{
+    ComponentMask mask = 0;
+    ComponentMask bits[] = { 0ull, GetComponentMask<Ts>()... };
+    for(ComponentMask bit : bits)
+    {
+        mask |= bit;
+    }
+    return mask;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+// index into the world's entity records, the generation tells a destroyed entity from its slot's next owner
+struct EntityID
+{
+    static const uint32_t k_invalid_index = 0xffffffff;
+
+    uint32_t index = k_invalid_index;
+    uint32_t generation = 0;
+
+    bool IsValid() const { return index != k_invalid_index; }
+    bool operator==(const EntityID& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const EntityID& other) const { return !(*this == other); }
+};
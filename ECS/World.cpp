@@ -0,0 +1,113 @@
+#include "World.h"
+#include <cstring>
+
+World& World::GetDefault()
+{
+    static World world;
+    return world;
+}
+
+EntityID World::CreateEntity()
+{
+    EntityID entity;
+    if(!m_free_indices.empty())
+    {
+        entity.index = m_free_indices.back();
+        m_free_indices.pop_back();
+    }
+    else
+    {
+        entity.index = (uint32_t)m_records.size();
+        m_records.emplace_back();
+    }
+
+    EntityRecord& record = m_records[entity.index];
+    entity.generation = record.generation;
+    record.archetype = GetOrCreateArchetype(0);
+    record.location = record.archetype->Allocate(entity);
+    m_entity_count++;
+    return entity;
+}
+
+void World::DestroyEntity(EntityID entity)
+{
+    assert(IsAlive(entity));
+    EntityRecord& record = m_records[entity.index];
+    RemoveFromArchetype(record);
+    record.archetype = nullptr;
+    record.generation++;
+    m_free_indices.push_back(entity.index);
+    m_entity_count--;
+}
+
+bool World::IsAlive(EntityID entity) const
+{
+    return entity.index < m_records.size() &&
+        m_records[entity.index].archetype != nullptr &&
+        m_records[entity.index].generation == entity.generation;
+}
+
+Archetype* World::GetOrCreateArchetype(ComponentMask mask)
+{
+    auto iter = m_archetypes.find(mask);
+    if(iter != m_archetypes.end())
+    {
+        return iter->second.get();
+    }
+
+    Archetype* archetype = new Archetype(mask);
+    m_archetypes[mask].reset(archetype);
+    m_archetype_list.push_back(archetype);
+    return archetype;
+}
+
+void World::MoveEntity(EntityID entity, ComponentMask new_mask)
+{
+    EntityRecord& record = m_records[entity.index];
+    Archetype* old_archetype = record.archetype;
+    Archetype* new_archetype = GetOrCreateArchetype(new_mask);
+    EntityLocation old_location = record.location;
+    EntityLocation new_location = new_archetype->Allocate(entity);
+
+    for(ComponentTypeID type=0; type<k_max_component_types; type++)
+    {
+        if(!(new_mask & (1ull << type)))
+        {
+            continue;
+        }
+
+        void* dest = new_archetype->GetComponent(new_location, type);
+        if(old_archetype->HasComponent(type))
+        {
+            memcpy(dest, old_archetype->GetComponent(old_location, type), ComponentTypeRegistry::GetInfo(type).size);
+        }
+        else
+        {
+            ComponentTypeRegistry::GetInfo(type).construct(dest);
+        }
+    }
+
+    RemoveFromArchetype(record);
+    record.archetype = new_archetype;
+    record.location = new_location;
+}
+
+void World::RemoveFromArchetype(EntityRecord& record)
+{
+    EntityID moved_entity = record.archetype->Remove(record.location);
+    if(moved_entity.IsValid())
+    {
+        m_records[moved_entity.index].location = record.location;
+    }
+}
+
+void* World::GetComponent(EntityID entity, ComponentTypeID type)
+{
+    assert(IsAlive(entity));
+    EntityRecord& record = m_records[entity.index];
+    if(!record.archetype->HasComponent(type))
+    {
+        return nullptr;
+    }
+    return record.archetype->GetComponent(record.location, type);
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Archetype.h"
+#include "Scene/SceneHierarchy.h"
+
+// archetype based entity component store
+// an entity is an id, its components live in the chunks of the archetype matching its component set
+// adding or removing a component moves the entity to another archetype, which invalidates
+// component pointers and references of the moved entity and of the entity that fills its old row
+// queries match archetypes by component mask, components must not be added or removed while iterating
+class World
+{
+public:
+    World() = default;
+    ~World() = default;
+
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    // world shared by the game objects
+    static World& GetDefault();
+
+    EntityID CreateEntity();
+    void DestroyEntity(EntityID entity);
+    bool IsAlive(EntityID entity) const;
+    uint32_t GetEntityCount() const { return m_entity_count; }
+
+    // transforms of the world's entities, see TransformComponent
+    SceneHierarchy& GetSceneHierarchy() { return m_scene_hierarchy; }
+
+    template<typename T>
+    T& AddComponent(EntityID entity, const T& value = T());
+    template<typename T>
+    void RemoveComponent(EntityID entity);
+    template<typename T>
+    bool HasComponent(EntityID entity) const;
+    // nullptr if the entity does not have the component
+    template<typename T>
+    T* GetComponent(EntityID entity);
+
+    // func(uint32_t count, const EntityID* entities, Ts* arrays...) once per chunk holding all of Ts
+    template<typename... Ts, typename Func>
+    void ForEachChunk(Func&& func);
+    // func(Ts&... components) once per entity holding all of Ts
+    template<typename... Ts, typename Func>
+    void ForEach(Func&& func);
+
+private:
+    struct EntityRecord
+    {
+        Archetype* archetype = nullptr;
+        EntityLocation location;
+        uint32_t generation = 0;
+    };
+
+    Archetype* GetOrCreateArchetype(ComponentMask mask);
+    // moves the entity to the archetype of new_mask, components of both archetypes are copied,
+    // components only in the new one are default constructed
+    void MoveEntity(EntityID entity, ComponentMask new_mask);
+    void RemoveFromArchetype(EntityRecord& record);
+    void* GetComponent(EntityID entity, ComponentTypeID type);
+
+private:
+    std::vector<EntityRecord> m_records;
+    std::vector<uint32_t> m_free_indices;
+    uint32_t m_entity_count = 0;
+
+    std::unordered_map<ComponentMask, std::unique_ptr<Archetype>> m_archetypes;
+    std::vector<Archetype*> m_archetype_list;   // creation order, walked by queries
+
+    SceneHierarchy m_scene_hierarchy;
+};
+
+template<typename T>
+T& World::AddComponent(EntityID entity, const T& value)
+{
+    assert(IsAlive(entity));
+    ComponentTypeID type = ComponentTypeRegistry::GetID<T>();
+    EntityRecord& record = m_records[entity.index];
+    if(!record.archetype->HasComponent(type))
+    {
+        MoveEntity(entity, record.archetype->GetMask() | (1ull << type));
+    }
+
+    T* component = static_cast<T*>(GetComponent(entity, type));
+    *component = value;
+    return *component;
+}
+
+template<typename T>
+void World::RemoveComponent(EntityID entity)
+{
+    assert(IsAlive(entity));
+    ComponentTypeID type = ComponentTypeRegistry::GetID<T>();
+    EntityRecord& record = m_records[entity.index];
+    if(record.archetype->HasComponent(type))
+    {
+        MoveEntity(entity, record.archetype->GetMask() & ~(1ull << type));
+    }
+}
+
+template<typename T>
+bool World::HasComponent(EntityID entity) const
+{
+    assert(IsAlive(entity));
+    return m_records[entity.index].archetype->HasComponent(ComponentTypeRegistry::GetID<T>());
+}
+
+template<typename T>
+T* World::GetComponent(EntityID entity)
+{
+    return static_cast<T*>(GetComponent(entity, ComponentTypeRegistry::GetID<T>()));
+}
+
+template<typename... Ts, typename Func>
+void World::ForEachChunk(Func&& func)
+{
+    ComponentMask mask = MakeComponentMask<Ts...>();
+    for(Archetype* archetype : m_archetype_list)
+    {
+        if((archetype->GetMask() & mask) != mask)
+        {
+            continue;
+        }
+
+        for(uint32_t chunk=0; chunk<archetype->GetChunkCount(); chunk++)
+        {
+            func(archetype->GetChunkEntityCount(chunk), archetype->GetEntities(chunk), archetype->template GetComponentArray<Ts>(chunk)...);
+        }
+    }
+}
+
+template<typename... Ts, typename Func>
+void World::ForEach(Func&& func)
+{
+    ForEachChunk<Ts...>([&func](uint32_t count, const EntityID* entities, Ts*... arrays)
+    {
+        for(uint32_t i=0; i<count; i++)
+        {
+            func(arrays[i]...);
+        }
+    });
+}
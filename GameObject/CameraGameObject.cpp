@@ -2,18 +2,18 @@
 
 Vector3 CameraGameObject::GetPosition() const
 {
-    return m_root_component->GetWorldLocation();
+    return GetGameObjectLocation();
 }
 
 void CameraGameObject::SetPosition(float x, float y, float z)
 {
-    m_root_component->SetWorldLocation(Vector3(x, y, z));
+    SetGameObjectLocation(Vector3(x, y, z));
     m_is_dirty = true;
 }
 
 void CameraGameObject::SetPosition(const Vector3& position)
 {
-    m_root_component->SetWorldLocation(position);
+    SetGameObjectLocation(position);
     m_is_dirty = true;
 }
 	
@@ -88,6 +88,9 @@ void CameraGameObject::SetLens(float fov_vertical, float aspect, float znear, fl
 
 	m_near_window_height = 2.0f * m_nearz * tanf( 0.5f * m_fov_vertical );
 	m_far_window_height  = 2.0f * m_farz * tanf( 0.5f * m_fov_vertical );
+
+	m_proj = Matrix::CreatePerspectiveFieldOfView(m_fov_vertical, m_aspect_ratio, m_nearz, m_farz);
+	m_is_dirty = true; // view projection and frustum are refreshed by UpdateViewMatrix
 }
 
 // Define camera space via LookAt parameters.
@@ -95,7 +98,7 @@ void CameraGameObject::LookAt(const Vector3& camera_pos, const Vector3& target_p
 {
     SetPosition(camera_pos);
 
-	m_look = (target_pos - m_root_component->GetWorldLocation());
+	m_look = (target_pos - GetGameObjectLocation());
     m_look.Normalize();
     m_right = up_dir.Cross(m_look);
     m_right.Normalize();
@@ -117,9 +120,9 @@ void CameraGameObject::UpdateViewMatrix()
 		m_right = m_up.Cross(m_look);
 
 		// Fill in the view matrix entries.
-		float x = - m_root_component->GetWorldLocation().Dot(m_right);
-		float y = - m_root_component->GetWorldLocation().Dot(m_up);
-		float z = - m_root_component->GetWorldLocation().Dot(m_look);
+		float x = - GetGameObjectLocation().Dot(m_right);
+		float y = - GetGameObjectLocation().Dot(m_up);
+		float z = - GetGameObjectLocation().Dot(m_look);
 
 		m_view(0, 0) = m_right.x;
 		m_view(1, 0) = m_right.y;
@@ -141,6 +144,9 @@ void CameraGameObject::UpdateViewMatrix()
 		m_view(2, 3) = 0.0f;
 		m_view(3, 3) = 1.0f;
 
+		m_view_proj = m_view * m_proj;
+		m_frustum = ExtractFrustum(m_view_proj);
+
 		m_is_dirty = false;
 	}
 }
@@ -154,6 +160,36 @@ Matrix CameraGameObject::GetViewMatrix()const
 
 Matrix CameraGameObject::GetProjMatrix()const
 {
-    return Matrix::CreatePerspectiveFieldOfView(m_fov_vertical, m_aspect_ratio, m_nearz, m_farz);
+    return m_proj;
+}
+
+Matrix CameraGameObject::GetViewProjMatrix()const
+{
+	assert(m_is_dirty == false);
+    return m_view_proj;
+}
+
+const Frustum& CameraGameObject::GetFrustum()const
+{
+	assert(m_is_dirty == false);
+    return m_frustum;
+}
+
+Ray CameraGameObject::GetPickRay(float ndc_x, float ndc_y)const
+{
+    // the basis is relative to the parent like the location, the camera's own rotation stays identity,
+    // so the world matrix moves the direction with the parents' rotation and scale, row vectors
+    const Matrix& world = GetWorldMatrix();
+    Vector3 local = m_right * (ndc_x * 0.5f * GetNearWindowWidth()) + m_up * (ndc_y * 0.5f * GetNearWindowHeight()) + m_look * m_nearz;
+
+    Ray ray;
+    ray.origin = Vector3(world._41, world._42, world._43);
+    ray.direction = Vector3(
+        local.x * world._11 + local.y * world._21 + local.z * world._31,
+        local.x * world._12 + local.y * world._22 + local.z * world._32,
+        local.x * world._13 + local.y * world._23 + local.z * world._33);
+    ray.direction.Normalize();
+    ray.max_distance = m_farz;
+    return ray;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "GameObject.h"
+#include "Scene/Bounds.h"
 
 // left hand coord
 // cross(right, up) = -look
@@ -43,6 +44,12 @@ public:
 	void UpdateViewMatrix();
 	Matrix GetViewMatrix()const;
 	Matrix GetProjMatrix()const;
+	Matrix GetViewProjMatrix()const;
+	// planes of the cached view projection, in world space
+	const Frustum& GetFrustum()const;
+	// world space ray from the camera through a point of the near plane, ndc in [-1, 1] with y up
+	// built from the world matrix, as of the last SceneHierarchy::UpdateWorldMatrices
+	Ray GetPickRay(float ndc_x, float ndc_y)const;
 
 	//TODO
 	// Strafe/Walk the camera a distance d.
@@ -71,5 +78,8 @@ private:
 
 	// Cache View/Proj matrices.
 	Matrix m_view = Matrix::Identity;
+	Matrix m_proj = Matrix::Identity;
+	Matrix m_view_proj = Matrix::Identity;
+	Frustum m_frustum;
 	bool m_is_dirty = true;
 };
\ No newline at end of file
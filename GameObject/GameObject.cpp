@@ -1,23 +1,58 @@
 #include "GameObject.h"
 
-Component *GameObject::GetRootComponent() const
+GameObject::GameObject(const std::string& Name, World* world):
+    m_name(NameTable::GetDefault().Intern(Name)),
+    m_world(world)
 {
-    return m_root_component;
+    m_entity = m_world->CreateEntity();
+    m_scene_node = m_world->GetSceneHierarchy().CreateNode();
+
+    TransformComponent transform;
+    transform.Node = m_scene_node;
+    m_world->AddComponent<TransformComponent>(m_entity, transform);
+}
+
+GameObject::~GameObject()
+{
+    m_world->GetSceneHierarchy().DestroyNode(m_scene_node);
+    m_world->DestroyEntity(m_entity);
+    NameTable::GetDefault().Release(m_name);
+}
+
+void GameObject::SetName(const std::string& new_name)
+{
+    // interned first, renaming to the same name keeps its entry
+    NameIndex old_name = m_name;
+    m_name = NameTable::GetDefault().Intern(new_name);
+    NameTable::GetDefault().Release(old_name);
+}
+
+void GameObject::SetParent(GameObject* parent)
+{
+    assert(parent == nullptr || parent->m_world == m_world);
+    m_world->GetSceneHierarchy().SetParent(m_scene_node, parent ? parent->m_scene_node : k_invalid_scene_node);
+}
+
+const Matrix& GameObject::GetWorldMatrix() const
+{
+    return m_world->GetSceneHierarchy().GetWorldMatrix(m_scene_node);
 }
 
 void GameObject::SetGameObjectTransform(const Transform &new_transform)
 {
-    m_root_component->SetWorldTransform(new_transform);
+    m_world->GetSceneHierarchy().SetLocalTransform(m_scene_node, new_transform);
 }
 
 Transform GameObject::GetGameObjectTransform() const
 {
-    return m_root_component->GetWorldTransform();
+    return m_world->GetSceneHierarchy().GetLocalTransform(m_scene_node);
 }
 
 void GameObject::SetGameObjectLocation(const Vector3 &new_location)
 {
-    m_root_component->SetWorldLocation(new_location);
+    Transform transform = GetGameObjectTransform();
+    transform.Location = new_location;
+    SetGameObjectTransform(transform);
 }
 
 void GameObject::SetGameObjectLocation(const float x, const float y, const float z)
@@ -27,12 +62,14 @@ void GameObject::SetGameObjectLocation(const float x, const float y, const float
 
 Vector3 GameObject::GetGameObjectLocation() const
 {
-    return m_root_component->GetWorldLocation();
+    return GetGameObjectTransform().Location;
 }
 
 void GameObject::SetGameObjectRotation(const Rotator &new_rotator)
 {
-    m_root_component->SetWorldRotation(new_rotator);
+    Transform transform = GetGameObjectTransform();
+    transform.SetRotator(new_rotator);
+    SetGameObjectTransform(transform);
 }
 
 //Roll: Angle of rotation around the z-axis, in degrees.
@@ -46,5 +83,17 @@ void GameObject::SetGameObjectRotation(const float roll, const float pitch, cons
 
 Rotator GameObject::GetGameObjectRotation() const
 {
-    return m_root_component->GetWorldRotation();
+    return GetGameObjectTransform().GetRotator();
+}
+
+void GameObject::SetGameObjectRotation(const Quaternion& new_rotation)
+{
+    Transform transform = GetGameObjectTransform();
+    transform.Rotation = new_rotation;
+    SetGameObjectTransform(transform);
+}
+
+Quaternion GameObject::GetGameObjectQuaternion() const
+{
+    return GetGameObjectTransform().Rotation;
 }
@@ -1,64 +1,66 @@
 #pragma once
 #include "Math/Math.h"
 #include "Component/Component.h"
-#include <vector>
-#include <memory>
+#include "ECS/World.h"
+#include "Utility/NameTable.h"
+#include <string>
 
 
+// thin handle over an entity of an ecs World, the components live in the world's chunks
+// the entity is created with a TransformComponent and destroyed with the game object
+// transforms are relative to the parent game object, world matrices are computed by
+// the world's SceneHierarchy::UpdateWorldMatrices
+// names are interned in NameTable::GetDefault and released with the game object, game objects are usually created in an ObjectPool
 class GameObject
 {
 public:
-	GameObject(const std::string& Name): m_name(Name) 
-	{ 
-		m_components.push_back(std::make_unique<Component>());
-		m_root_component = m_components[0].get();
-	}
+	GameObject(const std::string& Name, World* world = &World::GetDefault());
 	GameObject() = delete;
 
-	virtual ~GameObject() {}
+	virtual ~GameObject();
+
+	GameObject(const GameObject&) = delete;
+	GameObject& operator=(const GameObject&) = delete;
 
 	virtual void Tick(float DeltaSeconds) {}
 
 public:
+	World* GetWorld() const { return m_world; }
+	EntityID GetEntity() const { return m_entity; }
+
+	// the returned pointer is valid until a component is added to or removed from any entity of the world
 	template<typename T>
-	T* AddComponent()
+	T* AddComponent(const T& value = T())
 	{
-		auto NewComponent = std::make_unique<T>();
-		T* Result = NewComponent.get();
-		Components.push_back(std::move(NewComponent));
-
-		return Result;
+		return &m_world->AddComponent<T>(m_entity, value);
 	}
 
-	std::vector<Component*> GetComponents()
+	template<typename T>
+	void RemoveComponent()
 	{
-		std::vector<Component*> ret;
-
-		for (const auto& component : m_components)
-		{
-			ret.push_back(component.get());
-		}
+		m_world->RemoveComponent<T>(m_entity);
+	}
 
-		return ret;
+	template<typename T>
+	bool HasComponent() const
+	{
+		return m_world->HasComponent<T>(m_entity);
 	}
 
+	// nullptr if the game object does not have the component
 	template<typename T>
-	std::vector<T*> GetComponentsOfClass()
+	T* GetComponent() const
 	{
-		std::vector<T*> Result;
-		for (const auto& component : m_components)
-		{
-			T* ComponentOfClass = dynamic_cast<T*>(component.get());
-			if (ComponentOfClass)
-			{
-				Result.push_back(ComponentOfClass);
-			}
-		}
-
-		return Result;
+		return m_world->GetComponent<T>(m_entity);
 	}
 
-    Component* GetRootComponent() const;
+	// nullptr makes the game object a root, its local transform is kept
+	void SetParent(GameObject* parent);
+
+	SceneNodeID GetSceneNode() const { return m_scene_node; }
+
+	// as of the last SceneHierarchy::UpdateWorldMatrices
+	const Matrix& GetWorldMatrix() const;
 
 	virtual void SetGameObjectTransform(const Transform& new_transform);
 
@@ -74,14 +76,18 @@ public:
 
 	Rotator GetGameObjectRotation() const;
 
-	void SetName(const std::string& new_name) { m_name = new_name; }
+	// unit quaternion, no conversion from or to euler angles
+	void SetGameObjectRotation(const Quaternion& new_rotation);
+	Quaternion GetGameObjectQuaternion() const;
 
-	std::string GetName() const { return m_name; }
+	void SetName(const std::string& new_name);
 
-protected:
-	std::string m_name;
+	const char* GetName() const { return NameTable::GetDefault().GetString(m_name); }
 
-	std::vector<std::unique_ptr<Component>> m_components;
+protected:
+	NameIndex m_name = 0;
 
-    Component* m_root_component = nullptr;
+	World* m_world = nullptr;
+	EntityID m_entity;
+	SceneNodeID m_scene_node = k_invalid_scene_node;
 };
\ No newline at end of file
@@ -12,11 +12,20 @@ public:
     ModelGameObject() = delete;
 
     void SetMesh(Mesh* mesh) { m_mesh = mesh; }
-    void SetMaterial(Material* material) { m_material = material; }
-    void Draw(CameraGameObject* camera, ID3D12GraphicsCommandList* cmd_list, DescriptorCacheGPU *descriptor_cache);
+    void SetMaterial(MaterialInstance* material);
+    void SetPSOID(uint16_t pso_id) { m_pso_id = pso_id; } // see PSOManager::GetPSOID
+    // simplified closed mesh hiding what is behind it, nullptr when the object occludes nothing
+    void SetOccluderMesh(Mesh* occluder_mesh) { m_occluder_mesh = occluder_mesh; }
+
+    Mesh* GetMesh() const { return m_mesh; }
+    MaterialInstance* GetMaterial() const { return m_material; }
+    uint16_t GetPSOID() const { return m_pso_id; }
+    Mesh* GetOccluderMesh() const { return m_occluder_mesh; }
 
 private:
     Mesh* m_mesh = nullptr;
-    Material* m_material = nullptr;
+    MaterialInstance* m_material = nullptr;
+    uint16_t m_pso_id = 0;
+    Mesh* m_occluder_mesh = nullptr;
 
 };
@@ -1,56 +1,426 @@
 #include "Material.h"
 
-void Material::SetShader(Shader *shader)
+MaterialUploadStats MaterialTemplate::s_upload_stats;
+uint16_t MaterialTemplate::s_next_material_id = 0;
+
+void MaterialDirtyRanges::Add(uint32_t range_begin, uint32_t range_end)
+{
+    assert(range_begin < range_end);
+
+    // merge with every range it overlaps or touches
+    for(uint32_t i=0; i<count; )
+    {
+        if(range_begin <= end[i] && begin[i] <= range_end)
+        {
+            range_begin = std::min<uint32_t>(range_begin, begin[i]);
+            range_end = std::max<uint32_t>(range_end, end[i]);
+            count--;
+            begin[i] = begin[count];
+            end[i] = end[count];
+            continue;
+        }
+        i++;
+    }
+
+    if(count == k_max_ranges)
+    {
+        // out of ranges, one covering range copies a few clean bytes but stays correct
+        for(uint32_t i=0; i<count; i++)
+        {
+            range_begin = std::min<uint32_t>(range_begin, begin[i]);
+            range_end = std::max<uint32_t>(range_end, end[i]);
+        }
+        count = 0;
+    }
+
+    begin[count] = range_begin;
+    end[count] = range_end;
+    count++;
+}
+
+void MaterialInstance::SetParameter(ShaderParamHandle handle, ShaderResourceView *srv)
+{
+    int texture_index = m_template->FindTexture(handle);
+    assert(texture_index >= 0);
+    m_template->GetTextureOverrides(m_index)[texture_index] = srv;
+}
+
+void MaterialInstance::SetParameter(const std::string &name, ShaderResourceView *srv)
 {
-    m_shader = shader;
+    SetParameter(m_template->GetTextureHandle(name), srv);
 }
 
-D3D12ConstantBuffer *Material::GetCbPerObject()
+bool MaterialInstance::HasTextureOverrides() const
 {
-    return m_cb_per_object.get();
+    ShaderResourceView* const* texture_overrides = m_template->GetTextureOverrides(m_index);
+    for(size_t i=0; i<m_template->m_textures.size(); i++)
+    {
+        if(texture_overrides[i] != nullptr)
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
-void Material::CreateCb(ID3D12Device *device)
+bool MaterialInstance::HasSameOverrides(const MaterialInstance* other, uint64_t ignored_overrides) const
 {
-    // reset cb
-    m_cb_size = 0;
-    m_cb_per_object.release();
-    m_mapped_data.resize(0);
+    if(other == this)
+    {
+        return true;
+    }
+    if(other->m_template != m_template)
+    {
+        return false;
+    }
+
+    const uint64_t override_mask = m_template->m_override_masks[m_index] & ~ignored_overrides;
+    if(override_mask != (m_template->m_override_masks[other->m_index] & ~ignored_overrides))
+    {
+        return false;
+    }
+
+    const char* override_block = m_template->GetOverrideBlock(m_index);
+    const char* other_override_block = m_template->GetOverrideBlock(other->m_index);
+    for(const MaterialTemplate::OverrideDesc& desc : m_template->m_overrides)
+    {
+        const MaterialVariableHandle& handle = desc.handle;
+        if((override_mask & (1ull << handle.override_index)) != 0
+            && memcmp(override_block + handle.override_offset, other_override_block + handle.override_offset, handle.size) != 0)
+        {
+            return false;
+        }
+    }
+
+    ShaderResourceView* const* texture_overrides = m_template->GetTextureOverrides(m_index);
+    ShaderResourceView* const* other_texture_overrides = m_template->GetTextureOverrides(other->m_index);
+    for(size_t i=0; i<m_template->m_textures.size(); i++)
+    {
+        if(texture_overrides[i] != other_texture_overrides[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void MaterialInstance::CopyOverrides(const MaterialInstance* source)
+{
+    assert(source->m_template == m_template);
+    if(source == this)
+    {
+        return;
+    }
+
+    char* override_block = m_template->GetOverrideBlock(m_index);
+    const char* source_override_block = m_template->GetOverrideBlock(source->m_index);
+    uint64_t& override_mask = m_template->m_override_masks[m_index];
+    const uint64_t source_override_mask = m_template->m_override_masks[source->m_index];
+    for(const MaterialTemplate::OverrideDesc& desc : m_template->m_overrides)
+    {
+        const MaterialVariableHandle& handle = desc.handle;
+        const uint64_t bit = 1ull << handle.override_index;
+        if((override_mask & bit) != (source_override_mask & bit)
+            || memcmp(override_block + handle.override_offset, source_override_block + handle.override_offset, handle.size) != 0)
+        {
+            memcpy(override_block + handle.override_offset, source_override_block + handle.override_offset, handle.size);
+            m_template->MarkDirty(m_index, handle.offset, handle.size);
+        }
+    }
+    override_mask = source_override_mask;
+
+    size_t texture_count = m_template->m_textures.size();
+    memcpy(m_template->GetTextureOverrides(m_index), m_template->GetTextureOverrides(source->m_index), texture_count * sizeof(ShaderResourceView*));
+}
 
+void MaterialInstance::PassParametersToShader(ID3D12GraphicsCommandList *cmd_list, DescriptorCacheGPU *descriptor_cache)
+{
+    m_template->PassParametersToShader(m_index, cmd_list, descriptor_cache);
+}
+
+MaterialTemplate::MaterialTemplate(Shader *shader, ID3D12Device *device, const std::string &cb_name):
+    m_shader(shader),
+    m_material_id(s_next_material_id++),
+    m_cb_name(cb_name)
+{
+    ResolveLayout(device);
+}
+
+void MaterialTemplate::ResolveLayout(ID3D12Device *device)
+{
     // get cb reflection size
-    auto& cb_per_object_reflection = m_shader->GetCbReflection("cbPerObject");
-    m_cb_size = cb_per_object_reflection.GetSize();
+    auto& cb_reflection = m_shader->GetCbReflection(m_cb_name);
+    m_cb_size = cb_reflection.GetSize();
+
+    m_cb_handle = m_shader->GetParameterHandle(m_cb_name);
+    assert(m_cb_handle.IsValid());
+
+    m_default_data.assign(m_cb_size, 0);
+    m_staging_data.resize(m_cb_size);
+    m_defaults_version++;
 
-    // create cb
-    m_cb_per_object = std::make_unique<D3D12ConstantBuffer>(device, m_cb_size);
-    m_mapped_data.resize(m_cb_size);
+    // cb slots are sized to the cbuffer, a new size means a new pool
+    if(m_cb_pool == nullptr || m_cb_pool->GetSlotSize() != d3dUtil::CalcConstantBufferByteSize(m_cb_size))
+    {
+        for(ConstantBufferSlot& slot : m_cb_slots)
+        {
+            slot = ConstantBufferSlot();
+        }
+        m_cb_pool = std::make_unique<D3D12ConstantBufferPool>(device, m_cb_size);
+    }
 }
 
-void Material::UpdateCb()
+void MaterialTemplate::Refresh(ID3D12Device *device)
 {
-    m_cb_per_object->CopyData(m_mapped_data.data(), m_cb_size);
-    bool result = m_shader->SetParameter("cbPerObject", m_cb_per_object.get());
-    assert(result == true);
+    ResolveLayout(device);
+
+    // instance blocks are laid out by override, only the cbuffer offsets move
+    for(OverrideDesc& desc : m_overrides)
+    {
+        MaterialVariableHandle handle = ReflectVariable(desc.name);
+        assert(handle.size == desc.handle.size);
+        handle.override_index = desc.handle.override_index;
+        handle.override_offset = desc.handle.override_offset;
+        desc.handle = handle;
+    }
+    for(TextureDesc& desc : m_textures)
+    {
+        desc.handle = m_shader->GetParameterHandle(desc.name);
+        assert(desc.handle.kind == ShaderParamKind::k_srv);
+    }
+    for(const DefaultValue& default_value : m_default_values)
+    {
+        const MaterialVariableHandle handle = GetVariableHandle(default_value.name);
+        memcpy(m_default_data.data() + handle.offset, default_value.value.data(), default_value.value.size());
+    }
 }
 
-void Material::PassParametersToShader(ID3D12GraphicsCommandList *cmd_list, DescriptorCacheGPU *descriptor_cache)
+void MaterialTemplate::AddOverride(const std::string &name)
 {
-    UpdateCb();
-    m_shader->BindParameters(cmd_list, descriptor_cache);
+    assert(m_instance_capacity == 0);
+    assert(m_overrides.size() < k_max_overrides);
+
+    OverrideDesc desc;
+    desc.name = name;
+    desc.handle = ReflectVariable(name);
+    desc.handle.override_index = (int)m_overrides.size();
+    desc.handle.override_offset = m_override_stride;
+    m_overrides.push_back(desc);
+
+    // packed, but keep every variable 4 byte aligned
+    m_override_stride += (desc.handle.size + 3) & ~3u;
+}
+
+void MaterialTemplate::AddTexture(const std::string &name, ShaderResourceView *default_srv)
+{
+    assert(m_instance_capacity == 0);
+
+    TextureDesc desc;
+    desc.name = name;
+    desc.handle = m_shader->GetParameterHandle(name);
+    desc.default_srv = default_srv;
+    assert(desc.handle.kind == ShaderParamKind::k_srv);
+    m_textures.push_back(desc);
 }
 
-void Material::SetParameter(const std::string &name, DirectX::XMFLOAT4X4 data)
+MaterialVariableHandle MaterialTemplate::GetVariableHandle(const std::string &name) const
 {
-    auto& cb_per_object_reflection = m_shader->GetCbReflection("cbPerObject");
-    auto metadata = cb_per_object_reflection.GetVarMetaData(name);
-    assert(metadata.type == "float4x4");
-    memcpy(m_mapped_data.data() + metadata.offset,
-        &data,
-        sizeof(data));
+    for(const OverrideDesc& desc : m_overrides)
+    {
+        if(desc.name == name)
+        {
+            return desc.handle;
+        }
+    }
+    return ReflectVariable(name);
 }
 
-void Material::SetParameter(const std::string &name, ShaderResourceView *srv)
+MaterialVariableHandle MaterialTemplate::ReflectVariable(const std::string &name) const
 {
-    bool result = m_shader->SetParameter(name, srv);
+    auto& cb_reflection = m_shader->GetCbReflection(m_cb_name);
+    const auto& metadata = cb_reflection.GetVarMetaData(name);
+
+    MaterialVariableHandle handle;
+    handle.offset = metadata.offset;
+    handle.size = metadata.size;
+    handle.type = metadata.type;
+    handle.elements = metadata.elements;
+    handle.element_stride = metadata.element_stride;
+    assert(handle.offset + handle.size <= m_cb_size);
+    return handle;
+}
+
+void MaterialTemplate::SetDefaultData(const std::string &name, const void *data, unsigned int size)
+{
+    MaterialVariableHandle handle = GetVariableHandle(name);
+    assert(size <= handle.size);
+    memcpy(m_default_data.data() + handle.offset, data, size);
+    m_defaults_version++; // every instance uploads again, defaults change rarely
+
+    for(DefaultValue& default_value : m_default_values)
+    {
+        if(default_value.name == name)
+        {
+            default_value.value.assign((const char*)data, (const char*)data + size);
+            return;
+        }
+    }
+    m_default_values.push_back({ name, std::vector<char>((const char*)data, (const char*)data + size) });
+}
+
+void MaterialTemplate::SetDefaultTexture(const std::string &name, ShaderResourceView *srv)
+{
+    int texture_index = FindTexture(GetTextureHandle(name));
+    assert(texture_index >= 0);
+    m_textures[texture_index].default_srv = srv;
+}
+
+int MaterialTemplate::FindTexture(ShaderParamHandle handle) const
+{
+    for(int i=0; i<m_textures.size(); i++)
+    {
+        if(m_textures[i].handle.kind == handle.kind && m_textures[i].handle.index == handle.index)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+MaterialInstance *MaterialTemplate::CreateInstance()
+{
+    uint32_t index;
+    if(!m_free_instances.empty())
+    {
+        index = m_free_instances.back();
+        m_free_instances.pop_back();
+    }
+    else
+    {
+        // grow every pool by one chunk, instances are never moved
+        index = m_instance_capacity;
+        if(index % k_instance_chunk_size == 0)
+        {
+            size_t capacity = (size_t)m_instance_capacity + k_instance_chunk_size;
+            m_override_data.resize(capacity * m_override_stride);
+            m_override_masks.resize(capacity, 0);
+            m_texture_overrides.resize(capacity * m_textures.size(), nullptr);
+            m_cb_slots.resize(capacity);
+            m_dirty_ranges.resize(capacity);
+            m_uploaded_defaults_versions.resize(capacity, 0);
+            m_instance_chunks.push_back(std::unique_ptr<MaterialInstance[]>(new MaterialInstance[k_instance_chunk_size]));
+        }
+        m_instance_capacity++;
+    }
+
+    // start from the current defaults, so a partially written array override is still sensible
+    char* override_block = GetOverrideBlock(index);
+    for(const OverrideDesc& desc : m_overrides)
+    {
+        memcpy(override_block + desc.handle.override_offset, m_default_data.data() + desc.handle.offset, desc.handle.size);
+    }
+    m_override_masks[index] = 0;
+    m_dirty_ranges[index].Clear();
+    std::fill_n(GetTextureOverrides(index), m_textures.size(), nullptr);
+
+    MaterialInstance* instance = &m_instance_chunks[index / k_instance_chunk_size][index % k_instance_chunk_size];
+    instance->m_template = this;
+    instance->m_index = index;
+    m_instance_count++;
+    return instance;
+}
+
+void MaterialTemplate::DestroyInstance(MaterialInstance *instance)
+{
+    assert(instance->m_template == this);
+
+    uint32_t index = instance->m_index;
+    m_cb_pool->Free(m_cb_slots[index]);
+    m_free_instances.push_back(index);
+    m_instance_count--;
+
+    instance->m_template = nullptr;
+}
+
+void MaterialTemplate::AssembleRange(uint32_t index, uint32_t range_begin, uint32_t range_end)
+{
+    // defaults, then the overrides this instance set
+    memcpy(m_staging_data.data() + range_begin, m_default_data.data() + range_begin, range_end - range_begin);
+
+    const char* override_block = GetOverrideBlock(index);
+    uint64_t override_mask = m_override_masks[index];
+    for(const OverrideDesc& desc : m_overrides)
+    {
+        uint32_t override_begin = std::max(range_begin, desc.handle.offset);
+        uint32_t override_end = std::min(range_end, desc.handle.offset + desc.handle.size);
+        if((override_mask & (1ull << desc.handle.override_index)) && override_begin < override_end)
+        {
+            memcpy(m_staging_data.data() + override_begin,
+                override_block + desc.handle.override_offset + (override_begin - desc.handle.offset),
+                override_end - override_begin);
+        }
+    }
+}
+
+void MaterialTemplate::UploadConstants(uint32_t index)
+{
+    // every instance owns a slot, so instances drawn in the same frame do not overwrite each other
+    // the slot keeps its contents between frames, only what changed since the last write is copied
+    ConstantBufferSlot& slot = m_cb_slots[index];
+    MaterialDirtyRanges& dirty_ranges = m_dirty_ranges[index];
+    if(!slot.IsValid() || m_uploaded_defaults_versions[index] != m_defaults_version)
+    {
+        if(!slot.IsValid())
+        {
+            slot = m_cb_pool->Allocate();
+        }
+        dirty_ranges.Clear();
+        dirty_ranges.Add(0, m_cb_size);
+        m_uploaded_defaults_versions[index] = m_defaults_version;
+    }
+
+    if(dirty_ranges.IsEmpty())
+    {
+        s_upload_stats.skipped_uploads++;
+        return;
+    }
+
+    for(uint32_t i=0; i<dirty_ranges.count; i++)
+    {
+        uint32_t range_begin = dirty_ranges.begin[i];
+        uint32_t range_end = dirty_ranges.end[i];
+        AssembleRange(index, range_begin, range_end);
+        memcpy(slot.mapped_data + range_begin, m_staging_data.data() + range_begin, range_end - range_begin);
+        s_upload_stats.bytes_copied += range_end - range_begin;
+    }
+    dirty_ranges.Clear();
+    s_upload_stats.uploads++;
+}
+
+void MaterialTemplate::PassParametersToShader(uint32_t index, ID3D12GraphicsCommandList *cmd_list, DescriptorCacheGPU *descriptor_cache)
+{
+    // small cbuffers may be root constants, see RootSignatureOptimizer, then no upload buffer is needed
+    // and the shader skips constants that did not change
+    bool result;
+    if(m_shader->IsRootConstants(m_cb_handle))
+    {
+        AssembleRange(index, 0, m_cb_size);
+        result = m_shader->SetConstants(m_cb_handle, m_staging_data.data(), m_cb_size);
+    }
+    else
+    {
+        UploadConstants(index);
+        result = m_shader->SetParameter(m_cb_handle, m_cb_slots[index].gpu_address);
+    }
     assert(result == true);
+
+    ShaderResourceView* const* texture_overrides = GetTextureOverrides(index);
+    for(int i=0; i<m_textures.size(); i++)
+    {
+        ShaderResourceView* srv = texture_overrides[i] != nullptr ? texture_overrides[i] : m_textures[i].default_srv;
+        result = m_shader->SetParameter(m_textures[i].handle, srv);
+        assert(result == true);
+    }
+
+    m_shader->BindParameters(cmd_list, descriptor_cache);
 }
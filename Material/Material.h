@@ -10,37 +10,235 @@
 #include "Shader.h"
 #include "Texture\TextureManager.h"
 #include "D3DRHI\D3D12Buffer.h"
+#include "D3DRHI\D3D12ConstantBufferPool.h"
 
-class Material
+// reflected location of a material cbuffer variable, resolved once by MaterialTemplate::GetVariableHandle
+struct MaterialVariableHandle
+{
+    unsigned int offset = 0;
+    unsigned int size = 0;
+    CbVariableType type = CbVariableType::k_unknown;
+    unsigned int elements = 0;
+    unsigned int element_stride = 0;
+
+    int override_index = -1;            // per instance variables only, see MaterialTemplate::AddOverride
+    unsigned int override_offset = 0;   // in the instance's override block
+
+    bool IsValid() const { return size > 0; }
+    bool IsOverridable() const { return override_index >= 0; }
+};
+
+// byte ranges of a material cbuffer written since its last upload
+// a few ranges are kept apart, beyond that they collapse into one covering range
+struct MaterialDirtyRanges
+{
+    static const uint32_t k_max_ranges = 4;
+
+    uint32_t count = 0;
+    uint32_t begin[k_max_ranges];
+    uint32_t end[k_max_ranges];
+
+    bool IsEmpty() const { return count == 0; }
+    void Clear() { count = 0; }
+    void Add(uint32_t range_begin, uint32_t range_end);
+};
+
+// material constant uploads since the last reset, reset once per frame
+struct MaterialUploadStats
+{
+    uint64_t uploads = 0;           // instances whose cbuffer slot was written
+    uint64_t skipped_uploads = 0;   // instances still resident and unchanged
+    uint64_t bytes_copied = 0;
+};
+
+class MaterialTemplate;
+
+// lightweight per object material, the parameters live in its template's pools
+// created and destroyed by MaterialTemplate, never by new/delete
+class MaterialInstance
 {
 public:
-    Material() = default;
-    ~Material() = default;
+    MaterialInstance() = default;
+    ~MaterialInstance() = default;
 
-    void SetShader(Shader* shader);
-    void CreateCb(ID3D12Device* device);
+    MaterialInstance(const MaterialInstance&) = delete;
+    MaterialInstance& operator=(const MaterialInstance&) = delete;
 
-    D3D12ConstantBuffer* GetCbPerObject();
-    ID3D12RootSignature* GetRootSignature() {return m_shader->m_root_signature.Get();}
+    MaterialTemplate* GetTemplate() const { return m_template; }
+    uint32_t GetIndex() const { return m_index; }
+
+    // typed setters, the variable must have been declared with MaterialTemplate::AddOverride
+    template<typename T>
+    void SetParameter(MaterialVariableHandle handle, const T& value);
+    template<typename T>
+    void SetParameter(const std::string& name, const T& value);
+    // writes count elements starting at first_element, each element lands on its 16 byte aligned slot
+    template<typename T>
+    void SetParameterArray(MaterialVariableHandle handle, const T* values, unsigned int count, unsigned int first_element = 0);
+
+    // nullptr falls back to the template default
+    void SetParameter(ShaderParamHandle handle, ShaderResourceView* srv);
+    void SetParameter(const std::string& name, ShaderResourceView* srv);
+    bool HasTextureOverrides() const;
+    // same template, same overrides set to the same values and the same textures, e.g. to share an instanced draw
+    // ignored_overrides has a bit per MaterialVariableHandle::override_index left out of the comparison
+    bool HasSameOverrides(const MaterialInstance* other, uint64_t ignored_overrides = 0) const;
+    // takes the overrides and textures of another instance of the same template, only the values that differ are marked dirty
+    void CopyOverrides(const MaterialInstance* source);
 
-    void SetParameter(const std::string& name, DirectX::XMFLOAT4X4 data);
-    void SetParameter(const std::string& name, ShaderResourceView *srv);
     void PassParametersToShader(ID3D12GraphicsCommandList* cmd_list, DescriptorCacheGPU* descriptor_cache);
 
 private:
-    void UpdateCb();
+    friend class MaterialTemplate;
+
+    MaterialTemplate* m_template = nullptr;
+    uint32_t m_index = 0;
+};
+
+// shader, material cbuffer layout and default values shared by any number of MaterialInstance
+// per instance data is kept in contiguous pools indexed by MaterialInstance::GetIndex:
+//  - an override block with only the variables declared by AddOverride, packed
+//  - a bit mask of the overrides that were set
+//  - one srv per texture declared by AddTexture, nullptr meaning the default
+//  - a constant buffer slot, allocated on the first draw
+// overrides and textures are declared before the first instance is created
+class MaterialTemplate
+{
+public:
+    MaterialTemplate() = delete;
+    MaterialTemplate(Shader* shader, ID3D12Device* device, const std::string& cb_name = "cbPerObject");
+    ~MaterialTemplate() = default;
+
+    MaterialTemplate(const MaterialTemplate&) = delete;
+    MaterialTemplate& operator=(const MaterialTemplate&) = delete;
+
+    Shader* GetShader() const { return m_shader; }
+    uint16_t GetMaterialID() const { return m_material_id; } // unique per template, used in render queue sort keys
+
+    void AddOverride(const std::string& name);
+    void AddTexture(const std::string& name, ShaderResourceView* default_srv);
+
+    MaterialVariableHandle GetVariableHandle(const std::string& name) const;
+    ShaderParamHandle GetTextureHandle(const std::string& name) const { return m_shader->GetParameterHandle(name); }
+
+    template<typename T>
+    void SetDefault(const std::string& name, const T& value)
+    {
+        MaterialVariableHandle handle = GetVariableHandle(name);
+        assert(handle.type == CbVariableTypeOf<T>::value);
+        SetDefaultData(name, &value, sizeof(T));
+    }
+    void SetDefaultTexture(const std::string& name, ShaderResourceView* srv);
+
+    MaterialInstance* CreateInstance();
+    void DestroyInstance(MaterialInstance* instance);
+    uint32_t GetInstanceCount() const { return m_instance_count; }
+
+    // resolve the layout again after the shader was hot reloaded, instance overrides are kept
+    void Refresh(ID3D12Device* device);
+
+    static const MaterialUploadStats& GetUploadStats() { return s_upload_stats; }
+    static void ResetUploadStats() { s_upload_stats = MaterialUploadStats(); }
 
 private:
-    struct VariableAttribute
+    friend class MaterialInstance;
+
+    struct OverrideDesc
+    {
+        std::string name;
+        MaterialVariableHandle handle;
+    };
+
+    struct TextureDesc
     {
-        std::string type;
-        unsigned int offset;
-        unsigned int size;
+        std::string name;
+        ShaderParamHandle handle;
+        ShaderResourceView* default_srv = nullptr;
     };
-    
-    //std::unordered_map<std::string, VariableAttribute> m_material_vars;
-    std::unique_ptr<D3D12ConstantBuffer> m_cb_per_object = nullptr;
+
+    struct DefaultValue
+    {
+        std::string name;
+        std::vector<char> value;
+    };
+
+    static const uint32_t k_instance_chunk_size = 1024;   // instances are allocated in chunks so pointers stay valid
+    static const uint32_t k_max_overrides = 64;            // one bit each in the override mask
+
+    void ResolveLayout(ID3D12Device* device);
+    MaterialVariableHandle ReflectVariable(const std::string& name) const;
+    void SetDefaultData(const std::string& name, const void* data, unsigned int size);
+    char* GetOverrideBlock(uint32_t index) { return m_override_data.data() + (size_t)index * m_override_stride; }
+    ShaderResourceView** GetTextureOverrides(uint32_t index) { return m_texture_overrides.data() + (size_t)index * m_textures.size(); }
+    int FindTexture(ShaderParamHandle handle) const;
+    void MarkDirty(uint32_t index, uint32_t offset, uint32_t size) { m_dirty_ranges[index].Add(offset, offset + size); }
+    void AssembleRange(uint32_t index, uint32_t range_begin, uint32_t range_end);
+    void UploadConstants(uint32_t index);
+    void PassParametersToShader(uint32_t index, ID3D12GraphicsCommandList* cmd_list, DescriptorCacheGPU* descriptor_cache);
+
+private:
     Shader* m_shader = nullptr;
+    uint16_t m_material_id = 0;
+    std::string m_cb_name;
+    ShaderParamHandle m_cb_handle;
     unsigned int m_cb_size = 0;
-    std::vector<char> m_mapped_data; // data (size in bytes)
+
+    std::vector<char> m_default_data;          // whole cbuffer
+    uint32_t m_defaults_version = 0;           // increased when a default or the layout changes
+    std::vector<DefaultValue> m_default_values; // set by SetDefault, applied again on Refresh
+    std::vector<char> m_staging_data;          // cbuffer assembled for one draw
+
+    std::vector<OverrideDesc> m_overrides;
+    unsigned int m_override_stride = 0;
+    std::vector<TextureDesc> m_textures;
+
+    // per instance pools
+    std::vector<char> m_override_data;
+    std::vector<uint64_t> m_override_masks;
+    std::vector<ShaderResourceView*> m_texture_overrides;
+    std::vector<ConstantBufferSlot> m_cb_slots;
+    std::vector<MaterialDirtyRanges> m_dirty_ranges;    // in cbuffer bytes, since the slot was last written
+    std::vector<uint32_t> m_uploaded_defaults_versions; // m_defaults_version when the slot was last written
+    std::vector<uint32_t> m_free_instances;
+    std::vector<std::unique_ptr<MaterialInstance[]>> m_instance_chunks;
+    uint32_t m_instance_capacity = 0;
+    uint32_t m_instance_count = 0;
+
+    std::unique_ptr<D3D12ConstantBufferPool> m_cb_pool;
+
+    static MaterialUploadStats s_upload_stats;
+    static uint16_t s_next_material_id;
 };
+
+template<typename T>
+void MaterialInstance::SetParameter(MaterialVariableHandle handle, const T& value)
+{
+    assert(handle.type == CbVariableTypeOf<T>::value);
+    assert(handle.IsOverridable() && sizeof(T) <= handle.size);
+    memcpy(m_template->GetOverrideBlock(m_index) + handle.override_offset, &value, sizeof(T));
+    m_template->m_override_masks[m_index] |= 1ull << handle.override_index;
+    m_template->MarkDirty(m_index, handle.offset, sizeof(T));
+}
+
+template<typename T>
+void MaterialInstance::SetParameter(const std::string& name, const T& value)
+{
+    SetParameter(m_template->GetVariableHandle(name), value);
+}
+
+template<typename T>
+void MaterialInstance::SetParameterArray(MaterialVariableHandle handle, const T* values, unsigned int count, unsigned int first_element)
+{
+    assert(handle.type == CbVariableTypeOf<T>::value);
+    assert(handle.IsOverridable() && first_element + count <= handle.elements);
+    char* dest = m_template->GetOverrideBlock(m_index) + handle.override_offset + first_element * handle.element_stride;
+    for(unsigned int i=0; i<count; i++)
+    {
+        memcpy(dest + i * handle.element_stride, &values[i], sizeof(T));
+    }
+    m_template->m_override_masks[m_index] |= 1ull << handle.override_index;
+    if(count > 0)
+    {
+        m_template->MarkDirty(m_index, handle.offset + first_element * handle.element_stride, (count - 1) * handle.element_stride + sizeof(T));
+    }
+}
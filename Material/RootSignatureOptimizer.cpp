@@ -0,0 +1,212 @@
+#include "RootSignatureOptimizer.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+UINT RootParamSlot::GetDwordCost() const
+{
+	switch(type)
+	{
+	case RootParamType::k_constants:
+		return num_32bit_values;
+	case RootParamType::k_cbv:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+UINT RootSignatureLayout::GetDwordCost() const
+{
+	UINT cost = 0;
+	for(const RootParamSlot& param : params)
+	{
+		cost += param.GetDwordCost();
+	}
+	return cost;
+}
+
+static const char* GetVisibilityName(D3D12_SHADER_VISIBILITY visibility)
+{
+	switch(visibility)
+	{
+	case D3D12_SHADER_VISIBILITY_VERTEX:
+		return "VERTEX";
+	case D3D12_SHADER_VISIBILITY_PIXEL:
+		return "PIXEL";
+	default:
+		return "ALL";
+	}
+}
+
+static const char* GetFrequencyName(RootParamFrequency frequency)
+{
+	switch(frequency)
+	{
+	case RootParamFrequency::k_per_draw:
+		return "per draw";
+	case RootParamFrequency::k_per_material:
+		return "per material";
+	case RootParamFrequency::k_per_frame:
+		return "per frame";
+	default:
+		return "rarely";
+	}
+}
+
+std::string RootSignatureLayout::ToString(const RootSignatureInput& input) const
+{
+	std::string result;
+	char line[256];
+
+	snprintf(line, sizeof(line), "root signature: %u/%u DWORDs\n", GetDwordCost(), RootSignatureOptimizer::k_max_root_dwords);
+	result += line;
+
+	for(size_t i=0; i<params.size(); i++)
+	{
+		const RootParamSlot& param = params[i];
+		if(param.type == RootParamType::k_table)
+		{
+			const RootSignatureInput::Table& table = input.tables[param.source_index];
+			snprintf(line, sizeof(line), "  [%zu] table      %s x%u, %u DWORD, %s, %s\n",
+				i, table.range_type == D3D12_DESCRIPTOR_RANGE_TYPE_SRV ? "srv" : "uav", table.descriptor_count,
+				param.GetDwordCost(), GetVisibilityName(param.visibility), GetFrequencyName(param.frequency));
+		}
+		else
+		{
+			const RootSignatureInput::ConstantBuffer& cb = input.constant_buffers[param.source_index];
+			snprintf(line, sizeof(line), "  [%zu] %s %s b%u space%u, %u DWORDs, %s, %s\n",
+				i, param.type == RootParamType::k_constants ? "constants " : "cbv       ", cb.name.c_str(), cb.bind_point, cb.register_space,
+				param.GetDwordCost(), GetVisibilityName(param.visibility), GetFrequencyName(param.frequency));
+		}
+		result += line;
+	}
+
+	result += "  flags:";
+	if(flags & D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT) result += " ALLOW_IA";
+	if(flags & D3D12_ROOT_SIGNATURE_FLAG_DENY_VERTEX_SHADER_ROOT_ACCESS) result += " DENY_VS";
+	if(flags & D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS) result += " DENY_HS";
+	if(flags & D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS) result += " DENY_DS";
+	if(flags & D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS) result += " DENY_GS";
+	if(flags & D3D12_ROOT_SIGNATURE_FLAG_DENY_PIXEL_SHADER_ROOT_ACCESS) result += " DENY_PS";
+	result += "\n";
+
+	return result;
+}
+
+RootParamFrequency RootSignatureOptimizer::GetCbFrequency(const std::string& cb_name)
+{
+	if(cb_name == "cbPerObject" || cb_name == "cbPerDraw")
+	{
+		return RootParamFrequency::k_per_draw;
+	}
+	if(cb_name == "cbPerFrame" || cb_name == "cbPass")
+	{
+		return RootParamFrequency::k_per_frame;
+	}
+	if(cb_name == "cbRarely")
+	{
+		return RootParamFrequency::k_rarely;
+	}
+	return RootParamFrequency::k_per_material;
+}
+
+RootSignatureLayout RootSignatureOptimizer::Optimize(const RootSignatureInput& input)
+{
+	RootSignatureLayout layout;
+
+	// start from the cheapest form that always works: root descriptors and tables
+	for(int i=0; i<input.constant_buffers.size(); i++)
+	{
+		const RootSignatureInput::ConstantBuffer& cb = input.constant_buffers[i];
+
+		RootParamSlot param;
+		param.type = RootParamType::k_cbv;
+		param.frequency = GetCbFrequency(cb.name);
+		param.visibility = cb.visibility;
+		param.source_index = i;
+		param.num_32bit_values = 0;
+		layout.params.push_back(param);
+	}
+	for(int i=0; i<input.tables.size(); i++)
+	{
+		RootParamSlot param;
+		param.type = RootParamType::k_table;
+		param.frequency = RootParamFrequency::k_per_material;
+		param.visibility = input.tables[i].visibility;
+		param.source_index = i;
+		param.num_32bit_values = 0;
+		layout.params.push_back(param);
+	}
+	assert(layout.GetDwordCost() <= k_max_root_dwords);
+
+	// then spend the remaining budget on root constants, frequently updated and small cbuffers first,
+	// they skip the upload buffer and the descriptor indirection entirely
+	std::vector<RootParamSlot*> candidates;
+	for(RootParamSlot& param : layout.params)
+	{
+		UINT size = param.type == RootParamType::k_cbv ? input.constant_buffers[param.source_index].size : 0;
+		if(size > 0 && size % 4 == 0 && size / 4 <= k_max_root_constant_dwords)
+		{
+			candidates.push_back(&param);
+		}
+	}
+	std::stable_sort(candidates.begin(), candidates.end(), [&input](const RootParamSlot* a, const RootParamSlot* b)
+	{
+		if(a->frequency != b->frequency)
+		{
+			return a->frequency < b->frequency;
+		}
+		return input.constant_buffers[a->source_index].size < input.constant_buffers[b->source_index].size;
+	});
+
+	UINT cost = layout.GetDwordCost();
+	for(RootParamSlot* param : candidates)
+	{
+		UINT num_32bit_values = input.constant_buffers[param->source_index].size / 4;
+		UINT promoted_cost = cost - param->GetDwordCost() + num_32bit_values;
+		if(promoted_cost > k_max_root_dwords)
+		{
+			continue;
+		}
+
+		param->type = RootParamType::k_constants;
+		param->num_32bit_values = num_32bit_values;
+		cost = promoted_cost;
+	}
+
+	// drivers may keep the first parameters in hardware registers, so the most frequently changing go first
+	std::stable_sort(layout.params.begin(), layout.params.end(), [](const RootParamSlot& a, const RootParamSlot& b)
+	{
+		return a.frequency < b.frequency;
+	});
+
+	// deny every stage no parameter is visible to, compute ignores all of these
+	if(!input.b_compute)
+	{
+		bool b_vertex_access = false;
+		bool b_pixel_access = false;
+		for(const RootParamSlot& param : layout.params)
+		{
+			b_vertex_access |= param.visibility == D3D12_SHADER_VISIBILITY_VERTEX || param.visibility == D3D12_SHADER_VISIBILITY_ALL;
+			b_pixel_access |= param.visibility == D3D12_SHADER_VISIBILITY_PIXEL || param.visibility == D3D12_SHADER_VISIBILITY_ALL;
+		}
+
+		layout.flags = D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
+			| D3D12_ROOT_SIGNATURE_FLAG_DENY_HULL_SHADER_ROOT_ACCESS
+			| D3D12_ROOT_SIGNATURE_FLAG_DENY_DOMAIN_SHADER_ROOT_ACCESS
+			| D3D12_ROOT_SIGNATURE_FLAG_DENY_GEOMETRY_SHADER_ROOT_ACCESS;
+		if(!b_vertex_access)
+		{
+			layout.flags |= D3D12_ROOT_SIGNATURE_FLAG_DENY_VERTEX_SHADER_ROOT_ACCESS;
+		}
+		// static samplers live in the root signature too, keep pixel access for shaders sampling textures
+		if(!b_pixel_access && !input.b_samplers)
+		{
+			layout.flags |= D3D12_ROOT_SIGNATURE_FLAG_DENY_PIXEL_SHADER_ROOT_ACCESS;
+		}
+	}
+
+	assert(cost == layout.GetDwordCost() && cost <= k_max_root_dwords);
+	return layout;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <d3d12.h>
+#include <string>
+#include <vector>
+
+// picks the root signature layout of a shader from its reflection:
+// small cbuffers become root constants, other cbuffers root descriptors, srvs and uavs one table each,
+// everything inside the 64 DWORD budget with the tightest visibility and DENY_* flags
+
+enum class RootParamType : uint8_t
+{
+	k_constants,	// 1 DWORD per 32 bit value
+	k_cbv,			// root descriptor, 2 DWORDs
+	k_table,		// 1 DWORD
+};
+
+// parameters are ordered by this, the most frequently changing first
+enum class RootParamFrequency : uint8_t
+{
+	k_per_draw,
+	k_per_material,
+	k_per_frame,
+	k_rarely,
+};
+
+struct RootSignatureInput
+{
+	struct ConstantBuffer
+	{
+		std::string name;
+		UINT bind_point;
+		UINT register_space;
+		UINT size;		// reflected size in bytes
+		D3D12_SHADER_VISIBILITY visibility;
+	};
+
+	struct Table
+	{
+		D3D12_DESCRIPTOR_RANGE_TYPE range_type;
+		UINT descriptor_count;
+		D3D12_SHADER_VISIBILITY visibility;
+	};
+
+	bool b_compute = false;
+	bool b_samplers = false;	// the pixel shader uses the static samplers
+	std::vector<ConstantBuffer> constant_buffers;
+	std::vector<Table> tables;
+};
+
+struct RootParamSlot
+{
+	RootParamType type;
+	RootParamFrequency frequency;
+	D3D12_SHADER_VISIBILITY visibility;
+	int source_index;		// index into RootSignatureInput::constant_buffers or tables
+	UINT num_32bit_values;	// constants only
+
+	UINT GetDwordCost() const;
+};
+
+struct RootSignatureLayout
+{
+	std::vector<RootParamSlot> params;	// in root parameter order
+	D3D12_ROOT_SIGNATURE_FLAGS flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+
+	UINT GetDwordCost() const;
+	std::string ToString(const RootSignatureInput& input) const;
+};
+
+class RootSignatureOptimizer
+{
+public:
+	RootSignatureOptimizer() = delete;
+
+	static const UINT k_max_root_dwords = 64;
+	static const UINT k_max_root_constant_dwords = 16;	// per cbuffer, a float4x4
+
+	static RootSignatureLayout Optimize(const RootSignatureInput& input);
+
+	// from the cbuffer naming convention of the shaders, cbPerObject, cbPerFrame, cbRarely ...
+	static RootParamFrequency GetCbFrequency(const std::string& cb_name);
+};
@@ -1,5 +1,11 @@
 #include "Shader.h"
+#include "ShaderCache.h"
 #include "Utility/FormatConvert.h"
+#include <cstring>
+
+const Shader* Shader::s_bound_graphics_shader = nullptr;
+const Shader* Shader::s_bound_compute_shader = nullptr;
+ShaderBindingStats Shader::s_binding_stats;
 
 void ShaderDefines::GetD3DShaderMacro(std::vector<D3D_SHADER_MACRO> &out_macro) const
 {
@@ -45,16 +51,22 @@ void ShaderDefines::SetDefine(const std::string &name, const std::string &defini
     m_defines_map.insert_or_assign(name, definition);
 }
 
+UINT Shader::GetCompileFlags()
+{
+	UINT compileFlags = 0;
+#if defined(DEBUG) || defined(_DEBUG)  
+	compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+	return compileFlags;
+}
+
 ComPtr<ID3DBlob> Shader::CompileShader(
 	const std::wstring& filename,
 	const D3D_SHADER_MACRO* defines,
 	const std::string& entrypoint,
 	const std::string& target)
 {
-	UINT compileFlags = 0;
-#if defined(DEBUG) || defined(_DEBUG)  
-	compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
-#endif
+	UINT compileFlags = GetCompileFlags();
 
 	HRESULT hr = S_OK;
 
@@ -78,111 +90,449 @@ Shader::Shader(const ShaderInfo &shader_info, ID3D12Device* device):
     assert((shader_info.b_create_VS | shader_info.b_create_PS) ^ shader_info.b_create_CS);
 }
 
-bool Shader::SetParameter(std::string param_name, D3D12ConstantBuffer *constant_buffer)
+Shader::Shader(const ShaderInfo &shader_info):
+    m_shader_info(shader_info)
+{
+}
+
+ShaderParamHandle Shader::GetParameterHandle(const std::string& param_name) const
 {
-    bool ret = false;
+    // parameters are unique by name (merged across stages in LoadShaderParameters)
+    ShaderParamHandle handle;
 
-    for(ShaderCBVParameter& param : m_cbv_params)
+    for(int i=0; i<m_cbv_params.size(); i++)
+    {
+        if(m_cbv_params[i].name == param_name)
+        {
+            handle.kind = ShaderParamKind::k_cbv;
+            handle.index = (uint16_t)i;
+            return handle;
+        }
+    }
+    for(int i=0; i<m_srv_params.size(); i++)
     {
-        if(param.name == param_name)
+        if(m_srv_params[i].name == param_name)
         {
-            param.constant_buffer = constant_buffer;
-            ret = true;
+            handle.kind = ShaderParamKind::k_srv;
+            handle.index = (uint16_t)i;
+            return handle;
+        }
+    }
+    for(int i=0; i<m_uav_params.size(); i++)
+    {
+        if(m_uav_params[i].name == param_name)
+        {
+            handle.kind = ShaderParamKind::k_uav;
+            handle.index = (uint16_t)i;
+            return handle;
         }
     }
 
-    return ret;
+    return handle;
 }
 
-bool Shader::SetParameter(std::string param_name, ShaderResourceView *srv)
+bool Shader::SetParameter(const std::string& param_name, D3D12ConstantBuffer *constant_buffer)
 {
-    std::vector<ShaderResourceView*> srv_list{srv};
-    return SetParameter(param_name, srv_list);
+    return SetParameter(GetParameterHandle(param_name), constant_buffer);
 }
 
-bool Shader::SetParameter(std::string param_name, const std::vector<ShaderResourceView *> &srv_list)
+bool Shader::SetParameter(const std::string& param_name, ShaderResourceView *srv)
 {
-    bool ret = false;
+    return SetParameter(GetParameterHandle(param_name), srv);
+}
 
-    for(ShaderSRVParameter& param : m_srv_params)
+bool Shader::SetParameter(const std::string& param_name, const std::vector<ShaderResourceView *> &srv_list)
+{
+    return SetParameter(GetParameterHandle(param_name), srv_list);
+}
+
+bool Shader::SetParameter(const std::string& param_name, UnorderedAccessView *uav)
+{
+    return SetParameter(GetParameterHandle(param_name), uav);
+}
+
+bool Shader::SetParameter(const std::string& param_name, const std::vector<UnorderedAccessView*>& uav_list)
+{
+    return SetParameter(GetParameterHandle(param_name), uav_list);
+}
+
+bool Shader::SetParameter(ShaderParamHandle handle, D3D12ConstantBuffer *constant_buffer)
+{
+    return SetParameter(handle, constant_buffer->GetResource()->GetGPUVirtualAddress());
+}
+
+bool Shader::SetParameter(ShaderParamHandle handle, D3D12_GPU_VIRTUAL_ADDRESS constant_buffer_address)
+{
+    if(handle.kind != ShaderParamKind::k_cbv)
     {
-        if(param.name == param_name)
-        {
-            assert(param.bind_count == srv_list.size());
-            param.srv_list = srv_list;
-            ret = true;
-        }
+        return false;
     }
 
-    return ret;
+    ShaderCBVParameter& param = m_cbv_params[handle.index];
+    if(param.num_32bit_values > 0)
+    {
+        // root constants, see SetConstants
+        return false;
+    }
+
+    if(param.constant_buffer_address != constant_buffer_address)
+    {
+        param.constant_buffer_address = constant_buffer_address;
+        MarkRootParamDirty(param.root_param_index);
+    }
+    return true;
 }
 
-bool Shader::SetParameter(std::string param_name, UnorderedAccessView *uav)
+bool Shader::IsRootConstants(ShaderParamHandle handle) const
 {
-    std::vector<UnorderedAccessView*> uav_list{uav};
-    return SetParameter(param_name, uav_list);
+    return handle.kind == ShaderParamKind::k_cbv && m_cbv_params[handle.index].num_32bit_values > 0;
 }
 
-bool Shader::SetParameter(std::string param_name, const std::vector<UnorderedAccessView*>& uav_list)
+bool Shader::SetConstants(ShaderParamHandle handle, const void* data, UINT size)
 {
-    bool ret = false;
+    if(!IsRootConstants(handle))
+    {
+        return false;
+    }
 
-    for(ShaderUAVParameter& param : m_uav_params)
+    ShaderCBVParameter& param = m_cbv_params[handle.index];
+    assert(size == param.num_32bit_values * 4);
+    if(param.root_constants.size() != param.num_32bit_values || memcmp(param.root_constants.data(), data, size) != 0)
     {
-        if(param.name == param_name)
-        {
-            assert(uav_list.size() == param.bind_count);
-            param.uav_list = uav_list;
-            ret = true;
-        }
+        param.root_constants.resize(param.num_32bit_values);
+        memcpy(param.root_constants.data(), data, size);
+        MarkRootParamDirty(param.root_param_index);
     }
+    return true;
+}
 
-    return ret;
+bool Shader::SetParameter(ShaderParamHandle handle, ShaderResourceView *srv)
+{
+    if(handle.kind != ShaderParamKind::k_srv)
+    {
+        return false;
+    }
+
+    // write in place, a single srv does not need a temporary list
+    ShaderSRVParameter& param = m_srv_params[handle.index];
+    assert(param.bind_count == 1);
+    if(param.srv_list.size() != 1 || param.srv_list[0] != srv)
+    {
+        param.srv_list.resize(1);
+        param.srv_list[0] = srv;
+        MarkRootParamDirty(m_srv_signature_bind_slot);
+    }
+    return true;
+}
+
+bool Shader::SetParameter(ShaderParamHandle handle, const std::vector<ShaderResourceView *> &srv_list)
+{
+    if(handle.kind != ShaderParamKind::k_srv)
+    {
+        return false;
+    }
+
+    ShaderSRVParameter& param = m_srv_params[handle.index];
+    assert(param.bind_count == srv_list.size());
+    if(param.srv_list != srv_list)
+    {
+        param.srv_list = srv_list;
+        MarkRootParamDirty(m_srv_signature_bind_slot);
+    }
+    return true;
+}
+
+bool Shader::SetParameter(ShaderParamHandle handle, UnorderedAccessView *uav)
+{
+    if(handle.kind != ShaderParamKind::k_uav)
+    {
+        return false;
+    }
+
+    ShaderUAVParameter& param = m_uav_params[handle.index];
+    assert(param.bind_count == 1);
+    if(param.uav_list.size() != 1 || param.uav_list[0] != uav)
+    {
+        param.uav_list.resize(1);
+        param.uav_list[0] = uav;
+        MarkRootParamDirty(m_uav_signature_bind_slot);
+    }
+    return true;
+}
+
+bool Shader::SetParameter(ShaderParamHandle handle, const std::vector<UnorderedAccessView*>& uav_list)
+{
+    if(handle.kind != ShaderParamKind::k_uav)
+    {
+        return false;
+    }
+
+    ShaderUAVParameter& param = m_uav_params[handle.index];
+    assert(uav_list.size() == param.bind_count);
+    if(param.uav_list != uav_list)
+    {
+        param.uav_list = uav_list;
+        MarkRootParamDirty(m_uav_signature_bind_slot);
+    }
+    return true;
 }
 
 void Shader::Initialize(ID3D12Device* device)
 {
-    std::wstring file_path = FormatConvert::StrToWStr(m_shader_info.file_name);
+    CompileJobs compile_jobs = DispatchCompileJobs(ThreadPool::GetDefault());
+    FinishInitialize(compile_jobs, device);
+}
 
-    std::vector<D3D_SHADER_MACRO> shader_macros;
-    m_shader_info.shader_defines.GetD3DShaderMacro(shader_macros);
+std::vector<std::unique_ptr<Shader>> Shader::CreateShaders(const std::vector<ShaderInfo>& shader_infos, ID3D12Device* device)
+{
+    std::vector<std::unique_ptr<Shader>> shaders;
+    std::vector<CompileJobs> all_compile_jobs;
+    shaders.reserve(shader_infos.size());
+    all_compile_jobs.reserve(shader_infos.size());
 
-    // Compile Shader
-    if(m_shader_info.b_create_VS)
+    // dispatch stage x permutation jobs up front, so the pool sees all of them at once
+    for(const ShaderInfo& info : shader_infos)
     {
-        auto VS_blob = CompileShader(file_path, shader_macros.data(), m_shader_info.VS_entry_point, "vs_5_0");
-        m_shader_stage["VS"] = VS_blob;
+        assert((info.b_create_VS | info.b_create_PS) ^ info.b_create_CS);
+        shaders.push_back(std::unique_ptr<Shader>(new Shader(info)));
+        all_compile_jobs.push_back(shaders.back()->DispatchCompileJobs(ThreadPool::GetDefault()));
+    }
 
-        GetShaderParameters(VS_blob, ShaderType::k_vertex_shader);
+    // join in input order, reflection and root signatures do not depend on which job finished first
+    for(int i=0; i<shaders.size(); i++)
+    {
+        shaders[i]->FinishInitialize(all_compile_jobs[i], device);
     }
 
+    return shaders;
+}
+
+std::vector<ShaderStageDesc> Shader::GetStageDescs() const
+{
+    // fixed stage order, parameters are always reflected VS -> PS -> CS
+    std::vector<ShaderStageDesc> stages;
+    if(m_shader_info.b_create_VS)
+    {
+        stages.push_back({ "VS", ShaderType::k_vertex_shader, m_shader_info.VS_entry_point, "vs_5_0" });
+    }
     if(m_shader_info.b_create_PS)
     {
-        auto PS_blob = CompileShader(file_path, shader_macros.data(), m_shader_info.PS_entry_point, "ps_5_0");
-        m_shader_stage["PS"] = PS_blob;
+        stages.push_back({ "PS", ShaderType::k_pixel_shader, m_shader_info.PS_entry_point, "ps_5_0" });
+    }
+    if(m_shader_info.b_create_CS)
+    {
+        stages.push_back({ "CS", ShaderType::k_compute_shader, m_shader_info.CS_entry_point, "cs_5_0" });
+    }
+    return stages;
+}
+
+Shader::CompileJobs Shader::DispatchCompileJobs(ThreadPool& pool) const
+{
+    const std::string& file_name = m_shader_info.file_name;
+    const ShaderDefines& shader_defines = m_shader_info.shader_defines;
+
+    CompileJobs compile_jobs;
+    for(const ShaderStageDesc& stage : GetStageDescs())
+    {
+        // everything is captured by value, the job may outlive this call
+        auto compiled_stage = pool.Submit([file_name, shader_defines, stage]()
+        {
+            // bytecode and reflection come from the cache when nothing that feeds the compile changed
+            uint64_t cache_key = ShaderCache::ComputeKey(file_name, shader_defines, stage.entry_point, stage.target, GetCompileFlags());
+            CompiledShaderStage compiled;
+            if(ShaderCache::Load(cache_key, compiled))
+            {
+                return compiled;
+            }
 
-        GetShaderParameters(PS_blob, ShaderType::k_pixel_shader);
+            std::vector<D3D_SHADER_MACRO> shader_macros;
+            shader_defines.GetD3DShaderMacro(shader_macros);
+            compiled.bytecode = CompileShader(FormatConvert::StrToWStr(file_name), shader_macros.data(), stage.entry_point, stage.target);
+            compiled.reflection_data = ReflectStage(compiled.bytecode.Get());
+
+            ShaderCache::Store(cache_key, compiled);
+            return compiled;
+        });
+        compile_jobs.emplace_back(stage, std::move(compiled_stage));
     }
 
-    if(m_shader_info.b_create_CS)
+    return compile_jobs;
+}
+
+void Shader::FinishInitialize(CompileJobs& compile_jobs, ID3D12Device* device)
+{
+    // wait for every stage before reflecting, get() rethrows a failed compile on this thread
+    for(auto& job : compile_jobs)
     {
-        auto CS_blob = CompileShader(file_path, shader_macros.data(), m_shader_info.CS_entry_point, "cs_5_0");
-        m_shader_stage["CS"] = CS_blob;
+        CompiledShaderStage compiled = job.second.get();
+        m_shader_stage.Insert(NameID::Register(job.first.stage_name), compiled.bytecode);
 
-        GetShaderParameters(CS_blob, ShaderType::k_compute_shader);
+        ShaderReflectionBlobView reflection;
+        bool result = reflection.Parse(compiled.GetReflectionData(), compiled.GetReflectionSize());
+        assert(result == true);
+        LoadShaderParameters(reflection, job.first.shader_type);
     }
 
     CreateRootSignature(device);
 }
 
-void Shader::GetShaderParameters(ComPtr<ID3DBlob> blob, ShaderType shader_type)
+std::unique_ptr<Shader> Shader::CompileReload(CompileJobs& compile_jobs, ID3D12Device* device) const
+{
+    // build into a scratch shader, a failed compile throws and leaves this one untouched
+    std::unique_ptr<Shader> reloaded(new Shader(m_shader_info));
+    reloaded->FinishInitialize(compile_jobs, device);
+    return reloaded;
+}
+
+void Shader::ApplyReload(Shader& reloaded)
+{
+    // carry the current bindings over, matched by name
+    for(ShaderCBVParameter& param : reloaded.m_cbv_params)
+    {
+        for(const ShaderCBVParameter& old_param : m_cbv_params)
+        {
+            if(old_param.name == param.name)
+            {
+                param.constant_buffer_address = old_param.constant_buffer_address;
+                if(old_param.num_32bit_values == param.num_32bit_values)
+                {
+                    param.root_constants = old_param.root_constants;
+                }
+            }
+        }
+    }
+    for(ShaderSRVParameter& param : reloaded.m_srv_params)
+    {
+        for(const ShaderSRVParameter& old_param : m_srv_params)
+        {
+            if(old_param.name == param.name && old_param.bind_count == param.bind_count)
+            {
+                param.srv_list = old_param.srv_list;
+            }
+        }
+    }
+    for(ShaderUAVParameter& param : reloaded.m_uav_params)
+    {
+        for(const ShaderUAVParameter& old_param : m_uav_params)
+        {
+            if(old_param.name == param.name && old_param.bind_count == param.bind_count)
+            {
+                param.uav_list = old_param.uav_list;
+            }
+        }
+    }
+
+    // swap bytecode, reflection and root signature in one go
+    std::swap(m_shader_stage, reloaded.m_shader_stage);
+    std::swap(m_root_signature, reloaded.m_root_signature);
+    std::swap(m_cbv_params, reloaded.m_cbv_params);
+    std::swap(m_srv_params, reloaded.m_srv_params);
+    std::swap(m_uav_params, reloaded.m_uav_params);
+    std::swap(m_sampler_params, reloaded.m_sampler_params);
+    std::swap(m_srv_signature_bind_slot, reloaded.m_srv_signature_bind_slot);
+    std::swap(m_srv_count, reloaded.m_srv_count);
+    std::swap(m_uav_signature_bind_slot, reloaded.m_uav_signature_bind_slot);
+    std::swap(m_uav_count, reloaded.m_uav_count);
+    std::swap(m_sampler_signature_bind_slot, reloaded.m_sampler_signature_bind_slot);
+    std::swap(m_root_signature_layout, reloaded.m_root_signature_layout);
+    std::swap(m_cb_reflection_maps, reloaded.m_cb_reflection_maps);
+    m_version++;
+
+    // the root signature changed, nothing bound so far is valid
+    InvalidateBindingState();
+}
+
+static CbVariableType GetCbVariableType(const D3D12_SHADER_TYPE_DESC& type_desc)
 {
-    ID3D12ShaderReflection* reflection = nullptr;
-	D3DReflect(blob->GetBufferPointer(), blob->GetBufferSize(), IID_ID3D12ShaderReflection, (void**)&reflection);
+    if(type_desc.Class == D3D_SVC_SCALAR)
+    {
+        switch(type_desc.Type)
+        {
+        case D3D_SVT_FLOAT: return CbVariableType::k_float;
+        case D3D_SVT_INT: return CbVariableType::k_int;
+        case D3D_SVT_UINT: return CbVariableType::k_uint;
+        default: return CbVariableType::k_unknown;
+        }
+    }
+
+    if(type_desc.Type != D3D_SVT_FLOAT)
+    {
+        return CbVariableType::k_unknown;
+    }
+
+    if(type_desc.Class == D3D_SVC_VECTOR)
+    {
+        switch(type_desc.Columns)
+        {
+        case 2: return CbVariableType::k_float2;
+        case 3: return CbVariableType::k_float3;
+        case 4: return CbVariableType::k_float4;
+        default: return CbVariableType::k_unknown;
+        }
+    }
+
+    // count the 16 byte registers the matrix occupies, the cpu side passes it already in register order
+    UINT registers = 0;
+    if(type_desc.Class == D3D_SVC_MATRIX_ROWS && type_desc.Columns == 4)
+    {
+        registers = type_desc.Rows;
+    }
+    else if(type_desc.Class == D3D_SVC_MATRIX_COLUMNS && type_desc.Rows == 4)
+    {
+        registers = type_desc.Columns;
+    }
+
+    if(registers == 3)
+    {
+        return CbVariableType::k_float3x4;
+    }
+    if(registers == 4)
+    {
+        return CbVariableType::k_float4x4;
+    }
+    return CbVariableType::k_unknown;
+}
+
+static unsigned int GetCbVariableTypeSize(CbVariableType type)
+{
+    switch(type)
+    {
+    case CbVariableType::k_float:
+    case CbVariableType::k_int:
+    case CbVariableType::k_uint: return 4;
+    case CbVariableType::k_float2: return 8;
+    case CbVariableType::k_float3: return 12;
+    case CbVariableType::k_float4: return 16;
+    case CbVariableType::k_float3x4: return 48;
+    case CbVariableType::k_float4x4: return 64;
+    default: return 0;
+    }
+}
+
+// add shader_type to an already reflected parameter of the same name, returns false if there is none
+template<typename T>
+static bool MergeStage(std::vector<T>& params, const char* name, ShaderType shader_type)
+{
+    for(T& param : params)
+    {
+        if(param.name == name)
+        {
+            param.stage_mask |= GetShaderStageBit(shader_type);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<char> Shader::ReflectStage(ID3DBlob* blob)
+{
+    ComPtr<ID3D12ShaderReflection> reflection;
+	ThrowIfFailed(D3DReflect(blob->GetBufferPointer(), blob->GetBufferSize(), IID_PPV_ARGS(&reflection)));
 
 	D3D12_SHADER_DESC shader_desc;
 	reflection->GetDesc(&shader_desc);
 
+	ShaderReflectionBlobWriter writer;
 	for(int i=0; i<shader_desc.BoundResources; i++)
 	{
 		D3D12_SHADER_INPUT_BIND_DESC resource_desc;
@@ -196,20 +546,13 @@ void Shader::GetShaderParameters(ComPtr<ID3DBlob> blob, ShaderType shader_type)
 
         if (resource_type == D3D_SHADER_INPUT_TYPE::D3D_SIT_CBUFFER)
 		{
-            // create cbv parameter
-			ShaderCBVParameter param;
-			param.name = shader_var_name;
-			param.shader_type = shader_type;
-			param.bind_point = bind_point;
-			param.register_space = register_space;
-			m_cbv_params.push_back(param);
-
             // store constant buffer structure
             auto cb = reflection->GetConstantBufferByName(shader_var_name);
             D3D12_SHADER_BUFFER_DESC cb_desc;
             cb->GetDesc(&cb_desc);
+            writer.AddCbParam(shader_var_name, bind_point, register_space, cb_desc.Size);
+
             auto num_vars = cb_desc.Variables;
-            CbReflection cb_reflection;
             for(int j=0; j<num_vars; j++)
             {
                 auto var = cb->GetVariableByIndex(j);
@@ -218,50 +561,119 @@ void Shader::GetShaderParameters(ComPtr<ID3DBlob> blob, ShaderType shader_type)
                 var->GetDesc(&var_desc);
                 var->GetType()->GetDesc(&var_type_desc);
 
-                CbVariableMetaData var_meta_data;
-                var_meta_data.offset = var_desc.StartOffset;
-                var_meta_data.size = var_desc.Size;
-                var_meta_data.type = var_type_desc.Name;
+                CbVariableType type = GetCbVariableType(var_type_desc);
+                unsigned int element_stride = var_type_desc.Elements > 1 ?
+                    (var_desc.Size - GetCbVariableTypeSize(type)) / (var_type_desc.Elements - 1) : var_desc.Size;
 
-                cb_reflection.SetVarMetaData(var_desc.Name, var_meta_data);
+                writer.AddCbVariable(var_desc.Name, var_desc.StartOffset, var_desc.Size, (uint32_t)type, var_type_desc.Elements, element_stride);
             }
-            m_cb_reflection_maps[param.name] = std::move(cb_reflection);
 		}
 		else if (resource_type == D3D_SHADER_INPUT_TYPE::D3D_SIT_STRUCTURED
 			  || resource_type == D3D_SHADER_INPUT_TYPE::D3D_SIT_TEXTURE)
 		{
+			writer.AddParam(ReflectedParamKind::k_srv, shader_var_name, bind_point, bind_count, register_space);
+		}
+		else if (resource_type == D3D_SHADER_INPUT_TYPE::D3D_SIT_UAV_RWSTRUCTURED
+			  || resource_type == D3D_SHADER_INPUT_TYPE::D3D_SIT_UAV_RWTYPED)
+		{
+			writer.AddParam(ReflectedParamKind::k_uav, shader_var_name, bind_point, bind_count, register_space);
+		}
+		else if (resource_type == D3D_SHADER_INPUT_TYPE::D3D_SIT_SAMPLER)
+		{
+			writer.AddParam(ReflectedParamKind::k_sampler, shader_var_name, bind_point, bind_count, register_space);
+		}
+        else
+        {
+            assert(false);
+        }
+	}
+
+	return writer.Finish();
+}
+
+void Shader::LoadShaderParameters(const ShaderReflectionBlobView& reflection, ShaderType shader_type)
+{
+	for(uint32_t i=0; i<reflection.GetParamCount(); i++)
+	{
+		const ReflectedParam& reflected_param = reflection.GetParam(i);
+		const char* shader_var_name = reflection.GetString(reflected_param.name);
+
+        if (reflected_param.kind == ReflectedParamKind::k_cbv)
+		{
+            // a cbuffer shared by several stages is one parameter visible to all of them
+            if(MergeStage(m_cbv_params, shader_var_name, shader_type))
+            {
+                continue;
+            }
+
+            // create cbv parameter
+			ShaderCBVParameter param;
+			param.name = shader_var_name;
+			param.shader_type = shader_type;
+			param.stage_mask = GetShaderStageBit(shader_type);
+			param.bind_point = reflected_param.bind_point;
+			param.register_space = reflected_param.register_space;
+			m_cbv_params.push_back(param);
+
+            // store constant buffer structure
+            CbReflection& cb_reflection = m_cb_reflection_maps.FindOrAdd(NameID::Register(param.name));
+            cb_reflection.SetSize(reflected_param.cb_size);
+            cb_reflection.Reserve(reflected_param.variable_count);
+            for(uint32_t j=0; j<reflected_param.variable_count; j++)
+            {
+                const ReflectedCbVariable& variable = reflection.GetVariable(reflected_param.first_variable + j);
+
+                CbVariableMetaData var_meta_data;
+                var_meta_data.offset = variable.offset;
+                var_meta_data.size = variable.size;
+                var_meta_data.type = (CbVariableType)variable.type;
+                var_meta_data.elements = variable.elements;
+                var_meta_data.element_stride = variable.element_stride;
+
+                cb_reflection.SetVarMetaData(NameID::Register(reflection.GetString(variable.name)), var_meta_data);
+            }
+		}
+		else if (reflected_param.kind == ReflectedParamKind::k_srv)
+		{
+			if(MergeStage(m_srv_params, shader_var_name, shader_type))
+			{
+				continue;
+			}
+
 			ShaderSRVParameter param;
 			param.name = shader_var_name;
 			param.shader_type = shader_type;
-			param.bind_point = bind_point;
-			param.bind_count = bind_count;
-			param.register_space = register_space;
+			param.stage_mask = GetShaderStageBit(shader_type);
+			param.bind_point = reflected_param.bind_point;
+			param.bind_count = reflected_param.bind_count;
+			param.register_space = reflected_param.register_space;
 
 			m_srv_params.push_back(param);
 		}
-		else if (resource_type == D3D_SHADER_INPUT_TYPE::D3D_SIT_UAV_RWSTRUCTURED
-			  || resource_type == D3D_SHADER_INPUT_TYPE::D3D_SIT_UAV_RWTYPED)
+		else if (reflected_param.kind == ReflectedParamKind::k_uav)
 		{
 			assert(shader_type == ShaderType::k_compute_shader);
 
 			ShaderUAVParameter param;
 			param.name = shader_var_name;
 			param.shader_type = shader_type;
-			param.bind_point = bind_point;
-			param.bind_count = bind_count;
-			param.register_space = register_space;
+			param.stage_mask = GetShaderStageBit(shader_type);
+			param.bind_point = reflected_param.bind_point;
+			param.bind_count = reflected_param.bind_count;
+			param.register_space = reflected_param.register_space;
 
 			m_uav_params.push_back(param);
 		}
-		else if (resource_type == D3D_SHADER_INPUT_TYPE::D3D_SIT_SAMPLER)
+		else if (reflected_param.kind == ReflectedParamKind::k_sampler)
 		{
 			assert(shader_type == ShaderType::k_pixel_shader);
 
 			ShaderSamplerParameter param;
 			param.name = shader_var_name;
 			param.shader_type = shader_type;
-			param.bind_point = bind_point;
-			param.register_space = register_space;
+			param.stage_mask = GetShaderStageBit(shader_type);
+			param.bind_point = reflected_param.bind_point;
+			param.register_space = reflected_param.register_space;
 
 			m_sampler_params.push_back(param);
 		}
@@ -272,24 +684,22 @@ void Shader::GetShaderParameters(ComPtr<ID3DBlob> blob, ShaderType shader_type)
 	}
 }
 
-D3D12_SHADER_VISIBILITY Shader::GetShaderVisibility(ShaderType shader_type)
+D3D12_SHADER_VISIBILITY Shader::GetShaderVisibility(UINT stage_mask)
 {
     D3D12_SHADER_VISIBILITY visibility;
-	if (shader_type == ShaderType::k_vertex_shader)
+	if (stage_mask == GetShaderStageBit(ShaderType::k_vertex_shader))
 	{
 		visibility = D3D12_SHADER_VISIBILITY_VERTEX;
 	}
-	else if (shader_type == ShaderType::k_pixel_shader)
+	else if (stage_mask == GetShaderStageBit(ShaderType::k_pixel_shader))
 	{
 		visibility = D3D12_SHADER_VISIBILITY_PIXEL;
 	}
-	else if(shader_type == ShaderType::k_compute_shader)
-	{
-		visibility = D3D12_SHADER_VISIBILITY_ALL;
-	}
 	else
 	{
-		assert(false);
+		// compute shader, or a parameter shared by several graphics stages
+		assert(stage_mask != 0);
+		visibility = D3D12_SHADER_VISIBILITY_ALL;
 	}
 
 	return visibility;
@@ -354,59 +764,97 @@ std::vector<CD3DX12_STATIC_SAMPLER_DESC> Shader::CreateStaticSamplers()
     };
 }
 
-void Shader::CreateRootSignature(ID3D12Device* device)
+RootSignatureInput Shader::GetRootSignatureInput()
 {
-    //------------------------ set root parameters -------------------------
-    std::vector<CD3DX12_ROOT_PARAMETER> root_params;
+    RootSignatureInput input;
+    input.b_compute = m_shader_info.b_create_CS;
+    input.b_samplers = !m_sampler_params.empty();
 
-    // CBV: create root descriptor
     for(const ShaderCBVParameter& param : m_cbv_params)
     {
-        if(m_cbv_signature_base_bind_slot == -1)
-        {
-            m_cbv_signature_base_bind_slot = root_params.size();
-        }
-
-        CD3DX12_ROOT_PARAMETER root_param;
-        root_param.InitAsConstantBufferView(param.bind_point, param.register_space, GetShaderVisibility(param.shader_type));
-        root_params.push_back(root_param);
+        RootSignatureInput::ConstantBuffer cb;
+        cb.name = param.name;
+        cb.bind_point = param.bind_point;
+        cb.register_space = param.register_space;
+        cb.size = GetCbReflection(param.name).GetSize();
+        cb.visibility = GetShaderVisibility(param.stage_mask);
+        input.constant_buffers.push_back(cb);
     }
 
-    // SRV: create root descriptor table
+    // one table per descriptor type, visible to the union of the stages using it
+    m_srv_count = 0;
+    UINT srv_stage_mask = 0;
     for(const ShaderSRVParameter& param : m_srv_params)
     {
-        m_srv_count += param.bind_count; 
+        m_srv_count += param.bind_count;
+        srv_stage_mask |= param.stage_mask;
     }
-    CD3DX12_DESCRIPTOR_RANGE srv_table; // do not set this var inside the if{} below, because it must be addressed when creating root signature
     if(m_srv_count > 0)
     {
-        m_srv_signature_bind_slot = root_params.size();
-
-        srv_table.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, m_srv_count, 0, 0, 0);
-
-        CD3DX12_ROOT_PARAMETER root_param;
-        D3D12_SHADER_VISIBILITY shader_visibility = m_shader_info.b_create_CS ? 
-            D3D12_SHADER_VISIBILITY_ALL : D3D12_SHADER_VISIBILITY_PIXEL; // TODO
-        root_param.InitAsDescriptorTable(1, &srv_table, shader_visibility);
-        root_params.push_back(root_param);
+        input.tables.push_back({ D3D12_DESCRIPTOR_RANGE_TYPE_SRV, m_srv_count, GetShaderVisibility(srv_stage_mask) });
     }
 
-    // UAV: create root descriptor table
+    m_uav_count = 0;
+    UINT uav_stage_mask = 0;
     for(const ShaderUAVParameter& param : m_uav_params)
     {
         m_uav_count += param.bind_count;
+        uav_stage_mask |= param.stage_mask;
     }
-    CD3DX12_DESCRIPTOR_RANGE uav_table; // do not set this var inside the if{} below, because it must be addressed when creating root signature
     if(m_uav_count > 0)
     {
-        m_uav_signature_bind_slot = root_params.size();
+        input.tables.push_back({ D3D12_DESCRIPTOR_RANGE_TYPE_UAV, m_uav_count, GetShaderVisibility(uav_stage_mask) });
+    }
+
+    return input;
+}
+
+void Shader::CreateRootSignature(ID3D12Device* device)
+{
+    RootSignatureInput input = GetRootSignatureInput();
+    m_root_signature_layout = RootSignatureOptimizer::Optimize(input);
+
+    std::string layout_desc = m_shader_info.file_name + " " + m_root_signature_layout.ToString(input);
+    ::OutputDebugStringA(layout_desc.c_str());
+
+    //------------------------ set root parameters -------------------------
+    std::vector<CD3DX12_ROOT_PARAMETER> root_params(m_root_signature_layout.params.size());
+    std::vector<CD3DX12_DESCRIPTOR_RANGE> ranges(input.tables.size()); // addressed by the root parameters until the root signature is serialized
+
+    for(int i=0; i<root_params.size(); i++)
+    {
+        const RootParamSlot& slot = m_root_signature_layout.params[i];
+        if(slot.type == RootParamType::k_table)
+        {
+            const RootSignatureInput::Table& table = input.tables[slot.source_index];
+            CD3DX12_DESCRIPTOR_RANGE& range = ranges[slot.source_index];
+            range.Init(table.range_type, table.descriptor_count, 0, 0);
+            root_params[i].InitAsDescriptorTable(1, &range, slot.visibility);
 
-        uav_table.Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, m_uav_count, 0, 0);
+            if(table.range_type == D3D12_DESCRIPTOR_RANGE_TYPE_SRV)
+            {
+                m_srv_signature_bind_slot = i;
+            }
+            else
+            {
+                m_uav_signature_bind_slot = i;
+            }
+            continue;
+        }
 
-        CD3DX12_ROOT_PARAMETER root_param;
-        D3D12_SHADER_VISIBILITY shader_visibility = D3D12_SHADER_VISIBILITY_ALL; // TODO
-        root_param.InitAsDescriptorTable(1, &uav_table, shader_visibility);
-        root_params.push_back(root_param);
+        // constant buffers are in m_cbv_params order
+        ShaderCBVParameter& param = m_cbv_params[slot.source_index];
+        param.root_param_index = i;
+        if(slot.type == RootParamType::k_constants)
+        {
+            param.num_32bit_values = slot.num_32bit_values;
+            root_params[i].InitAsConstants(slot.num_32bit_values, param.bind_point, param.register_space, slot.visibility);
+        }
+        else
+        {
+            param.num_32bit_values = 0;
+            root_params[i].InitAsConstantBufferView(param.bind_point, param.register_space, slot.visibility);
+        }
     }
 
     // Sampler
@@ -417,7 +865,7 @@ void Shader::CreateRootSignature(ID3D12Device* device)
     CD3DX12_ROOT_SIGNATURE_DESC root_sig_desc(
         (UINT)root_params.size(), root_params.data(),
         (UINT)static_samplers.size(), static_samplers.data(),
-        D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT
+        m_root_signature_layout.flags
     );
 
     ComPtr<ID3DBlob> serialized_root_sig = nullptr;
@@ -442,17 +890,81 @@ void Shader::CreateRootSignature(ID3D12Device* device)
 }
 
 
+void Shader::SetRootSignature(ID3D12GraphicsCommandList* cmd_list, DescriptorCacheGPU* descriptor_cache)
+{
+    bool b_create_CS = m_shader_info.b_create_CS;
+    const Shader*& bound_shader = b_create_CS ? s_bound_compute_shader : s_bound_graphics_shader;
+
+    // the descriptor cache is reset once per command list recording, so its reset count tells a new recording apart
+    if(bound_shader == this
+        && m_bound_cmd_list == cmd_list
+        && m_bound_descriptor_cache_reset_count == descriptor_cache->GetResetCount())
+    {
+        return;
+    }
+
+    if(b_create_CS)
+    {
+        cmd_list->SetComputeRootSignature(m_root_signature.Get());
+    }
+    else
+    {
+        cmd_list->SetGraphicsRootSignature(m_root_signature.Get());
+    }
+
+    // a new root signature leaves every root argument undefined
+    bound_shader = this;
+    m_bound_cmd_list = cmd_list;
+    m_bound_descriptor_cache_reset_count = descriptor_cache->GetResetCount();
+    m_dirty_root_params = ~0ull;
+}
+
+void Shader::InvalidateBindingState()
+{
+    if(s_bound_graphics_shader == this)
+    {
+        s_bound_graphics_shader = nullptr;
+    }
+    if(s_bound_compute_shader == this)
+    {
+        s_bound_compute_shader = nullptr;
+    }
+    m_bound_cmd_list = nullptr;
+    m_dirty_root_params = ~0ull;
+}
+
 void Shader::BindParameters(ID3D12GraphicsCommandList* cmd_list, DescriptorCacheGPU* descriptor_cache)
 {
     CheckBindings();
+    SetRootSignature(cmd_list, descriptor_cache);
 
     bool b_create_CS = m_shader_info.b_create_CS;
 
     // CBV binding
-    for(int i=0; i<m_cbv_params.size(); i++)
+    for(const ShaderCBVParameter& param : m_cbv_params)
     {
-        int root_param_index = m_cbv_signature_base_bind_slot + i;
-        D3D12_GPU_VIRTUAL_ADDRESS gpu_virtual_address = m_cbv_params[i].constant_buffer->GetResource()->GetGPUVirtualAddress();
+        int root_param_index = param.root_param_index;
+        if((m_dirty_root_params & (1ull << root_param_index)) == 0)
+        {
+            s_binding_stats.eliminated_root_param_updates++;
+            continue;
+        }
+
+        if(param.num_32bit_values > 0)
+        {
+            if(b_create_CS)
+            {
+                cmd_list->SetComputeRoot32BitConstants(root_param_index, param.num_32bit_values, param.root_constants.data(), 0);
+            }
+            else
+            {
+                cmd_list->SetGraphicsRoot32BitConstants(root_param_index, param.num_32bit_values, param.root_constants.data(), 0);
+            }
+            s_binding_stats.root_param_updates++;
+            continue;
+        }
+
+        D3D12_GPU_VIRTUAL_ADDRESS gpu_virtual_address = param.constant_buffer_address;
 
         if(b_create_CS)
         {
@@ -462,79 +974,98 @@ void Shader::BindParameters(ID3D12GraphicsCommandList* cmd_list, DescriptorCache
         {
             cmd_list->SetGraphicsRootConstantBufferView(root_param_index, gpu_virtual_address);
         }
+        s_binding_stats.root_param_updates++;
     }
 
     // SRV binding
     if(m_srv_count > 0)
     {
-        std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> src_descriptors;
-        src_descriptors.resize(m_srv_count);
-
-        for(const ShaderSRVParameter& param : m_srv_params)
-        {
-            for(int i=0; i<param.srv_list.size(); i++)
-            {
-                int index = param.bind_point + i;
-                src_descriptors[index] = param.srv_list[i]->GetDescriptorHandle();
-            }
-        }
-
         int root_param_index = m_srv_signature_bind_slot;
-        auto gpu_descriptor_handle = descriptor_cache->AppendCbvSrvUavDescriptorsToHeap(src_descriptors);
-
-        if(b_create_CS)
+        if((m_dirty_root_params & (1ull << root_param_index)) == 0)
         {
-            cmd_list->SetComputeRootDescriptorTable(root_param_index, gpu_descriptor_handle);
+            s_binding_stats.eliminated_root_param_updates++;
         }
         else
         {
-            cmd_list->SetGraphicsRootDescriptorTable(root_param_index, gpu_descriptor_handle);
-        }
-    }
+            assert(m_srv_count <= k_max_table_descriptors);
+            std::array<D3D12_CPU_DESCRIPTOR_HANDLE, k_max_table_descriptors> src_descriptors;
 
-    // UAV binding
-    if(m_uav_count > 0)
-    {
-        std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> src_descriptors;
-        src_descriptors.resize(m_uav_count);
+            for(const ShaderSRVParameter& param : m_srv_params)
+            {
+                for(int i=0; i<param.srv_list.size(); i++)
+                {
+                    int index = param.bind_point + i;
+                    src_descriptors[index] = param.srv_list[i]->GetDescriptorHandle();
+                }
+            }
 
-        for(const ShaderUAVParameter& param : m_uav_params)
-        {
-            for(int i=0; i<param.uav_list.size(); i++)
+            auto gpu_descriptor_handle = descriptor_cache->AppendCbvSrvUavDescriptorsToHeap(src_descriptors.data(), m_srv_count);
+
+            if(b_create_CS)
             {
-                int index = param.bind_point + i;
-                src_descriptors[index] = param.uav_list[i]->GetDescriptorHandle();
+                cmd_list->SetComputeRootDescriptorTable(root_param_index, gpu_descriptor_handle);
             }
+            else
+            {
+                cmd_list->SetGraphicsRootDescriptorTable(root_param_index, gpu_descriptor_handle);
+            }
+            s_binding_stats.root_param_updates++;
         }
+    }
 
+    // UAV binding
+    if(m_uav_count > 0)
+    {
         int root_param_index = m_uav_signature_bind_slot;
-        auto gpu_descriptor_handle = descriptor_cache->AppendCbvSrvUavDescriptorsToHeap(src_descriptors);
-
-        if(b_create_CS)
+        if((m_dirty_root_params & (1ull << root_param_index)) == 0)
         {
-            cmd_list->SetComputeRootDescriptorTable(root_param_index, gpu_descriptor_handle);
+            s_binding_stats.eliminated_root_param_updates++;
         }
         else
         {
-            assert(false);
+            assert(m_uav_count <= k_max_table_descriptors);
+            std::array<D3D12_CPU_DESCRIPTOR_HANDLE, k_max_table_descriptors> src_descriptors;
+
+            for(const ShaderUAVParameter& param : m_uav_params)
+            {
+                for(int i=0; i<param.uav_list.size(); i++)
+                {
+                    int index = param.bind_point + i;
+                    src_descriptors[index] = param.uav_list[i]->GetDescriptorHandle();
+                }
+            }
+
+            auto gpu_descriptor_handle = descriptor_cache->AppendCbvSrvUavDescriptorsToHeap(src_descriptors.data(), m_uav_count);
+
+            if(b_create_CS)
+            {
+                cmd_list->SetComputeRootDescriptorTable(root_param_index, gpu_descriptor_handle);
+            }
+            else
+            {
+                assert(false);
+            }
+            s_binding_stats.root_param_updates++;
         }
     }
+
+    m_dirty_root_params = 0;
     
     // ClearBindings();
 }
 
-const CbReflection& Shader::GetCbReflection(const std::string &cb_name)
+const CbReflection& Shader::GetCbReflection(NameID cb_name)
 {
-    const auto& iter = m_cb_reflection_maps.find(cb_name);
-    assert(iter != m_cb_reflection_maps.end());
-    return iter->second;
+    const CbReflection* cb_reflection = m_cb_reflection_maps.Find(cb_name);
+    assert(cb_reflection);
+    return *cb_reflection;
 }
 
 void Shader::CheckBindings()
 {
     for(ShaderCBVParameter& param : m_cbv_params)
     {
-        assert(param.constant_buffer != nullptr);
+        assert(param.num_32bit_values > 0 ? param.root_constants.size() == param.num_32bit_values : param.constant_buffer_address != 0);
     }
     for(ShaderSRVParameter& param : m_srv_params)
     {
@@ -550,7 +1081,8 @@ void Shader::ClearBindings()
 {
     for(ShaderCBVParameter& param : m_cbv_params)
     {
-        param.constant_buffer = nullptr;
+        param.constant_buffer_address = 0;
+        param.root_constants.clear();
     }
     for(ShaderSRVParameter& param : m_srv_params)
     {
@@ -560,26 +1092,35 @@ void Shader::ClearBindings()
     {
         param.uav_list.clear();
     }
+    m_dirty_root_params = ~0ull;
 }
 
 int CbReflection::GetSize() const
 {
-    int size = 0;
-    for(auto& iter = m_metadata_maps.begin(); iter != m_metadata_maps.end(); iter++)
-    {
-        size += iter->second.size;
-    }
-    return size;
+    return m_size;
+}
+
+void CbReflection::Reserve(size_t variable_count)
+{
+    m_variables.reserve(variable_count);
+    m_variable_indices.Reserve((uint32_t)variable_count);
 }
 
-CbVariableMetaData CbReflection::GetVarMetaData(std::string name) const
+const CbVariableMetaData& CbReflection::GetVarMetaData(NameID name) const
 {
-    auto& result = m_metadata_maps.find(name);
-    assert(result != m_metadata_maps.end());
-    return result->second;
+    const uint32_t* index = m_variable_indices.Find(name);
+    assert(index);
+    return m_variables[*index];
 }
 
-void CbReflection::SetVarMetaData(std::string name, CbVariableMetaData data)
+void CbReflection::SetVarMetaData(NameID name, const CbVariableMetaData& data)
 {
-    m_metadata_maps[name] = data;
+    if(uint32_t* index = m_variable_indices.Find(name))
+    {
+        m_variables[*index] = data;
+        return;
+    }
+
+    m_variable_indices.Insert(name, (uint32_t)m_variables.size());
+    m_variables.push_back(data);
 }
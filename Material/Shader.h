@@ -3,7 +3,15 @@
 #include "D3DRHI/ResourceView.h"
 #include "D3DRHI/D3D12Buffer.h"
 #include "D3DRHI/DescriptorCacheGPU.h"
+#include "Utility/ThreadPool.h"
+#include "Utility/MappedFile.h"
+#include "Utility/NameID.h"
+#include "Utility/FlatHashMap.h"
+#include "ShaderReflectionBlob.h"
+#include "RootSignatureOptimizer.h"
+#include "Math/Math.h"
 #include <string>
+#include <future>
 using Microsoft::WRL::ComPtr;
 
 
@@ -14,17 +22,42 @@ enum class ShaderType
 	k_compute_shader,
 };
 
+inline UINT GetShaderStageBit(ShaderType shader_type) { return 1u << (UINT)shader_type; }
+
 struct ShaderParameter
 {
 	std::string name;
-	ShaderType shader_type;
+	ShaderType shader_type;	// first stage the parameter was reflected from
+	UINT stage_mask = 0;	// every stage using it, see GetShaderStageBit
 	UINT bind_point;
 	UINT register_space;
 };
 
+enum class ShaderParamKind : uint8_t
+{
+	k_invalid,
+	k_cbv,
+	k_srv,
+	k_uav,
+};
+
+// index of a reflected parameter, resolved once by Shader::GetParameterHandle
+// so per draw binding is an array access instead of a string search
+// handles must be resolved again after the shader is hot reloaded (see Shader::GetVersion)
+struct ShaderParamHandle
+{
+	ShaderParamKind kind = ShaderParamKind::k_invalid;
+	uint16_t index = 0;
+
+	bool IsValid() const { return kind != ShaderParamKind::k_invalid; }
+};
+
 struct ShaderCBVParameter : ShaderParameter
 {
-	D3D12ConstantBuffer* constant_buffer;
+	int root_param_index = -1;
+	UINT num_32bit_values = 0;				// > 0 when the optimizer made it root constants
+	D3D12_GPU_VIRTUAL_ADDRESS constant_buffer_address = 0;	// root descriptor
+	std::vector<uint32_t> root_constants;	// root constants, copied in by Shader::SetConstants
 };
 
 struct ShaderSRVParameter : ShaderParameter 
@@ -105,12 +138,62 @@ struct ShaderInfo
 	std::string CS_entry_point = "CS";
 };
 
+// output of one compile job, the reflection is a ShaderReflectionBlob
+struct CompiledShaderStage
+{
+	ComPtr<ID3DBlob> bytecode;
+	std::vector<char> reflection_data;				// set when the stage was compiled in this run
+	std::shared_ptr<MappedFile> reflection_file;	// set when it was loaded from the shader cache
+
+	const void* GetReflectionData() const { return reflection_file ? reflection_file->GetData() : reflection_data.data(); }
+	size_t GetReflectionSize() const { return reflection_file ? reflection_file->GetSize() : reflection_data.size(); }
+};
+
+// one compile job is dispatched per stage, "VS", "PS" or "CS"
+struct ShaderStageDesc
+{
+	std::string stage_name;
+	ShaderType shader_type;
+	std::string entry_point;
+	std::string target;
+};
+
+
+enum class CbVariableType : uint8_t
+{
+	k_unknown,
+	k_float,
+	k_float2,
+	k_float3,
+	k_float4,
+	k_int,
+	k_uint,
+	k_float3x4,	// three 16 byte registers, e.g. a row_major float3x4 or a column_major float4x3
+	k_float4x4,
+};
+
+// C++ type -> CbVariableType, used by the typed setters to check the reflected type at compile time
+template<typename T> struct CbVariableTypeOf;
+template<> struct CbVariableTypeOf<float> { static constexpr CbVariableType value = CbVariableType::k_float; };
+template<> struct CbVariableTypeOf<int32_t> { static constexpr CbVariableType value = CbVariableType::k_int; };
+template<> struct CbVariableTypeOf<uint32_t> { static constexpr CbVariableType value = CbVariableType::k_uint; };
+template<> struct CbVariableTypeOf<DirectX::XMFLOAT2> { static constexpr CbVariableType value = CbVariableType::k_float2; };
+template<> struct CbVariableTypeOf<DirectX::XMFLOAT3> { static constexpr CbVariableType value = CbVariableType::k_float3; };
+template<> struct CbVariableTypeOf<DirectX::XMFLOAT4> { static constexpr CbVariableType value = CbVariableType::k_float4; };
+template<> struct CbVariableTypeOf<DirectX::XMFLOAT3X4> { static constexpr CbVariableType value = CbVariableType::k_float3x4; };
+template<> struct CbVariableTypeOf<DirectX::XMFLOAT4X4> { static constexpr CbVariableType value = CbVariableType::k_float4x4; };
+template<> struct CbVariableTypeOf<Vector2> { static constexpr CbVariableType value = CbVariableType::k_float2; };
+template<> struct CbVariableTypeOf<Vector3> { static constexpr CbVariableType value = CbVariableType::k_float3; };
+template<> struct CbVariableTypeOf<Vector4> { static constexpr CbVariableType value = CbVariableType::k_float4; };
+template<> struct CbVariableTypeOf<Matrix> { static constexpr CbVariableType value = CbVariableType::k_float4x4; };
 
 struct CbVariableMetaData
 {
-	unsigned int offset;
-	unsigned int size;
-	std::string type;
+	unsigned int offset;		// byte offset in the cbuffer, as reflected
+	unsigned int size;			// bytes including the padding between array elements
+	CbVariableType type;
+	unsigned int elements;		// 0 if the variable is not an array
+	unsigned int element_stride;	// array elements start on 16 byte boundaries
 };
 
 // varname -> var metadata
@@ -120,19 +203,32 @@ public:
 	CbReflection() = default;
 	~CbReflection() = default;
 
+	// D3D12_SHADER_BUFFER_DESC::Size, includes the hlsl packing and trailing padding
 	int GetSize() const;
-	CbVariableMetaData GetVarMetaData(std::string name) const;
-	void SetVarMetaData(std::string name, CbVariableMetaData data);
+	void SetSize(unsigned int size) { m_size = size; }
+	void Reserve(size_t variable_count);
+	const CbVariableMetaData& GetVarMetaData(NameID name) const;
+	void SetVarMetaData(NameID name, const CbVariableMetaData& data);
 
 private:
-	std::unordered_map<std::string, CbVariableMetaData> m_metadata_maps;
+	unsigned int m_size = 0;
+	// flat storage, a cbuffer costs a handful of allocations no matter how many variables it has
+	std::vector<CbVariableMetaData> m_variables;
+	FlatHashMap<NameID, uint32_t> m_variable_indices;	// into m_variables
 };
 
 //typedef std::unordered_map<std::string, CbVariableMetaData> CbReflection; 
 
-typedef std::unordered_map<std::string, CbReflection> CbReflectionMaps;	// cbname -> cb_var_structure
+typedef FlatHashMap<NameID, CbReflection> CbReflectionMaps;	// cbname -> cb_var_structure
 
 
+// root parameter updates issued and skipped by Shader::BindParameters since the last reset
+struct ShaderBindingStats
+{
+	uint64_t root_param_updates = 0;
+	uint64_t eliminated_root_param_updates = 0;
+};
+
 class Shader
 {
 public:
@@ -140,27 +236,67 @@ public:
 	Shader(const ShaderInfo& shader_info, ID3D12Device* device);
 	~Shader() = default;
 
-	bool SetParameter(std::string param_name, D3D12ConstantBuffer* constant_buffer);
-	bool SetParameter(std::string param_name, ShaderResourceView* srv);
-	bool SetParameter(std::string param_name, const std::vector<ShaderResourceView*>& srv_list);
-	bool SetParameter(std::string param_name, UnorderedAccessView* uav);
-	bool SetParameter(std::string param_name, const std::vector<UnorderedAccessView*>& uav_list);
+	// compile every stage of every permutation on the worker pool, shaders are returned in input order
+	static std::vector<std::unique_ptr<Shader>> CreateShaders(const std::vector<ShaderInfo>& shader_infos, ID3D12Device* device);
+
+	ShaderParamHandle GetParameterHandle(const std::string& param_name) const;
+
+	bool SetParameter(const std::string& param_name, D3D12ConstantBuffer* constant_buffer);
+	bool SetParameter(const std::string& param_name, ShaderResourceView* srv);
+	bool SetParameter(const std::string& param_name, const std::vector<ShaderResourceView*>& srv_list);
+	bool SetParameter(const std::string& param_name, UnorderedAccessView* uav);
+	bool SetParameter(const std::string& param_name, const std::vector<UnorderedAccessView*>& uav_list);
+
+	bool SetParameter(ShaderParamHandle handle, D3D12ConstantBuffer* constant_buffer);
+	bool SetParameter(ShaderParamHandle handle, D3D12_GPU_VIRTUAL_ADDRESS constant_buffer_address); // e.g. a D3D12ConstantBufferPool slot
+	bool SetParameter(ShaderParamHandle handle, ShaderResourceView* srv);
+	bool SetParameter(ShaderParamHandle handle, const std::vector<ShaderResourceView*>& srv_list);
+	bool SetParameter(ShaderParamHandle handle, UnorderedAccessView* uav);
+	bool SetParameter(ShaderParamHandle handle, const std::vector<UnorderedAccessView*>& uav_list);
+	// cbuffers laid out as root constants take their data directly instead of a constant buffer
+	bool IsRootConstants(ShaderParamHandle handle) const;
+	bool SetConstants(ShaderParamHandle handle, const void* data, UINT size);
+	// sets the root signature if needed, then only the root parameters changed since the last call
+	// does not allocate, tables are assembled on the stack
 	void BindParameters(ID3D12GraphicsCommandList* cmd_list, DescriptorCacheGPU* descriptor_cache);
-	const CbReflection& GetCbReflection(const std::string& cb_name);
+	const CbReflection& GetCbReflection(NameID cb_name);
+	UINT GetVersion() const { return m_version; } // increased every time the shader is hot reloaded
+	const RootSignatureLayout& GetRootSignatureLayout() const { return m_root_signature_layout; }
+
+	static const ShaderBindingStats& GetBindingStats() { return s_binding_stats; }
+	static void ResetBindingStats() { s_binding_stats = ShaderBindingStats(); }
+
+	static const UINT k_max_table_descriptors = 64; // capacity of one srv or uav table
 
 private:
+	friend class ShaderHotReloader;
+
+	typedef std::vector<std::pair<ShaderStageDesc, std::future<CompiledShaderStage>>> CompileJobs;
+
+	explicit Shader(const ShaderInfo& shader_info);
+	static UINT GetCompileFlags();
 	static Microsoft::WRL::ComPtr<ID3DBlob> CompileShader(const std::wstring& Filename, const D3D_SHADER_MACRO* Defines, const std::string& Entrypoint, const std::string& Target);
 	void Initialize(ID3D12Device* device);
-	void GetShaderParameters(ComPtr<ID3DBlob> blob, ShaderType shader_type);
-	D3D12_SHADER_VISIBILITY GetShaderVisibility(ShaderType shader_type);
+	std::vector<ShaderStageDesc> GetStageDescs() const;
+	CompileJobs DispatchCompileJobs(ThreadPool& pool) const;
+	void FinishInitialize(CompileJobs& compile_jobs, ID3D12Device* device);
+	std::unique_ptr<Shader> CompileReload(CompileJobs& compile_jobs, ID3D12Device* device) const;
+	void ApplyReload(Shader& reloaded); // swaps in what CompileReload built, does not throw
+	static std::vector<char> ReflectStage(ID3DBlob* blob);	// D3DReflect -> ShaderReflectionBlob
+	void LoadShaderParameters(const ShaderReflectionBlobView& reflection, ShaderType shader_type);
+	D3D12_SHADER_VISIBILITY GetShaderVisibility(UINT stage_mask);
 	std::vector<CD3DX12_STATIC_SAMPLER_DESC> CreateStaticSamplers();
+	RootSignatureInput GetRootSignatureInput();
 	void CreateRootSignature(ID3D12Device* device);
 	void CheckBindings();
 	void ClearBindings();
+	void SetRootSignature(ID3D12GraphicsCommandList* cmd_list, DescriptorCacheGPU* descriptor_cache);
+	void InvalidateBindingState();
+	void MarkRootParamDirty(int root_param_index) { m_dirty_root_params |= 1ull << root_param_index; }
 
 public:
 	ShaderInfo m_shader_info;
-	std::unordered_map<std::string, ComPtr<ID3DBlob>> m_shader_stage;	// storing vs, ps or cs shader blob
+	FlatHashMap<NameID, ComPtr<ID3DBlob>> m_shader_stage;	// storing vs, ps or cs shader blob
 	ComPtr<ID3D12RootSignature> m_root_signature;
 
 private:
@@ -172,8 +308,6 @@ private:
 
 	std::vector<ShaderSamplerParameter> m_sampler_params;
 
-	int m_cbv_signature_base_bind_slot = -1;
-
 	int m_srv_signature_bind_slot = -1;
 
 	UINT m_srv_count = 0;
@@ -184,5 +318,19 @@ private:
 
 	int m_sampler_signature_bind_slot = -1;
 
+	RootSignatureLayout m_root_signature_layout;
+
 	CbReflectionMaps m_cb_reflection_maps;
+
+	UINT m_version = 0;
+
+	// root arguments set by BindParameters stay valid while this shader's root signature is the one
+	// set on m_bound_cmd_list and the descriptor cache has not been reset
+	ID3D12GraphicsCommandList* m_bound_cmd_list = nullptr;
+	uint64_t m_bound_descriptor_cache_reset_count = 0;
+	uint64_t m_dirty_root_params = ~0ull; // bit per root parameter, the 64 DWORD limit keeps it below 64 parameters
+
+	static const Shader* s_bound_graphics_shader;
+	static const Shader* s_bound_compute_shader;
+	static ShaderBindingStats s_binding_stats;
 };
\ No newline at end of file
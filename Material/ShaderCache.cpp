@@ -0,0 +1,175 @@
+#include "ShaderCache.h"
+#include "ShaderDependencyGraph.h"
+#include "Utility/FormatConvert.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    std::mutex g_cache_directory_mutex;
+    std::string g_cache_directory = "ShaderCache";
+
+    // 64 bit FNV-1a
+    const uint64_t k_fnv_offset_basis = 0xcbf29ce484222325ull;
+    const uint64_t k_fnv_prime = 0x100000001b3ull;
+
+    void HashBytes(uint64_t& hash, const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for(size_t i=0; i<size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= k_fnv_prime;
+        }
+    }
+
+    // the terminator keeps ("ab", "c") and ("a", "bc") apart
+    void HashString(uint64_t& hash, const std::string& str)
+    {
+        HashBytes(hash, str.c_str(), str.size() + 1);
+    }
+
+    bool WriteFileAtomic(const std::string& path, const void* data, size_t size)
+    {
+        // readers on other threads or processes only ever see a complete file
+        std::hash<std::thread::id> thread_hash;
+        std::string temp_path = path + "." + std::to_string(thread_hash(std::this_thread::get_id())) + ".tmp";
+        {
+            std::ofstream fout(temp_path, std::ios::binary | std::ios::trunc);
+            if(!fout)
+            {
+                return false;
+            }
+            fout.write(static_cast<const char*>(data), size);
+            if(!fout)
+            {
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temp_path, path, error);
+        if(error)
+        {
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+        return true;
+    }
+}
+
+void ShaderCache::SetCacheDirectory(const std::string& directory)
+{
+    std::lock_guard<std::mutex> lock(g_cache_directory_mutex);
+    g_cache_directory = directory;
+}
+
+std::string ShaderCache::GetCacheDirectory()
+{
+    std::lock_guard<std::mutex> lock(g_cache_directory_mutex);
+    return g_cache_directory;
+}
+
+uint64_t ShaderCache::ComputeKey(
+    const std::string& file_name,
+    const ShaderDefines& shader_defines,
+    const std::string& entry_point,
+    const std::string& target,
+    UINT compile_flags)
+{
+    uint64_t hash = k_fnv_offset_basis;
+
+    HashBytes(hash, &ShaderReflectionBlobHeader::k_version, sizeof(ShaderReflectionBlobHeader::k_version));
+    HashString(hash, entry_point);
+    HashString(hash, target);
+    HashBytes(hash, &compile_flags, sizeof(compile_flags));
+
+    // m_defines_map is unordered, sort so equal defines give equal keys
+    std::vector<std::pair<std::string, std::string>> defines(shader_defines.m_defines_map.begin(), shader_defines.m_defines_map.end());
+    std::sort(defines.begin(), defines.end());
+    for(const auto& define : defines)
+    {
+        HashString(hash, define.first);
+        HashString(hash, define.second);
+    }
+
+    // contents of the root file and everything it includes, in the deterministic scan order
+    ShaderDependencyGraph dependency_graph;
+    for(const std::string& file : dependency_graph.ScanRootFile(file_name))
+    {
+        HashString(hash, file);
+
+        std::ifstream fin(file, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+        HashString(hash, content);
+    }
+
+    return hash;
+}
+
+std::string ShaderCache::GetEntryPath(uint64_t key, const char* extension)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+    return (std::filesystem::path(GetCacheDirectory()) / (std::string(name) + extension)).string();
+}
+
+bool ShaderCache::Load(uint64_t key, CompiledShaderStage& out_stage)
+{
+    if(GetCacheDirectory().empty())
+    {
+        return false;
+    }
+
+    std::string bytecode_path = GetEntryPath(key, ".cso");
+    std::string reflection_path = GetEntryPath(key, ".refl");
+
+    std::error_code error;
+    if(!std::filesystem::exists(bytecode_path, error) || !std::filesystem::exists(reflection_path, error))
+    {
+        return false;
+    }
+
+    // a foreign or truncated blob is treated as a miss and overwritten by the next Store
+    auto reflection_file = std::make_shared<MappedFile>();
+    ShaderReflectionBlobView reflection;
+    if(!reflection_file->Open(reflection_path) || !reflection.Parse(reflection_file->GetData(), reflection_file->GetSize()))
+    {
+        return false;
+    }
+
+    ComPtr<ID3DBlob> bytecode = d3dUtil::LoadBinary(FormatConvert::StrToWStr(bytecode_path));
+    if(bytecode == nullptr || bytecode->GetBufferSize() == 0)
+    {
+        return false;
+    }
+
+    out_stage.bytecode = bytecode;
+    out_stage.reflection_data.clear();
+    out_stage.reflection_file = reflection_file;
+    return true;
+}
+
+void ShaderCache::Store(uint64_t key, const CompiledShaderStage& stage)
+{
+    std::string directory = GetCacheDirectory();
+    if(directory.empty())
+    {
+        return;
+    }
+
+    // a failed write only costs a recompile next run
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    // reflection last, Load requires both files so a half written entry is a miss
+    if(WriteFileAtomic(GetEntryPath(key, ".cso"), stage.bytecode->GetBufferPointer(), stage.bytecode->GetBufferSize()))
+    {
+        WriteFileAtomic(GetEntryPath(key, ".refl"), stage.GetReflectionData(), stage.GetReflectionSize());
+    }
+}
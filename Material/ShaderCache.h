@@ -0,0 +1,31 @@
+#pragma once
+#include "Shader.h"
+#include <cstdint>
+#include <string>
+
+// on disk cache of compiled shader stages, <dir>/<key>.cso holds the bytecode and
+// <dir>/<key>.refl the ShaderReflectionBlob, which is memory mapped on load
+// the key covers the source of the whole include closure, so stale entries are never hit
+class ShaderCache
+{
+public:
+    ShaderCache() = delete;
+
+    // an empty directory disables the cache
+    static void SetCacheDirectory(const std::string& directory);
+    static std::string GetCacheDirectory();
+
+    static uint64_t ComputeKey(
+        const std::string& file_name,
+        const ShaderDefines& shader_defines,
+        const std::string& entry_point,
+        const std::string& target,
+        UINT compile_flags);
+
+    // safe to call from compile jobs
+    static bool Load(uint64_t key, CompiledShaderStage& out_stage);
+    static void Store(uint64_t key, const CompiledShaderStage& stage);
+
+private:
+    static std::string GetEntryPath(uint64_t key, const char* extension);
+};
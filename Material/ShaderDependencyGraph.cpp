@@ -0,0 +1,103 @@
+#include "ShaderDependencyGraph.h"
+#include "Utility/FileWatcher.h"
+#include <filesystem>
+#include <fstream>
+#include <regex>
+
+const std::vector<std::string>& ShaderDependencyGraph::ScanRootFile(const std::string& root_file)
+{
+    std::string root = FileWatcher::NormalizePath(root_file);
+    RemoveRootFile(root);
+
+    // depth first walk, the visited set also guards against include cycles
+    std::vector<std::string> closure;
+    std::unordered_set<std::string> visited;
+    std::vector<std::string> pending{ root };
+    while(!pending.empty())
+    {
+        std::string file = pending.back();
+        pending.pop_back();
+        if(!visited.insert(file).second)
+        {
+            continue;
+        }
+
+        closure.push_back(file);
+        for(std::string& include : ParseIncludes(file))
+        {
+            pending.push_back(std::move(include));
+        }
+    }
+
+    for(const std::string& file : closure)
+    {
+        m_dependents[file].insert(root);
+    }
+
+    auto& result = m_root_closures[root];
+    result = std::move(closure);
+    return result;
+}
+
+void ShaderDependencyGraph::RemoveRootFile(const std::string& root_file)
+{
+    std::string root = FileWatcher::NormalizePath(root_file);
+
+    auto iter = m_root_closures.find(root);
+    if(iter == m_root_closures.end())
+    {
+        return;
+    }
+
+    for(const std::string& file : iter->second)
+    {
+        auto dependents = m_dependents.find(file);
+        if(dependents != m_dependents.end())
+        {
+            dependents->second.erase(root);
+            if(dependents->second.empty())
+            {
+                m_dependents.erase(dependents);
+            }
+        }
+    }
+    m_root_closures.erase(iter);
+}
+
+std::vector<std::string> ShaderDependencyGraph::GetAffectedRootFiles(const std::string& changed_file) const
+{
+    std::vector<std::string> ret;
+
+    auto iter = m_dependents.find(FileWatcher::NormalizePath(changed_file));
+    if(iter != m_dependents.end())
+    {
+        ret.assign(iter->second.begin(), iter->second.end());
+    }
+
+    return ret;
+}
+
+std::vector<std::string> ShaderDependencyGraph::ParseIncludes(const std::string& file)
+{
+    static const std::regex include_regex(R"(^\s*#\s*include\s*[<"]([^">]+)[">])");
+
+    std::vector<std::string> ret;
+    std::ifstream stream(file);
+    if(!stream.is_open())
+    {
+        return ret;
+    }
+
+    std::filesystem::path directory = std::filesystem::path(file).parent_path();
+    std::string line;
+    std::smatch match;
+    while(std::getline(stream, line))
+    {
+        if(std::regex_search(line, match, include_regex))
+        {
+            ret.push_back((directory / match[1].str()).lexically_normal().string());
+        }
+    }
+
+    return ret;
+}
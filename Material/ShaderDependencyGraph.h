@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// include graph of hlsl source files, all paths are normalized by FileWatcher::NormalizePath
+// a root file is the file_name a Shader is compiled from
+class ShaderDependencyGraph
+{
+public:
+    ShaderDependencyGraph() = default;
+    ~ShaderDependencyGraph() = default;
+
+    // (re)scan root_file and its includes recursively, returns the closure including root_file itself
+    const std::vector<std::string>& ScanRootFile(const std::string& root_file);
+    void RemoveRootFile(const std::string& root_file);
+
+    // root files whose include closure contains changed_file
+    std::vector<std::string> GetAffectedRootFiles(const std::string& changed_file) const;
+
+    // direct #include targets of file, resolved relative to the including file like D3D_COMPILE_STANDARD_FILE_INCLUDE
+    static std::vector<std::string> ParseIncludes(const std::string& file);
+
+private:
+    std::unordered_map<std::string, std::vector<std::string>> m_root_closures; // root file -> files it depends on
+    std::unordered_map<std::string, std::unordered_set<std::string>> m_dependents; // file -> root files depending on it
+};
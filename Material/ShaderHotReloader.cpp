@@ -0,0 +1,112 @@
+#include "ShaderHotReloader.h"
+#include <algorithm>
+
+ShaderHotReloader::ShaderHotReloader(PSOManager* pso_manager):
+    m_pso_manager(pso_manager),
+    m_file_watcher([this](const std::string& path) { OnFileChanged(path); })
+{
+}
+
+void ShaderHotReloader::RegisterShader(Shader* shader)
+{
+    assert(std::find(m_shaders.begin(), m_shaders.end(), shader) == m_shaders.end());
+    m_shaders.push_back(shader);
+    WatchDependencies(shader);
+}
+
+void ShaderHotReloader::UnregisterShader(Shader* shader)
+{
+    m_shaders.erase(std::remove(m_shaders.begin(), m_shaders.end(), shader), m_shaders.end());
+    m_pending_reloads.erase(
+        std::remove_if(m_pending_reloads.begin(), m_pending_reloads.end(),
+            [shader](const PendingReload& reload) { return reload.shader == shader; }),
+        m_pending_reloads.end());
+}
+
+std::vector<Shader*> ShaderHotReloader::Update(ID3D12Device* device)
+{
+    std::unordered_set<std::string> changed_files;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        changed_files.swap(m_changed_files);
+    }
+
+    // collect every permutation compiled from an affected root file
+    std::vector<Shader*> affected_shaders;
+    for(const std::string& file : changed_files)
+    {
+        for(const std::string& root_file : m_dependency_graph.GetAffectedRootFiles(file))
+        {
+            for(Shader* shader : m_shaders)
+            {
+                if(FileWatcher::NormalizePath(shader->m_shader_info.file_name) == root_file
+                    && std::find(affected_shaders.begin(), affected_shaders.end(), shader) == affected_shaders.end())
+                {
+                    affected_shaders.push_back(shader);
+                }
+            }
+        }
+    }
+
+    for(Shader* shader : affected_shaders)
+    {
+        // a newer edit supersedes a compile still in flight
+        m_pending_reloads.erase(
+            std::remove_if(m_pending_reloads.begin(), m_pending_reloads.end(),
+                [shader](const PendingReload& reload) { return reload.shader == shader; }),
+            m_pending_reloads.end());
+
+        m_pending_reloads.push_back({ shader, shader->DispatchCompileJobs(ThreadPool::GetDefault()) });
+    }
+
+    // swap in the reloads whose stages are all compiled
+    std::vector<Shader*> reloaded_shaders;
+    for(auto iter = m_pending_reloads.begin(); iter != m_pending_reloads.end(); )
+    {
+        bool b_ready = true;
+        for(auto& job : iter->compile_jobs)
+        {
+            b_ready &= job.second.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+        if(!b_ready)
+        {
+            iter++;
+            continue;
+        }
+
+        try
+        {
+            // compile and build the psos first, a shader the psos reject (e.g. a changed input signature)
+            // throws before anything live is touched
+            std::unique_ptr<Shader> reloaded = iter->shader->CompileReload(iter->compile_jobs, device);
+            m_pso_manager->RebuildPSOs(iter->shader, *reloaded, device);
+            iter->shader->ApplyReload(*reloaded);
+            WatchDependencies(iter->shader);
+            reloaded_shaders.push_back(iter->shader);
+        }
+        catch(DxException& e)
+        {
+            // the compiler output was already written to the debug output, keep running the old shader and psos
+            ::OutputDebugStringW(e.ToString().c_str());
+        }
+
+        iter = m_pending_reloads.erase(iter);
+    }
+
+    return reloaded_shaders;
+}
+
+void ShaderHotReloader::OnFileChanged(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_changed_files.insert(path);
+}
+
+void ShaderHotReloader::WatchDependencies(Shader* shader)
+{
+    // includes may have been added by the last edit, so the closure is scanned again
+    for(const std::string& file : m_dependency_graph.ScanRootFile(shader->m_shader_info.file_name))
+    {
+        m_file_watcher.WatchFile(file);
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "Shader.h"
+#include "ShaderDependencyGraph.h"
+#include "D3DRHI/PSOManager.h"
+#include "Utility/FileWatcher.h"
+
+// recompiles registered shaders when their source or any included file changes
+// compiles run on the worker pool, the swap itself happens in Update on the calling thread
+class ShaderHotReloader
+{
+public:
+    ShaderHotReloader() = delete;
+    explicit ShaderHotReloader(PSOManager* pso_manager);
+    ~ShaderHotReloader() = default;
+
+    void RegisterShader(Shader* shader);
+    void UnregisterShader(Shader* shader);
+
+    // call once per frame while the gpu does not use any registered shader
+    // starts recompiles for changed files and swaps in the finished ones, returns the reloaded shaders
+    std::vector<Shader*> Update(ID3D12Device* device);
+
+private:
+    struct PendingReload
+    {
+        Shader* shader;
+        Shader::CompileJobs compile_jobs;
+    };
+
+    void OnFileChanged(const std::string& path); // called on the watcher thread
+    void WatchDependencies(Shader* shader);
+
+private:
+    PSOManager* m_pso_manager = nullptr;
+    std::vector<Shader*> m_shaders;
+    ShaderDependencyGraph m_dependency_graph;
+    std::vector<PendingReload> m_pending_reloads;
+
+    std::mutex m_mutex;
+    std::unordered_set<std::string> m_changed_files; // written by the watcher thread
+
+    FileWatcher m_file_watcher; // declared last, its thread stops before the members above are destroyed
+};
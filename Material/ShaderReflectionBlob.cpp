@@ -0,0 +1,149 @@
+#include "ShaderReflectionBlob.h"
+#include <cassert>
+#include <cstring>
+
+void ShaderReflectionBlobWriter::AddParam(ReflectedParamKind kind, const std::string& name, uint32_t bind_point, uint32_t bind_count, uint32_t register_space)
+{
+    ReflectedParam param = {};
+    param.name = InternString(name);
+    param.kind = kind;
+    param.bind_point = bind_point;
+    param.bind_count = bind_count;
+    param.register_space = register_space;
+    m_params.push_back(param);
+}
+
+void ShaderReflectionBlobWriter::AddCbParam(const std::string& name, uint32_t bind_point, uint32_t register_space, uint32_t cb_size)
+{
+    AddParam(ReflectedParamKind::k_cbv, name, bind_point, 1, register_space);
+
+    ReflectedParam& param = m_params.back();
+    param.cb_size = cb_size;
+    param.first_variable = (uint32_t)m_variables.size();
+    param.variable_count = 0;
+}
+
+void ShaderReflectionBlobWriter::AddCbVariable(const std::string& name, uint32_t offset, uint32_t size, uint32_t type, uint32_t elements, uint32_t element_stride)
+{
+    assert(!m_params.empty() && m_params.back().kind == ReflectedParamKind::k_cbv);
+
+    ReflectedCbVariable variable;
+    variable.name = InternString(name);
+    variable.offset = offset;
+    variable.size = size;
+    variable.type = type;
+    variable.elements = elements;
+    variable.element_stride = element_stride;
+    m_variables.push_back(variable);
+
+    m_params.back().variable_count++;
+}
+
+std::vector<char> ShaderReflectionBlobWriter::Finish() const
+{
+    ShaderReflectionBlobHeader header;
+    header.magic = ShaderReflectionBlobHeader::k_magic;
+    header.version = ShaderReflectionBlobHeader::k_version;
+    header.param_count = (uint32_t)m_params.size();
+    header.variable_count = (uint32_t)m_variables.size();
+    header.string_table_size = (uint32_t)m_string_table.size();
+
+    size_t params_bytes = m_params.size() * sizeof(ReflectedParam);
+    size_t variables_bytes = m_variables.size() * sizeof(ReflectedCbVariable);
+
+    std::vector<char> blob(sizeof(header) + params_bytes + variables_bytes + m_string_table.size());
+    char* dest = blob.data();
+    memcpy(dest, &header, sizeof(header));
+    dest += sizeof(header);
+    if(params_bytes > 0)
+    {
+        memcpy(dest, m_params.data(), params_bytes);
+        dest += params_bytes;
+    }
+    if(variables_bytes > 0)
+    {
+        memcpy(dest, m_variables.data(), variables_bytes);
+        dest += variables_bytes;
+    }
+    if(!m_string_table.empty())
+    {
+        memcpy(dest, m_string_table.data(), m_string_table.size());
+    }
+
+    return blob;
+}
+
+uint32_t ShaderReflectionBlobWriter::InternString(const std::string& str)
+{
+    auto iter = m_interned_strings.find(str);
+    if(iter != m_interned_strings.end())
+    {
+        return iter->second;
+    }
+
+    // strings are stored null terminated so GetString can hand out a c string
+    uint32_t offset = (uint32_t)m_string_table.size();
+    m_string_table.append(str);
+    m_string_table.push_back('\0');
+    m_interned_strings.emplace(str, offset);
+    return offset;
+}
+
+bool ShaderReflectionBlobView::Parse(const void* data, size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    if(bytes == nullptr || size < sizeof(ShaderReflectionBlobHeader))
+    {
+        return false;
+    }
+
+    const ShaderReflectionBlobHeader* header = reinterpret_cast<const ShaderReflectionBlobHeader*>(bytes);
+    if(header->magic != ShaderReflectionBlobHeader::k_magic || header->version != ShaderReflectionBlobHeader::k_version)
+    {
+        return false;
+    }
+
+    size_t params_offset = sizeof(ShaderReflectionBlobHeader);
+    size_t variables_offset = params_offset + (size_t)header->param_count * sizeof(ReflectedParam);
+    size_t strings_offset = variables_offset + (size_t)header->variable_count * sizeof(ReflectedCbVariable);
+    if(strings_offset + header->string_table_size != size)
+    {
+        return false;
+    }
+
+    const ReflectedParam* params = reinterpret_cast<const ReflectedParam*>(bytes + params_offset);
+    const ReflectedCbVariable* variables = reinterpret_cast<const ReflectedCbVariable*>(bytes + variables_offset);
+    const char* string_table = bytes + strings_offset;
+
+    // every string must start inside the table, and the table must end with a terminator
+    if(header->string_table_size > 0 && string_table[header->string_table_size - 1] != '\0')
+    {
+        return false;
+    }
+    for(uint32_t i=0; i<header->param_count; i++)
+    {
+        const ReflectedParam& param = params[i];
+        if(param.name >= header->string_table_size || param.kind > ReflectedParamKind::k_sampler)
+        {
+            return false;
+        }
+        if(param.kind == ReflectedParamKind::k_cbv
+            && (uint64_t)param.first_variable + param.variable_count > header->variable_count)
+        {
+            return false;
+        }
+    }
+    for(uint32_t i=0; i<header->variable_count; i++)
+    {
+        if(variables[i].name >= header->string_table_size)
+        {
+            return false;
+        }
+    }
+
+    m_header = header;
+    m_params = params;
+    m_variables = variables;
+    m_string_table = string_table;
+    return true;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// compact binary form of one shader stage's reflection, written next to the cached bytecode
+// layout: header | params | cb variables | string table
+// strings are interned in the table and referenced by byte offset, the blob has no pointers
+// so it can be used straight from a memory mapped file
+
+enum class ReflectedParamKind : uint32_t
+{
+    k_cbv,
+    k_srv,
+    k_uav,
+    k_sampler,
+};
+
+struct ReflectedParam
+{
+    uint32_t name;              // offset into the string table
+    ReflectedParamKind kind;
+    uint32_t bind_point;
+    uint32_t bind_count;
+    uint32_t register_space;
+    uint32_t cb_size;           // cbv only, D3D12_SHADER_BUFFER_DESC::Size
+    uint32_t first_variable;    // cbv only, index into the variable array
+    uint32_t variable_count;    // cbv only
+};
+
+struct ReflectedCbVariable
+{
+    uint32_t name;              // offset into the string table
+    uint32_t offset;
+    uint32_t size;
+    uint32_t type;              // CbVariableType
+    uint32_t elements;
+    uint32_t element_stride;
+};
+
+struct ShaderReflectionBlobHeader
+{
+    static const uint32_t k_magic = 0x4C464552; // "REFL"
+    static const uint32_t k_version = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t param_count;
+    uint32_t variable_count;
+    uint32_t string_table_size;
+};
+
+class ShaderReflectionBlobWriter
+{
+public:
+    ShaderReflectionBlobWriter() = default;
+    ~ShaderReflectionBlobWriter() = default;
+
+    void AddParam(ReflectedParamKind kind, const std::string& name, uint32_t bind_point, uint32_t bind_count, uint32_t register_space);
+    void AddCbParam(const std::string& name, uint32_t bind_point, uint32_t register_space, uint32_t cb_size);
+    // the variable belongs to the cbuffer added last
+    void AddCbVariable(const std::string& name, uint32_t offset, uint32_t size, uint32_t type, uint32_t elements, uint32_t element_stride);
+
+    std::vector<char> Finish() const;
+
+private:
+    uint32_t InternString(const std::string& str);
+
+private:
+    std::vector<ReflectedParam> m_params;
+    std::vector<ReflectedCbVariable> m_variables;
+    std::string m_string_table;
+    std::unordered_map<std::string, uint32_t> m_interned_strings;
+};
+
+// non owning view over a blob, the memory has to outlive the view
+class ShaderReflectionBlobView
+{
+public:
+    ShaderReflectionBlobView() = default;
+    ~ShaderReflectionBlobView() = default;
+
+    // validates the header and every offset, returns false for a truncated or foreign blob
+    bool Parse(const void* data, size_t size);
+
+    uint32_t GetParamCount() const { return m_header->param_count; }
+    const ReflectedParam& GetParam(uint32_t index) const { return m_params[index]; }
+    const ReflectedCbVariable& GetVariable(uint32_t index) const { return m_variables[index]; }
+    const char* GetString(uint32_t offset) const { return m_string_table + offset; }
+
+private:
+    const ShaderReflectionBlobHeader* m_header = nullptr;
+    const ReflectedParam* m_params = nullptr;
+    const ReflectedCbVariable* m_variables = nullptr;
+    const char* m_string_table = nullptr;
+};
@@ -24,6 +24,8 @@ const Matrix Matrix::Identity = { 1.f, 0.f, 0.f, 0.f,
 								  0.f, 0.f, 1.f, 0.f,
 								  0.f, 0.f, 0.f, 1.f };
 
+const Quaternion Quaternion::Identity = { 0.f, 0.f, 0.f, 1.f };
+
 
 const float Math::Infinity = FLT_MAX;
 const float Math::Pi = 3.1415926535f;
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Vector3.h"
 #include "Vector4.h"
 #include "Matrix.h"
+#include "Quaternion.h"
 #include <Windows.h>
 #include <cstdint>
 #include <limits>
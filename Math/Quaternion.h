@@ -0,0 +1,332 @@
+// Modified version of DirectXTK12's source file
+
+//-------------------------------------------------------------------------------------
+// SimpleMath.h -- Simplified C++ Math wrapper for DirectXMath
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+// http://go.microsoft.com/fwlink/?LinkID=615561
+//-------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <DirectXMath.h>
+#include "Vector3.h"
+#include "Matrix.h"
+
+// Quaternion, q1 * q2 rotates by q1 then by q2 like row vector matrices
+struct Quaternion : public DirectX::XMFLOAT4
+{
+	Quaternion() noexcept : XMFLOAT4(0, 0, 0, 1.f) {}
+	constexpr Quaternion(float ix, float iy, float iz, float iw) noexcept : XMFLOAT4(ix, iy, iz, iw) {}
+	Quaternion(const Vector3& v, float scalar) noexcept : XMFLOAT4(v.x, v.y, v.z, scalar) {}
+	explicit Quaternion(_In_reads_(4) const float* pArray) noexcept : XMFLOAT4(pArray) {}
+	Quaternion(DirectX::FXMVECTOR V) noexcept { XMStoreFloat4(this, V); }
+	Quaternion(const XMFLOAT4& q) noexcept { this->x = q.x; this->y = q.y; this->z = q.z; this->w = q.w; }
+
+	Quaternion(const Quaternion&) = default;
+	Quaternion& operator=(const Quaternion&) = default;
+
+	Quaternion(Quaternion&&) = default;
+	Quaternion& operator=(Quaternion&&) = default;
+
+	operator DirectX::XMVECTOR() const  noexcept { return XMLoadFloat4(this); }
+
+	// Comparison operators
+	bool operator == (const Quaternion& q) const noexcept;
+	bool operator != (const Quaternion& q) const noexcept;
+
+	// Assignment operators
+	Quaternion& operator*= (const Quaternion& q) noexcept;
+	Quaternion& operator*= (float S) noexcept;
+
+	// Unary operators
+	Quaternion operator+ () const  noexcept { return *this; }
+	Quaternion operator- () const noexcept;
+
+	// Quaternion operations
+	float Length() const noexcept;
+	float LengthSquared() const noexcept;
+
+	void Normalize() noexcept;
+	void Normalize(Quaternion& result) const noexcept;
+
+	void Conjugate() noexcept;
+	void Conjugate(Quaternion& result) const noexcept;
+
+	void Inverse(Quaternion& result) const noexcept;
+
+	float Dot(const Quaternion& Q) const noexcept;
+
+	// Static functions
+	static Quaternion CreateFromAxisAngle(const Vector3& axis, float angle) noexcept;
+	static Quaternion CreateFromYawPitchRoll(float yaw, float pitch, float roll) noexcept;
+	static Quaternion CreateFromRotationMatrix(const Matrix& M) noexcept;
+
+	// shortest path, normalized
+	static Quaternion Lerp(const Quaternion& q1, const Quaternion& q2, float t) noexcept;
+	static Quaternion Slerp(const Quaternion& q1, const Quaternion& q2, float t) noexcept;
+
+	// q1 then q2
+	static Quaternion Concatenate(const Quaternion& q1, const Quaternion& q2) noexcept;
+
+	// Constants
+	static const Quaternion Identity;
+};
+
+
+//------------------------------------------------------------------------------
+// Comparision operators
+//------------------------------------------------------------------------------
+
+inline bool Quaternion::operator == (const Quaternion& q) const noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q1 = XMLoadFloat4(this);
+	XMVECTOR q2 = XMLoadFloat4(&q);
+	return XMQuaternionEqual(q1, q2);
+}
+
+inline bool Quaternion::operator != (const Quaternion& q) const noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q1 = XMLoadFloat4(this);
+	XMVECTOR q2 = XMLoadFloat4(&q);
+	return XMQuaternionNotEqual(q1, q2);
+}
+
+//------------------------------------------------------------------------------
+// Assignment operators
+//------------------------------------------------------------------------------
+
+inline Quaternion& Quaternion::operator*= (const Quaternion& q) noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q1 = XMLoadFloat4(this);
+	XMVECTOR q2 = XMLoadFloat4(&q);
+	XMStoreFloat4(this, XMQuaternionMultiply(q1, q2));
+	return *this;
+}
+
+inline Quaternion& Quaternion::operator*= (float S) noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q = XMLoadFloat4(this);
+	XMStoreFloat4(this, XMVectorScale(q, S));
+	return *this;
+}
+
+//------------------------------------------------------------------------------
+// Urnary operators
+//------------------------------------------------------------------------------
+
+inline Quaternion Quaternion::operator- () const noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q = XMLoadFloat4(this);
+
+	Quaternion R;
+	XMStoreFloat4(&R, XMVectorNegate(q));
+	return R;
+}
+
+//------------------------------------------------------------------------------
+// Binary operators
+//------------------------------------------------------------------------------
+
+inline Quaternion operator+ (const Quaternion& Q1, const Quaternion& Q2) noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q1 = XMLoadFloat4(&Q1);
+	XMVECTOR q2 = XMLoadFloat4(&Q2);
+
+	Quaternion R;
+	XMStoreFloat4(&R, XMVectorAdd(q1, q2));
+	return R;
+}
+
+inline Quaternion operator- (const Quaternion& Q1, const Quaternion& Q2) noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q1 = XMLoadFloat4(&Q1);
+	XMVECTOR q2 = XMLoadFloat4(&Q2);
+
+	Quaternion R;
+	XMStoreFloat4(&R, XMVectorSubtract(q1, q2));
+	return R;
+}
+
+inline Quaternion operator* (const Quaternion& Q1, const Quaternion& Q2) noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q1 = XMLoadFloat4(&Q1);
+	XMVECTOR q2 = XMLoadFloat4(&Q2);
+
+	Quaternion R;
+	XMStoreFloat4(&R, XMQuaternionMultiply(q1, q2));
+	return R;
+}
+
+inline Quaternion operator* (const Quaternion& Q, float S) noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q = XMLoadFloat4(&Q);
+
+	Quaternion R;
+	XMStoreFloat4(&R, XMVectorScale(q, S));
+	return R;
+}
+
+inline Quaternion operator* (float S, const Quaternion& Q) noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q1 = XMLoadFloat4(&Q);
+
+	Quaternion R;
+	XMStoreFloat4(&R, XMVectorScale(q1, S));
+	return R;
+}
+
+//------------------------------------------------------------------------------
+// Quaternion operations
+//------------------------------------------------------------------------------
+
+inline float Quaternion::Length() const noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q = XMLoadFloat4(this);
+	return XMVectorGetX(XMQuaternionLength(q));
+}
+
+inline float Quaternion::LengthSquared() const noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q = XMLoadFloat4(this);
+	return XMVectorGetX(XMQuaternionLengthSq(q));
+}
+
+inline void Quaternion::Normalize() noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q = XMLoadFloat4(this);
+	XMStoreFloat4(this, XMQuaternionNormalize(q));
+}
+
+inline void Quaternion::Normalize(Quaternion& result) const noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q = XMLoadFloat4(this);
+	XMStoreFloat4(&result, XMQuaternionNormalize(q));
+}
+
+inline void Quaternion::Conjugate() noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q = XMLoadFloat4(this);
+	XMStoreFloat4(this, XMQuaternionConjugate(q));
+}
+
+inline void Quaternion::Conjugate(Quaternion& result) const noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q = XMLoadFloat4(this);
+	XMStoreFloat4(&result, XMQuaternionConjugate(q));
+}
+
+inline void Quaternion::Inverse(Quaternion& result) const noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q = XMLoadFloat4(this);
+	XMStoreFloat4(&result, XMQuaternionInverse(q));
+}
+
+inline float Quaternion::Dot(const Quaternion& q) const noexcept
+{
+	using namespace DirectX;
+	XMVECTOR q1 = XMLoadFloat4(this);
+	XMVECTOR q2 = XMLoadFloat4(&q);
+	return XMVectorGetX(XMQuaternionDot(q1, q2));
+}
+
+//------------------------------------------------------------------------------
+// Static functions
+//------------------------------------------------------------------------------
+
+inline Quaternion Quaternion::CreateFromAxisAngle(const Vector3& axis, float angle) noexcept
+{
+	using namespace DirectX;
+	XMVECTOR a = XMLoadFloat3(&axis);
+
+	Quaternion R;
+	XMStoreFloat4(&R, XMQuaternionRotationAxis(a, angle));
+	return R;
+}
+
+inline Quaternion Quaternion::CreateFromYawPitchRoll(float yaw, float pitch, float roll) noexcept
+{
+	using namespace DirectX;
+	Quaternion R;
+	XMStoreFloat4(&R, XMQuaternionRotationRollPitchYaw(pitch, yaw, roll));
+	return R;
+}
+
+inline Quaternion Quaternion::CreateFromRotationMatrix(const Matrix& M) noexcept
+{
+	using namespace DirectX;
+	XMMATRIX M0 = XMLoadFloat4x4(&M);
+
+	Quaternion R;
+	XMStoreFloat4(&R, XMQuaternionRotationMatrix(M0));
+	return R;
+}
+
+inline Quaternion Quaternion::Lerp(const Quaternion& q1, const Quaternion& q2, float t) noexcept
+{
+	using namespace DirectX;
+	XMVECTOR Q0 = XMLoadFloat4(&q1);
+	XMVECTOR Q1 = XMLoadFloat4(&q2);
+
+	XMVECTOR dot = XMVector4Dot(Q0, Q1);
+
+	XMVECTOR R;
+	if (XMVector4GreaterOrEqual(dot, XMVectorZero()))
+	{
+		R = XMVectorLerp(Q0, Q1, t);
+	}
+	else
+	{
+		XMVECTOR tv = XMVectorReplicate(t);
+		XMVECTOR t1v = XMVectorReplicate(1.f - t);
+		XMVECTOR X0 = XMVectorMultiply(Q0, t1v);
+		XMVECTOR X1 = XMVectorMultiply(Q1, tv);
+		R = XMVectorSubtract(X0, X1);
+	}
+
+	Quaternion result;
+	XMStoreFloat4(&result, XMQuaternionNormalize(R));
+	return result;
+}
+
+inline Quaternion Quaternion::Slerp(const Quaternion& q1, const Quaternion& q2, float t) noexcept
+{
+	using namespace DirectX;
+	XMVECTOR Q0 = XMLoadFloat4(&q1);
+	XMVECTOR Q1 = XMLoadFloat4(&q2);
+
+	Quaternion result;
+	XMStoreFloat4(&result, XMQuaternionSlerp(Q0, Q1, t));
+	return result;
+}
+
+inline Quaternion Quaternion::Concatenate(const Quaternion& q1, const Quaternion& q2) noexcept
+{
+	using namespace DirectX;
+	XMVECTOR Q0 = XMLoadFloat4(&q1);
+	XMVECTOR Q1 = XMLoadFloat4(&q2);
+
+	Quaternion result;
+	XMStoreFloat4(&result, XMQuaternionMultiply(Q0, Q1));
+	return result;
+}
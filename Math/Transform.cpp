@@ -1,3 +1,492 @@
 #include "Transform.h"
+#include <cmath>
 
-const Rotator Rotator::Zero = { 0.f, 0.f, 0.f };
\ No newline at end of file
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define TRANSFORM_SSE 1
+#include <immintrin.h>
+#endif
+
+const Rotator Rotator::Zero = { 0.f, 0.f, 0.f };
+
+namespace
+{
+    // minimax polynomials of sin and cos on [-pi/4, pi/4], from cephes sinf / cosf
+    const float k_sin_c0 = -1.9515295891e-4f;
+    const float k_sin_c1 = 8.3321608736e-3f;
+    const float k_sin_c2 = -1.6666654611e-1f;
+    const float k_cos_c0 = 2.443315711809948e-5f;
+    const float k_cos_c1 = -1.388731625493765e-3f;
+    const float k_cos_c2 = 4.166664568298827e-2f;
+    const float k_radians_per_degree = 0.0174532925199432958f;
+
+    // the angle is reduced in degrees, where the quadrant boundaries are exact multiples of 90
+    // odd quadrants swap sin and cos, quadrants 2 and 3 negate sin, 1 and 2 negate cos
+    void SinCosDegrees(float degrees, float& sin, float& cos)
+    {
+        float quadrant = std::nearbyint(degrees * (1.0f / 90.0f));
+        float x = (degrees - quadrant * 90.0f) * k_radians_per_degree;
+        float z = x * x;
+        float s = x + x * z * ((k_sin_c0 * z + k_sin_c1) * z + k_sin_c2);
+        float c = 1.0f - 0.5f * z + z * z * ((k_cos_c0 * z + k_cos_c1) * z + k_cos_c2);
+
+        int q = (int)quadrant;
+        sin = (q & 1) ? c : s;
+        cos = (q & 1) ? s : c;
+        sin = (q & 2) ? -sin : sin;
+        cos = ((q + 1) & 2) ? -cos : cos;
+    }
+
+    // half angles of XMQuaternionRotationRollPitchYaw, whose matrix is Matrix::CreateFromYawPitchRoll
+    Quaternion HalfAnglesToQuaternion(float sr, float cr, float sp, float cp, float sy, float cy)
+    {
+        return Quaternion(
+            sp * cy * cr + cp * sy * sr,
+            cp * sy * cr - sp * cy * sr,
+            cp * cy * sr - sp * sy * cr,
+            cp * cy * cr + sp * sy * sr);
+    }
+
+    // rows are scale * (rows of XMMatrixRotationQuaternion), then the translation
+    void WriteMatrix(const TransformArrays& transforms, uint32_t i, Matrix& out)
+    {
+        float x = transforms.rotation_x[i];
+        float y = transforms.rotation_y[i];
+        float z = transforms.rotation_z[i];
+        float w = transforms.rotation_w[i];
+        float xx = x * (x + x), yy = y * (y + y), zz = z * (z + z);
+        float xy = x * (y + y), xz = x * (z + z), yz = y * (z + z);
+        float wx = w * (x + x), wy = w * (y + y), wz = w * (z + z);
+
+        float scale_x = transforms.scale_x[i];
+        float scale_y = transforms.scale_y[i];
+        float scale_z = transforms.scale_z[i];
+        out._11 = (1.0f - yy - zz) * scale_x;
+        out._12 = (xy + wz) * scale_x;
+        out._13 = (xz - wy) * scale_x;
+        out._14 = 0.0f;
+        out._21 = (xy - wz) * scale_y;
+        out._22 = (1.0f - xx - zz) * scale_y;
+        out._23 = (yz + wx) * scale_y;
+        out._24 = 0.0f;
+        out._31 = (xz + wy) * scale_z;
+        out._32 = (yz - wx) * scale_z;
+        out._33 = (1.0f - xx - yy) * scale_z;
+        out._34 = 0.0f;
+        out._41 = transforms.location_x[i];
+        out._42 = transforms.location_y[i];
+        out._43 = transforms.location_z[i];
+        out._44 = 1.0f;
+    }
+
+    // slerp as polynomials in the cosine of the angle, "A Fast and Accurate Algorithm for Computing SLERP" (Eberly)
+    // u[i] = 1 / (i (2i + 1)), v[i] = i / (2i + 1), the last pair is scaled to cancel most of the truncation error
+    const int k_slerp_terms = 16;
+    const float k_slerp_mu = 1.90110745351730037f;
+    const float k_slerp_u[k_slerp_terms] =
+    {
+        1.0f / (1 * 3), 1.0f / (2 * 5), 1.0f / (3 * 7), 1.0f / (4 * 9), 1.0f / (5 * 11), 1.0f / (6 * 13), 1.0f / (7 * 15), 1.0f / (8 * 17),
+        1.0f / (9 * 19), 1.0f / (10 * 21), 1.0f / (11 * 23), 1.0f / (12 * 25), 1.0f / (13 * 27), 1.0f / (14 * 29), 1.0f / (15 * 31), k_slerp_mu / (16 * 33),
+    };
+    const float k_slerp_v[k_slerp_terms] =
+    {
+        1.0f / 3, 2.0f / 5, 3.0f / 7, 4.0f / 9, 5.0f / 11, 6.0f / 13, 7.0f / 15, 8.0f / 17,
+        9.0f / 19, 10.0f / 21, 11.0f / 23, 12.0f / 25, 13.0f / 27, 14.0f / 29, 15.0f / 31, k_slerp_mu * 16 / 33,
+    };
+
+    // weights of from and to, the cosine has to be >= 0
+    void SlerpWeights(float cos_angle, float t, float& from_weight, float& to_weight)
+    {
+        float x_minus_one = cos_angle - 1.0f;
+        float d = 1.0f - t;
+        float f_t = 1.0f;
+        float f_d = 1.0f;
+        for(int i=k_slerp_terms - 1; i>=0; i--)
+        {
+            f_t = 1.0f + (k_slerp_u[i] * t * t - k_slerp_v[i]) * x_minus_one * f_t;
+            f_d = 1.0f + (k_slerp_u[i] * d * d - k_slerp_v[i]) * x_minus_one * f_d;
+        }
+        from_weight = d * f_d;
+        to_weight = t * f_t;
+    }
+
+    Quaternion Nlerp(const Quaternion& from, const Quaternion& to, float t)
+    {
+        float dot = from.x * to.x + from.y * to.y + from.z * to.z + from.w * to.w;
+        float to_weight = dot < 0.0f ? -t : t;
+        float from_weight = 1.0f - t;
+        Quaternion result(
+            from.x * from_weight + to.x * to_weight,
+            from.y * from_weight + to.y * to_weight,
+            from.z * from_weight + to.z * to_weight,
+            from.w * from_weight + to.w * to_weight);
+        float inv_length = 1.0f / std::sqrt(result.x * result.x + result.y * result.y + result.z * result.z + result.w * result.w);
+        return Quaternion(result.x * inv_length, result.y * inv_length, result.z * inv_length, result.w * inv_length);
+    }
+
+    Quaternion Slerp(const Quaternion& from, const Quaternion& to, float t)
+    {
+        float dot = from.x * to.x + from.y * to.y + from.z * to.z + from.w * to.w;
+        float from_weight, to_weight;
+        SlerpWeights(std::fabs(dot), t, from_weight, to_weight);
+        to_weight = dot < 0.0f ? -to_weight : to_weight;
+        return Quaternion(
+            from.x * from_weight + to.x * to_weight,
+            from.y * from_weight + to.y * to_weight,
+            from.z * from_weight + to.z * to_weight,
+            from.w * from_weight + to.w * to_weight);
+    }
+
+#if defined(TRANSFORM_SSE)
+    void SinCosDegrees(__m128 degrees, __m128& sin, __m128& cos)
+    {
+        __m128i quadrant = _mm_cvtps_epi32(_mm_mul_ps(degrees, _mm_set1_ps(1.0f / 90.0f)));
+        __m128 x = _mm_mul_ps(_mm_sub_ps(degrees, _mm_mul_ps(_mm_cvtepi32_ps(quadrant), _mm_set1_ps(90.0f))), _mm_set1_ps(k_radians_per_degree));
+        __m128 z = _mm_mul_ps(x, x);
+        __m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(k_sin_c0), z), _mm_set1_ps(k_sin_c1));
+        s = _mm_add_ps(_mm_mul_ps(s, z), _mm_set1_ps(k_sin_c2));
+        s = _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(x, z), s));
+        __m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(k_cos_c0), z), _mm_set1_ps(k_cos_c1));
+        c = _mm_add_ps(_mm_mul_ps(c, z), _mm_set1_ps(k_cos_c2));
+        c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_mul_ps(_mm_mul_ps(z, z), c));
+
+        __m128i one = _mm_set1_epi32(1);
+        __m128i two = _mm_set1_epi32(2);
+        __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one));
+        __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(quadrant, two), 30));
+        __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), 30));
+        sin = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sin_sign);
+        cos = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cos_sign);
+    }
+
+    // x, y, z, w hold one matrix row of 4 transforms, written to that row of out[0..3]
+    void StoreRows(__m128 x, __m128 y, __m128 z, __m128 w, int row, Matrix* out)
+    {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(&out[0]._11 + row * 4, x);
+        _mm_storeu_ps(&out[1]._11 + row * 4, y);
+        _mm_storeu_ps(&out[2]._11 + row * 4, z);
+        _mm_storeu_ps(&out[3]._11 + row * 4, w);
+    }
+
+    // quaternions are 16 bytes, 4 of them transpose to and from one register per component
+    void LoadQuaternions(const Quaternion* in, __m128& x, __m128& y, __m128& z, __m128& w)
+    {
+        x = _mm_loadu_ps(&in[0].x);
+        y = _mm_loadu_ps(&in[1].x);
+        z = _mm_loadu_ps(&in[2].x);
+        w = _mm_loadu_ps(&in[3].x);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+    }
+
+    void StoreQuaternions(__m128 x, __m128 y, __m128 z, __m128 w, Quaternion* out)
+    {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(&out[0].x, x);
+        _mm_storeu_ps(&out[1].x, y);
+        _mm_storeu_ps(&out[2].x, z);
+        _mm_storeu_ps(&out[3].x, w);
+    }
+
+    uint32_t GetMatricesSSE(const TransformArrays& transforms, uint32_t begin, uint32_t end, Matrix* out_matrices)
+    {
+        uint32_t i = begin;
+        for(; i + 4 <= end; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(transforms.rotation_x + i);
+            __m128 y = _mm_loadu_ps(transforms.rotation_y + i);
+            __m128 z = _mm_loadu_ps(transforms.rotation_z + i);
+            __m128 w = _mm_loadu_ps(transforms.rotation_w + i);
+            __m128 x2 = _mm_add_ps(x, x);
+            __m128 y2 = _mm_add_ps(y, y);
+            __m128 z2 = _mm_add_ps(z, z);
+            __m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+            __m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+            __m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+            __m128 scale_x = _mm_loadu_ps(transforms.scale_x + i);
+            __m128 scale_y = _mm_loadu_ps(transforms.scale_y + i);
+            __m128 scale_z = _mm_loadu_ps(transforms.scale_z + i);
+            __m128 one = _mm_set1_ps(1.0f);
+            __m128 zero = _mm_setzero_ps();
+
+            StoreRows(
+                _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), scale_x),
+                _mm_mul_ps(_mm_add_ps(xy, wz), scale_x),
+                _mm_mul_ps(_mm_sub_ps(xz, wy), scale_x),
+                zero, 0, out_matrices + i);
+            StoreRows(
+                _mm_mul_ps(_mm_sub_ps(xy, wz), scale_y),
+                _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), scale_y),
+                _mm_mul_ps(_mm_add_ps(yz, wx), scale_y),
+                zero, 1, out_matrices + i);
+            StoreRows(
+                _mm_mul_ps(_mm_add_ps(xz, wy), scale_z),
+                _mm_mul_ps(_mm_sub_ps(yz, wx), scale_z),
+                _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), scale_z),
+                zero, 2, out_matrices + i);
+            StoreRows(
+                _mm_loadu_ps(transforms.location_x + i),
+                _mm_loadu_ps(transforms.location_y + i),
+                _mm_loadu_ps(transforms.location_z + i),
+                one, 3, out_matrices + i);
+        }
+        return i;
+    }
+
+    uint32_t RotatorsToQuaternionsSSE(const float* roll, const float* pitch, const float* yaw, uint32_t count, Quaternion* out_rotations)
+    {
+        uint32_t i = 0;
+        __m128 half = _mm_set1_ps(0.5f);
+        for(; i + 4 <= count; i += 4)
+        {
+            __m128 sr, cr, sp, cp, sy, cy;
+            SinCosDegrees(_mm_mul_ps(_mm_loadu_ps(roll + i), half), sr, cr);
+            SinCosDegrees(_mm_mul_ps(_mm_loadu_ps(pitch + i), half), sp, cp);
+            SinCosDegrees(_mm_mul_ps(_mm_loadu_ps(yaw + i), half), sy, cy);
+            __m128 sp_cy = _mm_mul_ps(sp, cy);
+            __m128 cp_sy = _mm_mul_ps(cp, sy);
+            __m128 cp_cy = _mm_mul_ps(cp, cy);
+            __m128 sp_sy = _mm_mul_ps(sp, sy);
+
+            StoreQuaternions(
+                _mm_add_ps(_mm_mul_ps(sp_cy, cr), _mm_mul_ps(cp_sy, sr)),
+                _mm_sub_ps(_mm_mul_ps(cp_sy, cr), _mm_mul_ps(sp_cy, sr)),
+                _mm_sub_ps(_mm_mul_ps(cp_cy, sr), _mm_mul_ps(sp_sy, cr)),
+                _mm_add_ps(_mm_mul_ps(cp_cy, cr), _mm_mul_ps(sp_sy, sr)),
+                out_rotations + i);
+        }
+        return i;
+    }
+
+    // to is negated where the dot is negative, the returned dot is then >= 0
+    __m128 ShortestPath(__m128 fx, __m128 fy, __m128 fz, __m128 fw, __m128& tx, __m128& ty, __m128& tz, __m128& tw)
+    {
+        __m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(fx, tx), _mm_mul_ps(fy, ty)), _mm_add_ps(_mm_mul_ps(fz, tz), _mm_mul_ps(fw, tw)));
+        __m128 sign = _mm_and_ps(dot, _mm_set1_ps(-0.0f));
+        tx = _mm_xor_ps(tx, sign);
+        ty = _mm_xor_ps(ty, sign);
+        tz = _mm_xor_ps(tz, sign);
+        tw = _mm_xor_ps(tw, sign);
+        return _mm_xor_ps(dot, sign);
+    }
+
+    uint32_t NlerpRotationsSSE(const Quaternion* from, const Quaternion* to, const float* t, uint32_t count, Quaternion* out_rotations)
+    {
+        uint32_t i = 0;
+        for(; i + 4 <= count; i += 4)
+        {
+            __m128 fx, fy, fz, fw, tx, ty, tz, tw;
+            LoadQuaternions(from + i, fx, fy, fz, fw);
+            LoadQuaternions(to + i, tx, ty, tz, tw);
+            ShortestPath(fx, fy, fz, fw, tx, ty, tz, tw);
+
+            __m128 t4 = _mm_loadu_ps(t + i);
+            __m128 x = _mm_add_ps(fx, _mm_mul_ps(_mm_sub_ps(tx, fx), t4));
+            __m128 y = _mm_add_ps(fy, _mm_mul_ps(_mm_sub_ps(ty, fy), t4));
+            __m128 z = _mm_add_ps(fz, _mm_mul_ps(_mm_sub_ps(tz, fz), t4));
+            __m128 w = _mm_add_ps(fw, _mm_mul_ps(_mm_sub_ps(tw, fw), t4));
+            __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w))));
+            StoreQuaternions(_mm_div_ps(x, length), _mm_div_ps(y, length), _mm_div_ps(z, length), _mm_div_ps(w, length), out_rotations + i);
+        }
+        return i;
+    }
+
+    uint32_t SlerpRotationsSSE(const Quaternion* from, const Quaternion* to, const float* t, uint32_t count, Quaternion* out_rotations)
+    {
+        uint32_t i = 0;
+        __m128 one = _mm_set1_ps(1.0f);
+        for(; i + 4 <= count; i += 4)
+        {
+            __m128 fx, fy, fz, fw, tx, ty, tz, tw;
+            LoadQuaternions(from + i, fx, fy, fz, fw);
+            LoadQuaternions(to + i, tx, ty, tz, tw);
+            __m128 x_minus_one = _mm_sub_ps(ShortestPath(fx, fy, fz, fw, tx, ty, tz, tw), one);
+
+            __m128 t4 = _mm_loadu_ps(t + i);
+            __m128 d4 = _mm_sub_ps(one, t4);
+            __m128 sqr_t = _mm_mul_ps(t4, t4);
+            __m128 sqr_d = _mm_mul_ps(d4, d4);
+            __m128 f_t = one;
+            __m128 f_d = one;
+            for(int k=k_slerp_terms - 1; k>=0; k--)
+            {
+                __m128 u = _mm_set1_ps(k_slerp_u[k]);
+                __m128 v = _mm_set1_ps(k_slerp_v[k]);
+                f_t = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, sqr_t), v), x_minus_one), f_t));
+                f_d = _mm_add_ps(one, _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, sqr_d), v), x_minus_one), f_d));
+            }
+            __m128 to_weight = _mm_mul_ps(t4, f_t);
+            __m128 from_weight = _mm_mul_ps(d4, f_d);
+
+            StoreQuaternions(
+                _mm_add_ps(_mm_mul_ps(fx, from_weight), _mm_mul_ps(tx, to_weight)),
+                _mm_add_ps(_mm_mul_ps(fy, from_weight), _mm_mul_ps(ty, to_weight)),
+                _mm_add_ps(_mm_mul_ps(fz, from_weight), _mm_mul_ps(tz, to_weight)),
+                _mm_add_ps(_mm_mul_ps(fw, from_weight), _mm_mul_ps(tw, to_weight)),
+                out_rotations + i);
+        }
+        return i;
+    }
+#endif
+
+#if defined(__AVX2__)
+    // 8 transforms, the low and high halves are transposed like the sse path
+    void StoreRows(__m256 x, __m256 y, __m256 z, __m256 w, int row, Matrix* out)
+    {
+        StoreRows(_mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z), _mm256_castps256_ps128(w), row, out);
+        StoreRows(_mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1), _mm256_extractf128_ps(w, 1), row, out + 4);
+    }
+
+    uint32_t GetMatricesAVX2(const TransformArrays& transforms, uint32_t begin, uint32_t end, Matrix* out_matrices)
+    {
+        uint32_t i = begin;
+        for(; i + 8 <= end; i += 8)
+        {
+            __m256 x = _mm256_loadu_ps(transforms.rotation_x + i);
+            __m256 y = _mm256_loadu_ps(transforms.rotation_y + i);
+            __m256 z = _mm256_loadu_ps(transforms.rotation_z + i);
+            __m256 w = _mm256_loadu_ps(transforms.rotation_w + i);
+            __m256 x2 = _mm256_add_ps(x, x);
+            __m256 y2 = _mm256_add_ps(y, y);
+            __m256 z2 = _mm256_add_ps(z, z);
+            __m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+            __m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+            __m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+            __m256 scale_x = _mm256_loadu_ps(transforms.scale_x + i);
+            __m256 scale_y = _mm256_loadu_ps(transforms.scale_y + i);
+            __m256 scale_z = _mm256_loadu_ps(transforms.scale_z + i);
+            __m256 one = _mm256_set1_ps(1.0f);
+            __m256 zero = _mm256_setzero_ps();
+
+            StoreRows(
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), scale_x),
+                _mm256_mul_ps(_mm256_add_ps(xy, wz), scale_x),
+                _mm256_mul_ps(_mm256_sub_ps(xz, wy), scale_x),
+                zero, 0, out_matrices + i);
+            StoreRows(
+                _mm256_mul_ps(_mm256_sub_ps(xy, wz), scale_y),
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), scale_y),
+                _mm256_mul_ps(_mm256_add_ps(yz, wx), scale_y),
+                zero, 1, out_matrices + i);
+            StoreRows(
+                _mm256_mul_ps(_mm256_add_ps(xz, wy), scale_z),
+                _mm256_mul_ps(_mm256_sub_ps(yz, wx), scale_z),
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), scale_z),
+                zero, 2, out_matrices + i);
+            StoreRows(
+                _mm256_loadu_ps(transforms.location_x + i),
+                _mm256_loadu_ps(transforms.location_y + i),
+                _mm256_loadu_ps(transforms.location_z + i),
+                one, 3, out_matrices + i);
+        }
+        return i;
+    }
+#endif
+}
+
+Matrix Transform::GetTransformMatrixLH() const
+{
+    TransformArrays transform;
+    transform.location_x = &Location.x;
+    transform.location_y = &Location.y;
+    transform.location_z = &Location.z;
+    transform.rotation_x = &Rotation.x;
+    transform.rotation_y = &Rotation.y;
+    transform.rotation_z = &Rotation.z;
+    transform.rotation_w = &Rotation.w;
+    transform.scale_x = &Scale.x;
+    transform.scale_y = &Scale.y;
+    transform.scale_z = &Scale.z;
+
+    Matrix matrix;
+    WriteMatrix(transform, 0, matrix);
+    return matrix;
+}
+
+Quaternion Transform::RotatorToQuaternion(const Rotator& rotator)
+{
+    float sr, cr, sp, cp, sy, cy;
+    SinCosDegrees(rotator.Roll * 0.5f, sr, cr);
+    SinCosDegrees(rotator.Pitch * 0.5f, sp, cp);
+    SinCosDegrees(rotator.Yaw * 0.5f, sy, cy);
+    return HalfAnglesToQuaternion(sr, cr, sp, cp, sy, cy);
+}
+
+Rotator Transform::QuaternionToRotator(const Quaternion& rotation)
+{
+    // from the matrix, _32 = -sin(pitch) and (_12, _22) = cos(pitch) (sin(roll), cos(roll)),
+    // the yaw comes from the first row with the roll undone, which stays accurate near +-90 pitch
+    float x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+    float m11 = 1.0f - 2.0f * (y * y + z * z);
+    float m12 = 2.0f * (x * y + z * w);
+    float m13 = 2.0f * (x * z - y * w);
+    float m21 = 2.0f * (x * y - z * w);
+    float m22 = 1.0f - 2.0f * (x * x + z * z);
+    float m23 = 2.0f * (y * z + x * w);
+    float sin_pitch = 2.0f * (x * w - y * z);
+    float cos_pitch = std::sqrt(m12 * m12 + m22 * m22);
+
+    // at +-90 pitch only yaw - roll (or yaw + roll) is defined, the roll is then 0
+    float sin_roll = cos_pitch > 1e-6f ? m12 / cos_pitch : 0.0f;
+    float cos_roll = cos_pitch > 1e-6f ? m22 / cos_pitch : 1.0f;
+
+    Rotator rotator;
+    rotator.Pitch = Math::RadiansToDegrees(std::atan2(sin_pitch, cos_pitch));
+    rotator.Roll = Math::RadiansToDegrees(std::atan2(sin_roll, cos_roll));
+    rotator.Yaw = Math::RadiansToDegrees(std::atan2(sin_roll * m23 - cos_roll * m13, cos_roll * m11 - sin_roll * m21));
+    return rotator;
+}
+
+void Transform::GetTransformMatricesLH(const TransformArrays& transforms, uint32_t count, Matrix* out_matrices)
+{
+    uint32_t i = 0;
+#if defined(__AVX2__)
+    i = GetMatricesAVX2(transforms, i, count, out_matrices);
+#endif
+#if defined(TRANSFORM_SSE)
+    i = GetMatricesSSE(transforms, i, count, out_matrices);
+#endif
+
+    for(; i<count; i++)
+    {
+        WriteMatrix(transforms, i, out_matrices[i]);
+    }
+}
+
+void Transform::RotatorsToQuaternions(const float* roll, const float* pitch, const float* yaw, uint32_t count, Quaternion* out_rotations)
+{
+    uint32_t i = 0;
+#if defined(TRANSFORM_SSE)
+    i = RotatorsToQuaternionsSSE(roll, pitch, yaw, count, out_rotations);
+#endif
+
+    for(; i<count; i++)
+    {
+        out_rotations[i] = RotatorToQuaternion(Rotator(roll[i], pitch[i], yaw[i]));
+    }
+}
+
+void Transform::NlerpRotations(const Quaternion* from, const Quaternion* to, const float* t, uint32_t count, Quaternion* out_rotations)
+{
+    uint32_t i = 0;
+#if defined(TRANSFORM_SSE)
+    i = NlerpRotationsSSE(from, to, t, count, out_rotations);
+#endif
+
+    for(; i<count; i++)
+    {
+        out_rotations[i] = Nlerp(from[i], to[i], t[i]);
+    }
+}
+
+void Transform::SlerpRotations(const Quaternion* from, const Quaternion* to, const float* t, uint32_t count, Quaternion* out_rotations)
+{
+    uint32_t i = 0;
+#if defined(TRANSFORM_SSE)
+    i = SlerpRotationsSSE(from, to, t, count, out_rotations);
+#endif
+
+    for(; i<count; i++)
+    {
+        out_rotations[i] = Slerp(from[i], to[i], t[i]);
+    }
+}
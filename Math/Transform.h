@@ -19,32 +19,137 @@ struct Rotator
 	static const Rotator Zero;
 };
 
+// count transforms as parallel arrays, rotations are unit quaternions like Transform::Rotation
+struct TransformArrays
+{
+	const float* location_x = nullptr;
+	const float* location_y = nullptr;
+	const float* location_z = nullptr;
+	const float* rotation_x = nullptr;
+	const float* rotation_y = nullptr;
+	const float* rotation_z = nullptr;
+	const float* rotation_w = nullptr;
+	const float* scale_x = nullptr;
+	const float* scale_y = nullptr;
+	const float* scale_z = nullptr;
+};
+
+// scale, then rotation, then translation
+// the rotation is kept as a unit quaternion, Rotator is only converted from and to for editing and files
 class Transform
 {
 public:
 	Vector3 Location;
-	Rotator Rotation;
+	Quaternion Rotation;
 	Vector3 Scale;
 
 public:
 	Transform()
 	{
 		Location = Vector3::Zero;
-		Rotation = Rotator::Zero;
+		Rotation = Quaternion::Identity;
 		Scale = Vector3::One;
 	}
 
-	Matrix GetTransformMatrixLH() const
-	{
-		Matrix S = Matrix::CreateScale(Scale);
-		Matrix R = Matrix::CreateFromYawPitchRoll(Math::DegreesToRadians(Rotation.Yaw), Math::DegreesToRadians(Rotation.Pitch), Math::DegreesToRadians(Rotation.Roll));
-		Matrix T = Matrix::CreateTranslation(Location);
+	Transform(const Vector3& location, const Quaternion& rotation, const Vector3& scale)
+		:Location(location), Rotation(rotation), Scale(scale)
+	{}
 
-		return S * R * T;
-	}
+	Rotator GetRotator() const { return QuaternionToRotator(Rotation); }
+	void SetRotator(const Rotator& rotator) { Rotation = RotatorToQuaternion(rotator); }
+
+	// the matrix of GetRotator() is Matrix::CreateFromYawPitchRoll, so both paths agree
+	Matrix GetTransformMatrixLH() const;
 
     Matrix GetTransformMatrixRH() const
     {
         return GetTransformMatrixLH().Transpose();
     }
+
+	// this transform then parent, like this matrix * parent matrix
+	// scales multiply per axis, which drops the shear a non uniform parent scale puts on a rotated child
+	Transform operator*(const Transform& parent) const;
+	// exact for uniform scale, for non uniform scale only the rotation and scale are
+	Transform Inverse() const;
+
+	Vector3 TransformPosition(const Vector3& position) const;
+	// no translation
+	Vector3 TransformVector(const Vector3& vector) const;
+	Vector3 InverseTransformPosition(const Vector3& position) const;
+	Vector3 InverseTransformVector(const Vector3& vector) const;
+
+	static Vector3 RotateVector(const Quaternion& rotation, const Vector3& vector);
+	static Vector3 InverseRotateVector(const Quaternion& rotation, const Vector3& vector);
+
+	static Quaternion RotatorToQuaternion(const Rotator& rotator);
+	// pitch in [-90, 90], at +-90 the roll is folded into the yaw
+	static Rotator QuaternionToRotator(const Quaternion& rotation);
+
+	// GetTransformMatrixLH of count transforms, each matrix is written in one go without intermediate matrices
+	// 8 transforms per step with AVX2, 4 with SSE2, the rest one by one
+	static void GetTransformMatricesLH(const TransformArrays& transforms, uint32_t count, Matrix* out_matrices);
+	// RotatorToQuaternion of count rotations in degrees, sin/cos are polynomials accurate to a few ulp
+	static void RotatorsToQuaternions(const float* roll, const float* pitch, const float* yaw, uint32_t count, Quaternion* out_rotations);
+	// shortest path interpolation of from[i] to to[i] by t[i], 4 rotations per step with SSE2
+	// nlerp is normalized, slerp evaluates a polynomial instead of acos and sin, within 1e-6 of the exact slerp
+	static void NlerpRotations(const Quaternion* from, const Quaternion* to, const float* t, uint32_t count, Quaternion* out_rotations);
+	static void SlerpRotations(const Quaternion* from, const Quaternion* to, const float* t, uint32_t count, Quaternion* out_rotations);
 };
+
+inline Vector3 Transform::RotateVector(const Quaternion& rotation, const Vector3& vector)
+{
+	// v + w * t + u x t with t = 2 * (u x v), u the vector part
+	float tx = 2.0f * (rotation.y * vector.z - rotation.z * vector.y);
+	float ty = 2.0f * (rotation.z * vector.x - rotation.x * vector.z);
+	float tz = 2.0f * (rotation.x * vector.y - rotation.y * vector.x);
+	return Vector3(
+		vector.x + rotation.w * tx + rotation.y * tz - rotation.z * ty,
+		vector.y + rotation.w * ty + rotation.z * tx - rotation.x * tz,
+		vector.z + rotation.w * tz + rotation.x * ty - rotation.y * tx);
+}
+
+inline Vector3 Transform::InverseRotateVector(const Quaternion& rotation, const Vector3& vector)
+{
+	return RotateVector(Quaternion(-rotation.x, -rotation.y, -rotation.z, rotation.w), vector);
+}
+
+inline Transform Transform::operator*(const Transform& parent) const
+{
+	Transform result;
+	result.Scale = Vector3(Scale.x * parent.Scale.x, Scale.y * parent.Scale.y, Scale.z * parent.Scale.z);
+	result.Rotation = Rotation * parent.Rotation;
+	result.Location = parent.TransformPosition(Location);
+	return result;
+}
+
+inline Transform Transform::Inverse() const
+{
+	Transform result;
+	result.Scale = Vector3(1.0f / Scale.x, 1.0f / Scale.y, 1.0f / Scale.z);
+	result.Rotation = Quaternion(-Rotation.x, -Rotation.y, -Rotation.z, Rotation.w);
+	Vector3 location = InverseRotateVector(Rotation, Location);
+	result.Location = Vector3(-location.x * result.Scale.x, -location.y * result.Scale.y, -location.z * result.Scale.z);
+	return result;
+}
+
+inline Vector3 Transform::TransformPosition(const Vector3& position) const
+{
+	Vector3 rotated = RotateVector(Rotation, Vector3(position.x * Scale.x, position.y * Scale.y, position.z * Scale.z));
+	return Vector3(rotated.x + Location.x, rotated.y + Location.y, rotated.z + Location.z);
+}
+
+inline Vector3 Transform::TransformVector(const Vector3& vector) const
+{
+	return RotateVector(Rotation, Vector3(vector.x * Scale.x, vector.y * Scale.y, vector.z * Scale.z));
+}
+
+inline Vector3 Transform::InverseTransformPosition(const Vector3& position) const
+{
+	return InverseTransformVector(Vector3(position.x - Location.x, position.y - Location.y, position.z - Location.z));
+}
+
+inline Vector3 Transform::InverseTransformVector(const Vector3& vector) const
+{
+	Vector3 unrotated = InverseRotateVector(Rotation, vector);
+	return Vector3(unrotated.x / Scale.x, unrotated.y / Scale.y, unrotated.z / Scale.z);
+}
@@ -1,8 +1,47 @@
 #include "Mesh.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 
 void Mesh::SetVerticesCPU(const std::vector<Vertex> &vertices)
 {
     m_vertices.assign(vertices.begin(), vertices.end());
+
+    // sphere around the box center, not minimal but cheap and good enough for culling
+    if(m_vertices.empty())
+    {
+        m_bounds_center = { 0.0f, 0.0f, 0.0f };
+        m_bounds_radius = 0.0f;
+        m_bounds_extents = { 0.0f, 0.0f, 0.0f };
+        return;
+    }
+
+    DirectX::XMVECTOR box_min = DirectX::XMLoadFloat3(&m_vertices[0].Position);
+    DirectX::XMVECTOR box_max = box_min;
+    for(const Vertex& vertex : m_vertices)
+    {
+        DirectX::XMVECTOR position = DirectX::XMLoadFloat3(&vertex.Position);
+        box_min = DirectX::XMVectorMin(box_min, position);
+        box_max = DirectX::XMVectorMax(box_max, position);
+    }
+    DirectX::XMVECTOR center = DirectX::XMVectorScale(DirectX::XMVectorAdd(box_min, box_max), 0.5f);
+
+    float radius_sq = 0.0f;
+    for(const Vertex& vertex : m_vertices)
+    {
+        DirectX::XMVECTOR offset = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&vertex.Position), center);
+        radius_sq = std::max(radius_sq, DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(offset)));
+    }
+    DirectX::XMStoreFloat3(&m_bounds_center, center);
+    DirectX::XMStoreFloat3(&m_bounds_extents, DirectX::XMVectorScale(DirectX::XMVectorSubtract(box_max, box_min), 0.5f));
+    m_bounds_radius = std::sqrt(radius_sq);
+}
+
+void Mesh::AddLOD(Mesh* lod_mesh)
+{
+    assert(m_lod_count < k_max_lods);
+    assert(lod_mesh->GetGeometricError() >= GetLODMesh(m_lod_count - 1)->GetGeometricError());
+    m_lod_meshes[m_lod_count++] = lod_mesh;
 }
 
 void Mesh::SetIndicesCPU(const std::vector<std::uint16_t> &indices)
@@ -32,3 +71,13 @@ void Mesh::ReleaseUploadBuffer()
     m_vertex_buf.ReleaseUploadBuffer();
     m_index_buf.ReleaseUploadBuffer();
 }
+
+void Mesh::BuildBVH()
+{
+    if(m_vertices.empty() || m_indices16.empty())
+    {
+        m_bvh.Clear();
+        return;
+    }
+    m_bvh.Build(&m_vertices[0].Position.x, sizeof(Vertex), m_indices16.data(), (uint32_t)m_indices16.size());
+}
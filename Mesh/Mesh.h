@@ -2,20 +2,47 @@
 #include <vector>
 #include "D3DRHI/D3D12Buffer.h"
 #include "Vertex.h"
+#include "Scene/MeshBVH.h"
 
 class Mesh
 {
 public:
+    static const uint32_t k_max_lods = 4;
+
     Mesh() = default;
     ~Mesh() = default;
 
     void SetVerticesCPU(const std::vector<Vertex>& vertices);
     void SetIndicesCPU(const std::vector<std::uint16_t>& indices);
     size_t GetIndicesCount() const { return m_indices16.size(); }
+    const std::vector<Vertex>& GetVerticesCPU() const { return m_vertices; }
+    const std::vector<std::uint16_t>& GetIndicesCPU() const { return m_indices16; }
     void UploadDataToGPU(ID3D12Device* device, ID3D12GraphicsCommandList* cmd_list);
     void ReleaseUploadBuffer();
     D3D12_VERTEX_BUFFER_VIEW* GetVertexBufferView(){ return &m_vbv; }
     D3D12_INDEX_BUFFER_VIEW* GetIndexBufferView(){ return &m_ibv; }
+    uint16_t GetMeshID() const { return m_mesh_id; } // assigned by MeshManager, used in render queue sort keys
+    void SetMeshID(uint16_t mesh_id) { m_mesh_id = mesh_id; }
+
+    // bounding sphere and box in mesh space, computed by SetVerticesCPU, both share the center
+    const DirectX::XMFLOAT3& GetBoundsCenter() const { return m_bounds_center; }
+    float GetBoundsRadius() const { return m_bounds_radius; }
+    const DirectX::XMFLOAT3& GetBoundsExtents() const { return m_bounds_extents; }
+    uint32_t GetTriangleCount() const { return (uint32_t)(m_indices16.size() / 3); }
+
+    // largest distance between this mesh and the surface it approximates, in mesh space units
+    void SetGeometricError(float geometric_error) { m_geometric_error = geometric_error; }
+    float GetGeometricError() const { return m_geometric_error; }
+
+    // lod chain, level 0 is this mesh and each added level is coarser, with a larger geometric error
+    // the meshes are owned elsewhere, see MeshManager
+    void AddLOD(Mesh* lod_mesh);
+    uint32_t GetLODCount() const { return m_lod_count; }
+    Mesh* GetLODMesh(uint32_t level) { return level == 0 ? this : m_lod_meshes[level]; }
+
+    // triangle bvh of the cpu copy for ray queries, built once the vertices and indices are set
+    void BuildBVH();
+    const MeshBVH& GetBVH() const { return m_bvh; }
 
 private:
     std::vector<std::uint16_t> m_indices16;
@@ -26,4 +53,16 @@ private:
 
     D3D12_VERTEX_BUFFER_VIEW m_vbv;
     D3D12_INDEX_BUFFER_VIEW m_ibv;
+
+    uint16_t m_mesh_id = 0;
+
+    DirectX::XMFLOAT3 m_bounds_center = { 0.0f, 0.0f, 0.0f };
+    float m_bounds_radius = 0.0f;
+    DirectX::XMFLOAT3 m_bounds_extents = { 0.0f, 0.0f, 0.0f };
+
+    float m_geometric_error = 0.0f;
+    Mesh* m_lod_meshes[k_max_lods] = {}; // [0] is unused, this mesh may be moved before it is used
+    uint32_t m_lod_count = 1;
+
+    MeshBVH m_bvh;
 };
\ No newline at end of file
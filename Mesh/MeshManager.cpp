@@ -1,11 +1,30 @@
 #include "MeshManager.h"
+#include <cmath>
 
 
-Mesh *MeshManager::GetMesh(const std::string &name)
+Mesh *MeshManager::GetMesh(NameID name)
 {
-    const auto& pair = m_meshes.find(name);
-    assert(pair != m_meshes.end());
-    return &(pair->second);
+    Mesh* mesh = FindMesh(name);
+    assert(mesh);
+    return mesh;
+}
+
+Mesh* MeshManager::FindMesh(NameID name)
+{
+    Mesh* const* mesh = m_mesh_map.Find(name);
+    return mesh ? *mesh : nullptr;
+}
+
+Mesh* MeshManager::AddMesh(const std::string& name, Mesh&& mesh)
+{
+    NameID name_id = NameID::Register(name);
+    assert(!m_mesh_map.Contains(name_id));
+
+    mesh.SetMeshID(m_next_mesh_id++);
+    mesh.BuildBVH();
+    m_meshes.push_back(std::make_unique<Mesh>(std::move(mesh)));
+    m_mesh_map.Insert(name_id, m_meshes.back().get());
+    return m_meshes.back().get();
 }
 
 void MeshManager::LoadMeshFromFile(ID3D12Device *device, ID3D12GraphicsCommandList *cmdList)
@@ -18,13 +37,34 @@ void MeshManager::LoadMeshFromFile(ID3D12Device *device, ID3D12GraphicsCommandLi
     box.SetIndicesCPU(box_data.GetIndices16());
     box.SetVerticesCPU(box_data.Vertices);
     box.UploadDataToGPU(device, cmdList);
-    m_meshes["box"] = std::move(box);
+    AddMesh("box", std::move(box));
+
+    // geosphere lod chain, "sphere" then "sphere_lod1" ... each with one subdivision less
+    const float sphere_radius = 1.0f;
+    for(uint32_t level=0; level<Mesh::k_max_lods; level++)
+    {
+        uint32_t subdivisions = Mesh::k_max_lods - level;
+        auto sphere_data = geo_generator.CreateGeosphere(sphere_radius, subdivisions);
+        Mesh sphere;
+        sphere.SetIndicesCPU(sphere_data.GetIndices16());
+        sphere.SetVerticesCPU(sphere_data.Vertices);
+        // sagitta of the longest edge, an icosahedron edge spans about 1.107 radians and each subdivision halves it
+        float edge_angle = 1.1071487f / (float)(1u << subdivisions);
+        sphere.SetGeometricError(sphere_radius * (1.0f - std::cos(edge_angle * 0.5f)));
+        sphere.UploadDataToGPU(device, cmdList);
+        AddMesh(level == 0 ? std::string("sphere") : "sphere_lod" + std::to_string(level), std::move(sphere));
+    }
+    Mesh* sphere = GetMesh("sphere");
+    for(uint32_t level=1; level<Mesh::k_max_lods; level++)
+    {
+        sphere->AddLOD(GetMesh("sphere_lod" + std::to_string(level)));
+    }
 }
 
 void MeshManager::ReleaseUploadBuffer()
 {
-    for(auto& iter = m_meshes.begin(); iter != m_meshes.end(); iter++ )
+    for(auto& mesh : m_meshes)
     {
-        iter->second.ReleaseUploadBuffer();
+        mesh->ReleaseUploadBuffer();
     }
 }
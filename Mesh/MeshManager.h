@@ -1,8 +1,11 @@
 #pragma once
-#include <unordered_map>
+#include <memory>
 #include <string>
+#include <vector>
 #include "Mesh.h"
 #include "GeometryGenerator.h"
+#include "Utility/NameID.h"
+#include "Utility/FlatHashMap.h"
 
 class MeshManager
 {
@@ -10,11 +13,17 @@ public:
     MeshManager() = default;
     ~MeshManager() = default;
 
-    Mesh* GetMesh(const std::string& name);
+    Mesh* GetMesh(NameID name);
+    Mesh* FindMesh(NameID name); // nullptr if there is no such mesh
     void LoadMeshFromFile(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList); // called when init
     void ReleaseUploadBuffer(); // called between init and runtime
 
 private:
-    std::unordered_map<std::string, Mesh> m_meshes;
+    Mesh* AddMesh(const std::string& name, Mesh&& mesh);
+
+private:
+    std::vector<std::unique_ptr<Mesh>> m_meshes;    // meshes are referenced by pointer, they never move
+    FlatHashMap<NameID, Mesh*> m_mesh_map;
+    uint16_t m_next_mesh_id = 0;
 };
 
@@ -0,0 +1,187 @@
+#include "FrustumCuller.h"
+#include <cstring>
+#include "Utility/JobSystem.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define FRUSTUM_CULLER_SSE 1
+#include <immintrin.h>
+#endif
+
+static bool IsVisible(const Frustum& frustum, const CullBounds& bounds, CullShape shape, uint32_t i)
+{
+    for(const Plane& plane : frustum.planes)
+    {
+        float distance = plane.normal.x * bounds.center_x[i] + plane.normal.y * bounds.center_y[i] + plane.normal.z * bounds.center_z[i] + plane.d;
+        float extent = shape == CullShape::k_sphere ? bounds.radius[i] :
+            std::abs(plane.normal.x) * bounds.extent_x[i] + std::abs(plane.normal.y) * bounds.extent_y[i] + std::abs(plane.normal.z) * bounds.extent_z[i];
+        if(distance < -extent)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if defined(FRUSTUM_CULLER_SSE)
+// appends the lanes set in mask without branching on them, every lane is written and only visible ones are kept
+static uint32_t AppendVisible(uint32_t* visible_indices, uint32_t visible_count, uint32_t first_index, int mask, int lane_count)
+{
+    for(int lane=0; lane<lane_count; lane++)
+    {
+        visible_indices[visible_count] = first_index + lane;
+        visible_count += (mask >> lane) & 1;
+    }
+    return visible_count;
+}
+
+static uint32_t CullSSE(const Frustum& frustum, const CullBounds& bounds, CullShape shape, uint32_t begin, uint32_t end, uint32_t* visible_indices, uint32_t& visible_count)
+{
+    __m128 normal_x[Frustum::k_plane_count], normal_y[Frustum::k_plane_count], normal_z[Frustum::k_plane_count], plane_d[Frustum::k_plane_count];
+    __m128 abs_x[Frustum::k_plane_count], abs_y[Frustum::k_plane_count], abs_z[Frustum::k_plane_count];
+    for(int p=0; p<Frustum::k_plane_count; p++)
+    {
+        const Plane& plane = frustum.planes[p];
+        normal_x[p] = _mm_set1_ps(plane.normal.x);
+        normal_y[p] = _mm_set1_ps(plane.normal.y);
+        normal_z[p] = _mm_set1_ps(plane.normal.z);
+        plane_d[p] = _mm_set1_ps(plane.d);
+        abs_x[p] = _mm_set1_ps(std::abs(plane.normal.x));
+        abs_y[p] = _mm_set1_ps(std::abs(plane.normal.y));
+        abs_z[p] = _mm_set1_ps(std::abs(plane.normal.z));
+    }
+
+    uint32_t i = begin;
+    for(; i + 4 <= end; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(bounds.center_x + i);
+        __m128 y = _mm_loadu_ps(bounds.center_y + i);
+        __m128 z = _mm_loadu_ps(bounds.center_z + i);
+        __m128 radius = _mm_setzero_ps(), extent_x = _mm_setzero_ps(), extent_y = _mm_setzero_ps(), extent_z = _mm_setzero_ps();
+        if(shape == CullShape::k_sphere)
+        {
+            radius = _mm_loadu_ps(bounds.radius + i);
+        }
+        else
+        {
+            extent_x = _mm_loadu_ps(bounds.extent_x + i);
+            extent_y = _mm_loadu_ps(bounds.extent_y + i);
+            extent_z = _mm_loadu_ps(bounds.extent_z + i);
+        }
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for(int p=0; p<Frustum::k_plane_count; p++)
+        {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normal_x[p], x), _mm_mul_ps(normal_y[p], y)),
+                _mm_add_ps(_mm_mul_ps(normal_z[p], z), plane_d[p]));
+            __m128 extent = shape == CullShape::k_sphere ? radius :
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(abs_x[p], extent_x), _mm_mul_ps(abs_y[p], extent_y)), _mm_mul_ps(abs_z[p], extent_z));
+            // distance + extent >= 0
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, extent), _mm_setzero_ps()));
+        }
+        visible_count = AppendVisible(visible_indices, visible_count, i, _mm_movemask_ps(inside), 4);
+    }
+    return i;
+}
+#endif
+
+#if defined(__AVX__)
+static uint32_t CullAVX(const Frustum& frustum, const CullBounds& bounds, CullShape shape, uint32_t begin, uint32_t end, uint32_t* visible_indices, uint32_t& visible_count)
+{
+    __m256 normal_x[Frustum::k_plane_count], normal_y[Frustum::k_plane_count], normal_z[Frustum::k_plane_count], plane_d[Frustum::k_plane_count];
+    __m256 abs_x[Frustum::k_plane_count], abs_y[Frustum::k_plane_count], abs_z[Frustum::k_plane_count];
+    for(int p=0; p<Frustum::k_plane_count; p++)
+    {
+        const Plane& plane = frustum.planes[p];
+        normal_x[p] = _mm256_set1_ps(plane.normal.x);
+        normal_y[p] = _mm256_set1_ps(plane.normal.y);
+        normal_z[p] = _mm256_set1_ps(plane.normal.z);
+        plane_d[p] = _mm256_set1_ps(plane.d);
+        abs_x[p] = _mm256_set1_ps(std::abs(plane.normal.x));
+        abs_y[p] = _mm256_set1_ps(std::abs(plane.normal.y));
+        abs_z[p] = _mm256_set1_ps(std::abs(plane.normal.z));
+    }
+
+    uint32_t i = begin;
+    for(; i + 8 <= end; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(bounds.center_x + i);
+        __m256 y = _mm256_loadu_ps(bounds.center_y + i);
+        __m256 z = _mm256_loadu_ps(bounds.center_z + i);
+        __m256 radius = _mm256_setzero_ps(), extent_x = _mm256_setzero_ps(), extent_y = _mm256_setzero_ps(), extent_z = _mm256_setzero_ps();
+        if(shape == CullShape::k_sphere)
+        {
+            radius = _mm256_loadu_ps(bounds.radius + i);
+        }
+        else
+        {
+            extent_x = _mm256_loadu_ps(bounds.extent_x + i);
+            extent_y = _mm256_loadu_ps(bounds.extent_y + i);
+            extent_z = _mm256_loadu_ps(bounds.extent_z + i);
+        }
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for(int p=0; p<Frustum::k_plane_count; p++)
+        {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(normal_x[p], x), _mm256_mul_ps(normal_y[p], y)),
+                _mm256_add_ps(_mm256_mul_ps(normal_z[p], z), plane_d[p]));
+            __m256 extent = shape == CullShape::k_sphere ? radius :
+                _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(abs_x[p], extent_x), _mm256_mul_ps(abs_y[p], extent_y)), _mm256_mul_ps(abs_z[p], extent_z));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, extent), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+        visible_count = AppendVisible(visible_indices, visible_count, i, _mm256_movemask_ps(inside), 8);
+    }
+    return i;
+}
+#endif
+
+uint32_t FrustumCuller::Cull(const Frustum& frustum, const CullBounds& bounds, CullShape shape, uint32_t begin, uint32_t end, uint32_t* visible_indices)
+{
+    // the visible count never exceeds the number of objects tested before a lane,
+    // so the scratch writes of AppendVisible stay within end - begin entries
+    uint32_t visible_count = 0;
+    uint32_t i = begin;
+#if defined(__AVX__)
+    i = CullAVX(frustum, bounds, shape, i, end, visible_indices, visible_count);
+#endif
+#if defined(FRUSTUM_CULLER_SSE)
+    i = CullSSE(frustum, bounds, shape, i, end, visible_indices, visible_count);
+#endif
+
+    for(; i<end; i++)
+    {
+        if(IsVisible(frustum, bounds, shape, i))
+        {
+            visible_indices[visible_count++] = i;
+        }
+    }
+    return visible_count;
+}
+
+uint32_t FrustumCuller::Cull(JobSystem* job_system, const Frustum& frustum, const CullBounds& bounds, CullShape shape, uint32_t* visible_indices)
+{
+    if(!job_system || bounds.count < k_parallel_min_count)
+    {
+        return Cull(frustum, bounds, shape, 0, bounds.count, visible_indices);
+    }
+
+    // each block writes its visible indices at its own offset, the gaps are closed afterwards
+    uint32_t block_count = (bounds.count + k_block_size - 1) / k_block_size;
+    m_block_counts.resize(block_count);
+    job_system->ParallelFor(block_count, 1, [&](uint32_t first_block, uint32_t last_block)
+    {
+        for(uint32_t block=first_block; block<last_block; block++)
+        {
+            uint32_t begin = block * k_block_size;
+            uint32_t end = std::min(begin + k_block_size, bounds.count);
+            m_block_counts[block] = Cull(frustum, bounds, shape, begin, end, visible_indices + begin);
+        }
+    });
+
+    uint32_t visible_count = m_block_counts[0];
+    for(uint32_t block=1; block<block_count; block++)
+    {
+        memmove(visible_indices + visible_count, visible_indices + block * k_block_size, m_block_counts[block] * sizeof(uint32_t));
+        visible_count += m_block_counts[block];
+    }
+    return visible_count;
+}
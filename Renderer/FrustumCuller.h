@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Scene/Bounds.h"
+
+class JobSystem;
+
+// bounds of a set of objects as parallel arrays, the sphere and the box of an object share its center
+struct CullBounds
+{
+    const float* center_x = nullptr;
+    const float* center_y = nullptr;
+    const float* center_z = nullptr;
+    const float* radius = nullptr;      // spheres
+    const float* extent_x = nullptr;    // boxes, half sizes
+    const float* extent_y = nullptr;
+    const float* extent_z = nullptr;
+    uint32_t count = 0;
+};
+
+enum class CullShape : uint8_t
+{
+    k_sphere,
+    k_box,
+};
+
+// frustum test of SoA bounds, 8 objects per step with AVX, 4 with SSE, the rest one by one
+// the output is a compacted list of visible indices in increasing order
+class FrustumCuller
+{
+public:
+    FrustumCuller() = default;
+    ~FrustumCuller() = default;
+
+    // culls [begin, end), visible_indices needs room for end - begin entries, returns the number written
+    static uint32_t Cull(const Frustum& frustum, const CullBounds& bounds, CullShape shape, uint32_t begin, uint32_t end, uint32_t* visible_indices);
+
+    // culls every object, large sets are split in blocks over the job system and compacted afterwards
+    // visible_indices needs room for bounds.count entries, job_system may be nullptr
+    uint32_t Cull(JobSystem* job_system, const Frustum& frustum, const CullBounds& bounds, CullShape shape, uint32_t* visible_indices);
+
+private:
+    static const uint32_t k_block_size = 4096;
+    static const uint32_t k_parallel_min_count = 16384;
+
+    std::vector<uint32_t> m_block_counts;
+};
@@ -0,0 +1,8 @@
+#include "InstanceBatcher.h"
+
+bool InstanceBatcher::CanMerge(uint64_t key_a, uint64_t key_b)
+{
+    RenderSortKeyFields a = RenderQueue::DecodeKey(key_a);
+    RenderSortKeyFields b = RenderQueue::DecodeKey(key_b);
+    return a.pass == b.pass && a.pso_id == b.pso_id && a.material_id == b.material_id && a.mesh_id == b.mesh_id;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "RenderQueue.h"
+#include <cstdint>
+#include <vector>
+
+// a run of sorted draws sharing pass, pso, material and mesh, drawn with one DrawIndexedInstanced
+struct InstanceBatch
+{
+    uint32_t first_instance;    // into InstanceBatcher::GetInstanceItem
+    uint32_t instance_count;
+    bool b_instanced;           // false for a single draw that goes through the regular path
+};
+
+struct InstanceBatchStats
+{
+    uint64_t draws_before = 0;  // one per queued draw
+    uint64_t draws_after = 0;   // one per batch
+    uint64_t instanced_draws = 0;
+};
+
+// groups the draws of a sorted RenderQueue into instanced batches
+// the queue keys already put equal (pso, material, mesh) next to each other for opaque draws,
+// transparent draws only merge when they are also adjacent in back to front order
+// the key only has the material template, draws of instances with different parameters are kept apart by can_merge
+class InstanceBatcher
+{
+public:
+    InstanceBatcher() = default;
+    ~InstanceBatcher() = default;
+
+    // can_instance(item) rejects draws that cannot share a batch, e.g. a material instance overriding a texture
+    // can_merge(first_item, item) rejects a draw whose parameters differ from the batch's first draw
+    template<typename CanInstanceFunc, typename CanMergeFunc>
+    void Build(const RenderQueue& queue, CanInstanceFunc can_instance, CanMergeFunc can_merge, uint32_t max_instances = UINT32_MAX);
+
+    const std::vector<InstanceBatch>& GetBatches() const { return m_batches; }
+    uint32_t GetInstanceItem(uint32_t instance) const { return m_instance_items[instance]; }
+    const InstanceBatchStats& GetStats() const { return m_stats; }
+
+private:
+    static bool CanMerge(uint64_t key_a, uint64_t key_b);
+
+private:
+    std::vector<InstanceBatch> m_batches;
+    std::vector<uint32_t> m_instance_items;  // queue items in batch order
+    InstanceBatchStats m_stats;
+};
+
+template<typename CanInstanceFunc, typename CanMergeFunc>
+void InstanceBatcher::Build(const RenderQueue& queue, CanInstanceFunc can_instance, CanMergeFunc can_merge, uint32_t max_instances)
+{
+    // buffers keep their capacity, building does not allocate once warmed up
+    m_batches.clear();
+    m_instance_items.clear();
+    m_stats = InstanceBatchStats();
+
+    const uint32_t count = (uint32_t)queue.GetCount();
+    m_stats.draws_before = count;
+
+    for(uint32_t i=0; i<count; )
+    {
+        InstanceBatch batch;
+        batch.first_instance = (uint32_t)m_instance_items.size();
+        batch.instance_count = 1;
+        m_instance_items.push_back(queue.GetItem(i));
+
+        if(can_instance(queue.GetItem(i)))
+        {
+            while(i + batch.instance_count < count
+                && batch.instance_count < max_instances
+                && CanMerge(queue.GetKey(i), queue.GetKey(i + batch.instance_count))
+                && can_instance(queue.GetItem(i + batch.instance_count))
+                && can_merge(queue.GetItem(i), queue.GetItem(i + batch.instance_count)))
+            {
+                m_instance_items.push_back(queue.GetItem(i + batch.instance_count));
+                batch.instance_count++;
+            }
+        }
+
+        batch.b_instanced = batch.instance_count > 1;
+        m_stats.instanced_draws += batch.b_instanced ? 1 : 0;
+        m_batches.push_back(batch);
+        i += batch.instance_count;
+    }
+
+    m_stats.draws_after = m_batches.size();
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "Math/Math.h"
+
+// one element of gInstanceData in color.hlsl (USE_INSTANCING), keep both in sync
+struct InstanceData
+{
+    Matrix world;   // transposed, hlsl matrices are column major
+};
+
+static_assert(sizeof(InstanceData) == 64, "InstanceData must match the hlsl struct");
@@ -0,0 +1,99 @@
+#include "LODSelector.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define LOD_SELECTOR_SSE 1
+#include <emmintrin.h>
+#endif
+
+// closer than this to the bounding sphere counts as this distance, so the allowed error never reaches zero
+static const float k_min_distance = 1e-4f;
+
+void LODSelector::ComputeAllowedErrors(const Vector3& eye, float pixel_threshold, float screen_scale, const CullBounds& bounds, float* allowed_errors)
+{
+    float error_per_distance = pixel_threshold / screen_scale;
+
+    uint32_t i = 0;
+#if defined(LOD_SELECTOR_SSE)
+    const __m128 eye_x = _mm_set1_ps(eye.x);
+    const __m128 eye_y = _mm_set1_ps(eye.y);
+    const __m128 eye_z = _mm_set1_ps(eye.z);
+    const __m128 min_distance = _mm_set1_ps(k_min_distance);
+    const __m128 scale = _mm_set1_ps(error_per_distance);
+    for(; i + 4 <= bounds.count; i += 4)
+    {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(bounds.center_x + i), eye_x);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(bounds.center_y + i), eye_y);
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(bounds.center_z + i), eye_z);
+        __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+        distance = _mm_max_ps(_mm_sub_ps(distance, _mm_loadu_ps(bounds.radius + i)), min_distance);
+        _mm_storeu_ps(allowed_errors + i, _mm_mul_ps(distance, scale));
+    }
+#endif
+    for(; i < bounds.count; i++)
+    {
+        float dx = bounds.center_x[i] - eye.x;
+        float dy = bounds.center_y[i] - eye.y;
+        float dz = bounds.center_z[i] - eye.z;
+        float distance = std::max(std::sqrt(dx * dx + dy * dy + dz * dz) - bounds.radius[i], k_min_distance);
+        allowed_errors[i] = distance * error_per_distance;
+    }
+}
+
+void LODSelector::Select(const RenderView& view, const RenderProxyList& proxies, const uint32_t* proxy_indices, uint32_t count)
+{
+    CullBounds bounds = proxies.GetCullBounds();
+    m_allowed_errors.resize(bounds.count);
+    m_levels.resize(bounds.count, 0);
+    m_meshes.resize(bounds.count, nullptr);
+
+    float screen_scale = GetScreenScale(view.fov_y, view.viewport_height);
+    ComputeAllowedErrors(view.position, m_settings.pixel_threshold * m_threshold_scale, screen_scale, bounds, m_allowed_errors.data());
+
+    m_stats = LODStats();
+    float coarsen_factor = 1.0f - m_settings.hysteresis;
+    for(uint32_t n=0; n<count; n++)
+    {
+        uint32_t i = proxy_indices[n];
+        uint32_t object_id = proxies.GetObjectID(i);
+        if(object_id >= m_object_levels.size())
+        {
+            // objects seen for the first time start at the finest level
+            m_object_levels.resize(object_id + 1, 0);
+        }
+        Mesh* mesh = proxies.GetMesh(i);
+        float allowed_error = m_allowed_errors[i];
+        // geometric errors are in mesh space, a scaled object's error grows with its largest axis scale
+        float world_scale = GetMaxAxisScale(proxies.GetWorldMatrix(i));
+
+        // the object may have switched to a mesh with a shorter chain
+        uint32_t level = std::min((uint32_t)m_object_levels[object_id], mesh->GetLODCount() - 1);
+        while(level > 0 && mesh->GetLODMesh(level)->GetGeometricError() * world_scale > allowed_error)
+        {
+            level--;
+        }
+        while(level + 1 < mesh->GetLODCount() && mesh->GetLODMesh(level + 1)->GetGeometricError() * world_scale <= allowed_error * coarsen_factor)
+        {
+            level++;
+        }
+
+        Mesh* lod_mesh = mesh->GetLODMesh(level);
+        m_levels[i] = (uint8_t)level;
+        m_object_levels[object_id] = (uint8_t)level;
+        m_meshes[i] = lod_mesh;
+        m_stats.triangles += lod_mesh->GetTriangleCount();
+        m_stats.level_counts[level]++;
+    }
+    m_stats.threshold_scale = m_threshold_scale;
+
+    // the budget steers the next frames, a margin under it keeps the scale from oscillating
+    if(m_settings.triangle_budget > 0 && m_stats.triangles > m_settings.triangle_budget)
+    {
+        m_threshold_scale = std::min(m_threshold_scale * 1.25f, k_max_threshold_scale);
+    }
+    else if(m_settings.triangle_budget == 0 || m_stats.triangles < m_settings.triangle_budget * 0.8f)
+    {
+        m_threshold_scale = std::max(m_threshold_scale * 0.9f, 1.0f);
+    }
+}
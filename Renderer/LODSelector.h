@@ -0,0 +1,65 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "Math/Math.h"
+#include "Mesh/Mesh.h"
+#include "FrustumCuller.h"
+#include "RenderProxy.h"
+
+struct LODSettings
+{
+    float pixel_threshold = 1.0f;   // largest projected geometric error accepted, in pixels
+    float hysteresis = 0.25f;       // a coarser level is only taken under (1 - hysteresis) of the threshold
+    uint32_t triangle_budget = 0;   // of the selected levels, 0 is unlimited
+};
+
+// selection results of the last Select
+struct LODStats
+{
+    uint32_t triangles = 0;
+    float threshold_scale = 1.0f;   // applied to pixel_threshold to stay in the triangle budget
+    uint32_t level_counts[Mesh::k_max_lods] = {};
+};
+
+// picks per object the coarsest level of its mesh lod chain whose geometric error projects under a pixel threshold
+// the error in pixels of a level is geometric_error * world_scale * screen_scale / distance, world_scale being the
+// largest axis scale of the object and distance being from the eye to the bounding sphere, so the largest allowed error of each object is computed first in one SoA pass over the bounds
+// levels are kept per object id between frames (see RenderProxyList::Add), proxy indices shift as objects enter and
+// leave the view: refining happens at once, coarsening only past the hysteresis margin,
+// and the threshold is scaled up while the selection goes over the triangle budget and back down after
+class LODSelector
+{
+public:
+    LODSelector() = default;
+    ~LODSelector() = default;
+
+    void SetSettings(const LODSettings& settings) { m_settings = settings; }
+    const LODSettings& GetSettings() const { return m_settings; }
+
+    // pixels covered by one unit at distance one
+    static float GetScreenScale(float fov_y, float viewport_height) { return viewport_height / (2.0f * std::tan(fov_y * 0.5f)); }
+
+    // allowed_errors[i] is the largest geometric error of object i projecting under pixel_threshold pixels
+    // 4 objects per step with SSE, the rest one by one
+    static void ComputeAllowedErrors(const Vector3& eye, float pixel_threshold, float screen_scale, const CullBounds& bounds, float* allowed_errors);
+
+    // selects the level of the listed proxies, usually the visible ones
+    void Select(const RenderView& view, const RenderProxyList& proxies, const uint32_t* proxy_indices, uint32_t count);
+
+    // of the proxies listed to the last Select
+    uint32_t GetLevel(uint32_t proxy_index) const { return m_levels[proxy_index]; }
+    Mesh* GetMesh(uint32_t proxy_index) const { return m_meshes[proxy_index]; }
+    const LODStats& GetStats() const { return m_stats; }
+
+private:
+    static constexpr float k_max_threshold_scale = 64.0f;
+
+    LODSettings m_settings;
+    float m_threshold_scale = 1.0f;
+    std::vector<float> m_allowed_errors;
+    std::vector<uint8_t> m_levels;          // by proxy index, of the last Select
+    std::vector<uint8_t> m_object_levels;   // by object id, the history hysteresis works on
+    std::vector<Mesh*> m_meshes;
+    LODStats m_stats;
+};
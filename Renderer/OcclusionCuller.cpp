@@ -0,0 +1,320 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "Utility/JobSystem.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define OCCLUSION_CULLER_SSE 1
+#include <emmintrin.h>
+#endif
+
+// vertices closer than this in clip w are behind or on the near plane
+static const float k_min_w = 1e-5f;
+
+OcclusionCuller::OcclusionCuller():
+    m_depth(k_width * k_height, 1.0f),
+    m_block_max_depth(k_blocks_x * k_blocks_y, 1.0f)
+{
+}
+
+void OcclusionCuller::BeginFrame(const Matrix& view_proj)
+{
+    m_view_proj = view_proj;
+    m_triangles.clear();
+    m_stats = OcclusionStats();
+}
+
+void OcclusionCuller::AddOccluder(const float* positions, uint32_t stride, const uint16_t* indices, uint32_t index_count, const Matrix& world)
+{
+    Matrix m = world * m_view_proj;
+
+    uint32_t vertex_count = 0;
+    for(uint32_t i=0; i<index_count; i++)
+    {
+        vertex_count = std::max(vertex_count, (uint32_t)indices[i] + 1);
+    }
+
+    m_clip_positions.resize(vertex_count * 4);
+    for(uint32_t v=0; v<vertex_count; v++)
+    {
+        const float* p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + (size_t)v * stride);
+        float* clip = &m_clip_positions[v * 4];
+        clip[0] = p[0] * m._11 + p[1] * m._21 + p[2] * m._31 + m._41;
+        clip[1] = p[0] * m._12 + p[1] * m._22 + p[2] * m._32 + m._42;
+        clip[2] = p[0] * m._13 + p[1] * m._23 + p[2] * m._33 + m._43;
+        clip[3] = p[0] * m._14 + p[1] * m._24 + p[2] * m._34 + m._44;
+    }
+
+    for(uint32_t i=0; i+2<index_count; i+=3)
+    {
+        ScreenTriangle triangle;
+        bool b_behind = false;
+        for(int corner=0; corner<3; corner++)
+        {
+            const float* clip = &m_clip_positions[indices[i + corner] * 4];
+            // dropping an occluder triangle is always safe, so no near plane clipping
+            if(clip[3] <= k_min_w)
+            {
+                b_behind = true;
+                break;
+            }
+            float inv_w = 1.0f / clip[3];
+            triangle.x[corner] = (clip[0] * inv_w * 0.5f + 0.5f) * k_width;
+            triangle.y[corner] = (0.5f - clip[1] * inv_w * 0.5f) * k_height;
+            triangle.z[corner] = clip[2] * inv_w;
+        }
+        if(b_behind)
+        {
+            continue;
+        }
+
+        float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) - (triangle.y[1] - triangle.y[0]) * (triangle.x[2] - triangle.x[0]);
+        if(std::abs(area) < 1e-6f)
+        {
+            continue;
+        }
+        if(area < 0.0f)
+        {
+            std::swap(triangle.x[1], triangle.x[2]);
+            std::swap(triangle.y[1], triangle.y[2]);
+            std::swap(triangle.z[1], triangle.z[2]);
+        }
+
+        // pixels whose centers may be covered
+        triangle.min_x = std::max((int)std::floor(std::min({ triangle.x[0], triangle.x[1], triangle.x[2] }) - 0.5f), 0);
+        triangle.min_y = std::max((int)std::floor(std::min({ triangle.y[0], triangle.y[1], triangle.y[2] }) - 0.5f), 0);
+        triangle.max_x = std::min((int)std::ceil(std::max({ triangle.x[0], triangle.x[1], triangle.x[2] }) - 0.5f), (int)k_width - 1);
+        triangle.max_y = std::min((int)std::ceil(std::max({ triangle.y[0], triangle.y[1], triangle.y[2] }) - 0.5f), (int)k_height - 1);
+        if(triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y)
+        {
+            continue;
+        }
+
+        m_triangles.push_back(triangle);
+    }
+}
+
+void OcclusionCuller::Rasterize(JobSystem* job_system)
+{
+    m_stats.occluder_triangles = (uint32_t)m_triangles.size();
+
+    const uint32_t tile_count = k_tiles_x * k_tiles_y;
+    if(!job_system || m_triangles.empty())
+    {
+        for(uint32_t tile=0; tile<tile_count; tile++)
+        {
+            RasterizeTile(tile);
+        }
+        return;
+    }
+
+    // tiles own disjoint parts of the depth buffer and of the block depths
+    job_system->ParallelFor(tile_count, 1, [this](uint32_t begin, uint32_t end)
+    {
+        for(uint32_t tile=begin; tile<end; tile++)
+        {
+            RasterizeTile(tile);
+        }
+    });
+}
+
+void OcclusionCuller::RasterizeTile(uint32_t tile)
+{
+    int tile_min_x = (int)((tile % k_tiles_x) * k_tile_width);
+    int tile_min_y = (int)((tile / k_tiles_x) * k_tile_height);
+    int tile_max_x = tile_min_x + (int)k_tile_width - 1;
+    int tile_max_y = tile_min_y + (int)k_tile_height - 1;
+    float* tile_depth = &m_depth[tile * k_tile_width * k_tile_height];
+
+    std::fill(tile_depth, tile_depth + k_tile_width * k_tile_height, 1.0f);
+    for(const ScreenTriangle& triangle : m_triangles)
+    {
+        if(triangle.max_x >= tile_min_x && triangle.min_x <= tile_max_x && triangle.max_y >= tile_min_y && triangle.min_y <= tile_max_y)
+        {
+            RasterizeTriangle(triangle, tile_min_x, tile_min_y, tile_max_x, tile_max_y, tile_depth);
+        }
+    }
+
+    // farthest depth per block
+    for(int block_y=tile_min_y; block_y<=tile_max_y; block_y+=k_block_size)
+    {
+        for(int block_x=tile_min_x; block_x<=tile_max_x; block_x+=k_block_size)
+        {
+            float max_depth = 0.0f;
+            for(int y=block_y; y<block_y+(int)k_block_size; y++)
+            {
+                const float* row = tile_depth + (y - tile_min_y) * k_tile_width + (block_x - tile_min_x);
+                for(uint32_t x=0; x<k_block_size; x++)
+                {
+                    max_depth = std::max(max_depth, row[x]);
+                }
+            }
+            m_block_max_depth[(block_y / k_block_size) * k_blocks_x + block_x / k_block_size] = max_depth;
+        }
+    }
+}
+
+void OcclusionCuller::RasterizeTriangle(const ScreenTriangle& triangle, int tile_min_x, int tile_min_y, int tile_max_x, int tile_max_y, float* tile_depth)
+{
+    // edge function of edge (a, b) at p: (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x)
+    // w0 is opposite to vertex 0 and so on, positive inside for the orientation set up by AddOccluder
+    const float* x = triangle.x;
+    const float* y = triangle.y;
+    const float step_x[3] = { -(y[2] - y[1]), -(y[0] - y[2]), -(y[1] - y[0]) };
+    const float step_y[3] = { x[2] - x[1], x[0] - x[2], x[1] - x[0] };
+    const int edge_start[3] = { 1, 2, 0 };
+
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    float z_step_1 = (triangle.z[1] - triangle.z[0]) / area;
+    float z_step_2 = (triangle.z[2] - triangle.z[0]) / area;
+
+    // whole groups of 4 pixels, the tile width is a multiple of 4
+    int min_x = std::max(triangle.min_x, tile_min_x) & ~3;
+    int max_x = std::min(triangle.max_x, tile_max_x);
+    int min_y = std::max(triangle.min_y, tile_min_y);
+    int max_y = std::min(triangle.max_y, tile_max_y);
+
+    for(int py=min_y; py<=max_y; py++)
+    {
+        float center_y = py + 0.5f;
+        float* row = tile_depth + (py - tile_min_y) * k_tile_width;
+
+        float w_row[3];
+        for(int e=0; e<3; e++)
+        {
+            int a = edge_start[e];
+            w_row[e] = step_y[e] * (center_y - y[a]) + step_x[e] * (min_x + 0.5f - x[a]);
+        }
+
+#if defined(OCCLUSION_CULLER_SSE)
+        const __m128 lane_offsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        __m128 w0 = _mm_add_ps(_mm_set1_ps(w_row[0]), _mm_mul_ps(lane_offsets, _mm_set1_ps(step_x[0])));
+        __m128 w1 = _mm_add_ps(_mm_set1_ps(w_row[1]), _mm_mul_ps(lane_offsets, _mm_set1_ps(step_x[1])));
+        __m128 w2 = _mm_add_ps(_mm_set1_ps(w_row[2]), _mm_mul_ps(lane_offsets, _mm_set1_ps(step_x[2])));
+        const __m128 w0_step = _mm_set1_ps(step_x[0] * 4.0f);
+        const __m128 w1_step = _mm_set1_ps(step_x[1] * 4.0f);
+        const __m128 w2_step = _mm_set1_ps(step_x[2] * 4.0f);
+        const __m128 z0 = _mm_set1_ps(triangle.z[0]);
+        const __m128 z1_step = _mm_set1_ps(z_step_1);
+        const __m128 z2_step = _mm_set1_ps(z_step_2);
+        const __m128 zero = _mm_setzero_ps();
+
+        for(int px=min_x; px<=max_x; px+=4)
+        {
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)), _mm_cmpge_ps(w2, zero));
+            if(_mm_movemask_ps(inside))
+            {
+                // z = z0 + b1 * (z1 - z0) + b2 * (z2 - z0)
+                __m128 z = _mm_add_ps(z0, _mm_add_ps(_mm_mul_ps(w1, z1_step), _mm_mul_ps(w2, z2_step)));
+                float* dest = row + (px - tile_min_x);
+                __m128 depth = _mm_loadu_ps(dest);
+                __m128 nearest = _mm_min_ps(depth, z);
+                _mm_storeu_ps(dest, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, depth)));
+            }
+            w0 = _mm_add_ps(w0, w0_step);
+            w1 = _mm_add_ps(w1, w1_step);
+            w2 = _mm_add_ps(w2, w2_step);
+        }
+#else
+        for(int px=min_x; px<=max_x; px++)
+        {
+            float offset = (float)(px - min_x);
+            float w0 = w_row[0] + step_x[0] * offset;
+            float w1 = w_row[1] + step_x[1] * offset;
+            float w2 = w_row[2] + step_x[2] * offset;
+            if(w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f)
+            {
+                float z = triangle.z[0] + w1 * z_step_1 + w2 * z_step_2;
+                float& depth = row[px - tile_min_x];
+                depth = std::min(depth, z);
+            }
+        }
+#endif
+    }
+}
+
+bool OcclusionCuller::IsVisible(const Vector3& center, const Vector3& extents) const
+{
+    const Matrix& m = m_view_proj;
+    float min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX;
+    float min_z = FLT_MAX;
+    for(int corner=0; corner<8; corner++)
+    {
+        float px = center.x + ((corner & 1) ? extents.x : -extents.x);
+        float py = center.y + ((corner & 2) ? extents.y : -extents.y);
+        float pz = center.z + ((corner & 4) ? extents.z : -extents.z);
+        float clip_w = px * m._14 + py * m._24 + pz * m._34 + m._44;
+        if(clip_w <= k_min_w)
+        {
+            return true;
+        }
+
+        float inv_w = 1.0f / clip_w;
+        float sx = ((px * m._11 + py * m._21 + pz * m._31 + m._41) * inv_w * 0.5f + 0.5f) * k_width;
+        float sy = (0.5f - (px * m._12 + py * m._22 + pz * m._32 + m._42) * inv_w * 0.5f) * k_height;
+        float sz = (px * m._13 + py * m._23 + pz * m._33 + m._43) * inv_w;
+        min_x = std::min(min_x, sx);
+        max_x = std::max(max_x, sx);
+        min_y = std::min(min_y, sy);
+        max_y = std::max(max_y, sy);
+        min_z = std::min(min_z, sz);
+    }
+
+    // every pixel whose center the box may cover, clamped to the screen
+    int x0 = std::max((int)std::floor(min_x - 0.5f), 0);
+    int y0 = std::max((int)std::floor(min_y - 0.5f), 0);
+    int x1 = std::min((int)std::ceil(max_x - 0.5f), (int)k_width - 1);
+    int y1 = std::min((int)std::ceil(max_y - 0.5f), (int)k_height - 1);
+    if(x0 > x1 || y0 > y1)
+    {
+        return true;
+    }
+
+    for(int block_y=y0/(int)k_block_size; block_y<=y1/(int)k_block_size; block_y++)
+    {
+        for(int block_x=x0/(int)k_block_size; block_x<=x1/(int)k_block_size; block_x++)
+        {
+            if(m_block_max_depth[block_y * k_blocks_x + block_x] < min_z)
+            {
+                continue;
+            }
+
+            // the block has a pixel at least as far as the box, look at the covered ones
+            int py_begin = std::max(y0, block_y * (int)k_block_size);
+            int py_end = std::min(y1, (block_y + 1) * (int)k_block_size - 1);
+            int px_begin = std::max(x0, block_x * (int)k_block_size);
+            int px_end = std::min(x1, (block_x + 1) * (int)k_block_size - 1);
+            for(int py=py_begin; py<=py_end; py++)
+            {
+                for(int px=px_begin; px<=px_end; px++)
+                {
+                    if(m_depth[GetPixelIndex(px, py)] >= min_z)
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+uint32_t OcclusionCuller::CullVisible(const CullBounds& bounds, uint32_t* indices, uint32_t count)
+{
+    uint32_t visible_count = 0;
+    for(uint32_t i=0; i<count; i++)
+    {
+        uint32_t index = indices[i];
+        Vector3 center(bounds.center_x[index], bounds.center_y[index], bounds.center_z[index]);
+        Vector3 extents(bounds.extent_x[index], bounds.extent_y[index], bounds.extent_z[index]);
+        if(IsVisible(center, extents))
+        {
+            indices[visible_count++] = index;
+        }
+    }
+
+    m_stats.tested += count;
+    m_stats.occluded += count - visible_count;
+    return visible_count;
+}
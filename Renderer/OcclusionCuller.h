@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Math/Math.h"
+#include "FrustumCuller.h"
+
+class JobSystem;
+
+struct OcclusionStats
+{
+    uint32_t occluder_triangles = 0;    // rasterized, after near plane and screen rejection
+    uint32_t tested = 0;
+    uint32_t occluded = 0;
+};
+
+// cpu occlusion culling against a low resolution depth buffer
+// occluders are simplified closed meshes rasterized with their nearest depth per pixel,
+// occludees are world boxes tested with their nearest depth against the farthest occluder depth
+// of the pixels they cover, first per 8x8 block (hierarchical depth) then per pixel where needed
+// the buffer is stored tile by tile, Rasterize runs one job per tile and each tile clears, rasterizes
+// the triangles overlapping it (4 pixels at a time with SSE) and reduces its blocks
+// pixels are sampled at their centers, so silhouettes are accurate to one low resolution pixel
+class OcclusionCuller
+{
+public:
+    static const uint32_t k_width = 256;
+    static const uint32_t k_height = 128;
+    static const uint32_t k_tile_width = 64;
+    static const uint32_t k_tile_height = 32;
+    static const uint32_t k_block_size = 8;
+
+    OcclusionCuller();
+    ~OcclusionCuller() = default;
+
+    // view_proj maps world space to clip space, row vectors, [0, 1] depth
+    void BeginFrame(const Matrix& view_proj);
+    // positions are float3 at stride bytes from each other, triangle list
+    void AddOccluder(const float* positions, uint32_t stride, const uint16_t* indices, uint32_t index_count, const Matrix& world);
+    // job_system may be nullptr
+    void Rasterize(JobSystem* job_system);
+
+    // conservative, boxes crossing the near plane are visible
+    bool IsVisible(const Vector3& center, const Vector3& extents) const;
+    // keeps the visible ones of indices in order, returns their number
+    uint32_t CullVisible(const CullBounds& bounds, uint32_t* indices, uint32_t count);
+
+    const OcclusionStats& GetStats() const { return m_stats; }
+    float GetDepth(uint32_t x, uint32_t y) const { return m_depth[GetPixelIndex(x, y)]; }
+
+private:
+    static const uint32_t k_tiles_x = k_width / k_tile_width;
+    static const uint32_t k_tiles_y = k_height / k_tile_height;
+    static const uint32_t k_blocks_x = k_width / k_block_size;
+    static const uint32_t k_blocks_y = k_height / k_block_size;
+
+    // pixel space, y down, oriented so the edge functions are positive inside
+    struct ScreenTriangle
+    {
+        float x[3];
+        float y[3];
+        float z[3];
+        int min_x, min_y, max_x, max_y;     // inclusive pixel bounds
+    };
+
+    static uint32_t GetPixelIndex(uint32_t x, uint32_t y)
+    {
+        uint32_t tile = (y / k_tile_height) * k_tiles_x + x / k_tile_width;
+        return tile * k_tile_width * k_tile_height + (y % k_tile_height) * k_tile_width + x % k_tile_width;
+    }
+    void RasterizeTile(uint32_t tile);
+    void RasterizeTriangle(const ScreenTriangle& triangle, int tile_min_x, int tile_min_y, int tile_max_x, int tile_max_y, float* tile_depth);
+
+private:
+    Matrix m_view_proj;
+    std::vector<ScreenTriangle> m_triangles;
+    std::vector<float> m_clip_positions;    // scratch, x y z w per vertex of the current occluder
+    std::vector<float> m_depth;             // tiled
+    std::vector<float> m_block_max_depth;   // farthest depth of each 8x8 block
+    OcclusionStats m_stats;
+};
@@ -0,0 +1,70 @@
+#include "RenderProxy.h"
+#include "Mesh/Mesh.h"
+
+void RenderProxyList::Clear()
+{
+    m_object_ids.clear();
+    m_world_matrices.clear();
+    m_center_x.clear();
+    m_center_y.clear();
+    m_center_z.clear();
+    m_radius.clear();
+    m_extent_x.clear();
+    m_extent_y.clear();
+    m_extent_z.clear();
+    m_meshes.clear();
+    m_materials.clear();
+    m_pso_ids.clear();
+    m_occluder_meshes.clear();
+}
+
+void RenderProxyList::Reserve(size_t count)
+{
+    m_object_ids.reserve(count);
+    m_world_matrices.reserve(count);
+    m_center_x.reserve(count);
+    m_center_y.reserve(count);
+    m_center_z.reserve(count);
+    m_radius.reserve(count);
+    m_extent_x.reserve(count);
+    m_extent_y.reserve(count);
+    m_extent_z.reserve(count);
+    m_meshes.reserve(count);
+    m_materials.reserve(count);
+    m_pso_ids.reserve(count);
+    m_occluder_meshes.reserve(count);
+}
+
+void RenderProxyList::Add(uint32_t object_id, const Matrix& world_matrix, Mesh* mesh, MaterialInstance* material, uint16_t pso_id, Mesh* occluder_mesh)
+{
+    BoundingSphere sphere = TransformBoundingSphere(mesh->GetBoundsCenter(), mesh->GetBoundsRadius(), world_matrix);
+    Vector3 extents = TransformExtents(mesh->GetBoundsExtents(), world_matrix);
+
+    m_object_ids.push_back(object_id);
+    m_world_matrices.push_back(world_matrix);
+    m_center_x.push_back(sphere.center.x);
+    m_center_y.push_back(sphere.center.y);
+    m_center_z.push_back(sphere.center.z);
+    m_radius.push_back(sphere.radius);
+    m_extent_x.push_back(extents.x);
+    m_extent_y.push_back(extents.y);
+    m_extent_z.push_back(extents.z);
+    m_meshes.push_back(mesh);
+    m_materials.push_back(material);
+    m_pso_ids.push_back(pso_id);
+    m_occluder_meshes.push_back(occluder_mesh);
+}
+
+CullBounds RenderProxyList::GetCullBounds() const
+{
+    CullBounds bounds;
+    bounds.center_x = m_center_x.data();
+    bounds.center_y = m_center_y.data();
+    bounds.center_z = m_center_z.data();
+    bounds.radius = m_radius.data();
+    bounds.extent_x = m_extent_x.data();
+    bounds.extent_y = m_extent_y.data();
+    bounds.extent_z = m_extent_z.data();
+    bounds.count = GetCount();
+    return bounds;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Math/Math.h"
+#include "Scene/Bounds.h"
+#include "FrustumCuller.h"
+
+class Mesh;
+class MaterialInstance;
+
+// camera state of one frame
+struct RenderView
+{
+    Matrix view = Matrix::Identity;
+    Matrix proj = Matrix::Identity;
+    Vector3 position;
+    Vector3 look;
+    float far_z = 1.0f;
+    float fov_y = 1.0f;             // radians
+    float viewport_height = 1.0f;   // pixels
+    Frustum frustum;
+};
+
+// what the renderer needs of each drawn object, copied from the game objects at the frame sync point
+// and immutable afterwards, so the render thread never reads game state
+// materials are shared with the game objects and only read while recording, per draw values go to render owned storage
+// arrays are parallel (SoA), index i of each one describes the same object
+class RenderProxyList
+{
+public:
+    RenderProxyList() = default;
+    ~RenderProxyList() = default;
+
+    void Clear();
+    void Reserve(size_t count);
+
+    // object_id stays with the object from frame to frame while proxy indices shift as objects enter and leave the view,
+    // per object history (e.g. LODSelector's levels) is kept by it, so ids should be small and dense
+    // bounds are the mesh's bounding sphere and box moved to world space
+    // occluder_mesh may be nullptr, see ModelGameObject::SetOccluderMesh
+    void Add(uint32_t object_id, const Matrix& world_matrix, Mesh* mesh, MaterialInstance* material, uint16_t pso_id, Mesh* occluder_mesh = nullptr);
+
+    uint32_t GetCount() const { return (uint32_t)m_world_matrices.size(); }
+    uint32_t GetObjectID(uint32_t index) const { return m_object_ids[index]; }
+    const Matrix& GetWorldMatrix(uint32_t index) const { return m_world_matrices[index]; }
+    Vector3 GetBoundsCenter(uint32_t index) const { return Vector3(m_center_x[index], m_center_y[index], m_center_z[index]); }
+    float GetBoundsRadius(uint32_t index) const { return m_radius[index]; }
+    CullBounds GetCullBounds() const;
+    Mesh* GetMesh(uint32_t index) const { return m_meshes[index]; }
+    MaterialInstance* GetMaterial(uint32_t index) const { return m_materials[index]; }
+    uint16_t GetPSOID(uint32_t index) const { return m_pso_ids[index]; }
+    Mesh* GetOccluderMesh(uint32_t index) const { return m_occluder_meshes[index]; }
+
+private:
+    std::vector<uint32_t> m_object_ids;
+    std::vector<Matrix> m_world_matrices;
+    std::vector<float> m_center_x;
+    std::vector<float> m_center_y;
+    std::vector<float> m_center_z;
+    std::vector<float> m_radius;
+    std::vector<float> m_extent_x;
+    std::vector<float> m_extent_y;
+    std::vector<float> m_extent_z;
+    std::vector<Mesh*> m_meshes;
+    std::vector<MaterialInstance*> m_materials;
+    std::vector<uint16_t> m_pso_ids;
+    std::vector<Mesh*> m_occluder_meshes;
+};
+
+// one proxy list and view per frame in flight: the game thread fills one while the render thread reads the other
+struct RenderFrameData
+{
+    RenderProxyList proxies;
+    RenderView view;
+};
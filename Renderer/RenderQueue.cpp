@@ -0,0 +1,173 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <cassert>
+
+static const uint32_t k_mesh_shift_opaque = RenderQueue::k_depth_bits;
+static const uint32_t k_material_shift_opaque = k_mesh_shift_opaque + RenderQueue::k_mesh_bits;
+static const uint32_t k_pso_shift_opaque = k_material_shift_opaque + RenderQueue::k_material_bits;
+static const uint32_t k_pass_shift = 60;
+
+static const uint32_t k_mesh_shift_transparent = 0;
+static const uint32_t k_material_shift_transparent = RenderQueue::k_mesh_bits;
+static const uint32_t k_pso_shift_transparent = k_material_shift_transparent + RenderQueue::k_material_bits;
+static const uint32_t k_depth_shift_transparent = k_pso_shift_transparent + RenderQueue::k_pso_bits;
+
+static_assert(RenderQueue::k_pass_bits + RenderQueue::k_pso_bits + RenderQueue::k_material_bits
+    + RenderQueue::k_mesh_bits + RenderQueue::k_depth_bits == 64, "sort key fields must fill 64 bits");
+static_assert(k_pso_shift_opaque + RenderQueue::k_pso_bits == k_pass_shift, "opaque key layout");
+static_assert(k_depth_shift_transparent + RenderQueue::k_depth_bits == k_pass_shift, "transparent key layout");
+
+static uint64_t GetMask(uint32_t bits)
+{
+    return (1ull << bits) - 1;
+}
+
+uint64_t RenderQueue::MakeKey(RenderPass pass, uint32_t pso_id, uint32_t material_id, uint32_t mesh_id, float depth)
+{
+    assert(pso_id <= GetMask(k_pso_bits));
+    assert(material_id <= GetMask(k_material_bits));
+    assert(mesh_id <= GetMask(k_mesh_bits));
+
+    depth = std::min(std::max(depth, 0.0f), 1.0f);
+    uint64_t quantized_depth = (uint64_t)(depth * (float)GetMask(k_depth_bits));
+
+    uint64_t key = (uint64_t)pass << k_pass_shift;
+    if(pass == RenderPass::k_transparent)
+    {
+        // inverted, so far draws sort first
+        key |= (~quantized_depth & GetMask(k_depth_bits)) << k_depth_shift_transparent;
+        key |= (uint64_t)pso_id << k_pso_shift_transparent;
+        key |= (uint64_t)material_id << k_material_shift_transparent;
+        key |= (uint64_t)mesh_id << k_mesh_shift_transparent;
+    }
+    else
+    {
+        key |= (uint64_t)pso_id << k_pso_shift_opaque;
+        key |= (uint64_t)material_id << k_material_shift_opaque;
+        key |= (uint64_t)mesh_id << k_mesh_shift_opaque;
+        key |= quantized_depth;
+    }
+    return key;
+}
+
+RenderSortKeyFields RenderQueue::DecodeKey(uint64_t key)
+{
+    RenderSortKeyFields fields;
+    fields.pass = (RenderPass)(key >> k_pass_shift);
+    if(fields.pass == RenderPass::k_transparent)
+    {
+        fields.depth = (uint32_t)(~(key >> k_depth_shift_transparent) & GetMask(k_depth_bits));
+        fields.pso_id = (uint32_t)((key >> k_pso_shift_transparent) & GetMask(k_pso_bits));
+        fields.material_id = (uint32_t)((key >> k_material_shift_transparent) & GetMask(k_material_bits));
+        fields.mesh_id = (uint32_t)((key >> k_mesh_shift_transparent) & GetMask(k_mesh_bits));
+    }
+    else
+    {
+        fields.depth = (uint32_t)(key & GetMask(k_depth_bits));
+        fields.pso_id = (uint32_t)((key >> k_pso_shift_opaque) & GetMask(k_pso_bits));
+        fields.material_id = (uint32_t)((key >> k_material_shift_opaque) & GetMask(k_material_bits));
+        fields.mesh_id = (uint32_t)((key >> k_mesh_shift_opaque) & GetMask(k_mesh_bits));
+    }
+    return fields;
+}
+
+void RenderQueue::Reserve(size_t count)
+{
+    m_keys.reserve(count);
+    m_items.reserve(count);
+    m_scratch_keys.reserve(count);
+    m_scratch_items.reserve(count);
+}
+
+void RenderQueue::Clear()
+{
+    // keeps the capacity
+    m_keys.clear();
+    m_items.clear();
+}
+
+void RenderQueue::Push(uint64_t key, uint32_t item)
+{
+    m_keys.push_back(key);
+    m_items.push_back(item);
+}
+
+void RenderQueue::Sort()
+{
+    m_unsorted_stats = CountStateChanges(m_keys.data(), m_keys.size());
+    RadixSort();
+    m_sorted_stats = CountStateChanges(m_keys.data(), m_keys.size());
+}
+
+void RenderQueue::RadixSort()
+{
+    const size_t count = m_keys.size();
+    m_scratch_keys.resize(count);
+    m_scratch_items.resize(count);
+
+    // one read of the keys builds the histograms of all 8 digits
+    uint32_t histograms[8][256] = {};
+    for(uint64_t key : m_keys)
+    {
+        for(int digit=0; digit<8; digit++)
+        {
+            histograms[digit][(key >> (digit * 8)) & 0xff]++;
+        }
+    }
+
+    for(int digit=0; digit<8; digit++)
+    {
+        uint32_t* histogram = histograms[digit];
+        const uint32_t shift = digit * 8;
+
+        // every key has the same byte here, e.g. the pass or unused id bits, nothing to do
+        if(count == 0 || histogram[(m_keys[0] >> shift) & 0xff] == count)
+        {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for(int bucket=0; bucket<256; bucket++)
+        {
+            uint32_t bucket_count = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucket_count;
+        }
+
+        // stable scatter, ties keep the order of the previous pass
+        for(size_t i=0; i<count; i++)
+        {
+            uint32_t destination = histogram[(m_keys[i] >> shift) & 0xff]++;
+            m_scratch_keys[destination] = m_keys[i];
+            m_scratch_items[destination] = m_items[i];
+        }
+        m_keys.swap(m_scratch_keys);
+        m_items.swap(m_scratch_items);
+    }
+}
+
+RenderQueueStats RenderQueue::CountStateChanges(const uint64_t* keys, size_t count)
+{
+    RenderQueueStats stats;
+    stats.draws = count;
+
+    RenderSortKeyFields previous = {};
+    for(size_t i=0; i<count; i++)
+    {
+        RenderSortKeyFields fields = DecodeKey(keys[i]);
+        if(i == 0 || fields.pso_id != previous.pso_id)
+        {
+            stats.pso_changes++;
+        }
+        if(i == 0 || fields.material_id != previous.material_id)
+        {
+            stats.material_changes++;
+        }
+        if(i == 0 || fields.mesh_id != previous.mesh_id)
+        {
+            stats.mesh_changes++;
+        }
+        previous = fields;
+    }
+    return stats;
+}
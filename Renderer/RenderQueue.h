@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class RenderPass : uint8_t
+{
+    k_opaque,
+    k_transparent,
+};
+
+// state changes a draw loop would issue walking the keys in order
+struct RenderQueueStats
+{
+    uint64_t draws = 0;
+    uint64_t pso_changes = 0;
+    uint64_t material_changes = 0;
+    uint64_t mesh_changes = 0;
+};
+
+// fields of a sort key, see RenderQueue::MakeKey
+struct RenderSortKeyFields
+{
+    RenderPass pass;
+    uint32_t pso_id;
+    uint32_t material_id;
+    uint32_t mesh_id;
+    uint32_t depth;     // quantized, as stored
+};
+
+// draws are pushed as (64 bit sort key, item index into the caller's draw list) pairs
+// and sorted with an LSD radix sort, the buffers are kept between frames so sorting does not allocate
+//
+// key layout, msb first:
+//   opaque:      pass 4 | pso 10 | material 12 | mesh 14 | depth 24   state first, then front to back
+//   transparent: pass 4 | ~depth 24 | pso 10 | material 12 | mesh 14  back to front first, blending needs it
+class RenderQueue
+{
+public:
+    RenderQueue() = default;
+    ~RenderQueue() = default;
+
+    static const uint32_t k_pass_bits = 4;
+    static const uint32_t k_pso_bits = 10;
+    static const uint32_t k_material_bits = 12;
+    static const uint32_t k_mesh_bits = 14;
+    static const uint32_t k_depth_bits = 24;
+
+    // depth is the view depth normalized to [0, 1], ids have to fit their field
+    static uint64_t MakeKey(RenderPass pass, uint32_t pso_id, uint32_t material_id, uint32_t mesh_id, float depth);
+    static RenderSortKeyFields DecodeKey(uint64_t key);
+
+    void Reserve(size_t count);
+    void Clear();
+    void Push(uint64_t key, uint32_t item);
+
+    // also records the state changes of the submission order and the sorted order
+    void Sort();
+
+    size_t GetCount() const { return m_keys.size(); }
+    uint64_t GetKey(size_t index) const { return m_keys[index]; }
+    uint32_t GetItem(size_t index) const { return m_items[index]; }
+
+    const RenderQueueStats& GetUnsortedStats() const { return m_unsorted_stats; }
+    const RenderQueueStats& GetSortedStats() const { return m_sorted_stats; }
+
+    static RenderQueueStats CountStateChanges(const uint64_t* keys, size_t count);
+
+private:
+    void RadixSort();
+
+private:
+    std::vector<uint64_t> m_keys;
+    std::vector<uint32_t> m_items;
+    std::vector<uint64_t> m_scratch_keys;
+    std::vector<uint32_t> m_scratch_items;
+
+    RenderQueueStats m_unsorted_stats;
+    RenderQueueStats m_sorted_stats;
+};
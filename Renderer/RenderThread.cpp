@@ -0,0 +1,77 @@
+#include "RenderThread.h"
+#include <cassert>
+
+RenderThread::RenderThread(RenderFunc render_func):
+    m_render_func(std::move(render_func))
+{
+    m_thread = std::thread(&RenderThread::ThreadLoop, this);
+}
+
+RenderThread::~RenderThread()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_condition.wait(lock, [this]() { return !m_b_frame_pending; });
+        m_stop = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+void RenderThread::Kick(uint32_t frame_index)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        assert(!m_b_frame_pending);
+        m_frame_index = frame_index;
+        m_b_frame_pending = true;
+    }
+    m_condition.notify_all();
+}
+
+void RenderThread::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]() { return !m_b_frame_pending; });
+    if(m_exception)
+    {
+        std::exception_ptr exception = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+void RenderThread::ThreadLoop()
+{
+    while(true)
+    {
+        uint32_t frame_index = 0;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stop || m_b_frame_pending; });
+            if(m_stop)
+            {
+                return;
+            }
+            frame_index = m_frame_index;
+        }
+
+        // handed to the game thread, which is the one that can report it
+        std::exception_ptr exception;
+        try
+        {
+            m_render_func(frame_index);
+        }
+        catch(...)
+        {
+            exception = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_exception = exception;
+            m_b_frame_pending = false;
+        }
+        m_condition.notify_all();
+    }
+}
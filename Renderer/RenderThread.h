@@ -0,0 +1,43 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// records and submits frames on a dedicated thread so the game thread can simulate the next frame meanwhile
+// one frame is in flight at a time: Kick hands over a frame, WaitIdle blocks until it was rendered
+// everything the render function reads must stay untouched by the game thread until WaitIdle returns
+class RenderThread
+{
+public:
+    typedef std::function<void(uint32_t frame_index)> RenderFunc;
+
+    RenderThread() = delete;
+    explicit RenderThread(RenderFunc render_func);
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // the previous frame must be finished, see WaitIdle
+    void Kick(uint32_t frame_index);
+    // rethrows an exception the render function threw
+    void WaitIdle();
+
+private:
+    void ThreadLoop();
+
+private:
+    RenderFunc m_render_func;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_b_frame_pending = false;
+    uint32_t m_frame_index = 0;
+    std::exception_ptr m_exception;
+    bool m_stop = false;
+
+    std::thread m_thread;
+};
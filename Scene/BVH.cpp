@@ -0,0 +1,214 @@
+#include "BVH.h"
+#include <cassert>
+#include <cfloat>
+#include <numeric>
+
+namespace
+{
+    const uint32_t k_bin_count = 16;
+    const float k_traversal_cost = 1.0f;   // relative to one primitive test
+
+    struct BuildTask
+    {
+        uint32_t node = 0;
+        uint32_t depth = 0;
+    };
+
+    struct Bin
+    {
+        AABB bounds = { Vector3(FLT_MAX, FLT_MAX, FLT_MAX), Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX) };
+        uint32_t count = 0;
+    };
+
+    void Grow(AABB& box, const AABB& other)
+    {
+        box.min = Vector3(std::min(box.min.x, other.min.x), std::min(box.min.y, other.min.y), std::min(box.min.z, other.min.z));
+        box.max = Vector3(std::max(box.max.x, other.max.x), std::max(box.max.y, other.max.y), std::max(box.max.z, other.max.z));
+    }
+
+    void Grow(AABB& box, const Vector3& point)
+    {
+        box.min = Vector3(std::min(box.min.x, point.x), std::min(box.min.y, point.y), std::min(box.min.z, point.z));
+        box.max = Vector3(std::max(box.max.x, point.x), std::max(box.max.y, point.y), std::max(box.max.z, point.z));
+    }
+
+    // half the surface area, the sah only compares ratios
+    float GetHalfArea(const AABB& box)
+    {
+        float dx = box.max.x - box.min.x;
+        float dy = box.max.y - box.min.y;
+        float dz = box.max.z - box.min.z;
+        return dx < 0.0f ? 0.0f : dx * dy + dy * dz + dz * dx;
+    }
+
+    float GetAxis(const Vector3& v, int axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    uint32_t GetBin(float centroid, float centroid_min, float bin_scale)
+    {
+        return std::min((uint32_t)((centroid - centroid_min) * bin_scale), k_bin_count - 1);
+    }
+}
+
+void BVH::Build(const AABB* boxes, const Vector3* centroids, uint32_t count, uint32_t max_leaf_size)
+{
+    assert(max_leaf_size > 0);
+    Clear();
+    if(count == 0)
+    {
+        return;
+    }
+
+    m_primitive_order.resize(count);
+    std::iota(m_primitive_order.begin(), m_primitive_order.end(), 0u);
+
+    // a binary tree with count leaves at most, reserved so nodes are never reallocated during the build
+    m_nodes.reserve((size_t)count * 2 - 1);
+    m_nodes.emplace_back();
+    m_nodes[0].first = 0;
+    m_nodes[0].count = count;
+
+    std::vector<BuildTask> tasks;
+    tasks.push_back({ 0, 0 });
+    while(!tasks.empty())
+    {
+        BuildTask task = tasks.back();
+        tasks.pop_back();
+
+        // a pending node holds its primitive range like a leaf until it is split
+        uint32_t begin = m_nodes[task.node].first;
+        uint32_t primitive_count = m_nodes[task.node].count;
+        uint32_t end = begin + primitive_count;
+
+        AABB bounds = Bin().bounds;
+        AABB centroid_bounds = Bin().bounds;
+        for(uint32_t i=begin; i<end; i++)
+        {
+            Grow(bounds, boxes[m_primitive_order[i]]);
+            Grow(centroid_bounds, centroids[m_primitive_order[i]]);
+        }
+        BVHNode& node = m_nodes[task.node];
+        node.min[0] = bounds.min.x;
+        node.min[1] = bounds.min.y;
+        node.min[2] = bounds.min.z;
+        node.max[0] = bounds.max.x;
+        node.max[1] = bounds.max.y;
+        node.max[2] = bounds.max.z;
+
+        if(primitive_count <= max_leaf_size || task.depth + 1 >= k_max_depth)
+        {
+            continue;
+        }
+
+        // bin the centroids along the three axes in one pass
+        Bin bins[3][k_bin_count];
+        float bin_scales[3];
+        for(int axis=0; axis<3; axis++)
+        {
+            float extent = GetAxis(centroid_bounds.max, axis) - GetAxis(centroid_bounds.min, axis);
+            bin_scales[axis] = extent > 0.0f ? (float)k_bin_count / extent : 0.0f;
+        }
+        for(uint32_t i=begin; i<end; i++)
+        {
+            uint32_t primitive = m_primitive_order[i];
+            for(int axis=0; axis<3; axis++)
+            {
+                Bin& bin = bins[axis][GetBin(GetAxis(centroids[primitive], axis), GetAxis(centroid_bounds.min, axis), bin_scales[axis])];
+                Grow(bin.bounds, boxes[primitive]);
+                bin.count++;
+            }
+        }
+
+        // sweep the planes between bins, cost = area left * count left + area right * count right
+        int best_axis = -1;
+        uint32_t best_split = 0;
+        float best_cost = FLT_MAX;
+        for(int axis=0; axis<3; axis++)
+        {
+            if(bin_scales[axis] == 0.0f)
+            {
+                continue;
+            }
+
+            float right_costs[k_bin_count];
+            AABB right_bounds = Bin().bounds;
+            uint32_t right_count = 0;
+            for(uint32_t split=k_bin_count - 1; split>0; split--)
+            {
+                Grow(right_bounds, bins[axis][split].bounds);
+                right_count += bins[axis][split].count;
+                right_costs[split] = right_count > 0 ? GetHalfArea(right_bounds) * right_count : 0.0f;
+            }
+
+            AABB left_bounds = Bin().bounds;
+            uint32_t left_count = 0;
+            for(uint32_t split=1; split<k_bin_count; split++)
+            {
+                Grow(left_bounds, bins[axis][split - 1].bounds);
+                left_count += bins[axis][split - 1].count;
+                if(left_count == 0 || left_count == primitive_count)
+                {
+                    continue;
+                }
+                float cost = GetHalfArea(left_bounds) * left_count + right_costs[split];
+                if(cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_split = split;
+                }
+            }
+        }
+
+        // every centroid in the same place, nothing to split on
+        if(best_axis < 0)
+        {
+            continue;
+        }
+
+        // small ranges stay a leaf when testing them all is cheaper than one more level
+        // larger ones are split regardless so leaves keep a bounded size
+        float leaf_cost = GetHalfArea(bounds) * primitive_count;
+        float split_cost = GetHalfArea(bounds) * k_traversal_cost + best_cost;
+        if(split_cost >= leaf_cost && primitive_count <= max_leaf_size * 2)
+        {
+            continue;
+        }
+
+        float centroid_min = GetAxis(centroid_bounds.min, best_axis);
+        float bin_scale = bin_scales[best_axis];
+        auto middle = std::partition(m_primitive_order.begin() + begin, m_primitive_order.begin() + end, [&](uint32_t primitive)
+        {
+            return GetBin(GetAxis(centroids[primitive], best_axis), centroid_min, bin_scale) < best_split;
+        });
+        uint32_t left_count = (uint32_t)(middle - m_primitive_order.begin()) - begin;
+
+        uint32_t left = (uint32_t)m_nodes.size();
+        m_nodes.emplace_back();
+        m_nodes.emplace_back();
+        m_nodes[left].first = begin;
+        m_nodes[left].count = left_count;
+        m_nodes[left + 1].first = begin + left_count;
+        m_nodes[left + 1].count = primitive_count - left_count;
+        m_nodes[task.node].first = left;
+        m_nodes[task.node].count = 0;
+
+        tasks.push_back({ left + 1, task.depth + 1 });
+        tasks.push_back({ left, task.depth + 1 });
+    }
+}
+
+void BVH::Clear()
+{
+    m_nodes.clear();
+    m_primitive_order.clear();
+}
+
+AABB BVH::GetBounds() const
+{
+    assert(!m_nodes.empty());
+    const BVHNode& root = m_nodes[0];
+    return { Vector3(root.min[0], root.min[1], root.min[2]), Vector3(root.max[0], root.max[1], root.max[2]) };
+}
@@ -0,0 +1,187 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "Bounds.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define BVH_SSE 1
+#include <emmintrin.h>
+#endif
+
+// node of a binary bvh, 32 bytes so two siblings share a cache line
+// interior nodes have count 0 and their children at first and first + 1
+// leaves own the primitives [first, first + count) of BVH::GetPrimitiveOrder
+struct BVHNode
+{
+    float min[3];
+    uint32_t first = 0;
+    float max[3];
+    uint32_t count = 0;
+
+    bool IsLeaf() const { return count > 0; }
+};
+
+// ray prepared for box tests, arrays are padded to 4 floats for sse loads
+struct BVHRay
+{
+    alignas(16) float origin[4];
+    alignas(16) float direction[4];
+    alignas(16) float inv_direction[4];
+
+    BVHRay() = default;
+    BVHRay(const Vector3& ray_origin, const Vector3& ray_direction);
+};
+
+// bounding volume hierarchy over primitive boxes, built with binned sah
+// the primitives themselves are owned by the user, see MeshBVH and SceneBVH
+// traversal is front to back with a fixed stack, the build caps the depth so it never overflows
+class BVH
+{
+public:
+    static const uint32_t k_max_depth = 64;
+
+    BVH() = default;
+    ~BVH() = default;
+
+    // boxes and centroids are indexed by primitive, leaves hold up to max_leaf_size of them,
+    // twice that if the sah finds no cheaper split, more only at the depth limit or if their centroids coincide
+    void Build(const AABB* boxes, const Vector3* centroids, uint32_t count, uint32_t max_leaf_size);
+    void Clear();
+
+    bool IsEmpty() const { return m_nodes.empty(); }
+    uint32_t GetNodeCount() const { return (uint32_t)m_nodes.size(); }
+    const BVHNode& GetNode(uint32_t index) const { return m_nodes[index]; }
+    // primitive index of each leaf slot
+    const std::vector<uint32_t>& GetPrimitiveOrder() const { return m_primitive_order; }
+    AABB GetBounds() const;
+
+    // entry distance of the ray in [0, t_max], false if it misses the box
+    static bool IntersectBox(const BVHNode& node, const BVHRay& ray, float t_max, float& t_entry);
+
+    // leaf_func(first, count, t_max) tests the leaf's primitives and returns the new closest distance
+    // nodes farther than the closest hit so far are skipped
+    template<typename LeafFunc>
+    void Traverse(const BVHRay& ray, float t_max, LeafFunc&& leaf_func) const;
+
+private:
+    std::vector<BVHNode> m_nodes;   // m_nodes[0] is the root
+    std::vector<uint32_t> m_primitive_order;
+};
+
+inline BVHRay::BVHRay(const Vector3& ray_origin, const Vector3& ray_direction)
+{
+    // a zero direction component gets a +inf inverse, -0 too so the slab's t0 <= t1 still holds,
+    // an origin on one of its planes then gives 0 * inf = nan which IntersectBox leaves out
+    origin[0] = ray_origin.x;
+    origin[1] = ray_origin.y;
+    origin[2] = ray_origin.z;
+    origin[3] = 0.0f;
+    direction[0] = ray_direction.x;
+    direction[1] = ray_direction.y;
+    direction[2] = ray_direction.z;
+    direction[3] = 0.0f;
+    for(int axis=0; axis<3; axis++)
+    {
+        inv_direction[axis] = direction[axis] != 0.0f ? 1.0f / direction[axis] : INFINITY;
+    }
+    inv_direction[3] = 0.0f;
+}
+
+inline bool BVH::IntersectBox(const BVHNode& node, const BVHRay& ray, float t_max, float& t_entry)
+{
+#if defined(BVH_SSE)
+    // lane 3 holds first / count and is left out of the reductions
+    __m128 origin = _mm_load_ps(ray.origin);
+    __m128 inv_direction = _mm_load_ps(ray.inv_direction);
+    __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.min), origin), inv_direction);
+    __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(node.max), origin), inv_direction);
+    // min/max return their second operand when either is nan, the operand order keeps a nan slab
+    // out of the result so a ray along a box face still enters the box
+    __m128 t_near = _mm_min_ps(t1, t0);
+    __m128 t_far = _mm_max_ps(t0, t1);
+
+    __m128 near_result = _mm_max_ss(t_near, _mm_setzero_ps());
+    near_result = _mm_max_ss(_mm_shuffle_ps(t_near, t_near, _MM_SHUFFLE(1, 1, 1, 1)), near_result);
+    near_result = _mm_max_ss(_mm_shuffle_ps(t_near, t_near, _MM_SHUFFLE(2, 2, 2, 2)), near_result);
+    __m128 far_result = _mm_min_ss(t_far, _mm_set_ss(t_max));
+    far_result = _mm_min_ss(_mm_shuffle_ps(t_far, t_far, _MM_SHUFFLE(1, 1, 1, 1)), far_result);
+    far_result = _mm_min_ss(_mm_shuffle_ps(t_far, t_far, _MM_SHUFFLE(2, 2, 2, 2)), far_result);
+
+    t_entry = _mm_cvtss_f32(near_result);
+    return _mm_comile_ss(near_result, far_result) != 0;
+#else
+    float t_near = 0.0f;
+    float t_far = t_max;
+    for(int axis=0; axis<3; axis++)
+    {
+        float t0 = (node.min[axis] - ray.origin[axis]) * ray.inv_direction[axis];
+        float t1 = (node.max[axis] - ray.origin[axis]) * ray.inv_direction[axis];
+        // comparisons with a nan are false, it leaves t_near and t_far as they are
+        float axis_near = t1 < t0 ? t1 : t0;
+        float axis_far = t0 > t1 ? t0 : t1;
+        t_near = axis_near > t_near ? axis_near : t_near;
+        t_far = axis_far < t_far ? axis_far : t_far;
+    }
+    t_entry = t_near;
+    return t_near <= t_far;
+#endif
+}
+
+template<typename LeafFunc>
+void BVH::Traverse(const BVHRay& ray, float t_max, LeafFunc&& leaf_func) const
+{
+    float t_entry = 0.0f;
+    if(m_nodes.empty() || !IntersectBox(m_nodes[0], ray, t_max, t_entry))
+    {
+        return;
+    }
+
+    // one entry is pushed per level descended, the farther child with its entry distance
+    uint32_t stack_nodes[k_max_depth];
+    float stack_entries[k_max_depth];
+    uint32_t stack_size = 0;
+    uint32_t node_index = 0;
+
+    while(true)
+    {
+        const BVHNode& node = m_nodes[node_index];
+        if(node.IsLeaf())
+        {
+            t_max = leaf_func(node.first, node.count, t_max);
+        }
+        else
+        {
+            float entry0 = 0.0f;
+            float entry1 = 0.0f;
+            bool b_hit0 = IntersectBox(m_nodes[node.first], ray, t_max, entry0);
+            bool b_hit1 = IntersectBox(m_nodes[node.first + 1], ray, t_max, entry1);
+            if(b_hit0 && b_hit1)
+            {
+                uint32_t near_child = entry0 <= entry1 ? node.first : node.first + 1;
+                stack_nodes[stack_size] = near_child == node.first ? node.first + 1 : node.first;
+                stack_entries[stack_size] = std::max(entry0, entry1);
+                stack_size++;
+                node_index = near_child;
+                continue;
+            }
+            if(b_hit0 || b_hit1)
+            {
+                node_index = b_hit0 ? node.first : node.first + 1;
+                continue;
+            }
+        }
+
+        // pop the next subtree that may still hold a closer hit
+        do
+        {
+            if(stack_size == 0)
+            {
+                return;
+            }
+            stack_size--;
+        }
+        while(stack_entries[stack_size] > t_max);
+        node_index = stack_nodes[stack_size];
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include "Math/Math.h"
+
+struct BoundingSphere
+{
+    Vector3 center;
+    float radius = 0.0f;
+};
+
+struct AABB
+{
+    Vector3 min;
+    Vector3 max;
+};
+
+// points p with dot(normal, p) + d >= 0 are on the inner side
+struct Plane
+{
+    Vector3 normal;
+    float d = 0.0f;
+
+    float GetDistance(const Vector3& point) const { return normal.x * point.x + normal.y * point.y + normal.z * point.z + d; }
+};
+
+// left, right, bottom, top, near, far, normals pointing inside
+struct Frustum
+{
+    static const int k_plane_count = 6;
+    Plane planes[k_plane_count];
+};
+
+struct Ray
+{
+    Vector3 origin;
+    Vector3 direction;  // normalized
+    float max_distance = FLT_MAX;
+};
+
+// Gribb/Hartmann plane extraction for row vectors (clip = p * view_proj) and a [0, 1] clip depth
+// the planes are combinations of the matrix columns, normalized so distances are in world units
+inline Frustum ExtractFrustum(const Matrix& m)
+{
+    const float column_x[4] = { m._11, m._21, m._31, m._41 };
+    const float column_y[4] = { m._12, m._22, m._32, m._42 };
+    const float column_z[4] = { m._13, m._23, m._33, m._43 };
+    const float column_w[4] = { m._14, m._24, m._34, m._44 };
+
+    float coefficients[Frustum::k_plane_count][4];
+    for(int i=0; i<4; i++)
+    {
+        coefficients[0][i] = column_w[i] + column_x[i];  // left
+        coefficients[1][i] = column_w[i] - column_x[i];  // right
+        coefficients[2][i] = column_w[i] + column_y[i];  // bottom
+        coefficients[3][i] = column_w[i] - column_y[i];  // top
+        coefficients[4][i] = column_z[i];                // near
+        coefficients[5][i] = column_w[i] - column_z[i];  // far
+    }
+
+    Frustum frustum;
+    for(int i=0; i<Frustum::k_plane_count; i++)
+    {
+        const float* c = coefficients[i];
+        float inv_length = 1.0f / std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+        frustum.planes[i].normal = Vector3(c[0] * inv_length, c[1] * inv_length, c[2] * inv_length);
+        frustum.planes[i].d = c[3] * inv_length;
+    }
+    return frustum;
+}
+
+// half sizes of a box after transforming it, the box of the rotated box
+inline Vector3 TransformExtents(const Vector3& extents, const Matrix& world)
+{
+    return Vector3(
+        std::abs(world._11) * extents.x + std::abs(world._21) * extents.y + std::abs(world._31) * extents.z,
+        std::abs(world._12) * extents.x + std::abs(world._22) * extents.y + std::abs(world._32) * extents.z,
+        std::abs(world._13) * extents.x + std::abs(world._23) * extents.y + std::abs(world._33) * extents.z);
+}
+
+// length of the longest scaled axis of world, row vector times matrix so the rows of the upper 3x3 are the axes
+inline float GetMaxAxisScale(const Matrix& world)
+{
+    float scale_sq = std::max({
+        world._11 * world._11 + world._12 * world._12 + world._13 * world._13,
+        world._21 * world._21 + world._22 * world._22 + world._23 * world._23,
+        world._31 * world._31 + world._32 * world._32 + world._33 * world._33 });
+    return std::sqrt(scale_sq);
+}
+
+// sphere of a mesh moved to world space, the radius grows with the largest axis scale
+inline BoundingSphere TransformBoundingSphere(const Vector3& local_center, float local_radius, const Matrix& world)
+{
+    BoundingSphere sphere;
+    sphere.center = Vector3(
+        local_center.x * world._11 + local_center.y * world._21 + local_center.z * world._31 + world._41,
+        local_center.x * world._12 + local_center.y * world._22 + local_center.z * world._32 + world._42,
+        local_center.x * world._13 + local_center.y * world._23 + local_center.z * world._33 + world._43);
+    sphere.radius = local_radius * GetMaxAxisScale(world);
+    return sphere;
+}
@@ -0,0 +1,293 @@
+#include "LooseOctree.h"
+#include <cassert>
+
+LooseOctree::LooseOctree(const Vector3& center, float half_size, uint32_t max_depth):
+    m_max_depth(std::min(max_depth, k_max_depth))
+{
+    Node root;
+    root.center = center;
+    root.half_size = half_size;
+    std::fill(std::begin(root.children), std::end(root.children), k_invalid_index);
+    m_nodes.push_back(root);
+}
+
+uint32_t LooseOctree::GetTargetDepth(const BoundingSphere& bounds) const
+{
+    if(!IsInRootCell(bounds.center))
+    {
+        return 0;
+    }
+
+    uint32_t depth = 0;
+    float half_size = m_nodes[0].half_size * 0.5f;
+    while(depth < m_max_depth && bounds.radius <= half_size)
+    {
+        depth++;
+        half_size *= 0.5f;
+    }
+    return depth;
+}
+
+bool LooseOctree::IsInRootCell(const Vector3& point) const
+{
+    const Node& root = m_nodes[0];
+    return std::abs(point.x - root.center.x) <= root.half_size &&
+        std::abs(point.y - root.center.y) <= root.half_size &&
+        std::abs(point.z - root.center.z) <= root.half_size;
+}
+
+uint32_t LooseOctree::GetChildSlot(const Node& node, const Vector3& point)
+{
+    return (point.x > node.center.x ? 1 : 0) | (point.y > node.center.y ? 2 : 0) | (point.z > node.center.z ? 4 : 0);
+}
+
+uint32_t LooseOctree::AllocateNode(uint32_t parent, uint32_t slot)
+{
+    uint32_t index;
+    if(!m_free_nodes.empty())
+    {
+        index = m_free_nodes.back();
+        m_free_nodes.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)m_nodes.size();
+        m_nodes.emplace_back();
+    }
+
+    const Node& parent_node = m_nodes[parent];
+    float half_size = parent_node.half_size * 0.5f;
+    Node node;
+    node.center = Vector3(
+        parent_node.center.x + ((slot & 1) ? half_size : -half_size),
+        parent_node.center.y + ((slot & 2) ? half_size : -half_size),
+        parent_node.center.z + ((slot & 4) ? half_size : -half_size));
+    node.half_size = half_size;
+    node.depth = parent_node.depth + 1;
+    node.parent = parent;
+    std::fill(std::begin(node.children), std::end(node.children), k_invalid_index);
+    m_nodes[index] = node;
+
+    m_nodes[parent].children[slot] = index;
+    m_nodes[parent].child_count++;
+    return index;
+}
+
+uint32_t LooseOctree::FindOrCreateNode(const BoundingSphere& bounds)
+{
+    uint32_t target_depth = GetTargetDepth(bounds);
+    uint32_t node = 0;
+    for(uint32_t depth=0; depth<target_depth; depth++)
+    {
+        uint32_t slot = GetChildSlot(m_nodes[node], bounds.center);
+        uint32_t child = m_nodes[node].children[slot];
+        node = child != k_invalid_index ? child : AllocateNode(node, slot);
+    }
+    return node;
+}
+
+void LooseOctree::LinkObject(uint32_t node, OctreeHandle handle)
+{
+    Object& object = m_objects[handle];
+    object.node = node;
+    object.prev = k_invalid_index;
+    object.next = m_nodes[node].first_object;
+    if(object.next != k_invalid_index)
+    {
+        m_objects[object.next].prev = handle;
+    }
+    m_nodes[node].first_object = handle;
+}
+
+void LooseOctree::UnlinkObject(OctreeHandle handle)
+{
+    Object& object = m_objects[handle];
+    if(object.prev != k_invalid_index)
+    {
+        m_objects[object.prev].next = object.next;
+    }
+    else
+    {
+        m_nodes[object.node].first_object = object.next;
+    }
+    if(object.next != k_invalid_index)
+    {
+        m_objects[object.next].prev = object.prev;
+    }
+    object.prev = object.next = k_invalid_index;
+}
+
+void LooseOctree::PruneNode(uint32_t node)
+{
+    // free empty leaves up to the first node still in use, the root is kept
+    while(node != 0 && m_nodes[node].first_object == k_invalid_index && m_nodes[node].child_count == 0)
+    {
+        uint32_t parent = m_nodes[node].parent;
+        for(uint32_t& child : m_nodes[parent].children)
+        {
+            if(child == node)
+            {
+                child = k_invalid_index;
+            }
+        }
+        m_nodes[parent].child_count--;
+        m_free_nodes.push_back(node);
+        node = parent;
+    }
+}
+
+OctreeHandle LooseOctree::Insert(const BoundingSphere& bounds, uint32_t user_data)
+{
+    OctreeHandle handle;
+    if(!m_free_objects.empty())
+    {
+        handle = m_free_objects.back();
+        m_free_objects.pop_back();
+    }
+    else
+    {
+        handle = (OctreeHandle)m_objects.size();
+        m_objects.emplace_back();
+    }
+
+    m_objects[handle].bounds = bounds;
+    m_objects[handle].user_data = user_data;
+    LinkObject(FindOrCreateNode(bounds), handle);
+    m_object_count++;
+    return handle;
+}
+
+void LooseOctree::Remove(OctreeHandle handle)
+{
+    assert(m_objects[handle].node != k_invalid_index);
+    uint32_t node = m_objects[handle].node;
+    UnlinkObject(handle);
+    m_objects[handle].node = k_invalid_index;
+    PruneNode(node);
+    m_free_objects.push_back(handle);
+    m_object_count--;
+}
+
+void LooseOctree::Move(OctreeHandle handle, const BoundingSphere& bounds)
+{
+    Object& object = m_objects[handle];
+    assert(object.node != k_invalid_index);
+    object.bounds = bounds;
+
+    // still the right cell, nothing to relink
+    const Node& node = m_nodes[object.node];
+    if(node.depth == GetTargetDepth(bounds) &&
+        std::abs(bounds.center.x - node.center.x) <= node.half_size &&
+        std::abs(bounds.center.y - node.center.y) <= node.half_size &&
+        std::abs(bounds.center.z - node.center.z) <= node.half_size)
+    {
+        return;
+    }
+
+    uint32_t old_node = object.node;
+    UnlinkObject(handle);
+    LinkObject(FindOrCreateNode(bounds), handle);
+    PruneNode(old_node);
+}
+
+void LooseOctree::QueryFrustum(const Frustum& frustum, std::vector<OctreeHandle>& results) const
+{
+    // a box is outside when its corner furthest along the plane normal is behind the plane
+    auto node_test = [&frustum](const Vector3& center, float half_size)
+    {
+        for(const Plane& plane : frustum.planes)
+        {
+            float extent = half_size * (std::abs(plane.normal.x) + std::abs(plane.normal.y) + std::abs(plane.normal.z));
+            if(plane.GetDistance(center) < -extent)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto object_test = [&frustum](const BoundingSphere& bounds)
+    {
+        for(const Plane& plane : frustum.planes)
+        {
+            if(plane.GetDistance(bounds.center) < -bounds.radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    Query(node_test, object_test, results);
+}
+
+void LooseOctree::QuerySphere(const BoundingSphere& sphere, std::vector<OctreeHandle>& results) const
+{
+    auto node_test = [&sphere](const Vector3& center, float half_size)
+    {
+        // distance from the sphere center to the box
+        float dx = std::max(std::abs(sphere.center.x - center.x) - half_size, 0.0f);
+        float dy = std::max(std::abs(sphere.center.y - center.y) - half_size, 0.0f);
+        float dz = std::max(std::abs(sphere.center.z - center.z) - half_size, 0.0f);
+        return dx * dx + dy * dy + dz * dz <= sphere.radius * sphere.radius;
+    };
+    auto object_test = [&sphere](const BoundingSphere& bounds)
+    {
+        float dx = bounds.center.x - sphere.center.x;
+        float dy = bounds.center.y - sphere.center.y;
+        float dz = bounds.center.z - sphere.center.z;
+        float radius = bounds.radius + sphere.radius;
+        return dx * dx + dy * dy + dz * dz <= radius * radius;
+    };
+    Query(node_test, object_test, results);
+}
+
+void LooseOctree::QueryAABB(const AABB& box, std::vector<OctreeHandle>& results) const
+{
+    auto node_test = [&box](const Vector3& center, float half_size)
+    {
+        return center.x - half_size <= box.max.x && center.x + half_size >= box.min.x &&
+            center.y - half_size <= box.max.y && center.y + half_size >= box.min.y &&
+            center.z - half_size <= box.max.z && center.z + half_size >= box.min.z;
+    };
+    auto object_test = [&box](const BoundingSphere& bounds)
+    {
+        float dx = bounds.center.x - std::min(std::max(bounds.center.x, box.min.x), box.max.x);
+        float dy = bounds.center.y - std::min(std::max(bounds.center.y, box.min.y), box.max.y);
+        float dz = bounds.center.z - std::min(std::max(bounds.center.z, box.min.z), box.max.z);
+        return dx * dx + dy * dy + dz * dz <= bounds.radius * bounds.radius;
+    };
+    Query(node_test, object_test, results);
+}
+
+void LooseOctree::QueryRay(const Ray& ray, std::vector<OctreeHandle>& results) const
+{
+    // slab test, a zero direction component gives infinite inverses which the min/max handle
+    Vector3 inv_direction(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+    auto node_test = [&ray, &inv_direction](const Vector3& center, float half_size)
+    {
+        float t_min = 0.0f;
+        float t_max = ray.max_distance;
+        const float origin[3] = { ray.origin.x, ray.origin.y, ray.origin.z };
+        const float inv[3] = { inv_direction.x, inv_direction.y, inv_direction.z };
+        const float box_center[3] = { center.x, center.y, center.z };
+        for(int axis=0; axis<3; axis++)
+        {
+            float t0 = (box_center[axis] - half_size - origin[axis]) * inv[axis];
+            float t1 = (box_center[axis] + half_size - origin[axis]) * inv[axis];
+            t_min = std::max(t_min, std::min(t0, t1));
+            t_max = std::min(t_max, std::max(t0, t1));
+        }
+        return t_min <= t_max;
+    };
+    auto object_test = [&ray](const BoundingSphere& bounds)
+    {
+        // closest point of the ray segment to the center
+        Vector3 offset(bounds.center.x - ray.origin.x, bounds.center.y - ray.origin.y, bounds.center.z - ray.origin.z);
+        float t = offset.x * ray.direction.x + offset.y * ray.direction.y + offset.z * ray.direction.z;
+        t = std::min(std::max(t, 0.0f), ray.max_distance);
+        float dx = offset.x - ray.direction.x * t;
+        float dy = offset.y - ray.direction.y * t;
+        float dz = offset.z - ray.direction.z * t;
+        return dx * dx + dy * dy + dz * dz <= bounds.radius * bounds.radius;
+    };
+    Query(node_test, object_test, results);
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Bounds.h"
+
+// stable handle of an object in a LooseOctree
+typedef uint32_t OctreeHandle;
+static const OctreeHandle k_invalid_octree_handle = 0xffffffff;
+
+// loose octree over bounding spheres, loose factor 2: a node's cell is [center - half_size, center + half_size]
+// and its objects stay within twice that, so an object goes to the deepest cell at least as large as its radius
+// that contains its center, without ever straddling a child boundary
+// nodes are created on demand along the insertion path and freed once they hold nothing
+// insert, remove and move walk one root to leaf path, moving within its current cell only updates the bounds
+// objects whose center lies outside the root cell are kept in the root
+// queries append handles to a caller owned vector and traverse with a fixed stack, so a reused vector never allocates
+class LooseOctree
+{
+public:
+    static const uint32_t k_max_depth = 16;
+
+    LooseOctree() = delete;
+    LooseOctree(const Vector3& center, float half_size, uint32_t max_depth = 6);
+    ~LooseOctree() = default;
+
+    OctreeHandle Insert(const BoundingSphere& bounds, uint32_t user_data);
+    void Remove(OctreeHandle handle);
+    void Move(OctreeHandle handle, const BoundingSphere& bounds);
+
+    const BoundingSphere& GetBounds(OctreeHandle handle) const { return m_objects[handle].bounds; }
+    uint32_t GetUserData(OctreeHandle handle) const { return m_objects[handle].user_data; }
+    uint32_t GetObjectCount() const { return m_object_count; }
+    uint32_t GetNodeCount() const { return (uint32_t)(m_nodes.size() - m_free_nodes.size()); }
+
+    // results are appended, objects intersecting or possibly intersecting (frustum corners) the shape
+    void QueryFrustum(const Frustum& frustum, std::vector<OctreeHandle>& results) const;
+    void QuerySphere(const BoundingSphere& sphere, std::vector<OctreeHandle>& results) const;
+    void QueryAABB(const AABB& box, std::vector<OctreeHandle>& results) const;
+    // unordered, every object whose sphere the ray hits within max_distance
+    void QueryRay(const Ray& ray, std::vector<OctreeHandle>& results) const;
+
+private:
+    static const uint32_t k_invalid_index = 0xffffffff;
+
+    struct Node
+    {
+        Vector3 center;
+        float half_size = 0.0f;
+        uint32_t depth = 0;
+        uint32_t parent = k_invalid_index;
+        uint32_t children[8];
+        uint32_t child_count = 0;
+        uint32_t first_object = k_invalid_index;
+    };
+
+    struct Object
+    {
+        BoundingSphere bounds;
+        uint32_t user_data = 0;
+        uint32_t node = k_invalid_index;    // k_invalid_index while the slot is free
+        uint32_t prev = k_invalid_index;
+        uint32_t next = k_invalid_index;
+    };
+
+    uint32_t GetTargetDepth(const BoundingSphere& bounds) const;
+    bool IsInRootCell(const Vector3& point) const;
+    static uint32_t GetChildSlot(const Node& node, const Vector3& point);
+    uint32_t FindOrCreateNode(const BoundingSphere& bounds);
+    uint32_t AllocateNode(uint32_t parent, uint32_t slot);
+    void LinkObject(uint32_t node, OctreeHandle handle);
+    void UnlinkObject(OctreeHandle handle);
+    void PruneNode(uint32_t node);
+
+    // node_test(center, loose_half_size) culls subtrees, object_test(bounds) filters objects
+    template<typename NodeTest, typename ObjectTest>
+    void Query(NodeTest&& node_test, ObjectTest&& object_test, std::vector<OctreeHandle>& results) const;
+
+private:
+    uint32_t m_max_depth = 8;
+    std::vector<Node> m_nodes;          // m_nodes[0] is the root
+    std::vector<uint32_t> m_free_nodes;
+    std::vector<Object> m_objects;
+    std::vector<OctreeHandle> m_free_objects;
+    uint32_t m_object_count = 0;
+};
+
+template<typename NodeTest, typename ObjectTest>
+void LooseOctree::Query(NodeTest&& node_test, ObjectTest&& object_test, std::vector<OctreeHandle>& results) const
+{
+    // each pop pushes at most 8 children, so depth * 7 + 1 entries are enough
+    uint32_t stack[k_max_depth * 7 + 1];
+    uint32_t stack_size = 0;
+    stack[stack_size++] = 0;
+
+    while(stack_size > 0)
+    {
+        const Node& node = m_nodes[stack[--stack_size]];
+
+        for(uint32_t object = node.first_object; object != k_invalid_index; object = m_objects[object].next)
+        {
+            if(object_test(m_objects[object].bounds))
+            {
+                results.push_back(object);
+            }
+        }
+
+        for(uint32_t child : node.children)
+        {
+            if(child != k_invalid_index && node_test(m_nodes[child].center, m_nodes[child].half_size * 2.0f))
+            {
+                stack[stack_size++] = child;
+            }
+        }
+    }
+}
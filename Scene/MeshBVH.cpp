@@ -0,0 +1,123 @@
+#include "MeshBVH.h"
+
+void MeshBVH::Build(const float* positions, uint32_t stride, const uint16_t* indices, uint32_t index_count)
+{
+    BuildTriangles(positions, stride, indices, index_count);
+}
+
+void MeshBVH::Build(const float* positions, uint32_t stride, const uint32_t* indices, uint32_t index_count)
+{
+    BuildTriangles(positions, stride, indices, index_count);
+}
+
+void MeshBVH::Clear()
+{
+    m_bvh.Clear();
+    m_triangles.clear();
+}
+
+template<typename Index>
+void MeshBVH::BuildTriangles(const float* positions, uint32_t stride, const Index* indices, uint32_t index_count)
+{
+    uint32_t triangle_count = index_count / 3;
+    std::vector<AABB> boxes(triangle_count);
+    std::vector<Vector3> centroids(triangle_count);
+    std::vector<Triangle> triangles(triangle_count);
+    for(uint32_t i=0; i<triangle_count; i++)
+    {
+        const float* p[3];
+        for(int corner=0; corner<3; corner++)
+        {
+            p[corner] = reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + (size_t)indices[i * 3 + corner] * stride);
+        }
+
+        AABB& box = boxes[i];
+        box.min = Vector3(std::min({ p[0][0], p[1][0], p[2][0] }), std::min({ p[0][1], p[1][1], p[2][1] }), std::min({ p[0][2], p[1][2], p[2][2] }));
+        box.max = Vector3(std::max({ p[0][0], p[1][0], p[2][0] }), std::max({ p[0][1], p[1][1], p[2][1] }), std::max({ p[0][2], p[1][2], p[2][2] }));
+        centroids[i] = Vector3((box.min.x + box.max.x) * 0.5f, (box.min.y + box.max.y) * 0.5f, (box.min.z + box.max.z) * 0.5f);
+
+        Triangle& triangle = triangles[i];
+        for(int axis=0; axis<3; axis++)
+        {
+            triangle.v0[axis] = p[0][axis];
+            triangle.edge1[axis] = p[1][axis] - p[0][axis];
+            triangle.edge2[axis] = p[2][axis] - p[0][axis];
+        }
+        triangle.index = i;
+    }
+
+    m_bvh.Build(boxes.data(), centroids.data(), triangle_count, k_max_leaf_size);
+
+    const std::vector<uint32_t>& order = m_bvh.GetPrimitiveOrder();
+    m_triangles.resize(triangle_count);
+    for(uint32_t i=0; i<triangle_count; i++)
+    {
+        m_triangles[i] = triangles[order[i]];
+    }
+}
+
+bool MeshBVH::IntersectTriangle(const Triangle& triangle, const BVHRay& ray, float t_max, float& t, float& u, float& v)
+{
+    // moller-trumbore
+    const float* d = ray.direction;
+    const float* e1 = triangle.edge1;
+    const float* e2 = triangle.edge2;
+    float p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+    float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    if(det == 0.0f)
+    {
+        return false; // parallel to the plane or a degenerate triangle
+    }
+    float inv_det = 1.0f / det;
+
+    float s[3] = { ray.origin[0] - triangle.v0[0], ray.origin[1] - triangle.v0[1], ray.origin[2] - triangle.v0[2] };
+    u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv_det;
+    if(u < 0.0f || u > 1.0f)
+    {
+        return false;
+    }
+
+    float q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+    v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inv_det;
+    if(v < 0.0f || u + v > 1.0f)
+    {
+        return false;
+    }
+
+    t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv_det;
+    return t >= 0.0f && t <= t_max;
+}
+
+bool MeshBVH::RayCast(const BVHRay& ray, float& t_max, MeshRayHit& hit) const
+{
+    bool b_hit = false;
+    m_bvh.Traverse(ray, t_max, [&](uint32_t first, uint32_t count, float leaf_t_max)
+    {
+        for(uint32_t i=first; i<first + count; i++)
+        {
+            float t, u, v;
+            if(IntersectTriangle(m_triangles[i], ray, leaf_t_max, t, u, v))
+            {
+                leaf_t_max = t;
+                hit.triangle = m_triangles[i].index;
+                hit.u = u;
+                hit.v = v;
+                hit.distance = t;
+                b_hit = true;
+            }
+        }
+        return leaf_t_max;
+    });
+
+    if(b_hit)
+    {
+        t_max = hit.distance;
+    }
+    return b_hit;
+}
+
+bool MeshBVH::RayCast(const Ray& ray, MeshRayHit& hit) const
+{
+    float t_max = ray.max_distance;
+    return RayCast(BVHRay(ray.origin, ray.direction), t_max, hit);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BVH.h"
+
+// closest triangle hit by a ray, the point is (1 - u - v) * v0 + u * v1 + v * v2
+struct MeshRayHit
+{
+    uint32_t triangle = 0;  // index / 3 of its first index in the mesh's index list
+    float u = 0.0f;
+    float v = 0.0f;
+    float distance = 0.0f;  // in units of the ray direction's length
+};
+
+// triangle bvh of one mesh, in mesh space
+// triangles are copied in leaf order as a vertex and two edges, so a leaf is tested without touching the vertex buffer
+// both faces are hit, picking does not care about the winding
+class MeshBVH
+{
+public:
+    static const uint32_t k_max_leaf_size = 4;
+
+    MeshBVH() = default;
+    ~MeshBVH() = default;
+
+    // positions are float3 at stride bytes from each other, triangle list
+    void Build(const float* positions, uint32_t stride, const uint16_t* indices, uint32_t index_count);
+    void Build(const float* positions, uint32_t stride, const uint32_t* indices, uint32_t index_count);
+    void Clear();
+
+    bool IsEmpty() const { return m_bvh.IsEmpty(); }
+    uint32_t GetTriangleCount() const { return (uint32_t)m_triangles.size(); }
+    uint32_t GetNodeCount() const { return m_bvh.GetNodeCount(); }
+    AABB GetBounds() const { return m_bvh.GetBounds(); }
+
+    // closest hit in [0, t_max], t_max is lowered to its distance
+    bool RayCast(const BVHRay& ray, float& t_max, MeshRayHit& hit) const;
+    bool RayCast(const Ray& ray, MeshRayHit& hit) const;
+
+private:
+    struct Triangle
+    {
+        float v0[3];
+        float edge1[3];
+        float edge2[3];
+        uint32_t index;
+    };
+
+    template<typename Index>
+    void BuildTriangles(const float* positions, uint32_t stride, const Index* indices, uint32_t index_count);
+    static bool IntersectTriangle(const Triangle& triangle, const BVHRay& ray, float t_max, float& t, float& u, float& v);
+
+private:
+    BVH m_bvh;
+    std::vector<Triangle> m_triangles;  // in leaf order
+};
@@ -0,0 +1,102 @@
+#include "SceneBVH.h"
+
+void SceneBVH::Clear()
+{
+    m_bvh.Clear();
+    m_instances.clear();
+}
+
+void SceneBVH::AddInstance(const MeshBVH* mesh_bvh, const Matrix& world, uint32_t user_data)
+{
+    if(mesh_bvh == nullptr || mesh_bvh->IsEmpty())
+    {
+        return;
+    }
+
+    Instance instance;
+    instance.mesh_bvh = mesh_bvh;
+    instance.world = world;
+    instance.inv_world = world.Invert();
+    instance.user_data = user_data;
+    m_instances.push_back(instance);
+}
+
+void SceneBVH::Build()
+{
+    uint32_t instance_count = (uint32_t)m_instances.size();
+    m_boxes.resize(instance_count);
+    m_centroids.resize(instance_count);
+    for(uint32_t i=0; i<instance_count; i++)
+    {
+        // box of the mesh's root box moved to world space
+        const Instance& instance = m_instances[i];
+        AABB local_box = instance.mesh_bvh->GetBounds();
+        Vector3 local_center((local_box.min.x + local_box.max.x) * 0.5f, (local_box.min.y + local_box.max.y) * 0.5f, (local_box.min.z + local_box.max.z) * 0.5f);
+        Vector3 local_extents(local_box.max.x - local_center.x, local_box.max.y - local_center.y, local_box.max.z - local_center.z);
+        const Matrix& m = instance.world;
+        Vector3 center(
+            local_center.x * m._11 + local_center.y * m._21 + local_center.z * m._31 + m._41,
+            local_center.x * m._12 + local_center.y * m._22 + local_center.z * m._32 + m._42,
+            local_center.x * m._13 + local_center.y * m._23 + local_center.z * m._33 + m._43);
+        Vector3 extents = TransformExtents(local_extents, m);
+
+        m_boxes[i].min = Vector3(center.x - extents.x, center.y - extents.y, center.z - extents.z);
+        m_boxes[i].max = Vector3(center.x + extents.x, center.y + extents.y, center.z + extents.z);
+        m_centroids[i] = center;
+    }
+
+    m_bvh.Build(m_boxes.data(), m_centroids.data(), instance_count, k_max_leaf_size);
+
+    // leaves then index m_instances directly
+    const std::vector<uint32_t>& order = m_bvh.GetPrimitiveOrder();
+    m_sorted_instances.resize(instance_count);
+    for(uint32_t i=0; i<instance_count; i++)
+    {
+        m_sorted_instances[i] = m_instances[order[i]];
+    }
+    m_instances.swap(m_sorted_instances);
+}
+
+bool SceneBVH::RayCast(const Ray& ray, RayHit& hit) const
+{
+    bool b_hit = false;
+    BVHRay world_ray(ray.origin, ray.direction);
+    m_bvh.Traverse(world_ray, ray.max_distance, [&](uint32_t first, uint32_t count, float t_max)
+    {
+        for(uint32_t i=first; i<first + count; i++)
+        {
+            // row vectors, the point takes the translation and the direction does not
+            const Instance& instance = m_instances[i];
+            const Matrix& m = instance.inv_world;
+            Vector3 origin(
+                ray.origin.x * m._11 + ray.origin.y * m._21 + ray.origin.z * m._31 + m._41,
+                ray.origin.x * m._12 + ray.origin.y * m._22 + ray.origin.z * m._32 + m._42,
+                ray.origin.x * m._13 + ray.origin.y * m._23 + ray.origin.z * m._33 + m._43);
+            Vector3 direction(
+                ray.direction.x * m._11 + ray.direction.y * m._21 + ray.direction.z * m._31,
+                ray.direction.x * m._12 + ray.direction.y * m._22 + ray.direction.z * m._32,
+                ray.direction.x * m._13 + ray.direction.y * m._23 + ray.direction.z * m._33);
+
+            MeshRayHit mesh_hit;
+            if(instance.mesh_bvh->RayCast(BVHRay(origin, direction), t_max, mesh_hit))
+            {
+                hit.object = instance.user_data;
+                hit.triangle = mesh_hit.triangle;
+                hit.u = mesh_hit.u;
+                hit.v = mesh_hit.v;
+                hit.distance = mesh_hit.distance;
+                b_hit = true;
+            }
+        }
+        return t_max;
+    });
+
+    if(b_hit)
+    {
+        hit.position = Vector3(
+            ray.origin.x + ray.direction.x * hit.distance,
+            ray.origin.y + ray.direction.y * hit.distance,
+            ray.origin.z + ray.direction.z * hit.distance);
+    }
+    return b_hit;
+}
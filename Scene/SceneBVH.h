@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "BVH.h"
+#include "MeshBVH.h"
+
+// closest hit of SceneBVH::RayCast, the triangle and barycentrics are those of MeshRayHit
+struct RayHit
+{
+    uint32_t object = 0;    // user data of the instance
+    uint32_t triangle = 0;
+    float u = 0.0f;
+    float v = 0.0f;
+    float distance = 0.0f;  // world units, the ray direction is normalized
+    Vector3 position;       // world space
+};
+
+// top level bvh over mesh instances, each referencing a MeshBVH in mesh space
+// rays are moved to mesh space per instance instead of transforming the triangles, so instances
+// of one mesh share its bvh, the direction is not normalized again and distances stay in world units
+// instances are added then Build is called, rebuilding a few hundred instances per frame is cheap
+class SceneBVH
+{
+public:
+    static const uint32_t k_max_leaf_size = 2;
+
+    SceneBVH() = default;
+    ~SceneBVH() = default;
+
+    void Clear();
+    // mesh_bvh must outlive the scene bvh, empty ones are skipped
+    void AddInstance(const MeshBVH* mesh_bvh, const Matrix& world, uint32_t user_data);
+    void Build();
+
+    uint32_t GetInstanceCount() const { return (uint32_t)m_instances.size(); }
+    uint32_t GetNodeCount() const { return m_bvh.GetNodeCount(); }
+
+    // closest hit within ray.max_distance
+    bool RayCast(const Ray& ray, RayHit& hit) const;
+
+private:
+    struct Instance
+    {
+        const MeshBVH* mesh_bvh = nullptr;
+        Matrix world;
+        Matrix inv_world;
+        uint32_t user_data = 0;
+    };
+
+private:
+    BVH m_bvh;
+    std::vector<Instance> m_instances;  // in leaf order once built
+    // build scratch, kept so rebuilding every frame reuses the memory
+    std::vector<AABB> m_boxes;
+    std::vector<Vector3> m_centroids;
+    std::vector<Instance> m_sorted_instances;
+};
@@ -0,0 +1,263 @@
+#include "SceneFile.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+// bytes of a section for the counts in the header
+static uint64_t GetSectionSize(const SceneFileHeader& header, SceneFileSection section)
+{
+    switch(section)
+    {
+    case SceneFileSection::k_mesh_names:
+        return (uint64_t)header.mesh_count * sizeof(uint32_t);
+    case SceneFileSection::k_material_names:
+        return (uint64_t)header.material_count * sizeof(uint32_t);
+    case SceneFileSection::k_string_table:
+        return header.string_table_size;
+    default:
+        return (uint64_t)header.object_count * sizeof(uint32_t); // per object, uint32 or float
+    }
+}
+
+static uint64_t AlignSectionOffset(uint64_t offset)
+{
+    return (offset + SceneFileHeader::k_section_alignment - 1) & ~(uint64_t)(SceneFileHeader::k_section_alignment - 1);
+}
+
+uint32_t SceneFileWriter::AddObject(const std::string& name, uint32_t parent, const Transform& local_transform, const std::string& mesh, const std::string& material)
+{
+    // the ancestors of the new object are the ones of the last object up to its parent
+    while(!m_ancestors.empty() && m_ancestors.back() != parent)
+    {
+        m_ancestors.pop_back();
+    }
+    assert(parent == SceneFileView::k_no_parent || !m_ancestors.empty()); // not depth first
+
+    uint32_t object = (uint32_t)m_parents.size();
+    m_ancestors.push_back(object);
+
+    m_parents.push_back(parent);
+    Rotator rotator = local_transform.GetRotator();
+    const float transform[9] =
+    {
+        local_transform.Location.x, local_transform.Location.y, local_transform.Location.z,
+        rotator.Roll, rotator.Pitch, rotator.Yaw,
+        local_transform.Scale.x, local_transform.Scale.y, local_transform.Scale.z,
+    };
+    for(int i=0; i<9; i++)
+    {
+        m_transforms[i].push_back(transform[i]);
+    }
+    m_mesh_refs.push_back(InternName(mesh, m_mesh_names, m_mesh_indices));
+    m_material_refs.push_back(InternName(material, m_material_names, m_material_indices));
+    m_object_names.push_back(InternString(name));
+    return object;
+}
+
+std::vector<char> SceneFileWriter::Finish() const
+{
+    SceneFileHeader header = {};
+    header.magic = SceneFileHeader::k_magic;
+    header.version = SceneFileHeader::k_version;
+    header.object_count = (uint32_t)m_parents.size();
+    header.mesh_count = (uint32_t)m_mesh_names.size();
+    header.material_count = (uint32_t)m_material_names.size();
+    header.string_table_size = (uint32_t)m_string_table.size();
+
+    const void* section_data[(uint32_t)SceneFileSection::k_count] =
+    {
+        m_parents.data(),
+        m_transforms[0].data(), m_transforms[1].data(), m_transforms[2].data(),
+        m_transforms[3].data(), m_transforms[4].data(), m_transforms[5].data(),
+        m_transforms[6].data(), m_transforms[7].data(), m_transforms[8].data(),
+        m_mesh_refs.data(),
+        m_material_refs.data(),
+        m_object_names.data(),
+        m_mesh_names.data(),
+        m_material_names.data(),
+        m_string_table.data(),
+    };
+
+    uint64_t offset = sizeof(SceneFileHeader);
+    for(uint32_t section=0; section<(uint32_t)SceneFileSection::k_count; section++)
+    {
+        offset = AlignSectionOffset(offset);
+        header.section_offsets[section] = offset;
+        offset += GetSectionSize(header, (SceneFileSection)section);
+    }
+
+    // padding between sections stays zero
+    std::vector<char> file((size_t)offset, 0);
+    memcpy(file.data(), &header, sizeof(header));
+    for(uint32_t section=0; section<(uint32_t)SceneFileSection::k_count; section++)
+    {
+        uint64_t size = GetSectionSize(header, (SceneFileSection)section);
+        if(size > 0)
+        {
+            memcpy(file.data() + header.section_offsets[section], section_data[section], (size_t)size);
+        }
+    }
+    return file;
+}
+
+bool SceneFileWriter::Write(const std::string& path) const
+{
+    std::vector<char> file = Finish();
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(file.data(), file.size());
+    return stream.good();
+}
+
+uint32_t SceneFileWriter::InternString(const std::string& str)
+{
+    auto iter = m_interned_strings.find(str);
+    if(iter != m_interned_strings.end())
+    {
+        return iter->second;
+    }
+
+    uint32_t offset = (uint32_t)m_string_table.size();
+    m_string_table.append(str);
+    m_string_table.push_back('\0');
+    m_interned_strings.emplace(str, offset);
+    return offset;
+}
+
+uint32_t SceneFileWriter::InternName(const std::string& name, std::vector<uint32_t>& names, std::unordered_map<std::string, uint32_t>& indices)
+{
+    auto iter = indices.find(name);
+    if(iter != indices.end())
+    {
+        return iter->second;
+    }
+
+    uint32_t index = (uint32_t)names.size();
+    names.push_back(InternString(name));
+    indices.emplace(name, index);
+    return index;
+}
+
+bool SceneFileView::Parse(const void* data, size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    if(bytes == nullptr || size < sizeof(SceneFileHeader))
+    {
+        return false;
+    }
+
+    const SceneFileHeader* header = reinterpret_cast<const SceneFileHeader*>(bytes);
+    if(header->magic != SceneFileHeader::k_magic || header->version != SceneFileHeader::k_version)
+    {
+        return false;
+    }
+
+    const void* sections[(uint32_t)SceneFileSection::k_count];
+    for(uint32_t section=0; section<(uint32_t)SceneFileSection::k_count; section++)
+    {
+        uint64_t offset = header->section_offsets[section];
+        uint64_t section_size = GetSectionSize(*header, (SceneFileSection)section);
+        if(offset % SceneFileHeader::k_section_alignment != 0 || offset < sizeof(SceneFileHeader)
+            || offset > size || section_size > size - offset)
+        {
+            return false;
+        }
+        sections[section] = bytes + offset;
+    }
+
+    const char* string_table = static_cast<const char*>(sections[(uint32_t)SceneFileSection::k_string_table]);
+    if(header->string_table_size > 0 && string_table[header->string_table_size - 1] != '\0')
+    {
+        return false;
+    }
+
+    const uint32_t* parents = static_cast<const uint32_t*>(sections[(uint32_t)SceneFileSection::k_parents]);
+    const uint32_t* mesh_refs = static_cast<const uint32_t*>(sections[(uint32_t)SceneFileSection::k_mesh_refs]);
+    const uint32_t* material_refs = static_cast<const uint32_t*>(sections[(uint32_t)SceneFileSection::k_material_refs]);
+    const uint32_t* object_names = static_cast<const uint32_t*>(sections[(uint32_t)SceneFileSection::k_object_names]);
+    const uint32_t* mesh_names = static_cast<const uint32_t*>(sections[(uint32_t)SceneFileSection::k_mesh_names]);
+    const uint32_t* material_names = static_cast<const uint32_t*>(sections[(uint32_t)SceneFileSection::k_material_names]);
+
+    // depth first: a parent is the previous object or one of its ancestors, walked back with a stack
+    std::vector<uint32_t> ancestors;
+    for(uint32_t i=0; i<header->object_count; i++)
+    {
+        while(!ancestors.empty() && ancestors.back() != parents[i])
+        {
+            ancestors.pop_back();
+        }
+        if((parents[i] != k_no_parent && ancestors.empty()) || mesh_refs[i] >= header->mesh_count
+            || material_refs[i] >= header->material_count || object_names[i] >= header->string_table_size)
+        {
+            return false;
+        }
+        ancestors.push_back(i);
+    }
+    for(uint32_t i=0; i<header->mesh_count; i++)
+    {
+        if(mesh_names[i] >= header->string_table_size)
+        {
+            return false;
+        }
+    }
+    for(uint32_t i=0; i<header->material_count; i++)
+    {
+        if(material_names[i] >= header->string_table_size)
+        {
+            return false;
+        }
+    }
+
+    m_header = header;
+    memcpy(m_sections, sections, sizeof(sections));
+    return true;
+}
+
+Transform SceneFileView::GetLocalTransform(uint32_t object) const
+{
+    Transform transform;
+    transform.Location = Vector3(GetSection<float>(SceneFileSection::k_location_x)[object],
+        GetSection<float>(SceneFileSection::k_location_y)[object], GetSection<float>(SceneFileSection::k_location_z)[object]);
+    transform.SetRotator(Rotator(GetSection<float>(SceneFileSection::k_rotation_roll)[object],
+        GetSection<float>(SceneFileSection::k_rotation_pitch)[object], GetSection<float>(SceneFileSection::k_rotation_yaw)[object]));
+    transform.Scale = Vector3(GetSection<float>(SceneFileSection::k_scale_x)[object],
+        GetSection<float>(SceneFileSection::k_scale_y)[object], GetSection<float>(SceneFileSection::k_scale_z)[object]);
+    return transform;
+}
+
+void SceneFileView::GetLocalTransforms(uint32_t first, uint32_t count, Transform* out_transforms) const
+{
+    const float* location_x = GetSection<float>(SceneFileSection::k_location_x) + first;
+    const float* location_y = GetSection<float>(SceneFileSection::k_location_y) + first;
+    const float* location_z = GetSection<float>(SceneFileSection::k_location_z) + first;
+    const float* roll = GetSection<float>(SceneFileSection::k_rotation_roll) + first;
+    const float* pitch = GetSection<float>(SceneFileSection::k_rotation_pitch) + first;
+    const float* yaw = GetSection<float>(SceneFileSection::k_rotation_yaw) + first;
+    const float* scale_x = GetSection<float>(SceneFileSection::k_scale_x) + first;
+    const float* scale_y = GetSection<float>(SceneFileSection::k_scale_y) + first;
+    const float* scale_z = GetSection<float>(SceneFileSection::k_scale_z) + first;
+
+    // the rotation sections are SoA already, they are converted a batch at a time
+    Quaternion rotations[k_rotation_batch];
+    for(uint32_t begin=0; begin<count; begin+=k_rotation_batch)
+    {
+        uint32_t batch_count = std::min(count - begin, k_rotation_batch);
+        Transform::RotatorsToQuaternions(roll + begin, pitch + begin, yaw + begin, batch_count, rotations);
+        for(uint32_t j=0; j<batch_count; j++)
+        {
+            uint32_t i = begin + j;
+            out_transforms[i] = Transform(Vector3(location_x[i], location_y[i], location_z[i]), rotations[j], Vector3(scale_x[i], scale_y[i], scale_z[i]));
+        }
+    }
+}
+
+bool SceneFile::Open(const std::string& path)
+{
+    Close();
+    if(!m_file.Open(path) || !m_view.Parse(m_file.GetData(), m_file.GetSize()))
+    {
+        Close();
+        return false;
+    }
+    return true;
+}
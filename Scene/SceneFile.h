@@ -0,0 +1,145 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Math/Transform.h"
+#include "Utility/MappedFile.h"
+
+// binary scene: objects with a local transform, a parent, a mesh and a material, in depth first order
+// layout: header | sections, each section starts at a 16 byte aligned offset from the start of the file
+// every per object field is its own array (SoA), meshes, materials and names are referenced by index or
+// by offset into the string table, so the file has no pointers and is used straight from a memory mapping
+
+enum class SceneFileSection : uint32_t
+{
+    k_parents,          // uint32 per object, index of an earlier object or SceneFileView::k_no_parent
+    k_location_x,       // float per object, local transform
+    k_location_y,
+    k_location_z,
+    k_rotation_roll,    // degrees, see Rotator
+    k_rotation_pitch,
+    k_rotation_yaw,
+    k_scale_x,
+    k_scale_y,
+    k_scale_z,
+    k_mesh_refs,        // uint32 per object, index into the mesh names
+    k_material_refs,    // uint32 per object, index into the material names
+    k_object_names,     // uint32 per object, offset into the string table
+    k_mesh_names,       // uint32 per mesh, offset into the string table
+    k_material_names,   // uint32 per material, offset into the string table
+    k_string_table,     // null terminated strings
+    k_count,
+};
+
+struct SceneFileHeader
+{
+    static const uint32_t k_magic = 0x454E4353; // "SCNE"
+    static const uint32_t k_version = 1;
+    static const uint32_t k_section_alignment = 16;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t object_count;
+    uint32_t mesh_count;
+    uint32_t material_count;
+    uint32_t string_table_size;
+    uint64_t section_offsets[(uint32_t)SceneFileSection::k_count];
+};
+
+class SceneFileWriter
+{
+public:
+    SceneFileWriter() = default;
+    ~SceneFileWriter() = default;
+
+    // objects are added depth first: parent is k_no_parent or the previous object or one of its ancestors
+    // returns the object's index
+    uint32_t AddObject(const std::string& name, uint32_t parent, const Transform& local_transform, const std::string& mesh, const std::string& material);
+    uint32_t GetObjectCount() const { return (uint32_t)m_parents.size(); }
+
+    std::vector<char> Finish() const;
+    // returns false if the file could not be written
+    bool Write(const std::string& path) const;
+
+private:
+    uint32_t InternString(const std::string& str);
+    uint32_t InternName(const std::string& name, std::vector<uint32_t>& names, std::unordered_map<std::string, uint32_t>& indices);
+
+private:
+    std::vector<uint32_t> m_parents;
+    std::vector<float> m_transforms[9];     // location xyz, rotation roll pitch yaw, scale xyz
+    std::vector<uint32_t> m_mesh_refs;
+    std::vector<uint32_t> m_material_refs;
+    std::vector<uint32_t> m_object_names;
+    std::vector<uint32_t> m_mesh_names;
+    std::vector<uint32_t> m_material_names;
+    std::string m_string_table;
+    std::unordered_map<std::string, uint32_t> m_interned_strings;
+    std::unordered_map<std::string, uint32_t> m_mesh_indices;
+    std::unordered_map<std::string, uint32_t> m_material_indices;
+    std::vector<uint32_t> m_ancestors;      // of the last added object, itself included
+};
+
+// non owning view over a scene file, the memory has to outlive the view
+// Parse resolves each section offset to a pointer once, the arrays are then read in place
+class SceneFileView
+{
+public:
+    static const uint32_t k_no_parent = 0xffffffff;
+
+    SceneFileView() = default;
+    ~SceneFileView() = default;
+
+    // validates the header, the sections, every reference and the depth first order,
+    // returns false for a truncated or foreign file
+    bool Parse(const void* data, size_t size);
+
+    uint32_t GetObjectCount() const { return m_header->object_count; }
+    uint32_t GetMeshCount() const { return m_header->mesh_count; }
+    uint32_t GetMaterialCount() const { return m_header->material_count; }
+
+    const uint32_t* GetParents() const { return GetSection<uint32_t>(SceneFileSection::k_parents); }
+    const uint32_t* GetMeshRefs() const { return GetSection<uint32_t>(SceneFileSection::k_mesh_refs); }
+    const uint32_t* GetMaterialRefs() const { return GetSection<uint32_t>(SceneFileSection::k_material_refs); }
+    Transform GetLocalTransform(uint32_t object) const;
+    // GetLocalTransform of objects [first, first + count), with the rotations converted in SIMD batches
+    void GetLocalTransforms(uint32_t first, uint32_t count, Transform* out_transforms) const;
+    const char* GetObjectName(uint32_t object) const { return GetString(GetSection<uint32_t>(SceneFileSection::k_object_names)[object]); }
+    const char* GetMeshName(uint32_t mesh) const { return GetString(GetSection<uint32_t>(SceneFileSection::k_mesh_names)[mesh]); }
+    const char* GetMaterialName(uint32_t material) const { return GetString(GetSection<uint32_t>(SceneFileSection::k_material_names)[material]); }
+
+private:
+    static constexpr uint32_t k_rotation_batch = 64;  // rotations per Transform::RotatorsToQuaternions call
+
+    template<typename T>
+    const T* GetSection(SceneFileSection section) const { return static_cast<const T*>(m_sections[(uint32_t)section]); }
+    const char* GetString(uint32_t offset) const { return GetSection<char>(SceneFileSection::k_string_table) + offset; }
+
+private:
+    const SceneFileHeader* m_header = nullptr;
+    const void* m_sections[(uint32_t)SceneFileSection::k_count] = {};
+};
+
+// a scene file mapped in memory with its view
+class SceneFile
+{
+public:
+    SceneFile() = default;
+    ~SceneFile() = default;
+
+    SceneFile(const SceneFile&) = delete;
+    SceneFile& operator=(const SceneFile&) = delete;
+
+    // returns false if the file is missing or does not parse
+    bool Open(const std::string& path);
+    void Close() { m_file.Close(); m_view = SceneFileView(); }
+    bool IsOpen() const { return m_file.IsOpen(); }
+
+    const SceneFileView& GetView() const { return m_view; }
+
+private:
+    MappedFile m_file;
+    SceneFileView m_view;
+};
@@ -0,0 +1,349 @@
+#include "SceneHierarchy.h"
+#include <atomic>
+#include <cassert>
+#include "Utility/JobSystem.h"
+
+// scratch ends up holding the old values, so its capacity is reused by the next call
+template<typename T>
+static void Permute(std::vector<T>& values, const std::vector<uint32_t>& order, std::vector<T>& scratch)
+{
+    scratch.resize(order.size());
+    for(uint32_t i=0; i<order.size(); i++)
+    {
+        scratch[i] = values[order[i]];
+    }
+    values.swap(scratch);
+}
+
+SceneNodeID SceneHierarchy::CreateNode(SceneNodeID parent)
+{
+    SceneNodeID node;
+    if(!m_free_ids.empty())
+    {
+        node = m_free_ids.back();
+        m_free_ids.pop_back();
+    }
+    else
+    {
+        node = (SceneNodeID)m_id_to_index.size();
+        m_id_to_index.push_back(0);
+    }
+
+    // append as a root, then move under the parent
+    uint32_t index = (uint32_t)m_node_ids.size();
+    m_id_to_index[node] = index;
+    m_parents.push_back(k_no_parent);
+    m_subtree_sizes.push_back(1);
+    m_local_transforms.emplace_back();
+    m_world_transforms.emplace_back();
+    m_world_matrices.push_back(Matrix::Identity);
+    m_dirty.push_back(1);
+    m_updated.push_back(0);
+    m_destroyed.push_back(0);
+    m_node_ids.push_back(node);
+
+    if(parent != k_invalid_scene_node)
+    {
+        SetParent(node, parent);
+    }
+    return node;
+}
+
+void SceneHierarchy::AppendNodes(uint32_t count, const uint32_t* parents, SceneNodeID* out_nodes)
+{
+    uint32_t first_index = (uint32_t)m_node_ids.size();
+    size_t new_size = (size_t)first_index + count;
+    m_parents.resize(new_size);
+    m_subtree_sizes.resize(new_size, 1);
+    m_local_transforms.resize(new_size);
+    m_world_transforms.resize(new_size);
+    m_world_matrices.resize(new_size, Matrix::Identity);
+    m_dirty.resize(new_size, 1);
+    m_updated.resize(new_size, 0);
+    m_destroyed.resize(new_size, 0);
+    m_node_ids.resize(new_size);
+
+    for(uint32_t i=0; i<count; i++)
+    {
+        SceneNodeID node;
+        if(!m_free_ids.empty())
+        {
+            node = m_free_ids.back();
+            m_free_ids.pop_back();
+        }
+        else
+        {
+            node = (SceneNodeID)m_id_to_index.size();
+            m_id_to_index.push_back(0);
+        }
+
+        assert(parents[i] == k_invalid_scene_node || parents[i] < i);
+        uint32_t index = first_index + i;
+        m_id_to_index[node] = index;
+        m_node_ids[index] = node;
+        m_parents[index] = parents[i] == k_invalid_scene_node ? k_no_parent : first_index + parents[i];
+        out_nodes[i] = node;
+    }
+
+    // children come after their parent, so walking backwards sees every subtree complete
+    for(uint32_t i=count; i-->0; )
+    {
+        if(parents[i] != k_invalid_scene_node)
+        {
+            m_subtree_sizes[first_index + parents[i]] += m_subtree_sizes[first_index + i];
+        }
+    }
+}
+
+void SceneHierarchy::DestroyNode(SceneNodeID node)
+{
+    uint32_t index = GetIndex(node);
+    assert(!m_destroyed[index]);
+    uint32_t parent_index = m_parents[index];
+
+    // the children stay where they are, inside the parent's subtree, so depth first order holds without moving anything
+    // children of nodes destroyed before can sit deeper in the range, so all of it is checked and not just the direct subtrees
+    uint32_t subtree_end = index + m_subtree_sizes[index];
+    for(uint32_t i=index + 1; i<subtree_end; i++)
+    {
+        if(m_parents[i] == index)
+        {
+            m_parents[i] = parent_index;
+            m_dirty[i] = 1;
+        }
+    }
+
+    // the id is only freed by Compact, until then it still maps to this index
+    m_destroyed[index] = 1;
+    m_destroyed_count++;
+}
+
+void SceneHierarchy::SetParent(SceneNodeID node, SceneNodeID parent)
+{
+    Compact();
+
+    uint32_t index = GetIndex(node);
+    uint32_t subtree_end = index + m_subtree_sizes[index];
+    uint32_t parent_index = parent == k_invalid_scene_node ? k_no_parent : GetIndex(parent);
+    assert(parent_index == k_no_parent || parent_index < index || parent_index >= subtree_end); // no cycles
+    if(parent_index == m_parents[index])
+    {
+        return;
+    }
+
+    // the subtree goes after the parent's current subtree, or to the end as a root
+    uint32_t insert_at = parent_index == k_no_parent ? (uint32_t)m_node_ids.size() : parent_index + m_subtree_sizes[parent_index];
+
+    m_order.clear();
+    for(uint32_t i=0; i<=m_node_ids.size(); i++)
+    {
+        if(i == insert_at)
+        {
+            for(uint32_t j=index; j<subtree_end; j++)
+            {
+                m_order.push_back(j);
+            }
+        }
+        if(i < m_node_ids.size() && (i < index || i >= subtree_end))
+        {
+            m_order.push_back(i);
+        }
+    }
+
+    m_parents[index] = parent_index;
+    Reorder(m_order);
+    m_dirty[GetIndex(node)] = 1;
+}
+
+SceneNodeID SceneHierarchy::GetParent(SceneNodeID node) const
+{
+    uint32_t parent_index = m_parents[GetIndex(node)];
+    return parent_index == k_no_parent ? k_invalid_scene_node : m_node_ids[parent_index];
+}
+
+void SceneHierarchy::SetLocalTransform(SceneNodeID node, const Transform& local_transform)
+{
+    uint32_t index = GetIndex(node);
+    m_local_transforms[index] = local_transform;
+    m_dirty[index] = 1;
+}
+
+void SceneHierarchy::UpdateWorldMatrices(JobSystem* job_system)
+{
+    Compact();
+
+    uint32_t node_count = (uint32_t)m_node_ids.size();
+    if(!job_system || node_count < k_parallel_min_nodes)
+    {
+        m_updated_count = UpdateRange(0, node_count);
+        return;
+    }
+
+    // root subtrees are contiguous and independent of each other
+    m_root_indices.clear();
+    for(uint32_t i=0; i<node_count; i+=m_subtree_sizes[i])
+    {
+        m_root_indices.push_back(i);
+    }
+    m_root_indices.push_back(node_count);
+
+    std::atomic<uint32_t> updated_count{ 0 };
+    job_system->ParallelFor((uint32_t)m_root_indices.size() - 1, 16, [this, &updated_count](uint32_t begin, uint32_t end)
+    {
+        updated_count += UpdateRange(m_root_indices[begin], m_root_indices[end]);
+    });
+    m_updated_count = updated_count;
+}
+
+uint32_t SceneHierarchy::UpdateRange(uint32_t begin, uint32_t end)
+{
+    // world transforms are composed in depth first order, so a parent's is always done before its children's,
+    // the updated ones are gathered as SoA and turned into world matrices in batches
+    float soa[10][k_world_matrix_batch];
+    TransformArrays batch;
+    batch.location_x = soa[0];
+    batch.location_y = soa[1];
+    batch.location_z = soa[2];
+    batch.rotation_x = soa[3];
+    batch.rotation_y = soa[4];
+    batch.rotation_z = soa[5];
+    batch.rotation_w = soa[6];
+    batch.scale_x = soa[7];
+    batch.scale_y = soa[8];
+    batch.scale_z = soa[9];
+    uint32_t batch_nodes[k_world_matrix_batch];
+    Matrix world_matrices[k_world_matrix_batch];
+
+    uint32_t updated_count = 0;
+    uint32_t i = begin;
+    while(i < end)
+    {
+        uint32_t batch_count = 0;
+        for(; i<end && batch_count<k_world_matrix_batch; i++)
+        {
+            uint32_t parent = m_parents[i];
+            bool b_update = m_dirty[i] || (parent != k_no_parent && m_updated[parent]);
+            m_updated[i] = b_update;
+            if(!b_update)
+            {
+                continue;
+            }
+
+            Transform& world = m_world_transforms[i];
+            world = parent == k_no_parent ? m_local_transforms[i] : m_local_transforms[i] * m_world_transforms[parent];
+            // each product rounds the length of the rotation a little, down a deep chain that would scale the matrices
+            world.Rotation.Normalize();
+            m_dirty[i] = 0;
+
+            soa[0][batch_count] = world.Location.x;
+            soa[1][batch_count] = world.Location.y;
+            soa[2][batch_count] = world.Location.z;
+            soa[3][batch_count] = world.Rotation.x;
+            soa[4][batch_count] = world.Rotation.y;
+            soa[5][batch_count] = world.Rotation.z;
+            soa[6][batch_count] = world.Rotation.w;
+            soa[7][batch_count] = world.Scale.x;
+            soa[8][batch_count] = world.Scale.y;
+            soa[9][batch_count] = world.Scale.z;
+            batch_nodes[batch_count++] = i;
+        }
+
+        Transform::GetTransformMatricesLH(batch, batch_count, world_matrices);
+        for(uint32_t j=0; j<batch_count; j++)
+        {
+            m_world_matrices[batch_nodes[j]] = world_matrices[j];
+        }
+        updated_count += batch_count;
+    }
+    return updated_count;
+}
+
+void SceneHierarchy::Reorder(const std::vector<uint32_t>& order)
+{
+    assert(m_destroyed_count == 0);
+    m_old_to_new.assign(m_node_ids.size(), k_no_parent);
+    for(uint32_t i=0; i<order.size(); i++)
+    {
+        m_old_to_new[order[i]] = i;
+    }
+
+    Permute(m_parents, order, m_scratch_indices);
+    Permute(m_local_transforms, order, m_scratch_transforms);
+    Permute(m_world_transforms, order, m_scratch_transforms);
+    Permute(m_world_matrices, order, m_scratch_matrices);
+    Permute(m_dirty, order, m_scratch_flags);
+    Permute(m_updated, order, m_scratch_flags);
+    Permute(m_node_ids, order, m_scratch_indices);
+
+    uint32_t node_count = (uint32_t)order.size();
+    m_destroyed.resize(node_count);
+    for(uint32_t i=0; i<node_count; i++)
+    {
+        if(m_parents[i] != k_no_parent)
+        {
+            m_parents[i] = m_old_to_new[m_parents[i]];
+            assert(m_parents[i] < i);
+        }
+        m_id_to_index[m_node_ids[i]] = i;
+    }
+    UpdateSubtreeSizes();
+}
+
+void SceneHierarchy::Compact()
+{
+    if(m_destroyed_count == 0)
+    {
+        return;
+    }
+
+    // kept nodes only move towards the front, so they are moved in place in one forward pass
+    // DestroyNode reattached every child of a destroyed node, so the parent of a kept node is kept and already moved
+    uint32_t node_count = (uint32_t)m_node_ids.size();
+    m_old_to_new.resize(node_count);
+    uint32_t kept_count = 0;
+    for(uint32_t i=0; i<node_count; i++)
+    {
+        if(m_destroyed[i])
+        {
+            m_free_ids.push_back(m_node_ids[i]);
+            continue;
+        }
+
+        uint32_t parent = m_parents[i];
+        m_old_to_new[i] = kept_count;
+        m_parents[kept_count] = parent == k_no_parent ? k_no_parent : m_old_to_new[parent];
+        m_local_transforms[kept_count] = m_local_transforms[i];
+        m_world_transforms[kept_count] = m_world_transforms[i];
+        m_world_matrices[kept_count] = m_world_matrices[i];
+        m_dirty[kept_count] = m_dirty[i];
+        m_updated[kept_count] = m_updated[i];
+        m_node_ids[kept_count] = m_node_ids[i];
+        m_id_to_index[m_node_ids[kept_count]] = kept_count;
+        kept_count++;
+    }
+
+    m_parents.resize(kept_count);
+    m_local_transforms.resize(kept_count);
+    m_world_transforms.resize(kept_count);
+    m_world_matrices.resize(kept_count);
+    m_dirty.resize(kept_count);
+    m_updated.resize(kept_count);
+    m_node_ids.resize(kept_count);
+    m_destroyed.assign(kept_count, 0);
+    m_destroyed_count = 0;
+    UpdateSubtreeSizes();
+}
+
+void SceneHierarchy::UpdateSubtreeSizes()
+{
+    // children come after their parent, so one backward pass accumulates the sizes
+    uint32_t node_count = (uint32_t)m_node_ids.size();
+    m_subtree_sizes.assign(node_count, 1);
+    for(uint32_t i=node_count; i-- > 0; )
+    {
+        if(m_parents[i] != k_no_parent)
+        {
+            m_subtree_sizes[m_parents[i]] += m_subtree_sizes[i];
+        }
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Math/Transform.h"
+
+class JobSystem;
+
+// stable node id, the node's storage index changes whenever the hierarchy is edited
+typedef uint32_t SceneNodeID;
+static const SceneNodeID k_invalid_scene_node = 0xffffffff;
+
+// parent/child transforms stored as parallel arrays in depth first order, a parent always comes before its children
+// setting a local transform marks the node dirty, UpdateWorldMatrices then walks the arrays once:
+// a node is recomputed when it is dirty or its parent was recomputed in the same pass, other world matrices stay cached
+// world transforms compose as Transform (quaternion rotation, per axis scale), matrices are only built from them for upload,
+// so a non uniform scale on a parent does not shear its rotated children
+// reparenting reorders the arrays and costs O(node count), it is expected to be rare
+// destroyed nodes are only marked and their children reattached in place, the arrays are compacted once for all of them
+// by the next UpdateWorldMatrices or SetParent, so destroying many nodes stays linear
+class SceneHierarchy
+{
+public:
+    SceneHierarchy() = default;
+    ~SceneHierarchy() = default;
+
+    SceneHierarchy(const SceneHierarchy&) = delete;
+    SceneHierarchy& operator=(const SceneHierarchy&) = delete;
+
+    // the node is appended as last child of parent, or as a new root
+    SceneNodeID CreateNode(SceneNodeID parent = k_invalid_scene_node);
+    // appends count new nodes as whole root subtrees, without the reorder CreateNode does per node
+    // parents[i] is k_invalid_scene_node or the index of an earlier node of the batch, in depth first order
+    // the new ids are written to out_nodes, local transforms start as identity
+    void AppendNodes(uint32_t count, const uint32_t* parents, SceneNodeID* out_nodes);
+    // children of the node are attached to its parent, keeping their local transforms
+    void DestroyNode(SceneNodeID node);
+    // k_invalid_scene_node makes the node a root, its local transform is kept
+    void SetParent(SceneNodeID node, SceneNodeID parent);
+    SceneNodeID GetParent(SceneNodeID node) const;
+
+    void SetLocalTransform(SceneNodeID node, const Transform& local_transform);
+    const Transform& GetLocalTransform(SceneNodeID node) const { return m_local_transforms[GetIndex(node)]; }
+
+    // with a job system, large hierarchies update their root subtrees in parallel
+    void UpdateWorldMatrices(JobSystem* job_system = nullptr);
+
+    // as of the last UpdateWorldMatrices
+    const Transform& GetWorldTransform(SceneNodeID node) const { return m_world_transforms[GetIndex(node)]; }
+    const Matrix& GetWorldMatrix(SceneNodeID node) const { return m_world_matrices[GetIndex(node)]; }
+    bool WasUpdated(SceneNodeID node) const { return m_updated[GetIndex(node)] != 0; }
+    uint32_t GetUpdatedCount() const { return m_updated_count; }
+
+    // depth first arrays, for systems walking all nodes, compacted as of the last UpdateWorldMatrices
+    uint32_t GetNodeCount() const { return (uint32_t)m_node_ids.size(); }
+    const Matrix* GetWorldMatrices() const { return m_world_matrices.data(); }
+    const SceneNodeID* GetNodeIDs() const { return m_node_ids.data(); }
+
+private:
+    static constexpr uint32_t k_no_parent = 0xffffffff;
+
+    uint32_t GetIndex(SceneNodeID node) const { return m_id_to_index[node]; }
+    static const uint32_t k_parallel_min_nodes = 4096;   // below this the job overhead outweighs the work
+    static const uint32_t k_world_matrix_batch = 64;     // world matrices built per Transform::GetTransformMatricesLH call
+
+    // nodes [begin, end) have to be whole root subtrees, returns the number of updated nodes
+    uint32_t UpdateRange(uint32_t begin, uint32_t end);
+    // order[new index] = old index, may drop nodes, parents of kept nodes have to be kept
+    void Reorder(const std::vector<uint32_t>& order);
+    // removes the nodes marked by DestroyNode in one stable pass
+    void Compact();
+    void UpdateSubtreeSizes();
+
+private:
+    // depth first order
+    std::vector<uint32_t> m_parents;            // index, k_no_parent for roots
+    std::vector<uint32_t> m_subtree_sizes;      // including the node itself
+    std::vector<Transform> m_local_transforms;
+    std::vector<Transform> m_world_transforms;
+    std::vector<Matrix> m_world_matrices;
+    std::vector<uint8_t> m_dirty;               // local transform changed since the last update
+    std::vector<uint8_t> m_updated;             // world transform and matrix recomputed by the last update
+    std::vector<uint8_t> m_destroyed;           // waiting for Compact, nothing refers to these anymore
+    uint32_t m_destroyed_count = 0;
+    std::vector<SceneNodeID> m_node_ids;
+    uint32_t m_updated_count = 0;
+    std::vector<uint32_t> m_root_indices;       // scratch for the parallel update
+
+    // scratch for Reorder and Compact, kept so structural edits do not allocate once warmed up
+    std::vector<uint32_t> m_order;
+    std::vector<uint32_t> m_old_to_new;
+    std::vector<uint32_t> m_scratch_indices;
+    std::vector<Transform> m_scratch_transforms;
+    std::vector<Matrix> m_scratch_matrices;
+    std::vector<uint8_t> m_scratch_flags;
+
+    std::vector<uint32_t> m_id_to_index;
+    std::vector<SceneNodeID> m_free_ids;
+};
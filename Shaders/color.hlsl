@@ -4,10 +4,26 @@
 // Transforms and colors geometry.
 //***************************************************************************************
 
+#ifdef USE_INSTANCING
+// one element per instance, see Renderer/InstanceData.h
+struct InstanceData
+{
+    float4x4 World;
+};
+
+StructuredBuffer<InstanceData> gInstanceData : register(t1);
+
+cbuffer cbPerObject : register(b0)
+{
+	float4x4 gViewProj;
+	uint gInstanceOffset; // first element of this draw in gInstanceData
+};
+#else
 cbuffer cbPerObject : register(b0)
 {
 	float4x4 gWorldViewProj; // must set
 };
+#endif
 
 cbuffer cbPerFrame : register(b1)
 {
@@ -68,12 +84,23 @@ struct VertexOut
     float2 TexCoord : TEXCOORD;
 };
 
+#ifdef USE_INSTANCING
+VertexOut VS(VertexIn vin, uint instance_id : SV_InstanceID)
+{
+	VertexOut vout;
+
+	// SV_InstanceID does not include the start instance, the offset comes from the constants
+	InstanceData instance = gInstanceData[gInstanceOffset + instance_id];
+	float4 pos_w = mul(float4(vin.PosL, 1.0f), instance.World);
+	vout.PosH = mul(pos_w, gViewProj);
+#else
 VertexOut VS(VertexIn vin)
 {
 	VertexOut vout;
 	
 	// Transform to homogeneous clip space.
 	vout.PosH = mul(float4(vin.PosL, 1.0f), gWorldViewProj);
+#endif
 
     vout.TexCoord = vin.TexCoord;
     
@@ -0,0 +1,338 @@
+// MeshBVH and SceneBVH ray casts against hand placed triangles and a brute force search over all of them
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Test.h"
+#include "Scene/MeshBVH.h"
+#include "Scene/SceneBVH.h"
+
+// triangle list with its own vertices per triangle, built in the tests and handed to MeshBVH::Build
+struct TriangleSoup
+{
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+
+    void Add(const Vector3& a, const Vector3& b, const Vector3& c)
+    {
+        for(const Vector3& p : { a, b, c })
+        {
+            indices.push_back((uint32_t)positions.size() / 3);
+            positions.push_back(p.x);
+            positions.push_back(p.y);
+            positions.push_back(p.z);
+        }
+    }
+
+    // two triangles over [x0, x1] x [y0, y1] at depth z
+    void AddQuadZ(float x0, float y0, float x1, float y1, float z)
+    {
+        Add(Vector3(x0, y0, z), Vector3(x1, y0, z), Vector3(x1, y1, z));
+        Add(Vector3(x0, y0, z), Vector3(x1, y1, z), Vector3(x0, y1, z));
+    }
+
+    uint32_t GetTriangleCount() const { return (uint32_t)indices.size() / 3; }
+
+    void Build(MeshBVH& bvh) const
+    {
+        bvh.Build(positions.data(), sizeof(float) * 3, indices.data(), (uint32_t)indices.size());
+    }
+
+    // closest hit by testing every triangle in double precision, -1 if none
+    int BruteForce(const Ray& ray, double& closest) const
+    {
+        int closest_triangle = -1;
+        closest = ray.max_distance;
+        for(uint32_t i=0; i<GetTriangleCount(); i++)
+        {
+            const float* v0 = &positions[indices[i * 3] * 3];
+            const float* v1 = &positions[indices[i * 3 + 1] * 3];
+            const float* v2 = &positions[indices[i * 3 + 2] * 3];
+            double d[3] = { ray.direction.x, ray.direction.y, ray.direction.z };
+            double e1[3] = { (double)v1[0] - v0[0], (double)v1[1] - v0[1], (double)v1[2] - v0[2] };
+            double e2[3] = { (double)v2[0] - v0[0], (double)v2[1] - v0[1], (double)v2[2] - v0[2] };
+            double p[3] = { d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0] };
+            double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+            if(det == 0.0)
+            {
+                continue;
+            }
+            double s[3] = { (double)ray.origin.x - v0[0], (double)ray.origin.y - v0[1], (double)ray.origin.z - v0[2] };
+            double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) / det;
+            double q[3] = { s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0] };
+            double v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) / det;
+            double t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) / det;
+            if(u >= 0.0 && v >= 0.0 && u + v <= 1.0 && t >= 0.0 && t <= closest)
+            {
+                closest = t;
+                closest_triangle = (int)i;
+            }
+        }
+        return closest_triangle;
+    }
+};
+
+static Ray MakeRay(const Vector3& origin, const Vector3& direction, float max_distance = FLT_MAX)
+{
+    float inv_length = 1.0f / std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+    Ray ray;
+    ray.origin = origin;
+    ray.direction = Vector3(direction.x * inv_length, direction.y * inv_length, direction.z * inv_length);
+    ray.max_distance = max_distance;
+    return ray;
+}
+
+TEST_CASE(RayHitsTriangleFromBothSides)
+{
+    TriangleSoup soup;
+    soup.Add(Vector3(0.0f, 0.0f, 5.0f), Vector3(1.0f, 0.0f, 5.0f), Vector3(0.0f, 1.0f, 5.0f));
+    MeshBVH bvh;
+    soup.Build(bvh);
+
+    MeshRayHit hit;
+    TEST_CHECK(bvh.RayCast(MakeRay(Vector3(0.25f, 0.25f, 0.0f), Vector3(0.0f, 0.0f, 1.0f)), hit));
+    TEST_CHECK(hit.triangle == 0);
+    TEST_CHECK_NEAR(hit.distance, 5.0f, 1e-5f);
+    TEST_CHECK_NEAR(hit.u, 0.25f, 1e-5f);
+    TEST_CHECK_NEAR(hit.v, 0.25f, 1e-5f);
+
+    // the back face too, picking does not care about the winding
+    TEST_CHECK(bvh.RayCast(MakeRay(Vector3(0.5f, 0.25f, 8.0f), Vector3(0.0f, 0.0f, -1.0f)), hit));
+    TEST_CHECK_NEAR(hit.distance, 3.0f, 1e-5f);
+    TEST_CHECK_NEAR(hit.u, 0.5f, 1e-5f);
+}
+
+TEST_CASE(RayMissesBesideBehindAndBeyondTheTriangle)
+{
+    TriangleSoup soup;
+    soup.Add(Vector3(0.0f, 0.0f, 5.0f), Vector3(1.0f, 0.0f, 5.0f), Vector3(0.0f, 1.0f, 5.0f));
+    MeshBVH bvh;
+    soup.Build(bvh);
+
+    MeshRayHit hit;
+    TEST_CHECK(!bvh.RayCast(MakeRay(Vector3(0.75f, 0.75f, 0.0f), Vector3(0.0f, 0.0f, 1.0f)), hit));   // beside the hypotenuse
+    TEST_CHECK(!bvh.RayCast(MakeRay(Vector3(0.25f, 0.25f, 0.0f), Vector3(0.0f, 0.0f, -1.0f)), hit));  // pointing away
+    TEST_CHECK(!bvh.RayCast(MakeRay(Vector3(0.25f, 0.25f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), 4.0f), hit));
+    TEST_CHECK(!bvh.RayCast(MakeRay(Vector3(0.25f, 0.25f, 0.0f), Vector3(1.0f, 0.0f, 0.0f)), hit));   // parallel to it
+
+    MeshBVH empty;
+    TEST_CHECK(empty.IsEmpty());
+    TEST_CHECK(!empty.RayCast(MakeRay(Vector3::Zero, Vector3(0.0f, 0.0f, 1.0f)), hit));
+}
+
+TEST_CASE(ClosestOfStackedQuadsIsHit)
+{
+    // 64 quads at z = 1 to 64, added in shuffled order so the closest is not the first triangle
+    std::vector<int> depths(64);
+    for(int i=0; i<64; i++)
+    {
+        depths[i] = i + 1;
+    }
+    std::shuffle(depths.begin(), depths.end(), std::mt19937(1234));
+    TriangleSoup soup;
+    for(int depth : depths)
+    {
+        soup.AddQuadZ(-1.0f, -1.0f, 1.0f, 1.0f, (float)depth);
+    }
+    MeshBVH bvh;
+    soup.Build(bvh);
+    TEST_CHECK(bvh.GetNodeCount() > 1);
+
+    MeshRayHit hit;
+    TEST_CHECK(bvh.RayCast(MakeRay(Vector3(0.1f, 0.2f, 0.0f), Vector3(0.0f, 0.0f, 1.0f)), hit));
+    TEST_CHECK_NEAR(hit.distance, 1.0f, 1e-5f);
+    TEST_CHECK(depths[hit.triangle / 2] == 1);
+
+    TEST_CHECK(bvh.RayCast(MakeRay(Vector3(-0.3f, 0.4f, 20.5f), Vector3(0.0f, 0.0f, 1.0f)), hit));
+    TEST_CHECK_NEAR(hit.distance, 0.5f, 1e-5f);
+    TEST_CHECK(depths[hit.triangle / 2] == 21);
+
+    TEST_CHECK(bvh.RayCast(MakeRay(Vector3(0.5f, -0.5f, 100.0f), Vector3(0.0f, 0.0f, -1.0f)), hit));
+    TEST_CHECK_NEAR(hit.distance, 36.0f, 1e-4f);
+    TEST_CHECK(depths[hit.triangle / 2] == 64);
+
+    // slanted through the stack, the first quad it crosses wins
+    TEST_CHECK(bvh.RayCast(MakeRay(Vector3(0.0f, 0.0f, 10.5f), Vector3(0.1f, 0.0f, 1.0f)), hit));
+    TEST_CHECK(depths[hit.triangle / 2] == 11);
+}
+
+TEST_CASE(RandomRaysMatchBruteForce)
+{
+    // small triangles scattered in a 20 unit cube, rays from all over it in all directions
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> offset(-1.0f, 1.0f);
+    TriangleSoup soup;
+    for(int i=0; i<3000; i++)
+    {
+        Vector3 center(position(random), position(random), position(random));
+        soup.Add(Vector3(center.x + offset(random), center.y + offset(random), center.z + offset(random)),
+            Vector3(center.x + offset(random), center.y + offset(random), center.z + offset(random)),
+            Vector3(center.x + offset(random), center.y + offset(random), center.z + offset(random)));
+    }
+
+    // the same mesh through both index types
+    MeshBVH bvh32;
+    soup.Build(bvh32);
+    std::vector<uint16_t> indices16(soup.indices.begin(), soup.indices.end());
+    MeshBVH bvh16;
+    bvh16.Build(soup.positions.data(), sizeof(float) * 3, indices16.data(), (uint32_t)indices16.size());
+    TEST_CHECK(bvh32.GetTriangleCount() == 3000);
+    TEST_CHECK(bvh16.GetTriangleCount() == 3000);
+
+    int mismatch_count = 0;
+    int hit_count = 0;
+    for(int i=0; i<1000; i++)
+    {
+        Ray ray = MakeRay(Vector3(position(random) * 1.5f, position(random) * 1.5f, position(random) * 1.5f),
+            Vector3(offset(random), offset(random), offset(random)), i % 4 == 0 ? 5.0f : FLT_MAX);
+        double expected = 0.0;
+        int expected_triangle = soup.BruteForce(ray, expected);
+        hit_count += expected_triangle >= 0;
+
+        MeshRayHit hits[2];
+        bool b_hits[2] = { bvh32.RayCast(ray, hits[0]), bvh16.RayCast(ray, hits[1]) };
+        for(int b=0; b<2; b++)
+        {
+            // the triangle may differ only where two are hit at the same distance
+            bool b_same = b_hits[b] == (expected_triangle >= 0)
+                && (!b_hits[b] || std::abs(hits[b].distance - expected) <= 1e-4 * std::max(1.0, expected));
+            mismatch_count += b_same ? 0 : 1;
+        }
+    }
+    TEST_CHECK(mismatch_count == 0);
+    TEST_CHECK(hit_count > 100);
+}
+
+TEST_CASE(AxisAlignedRaysHitOnNodeBoundaries)
+{
+    // unit quads over [0, 8] x [0, 8] at z = 0 and walls in the x = 0 to 8 planes behind them,
+    // rays with zero direction components along the shared edges lie exactly on the planes of the node boxes
+    TriangleSoup soup;
+    for(int y=0; y<8; y++)
+    {
+        for(int x=0; x<8; x++)
+        {
+            soup.AddQuadZ((float)x, (float)y, (float)(x + 1), (float)(y + 1), 0.0f);
+        }
+    }
+    for(int x=0; x<=8; x++)
+    {
+        soup.Add(Vector3((float)x, 0.0f, 1.0f), Vector3((float)x, 8.0f, 1.0f), Vector3((float)x, 8.0f, 9.0f));
+        soup.Add(Vector3((float)x, 0.0f, 1.0f), Vector3((float)x, 8.0f, 9.0f), Vector3((float)x, 0.0f, 9.0f));
+    }
+    MeshBVH bvh;
+    soup.Build(bvh);
+
+    const Ray rays[] = {
+        MakeRay(Vector3(3.0f, 2.5f, -10.0f), Vector3(0.0f, 0.0f, 1.0f)),
+        MakeRay(Vector3(0.0f, 0.5f, -10.0f), Vector3(0.0f, 0.0f, 1.0f)),
+        MakeRay(Vector3(8.0f, 8.0f, -10.0f), Vector3(0.0f, 0.0f, 1.0f)),
+        MakeRay(Vector3(4.0f, 4.0f, 0.5f), Vector3(0.0f, 0.0f, -1.0f)),
+        MakeRay(Vector3(-5.0f, 0.0f, 5.0f), Vector3(1.0f, 0.0f, 0.0f)),
+        MakeRay(Vector3(20.0f, 8.0f, 9.0f), Vector3(-1.0f, 0.0f, 0.0f)),
+        MakeRay(Vector3(2.5f, 4.0f, 5.0f), Vector3(1.0f, 0.0f, 0.0f)),
+        MakeRay(Vector3(6.0f, 20.0f, 0.0f), Vector3(0.0f, -1.0f, 0.0f)),    // in the floor's plane and under the walls
+        MakeRay(Vector3(8.5f, 4.0f, -10.0f), Vector3(0.0f, 0.0f, 1.0f)),    // just outside everything
+        MakeRay(Vector3(4.0f, -1.0f, 5.0f), Vector3(0.0f, 0.0f, 1.0f)),
+    };
+    const float expected_distances[] = { 10.0f, 10.0f, 10.0f, 0.5f, 5.0f, 12.0f, 0.5f, -1.0f, -1.0f, -1.0f };
+    for(int i=0; i<(int)(sizeof(rays) / sizeof(rays[0])); i++)
+    {
+        double brute_force = 0.0;
+        bool b_expected = soup.BruteForce(rays[i], brute_force) >= 0;
+        MeshRayHit hit;
+        bool b_hit = bvh.RayCast(rays[i], hit);
+        TEST_CHECK(b_hit == b_expected);
+        TEST_CHECK(b_hit == (expected_distances[i] >= 0.0f));
+        if(b_hit && expected_distances[i] >= 0.0f)
+        {
+            TEST_CHECK_NEAR(hit.distance, expected_distances[i], 1e-4f);
+        }
+    }
+}
+
+TEST_CASE(InstancesAreHitInWorldSpace)
+{
+    // one unit quad at z = 0 shared by every instance
+    TriangleSoup soup;
+    soup.AddQuadZ(-0.5f, -0.5f, 0.5f, 0.5f, 0.0f);
+    MeshBVH quad;
+    soup.Build(quad);
+
+    SceneBVH scene;
+    scene.AddInstance(&quad, Matrix::CreateTranslation(0.0f, 0.0f, 10.0f), 7);
+    scene.AddInstance(&quad, Matrix::CreateScale(Vector3(2.0f, 2.0f, 2.0f)) * Matrix::CreateTranslation(0.0f, 0.0f, 5.0f), 3);
+    scene.AddInstance(&quad, Matrix::CreateScale(Vector3(8.0f, 8.0f, 8.0f)) * Matrix::CreateTranslation(0.0f, 0.0f, 20.0f), 11);
+    // turned to face x, standing at x = 10
+    scene.AddInstance(&quad, Matrix::CreateFromYawPitchRoll(Math::DegreesToRadians(90.0f), 0.0f, 0.0f) * Matrix::CreateTranslation(10.0f, 0.0f, 0.0f), 9);
+    scene.AddInstance(nullptr, Matrix::Identity, 1);
+    scene.Build();
+    TEST_CHECK(scene.GetInstanceCount() == 4);
+
+    RayHit hit;
+    TEST_CHECK(scene.RayCast(MakeRay(Vector3(0.1f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f)), hit));
+    TEST_CHECK(hit.object == 3);
+    TEST_CHECK_NEAR(hit.distance, 5.0f, 1e-4f);
+    TEST_CHECK_NEAR(hit.position.z, 5.0f, 1e-4f);
+
+    // outside the doubled quad, the 8x one 20 units away, distances stay in world units
+    TEST_CHECK(scene.RayCast(MakeRay(Vector3(1.5f, -2.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f)), hit));
+    TEST_CHECK(hit.object == 11);
+    TEST_CHECK_NEAR(hit.distance, 20.0f, 1e-4f);
+    TEST_CHECK_NEAR(hit.position.x, 1.5f, 1e-4f);
+    TEST_CHECK_NEAR(hit.position.y, -2.0f, 1e-4f);
+
+    // behind the first two from the far side
+    TEST_CHECK(scene.RayCast(MakeRay(Vector3(0.0f, 0.25f, 15.0f), Vector3(0.0f, 0.0f, -1.0f)), hit));
+    TEST_CHECK(hit.object == 7);
+    TEST_CHECK_NEAR(hit.distance, 5.0f, 1e-4f);
+
+    TEST_CHECK(scene.RayCast(MakeRay(Vector3(0.0f, 0.2f, 0.1f), Vector3(1.0f, 0.0f, 0.0f)), hit));
+    TEST_CHECK(hit.object == 9);
+    TEST_CHECK_NEAR(hit.distance, 10.0f, 1e-4f);
+
+    TEST_CHECK(!scene.RayCast(MakeRay(Vector3(0.1f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f), 4.0f), hit));
+    TEST_CHECK(!scene.RayCast(MakeRay(Vector3(5.0f, 5.0f, 0.0f), Vector3(0.0f, 0.0f, 1.0f)), hit));
+    TEST_CHECK(!scene.RayCast(MakeRay(Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f)), hit));
+}
+
+TEST_CASE(ClosestOfManyInstancesIsHit)
+{
+    TriangleSoup soup;
+    soup.AddQuadZ(-0.5f, -0.5f, 0.5f, 0.5f, 0.0f);
+    MeshBVH quad;
+    soup.Build(quad);
+
+    // a row along x of 200 stacks of 4 quads at shuffled depths, user data is the depth times 1000 plus the column
+    std::mt19937 random(1234);
+    SceneBVH scene;
+    for(int column=0; column<200; column++)
+    {
+        int depths[4] = { 2, 4, 6, 8 };
+        std::shuffle(depths, depths + 4, random);
+        for(int depth : depths)
+        {
+            scene.AddInstance(&quad, Matrix::CreateTranslation((float)column, 0.0f, (float)depth), depth * 1000 + column);
+        }
+    }
+    scene.Build();
+    TEST_CHECK(scene.GetNodeCount() > 1);
+
+    int wrong_count = 0;
+    for(int column=0; column<200; column++)
+    {
+        RayHit hit;
+        bool b_front = scene.RayCast(MakeRay(Vector3((float)column + 0.2f, 0.1f, 0.0f), Vector3(0.0f, 0.0f, 1.0f)), hit);
+        wrong_count += b_front && hit.object == (uint32_t)(2000 + column) ? 0 : 1;
+        bool b_back = scene.RayCast(MakeRay(Vector3((float)column - 0.2f, -0.1f, 5.0f), Vector3(0.0f, 0.0f, 1.0f)), hit);
+        wrong_count += b_back && hit.object == (uint32_t)(6000 + column) && std::abs(hit.distance - 1.0f) < 1e-4f ? 0 : 1;
+    }
+    TEST_CHECK(wrong_count == 0);
+}
+
+int main()
+{
+    return RunTests();
+}
@@ -0,0 +1,129 @@
+// reflected cbuffer layouts against hand-written cbuffers with known hlsl packing,
+// every variable goes through D3DReflect, the ShaderReflectionBlob and CbReflection like a real shader
+#include "Test.h"
+#include "TempDirectory.h"
+#include "D3DRHI/HeadlessDevice.h"
+#include "Material/Shader.h"
+#include "Material/ShaderCache.h"
+
+// offsets in the comments are the hlsl packing rules: nothing straddles a 16 byte register,
+// arrays and matrices start on a register and each array element but the last fills its register
+static const char* const k_shader_source = R"(
+cbuffer cbLayout : register(b0)
+{
+    float gScalar;                  // 0
+    float3 gPosition;               // 4, fits behind the float
+    float2 gUV;                     // 16
+    float3 gNormal;                 // 32, does not fit behind the float2
+    float gAfterFloat3;             // 44, fills the float3's register
+    float4x4 gWorld;                // 48
+    row_major float3x4 gBone;       // 112, three registers
+    float4x3 gColumnBone;           // 160, column_major so three registers too
+    float gWeights[4];              // 208, 16 byte stride, 52 bytes
+    float gAfterArray;              // 260, fills the last element's register
+    float4 gColors[3];              // 272
+    int gCount;                     // 320
+    uint gMask;                     // 324
+    float3 gOffsets[2];             // 336, 16 byte stride, 28 bytes
+    float3x3 gNormalMatrix;         // 368, no setter type
+};
+
+float4 VS(float3 pos : POSITION) : SV_POSITION
+{
+    return float4(pos, gScalar);
+}
+)";
+
+struct ExpectedVariable
+{
+    const char* name;
+    unsigned int offset;
+    unsigned int size;
+    CbVariableType type;
+    unsigned int elements;
+    unsigned int element_stride;
+};
+
+static const ExpectedVariable k_expected_variables[] =
+{
+    { "gScalar",        0,   4,  CbVariableType::k_float,     0, 4 },
+    { "gPosition",      4,   12, CbVariableType::k_float3,    0, 12 },
+    { "gUV",            16,  8,  CbVariableType::k_float2,    0, 8 },
+    { "gNormal",        32,  12, CbVariableType::k_float3,    0, 12 },
+    { "gAfterFloat3",   44,  4,  CbVariableType::k_float,     0, 4 },
+    { "gWorld",         48,  64, CbVariableType::k_float4x4,  0, 64 },
+    { "gBone",          112, 48, CbVariableType::k_float3x4,  0, 48 },
+    { "gColumnBone",    160, 48, CbVariableType::k_float3x4,  0, 48 },
+    { "gWeights",       208, 52, CbVariableType::k_float,     4, 16 },
+    { "gAfterArray",    260, 4,  CbVariableType::k_float,     0, 4 },
+    { "gColors",        272, 48, CbVariableType::k_float4,    3, 16 },
+    { "gCount",         320, 4,  CbVariableType::k_int,       0, 4 },
+    { "gMask",          324, 4,  CbVariableType::k_uint,      0, 4 },
+    { "gOffsets",       336, 28, CbVariableType::k_float3,    2, 16 },
+};
+
+static std::unique_ptr<Shader> CreateLayoutShader(const TempDirectory& directory, ID3D12Device* device)
+{
+    ShaderCache::SetCacheDirectory("");
+
+    ShaderInfo shader_info;
+    shader_info.shader_name = "CbLayout";
+    shader_info.file_name = directory.WriteFile("layout.hlsl", k_shader_source);
+    shader_info.b_create_VS = true;
+    return std::make_unique<Shader>(shader_info, device);
+}
+
+TEST_CASE(CbReflectionMatchesHlslPacking)
+{
+    TempDirectory directory("CbLayoutTests");
+    HeadlessDevice headless_device;
+    std::unique_ptr<Shader> shader = CreateLayoutShader(directory, headless_device.GetDevice());
+    const CbReflection& cb_reflection = shader->GetCbReflection("cbLayout");
+
+    for(const ExpectedVariable& expected : k_expected_variables)
+    {
+        const CbVariableMetaData& metadata = cb_reflection.GetVarMetaData(std::string(expected.name));
+        int failures_before = GetTestFailureCount();
+        TEST_CHECK(metadata.offset == expected.offset);
+        TEST_CHECK(metadata.size == expected.size);
+        TEST_CHECK(metadata.type == expected.type);
+        TEST_CHECK(metadata.elements == expected.elements);
+        TEST_CHECK(metadata.element_stride == expected.element_stride);
+        if(GetTestFailureCount() != failures_before)
+        {
+            printf("    in %s\n", expected.name);
+        }
+    }
+
+    // the 16 byte aligned size including the packing, not the sum of the variable sizes
+    TEST_CHECK(cb_reflection.GetSize() == 416);
+}
+
+TEST_CASE(UnsupportedTypesAreReflectedAsUnknown)
+{
+    TempDirectory directory("CbLayoutTests");
+    HeadlessDevice headless_device;
+    std::unique_ptr<Shader> shader = CreateLayoutShader(directory, headless_device.GetDevice());
+
+    const CbVariableMetaData& metadata = shader->GetCbReflection("cbLayout").GetVarMetaData("gNormalMatrix");
+    TEST_CHECK(metadata.offset == 368);
+    TEST_CHECK(metadata.type == CbVariableType::k_unknown);
+}
+
+TEST_CASE(ArrayElementsLandOnTheirStride)
+{
+    // element i of an array starts at offset + i * element_stride, what SetParameterArray relies on
+    TempDirectory directory("CbLayoutTests");
+    HeadlessDevice headless_device;
+    std::unique_ptr<Shader> shader = CreateLayoutShader(directory, headless_device.GetDevice());
+    const CbReflection& cb_reflection = shader->GetCbReflection("cbLayout");
+
+    const CbVariableMetaData& weights = cb_reflection.GetVarMetaData("gWeights");
+    const CbVariableMetaData& after_array = cb_reflection.GetVarMetaData("gAfterArray");
+    TEST_CHECK(weights.offset + (weights.elements - 1) * weights.element_stride + 4 == after_array.offset);
+
+    const CbVariableMetaData& offsets = cb_reflection.GetVarMetaData("gOffsets");
+    TEST_CHECK((offsets.elements - 1) * offsets.element_stride + 12 == offsets.size);
+}
+
+int main() { return RunTests(); }
@@ -0,0 +1,195 @@
+// InstanceBatcher grouping over sorted RenderQueues, the draw call reduction is in InstanceBatchStats
+#include "Test.h"
+#include "Renderer/InstanceBatcher.h"
+
+struct TestDraw
+{
+    RenderPass pass;
+    uint32_t pso_id;
+    uint32_t material_id;
+    uint32_t mesh_id;
+    float depth;
+    uint32_t parameters = 0;            // stands in for a material instance's overrides
+    bool b_texture_override = false;
+};
+
+static void Batch(InstanceBatcher& batcher, const std::vector<TestDraw>& draws, uint32_t max_instances = UINT32_MAX)
+{
+    RenderQueue queue;
+    for(uint32_t i=0; i<(uint32_t)draws.size(); i++)
+    {
+        const TestDraw& draw = draws[i];
+        queue.Push(RenderQueue::MakeKey(draw.pass, draw.pso_id, draw.material_id, draw.mesh_id, draw.depth), i);
+    }
+    queue.Sort();
+
+    batcher.Build(queue,
+        [&draws](uint32_t item) { return !draws[item].b_texture_override; },
+        [&draws](uint32_t first_item, uint32_t item) { return draws[first_item].parameters == draws[item].parameters; },
+        max_instances);
+}
+
+static bool IsBatchOf(const InstanceBatcher& batcher, const InstanceBatch& batch, std::vector<uint32_t> items)
+{
+    if(batch.instance_count != items.size() || batch.b_instanced != (items.size() > 1))
+    {
+        return false;
+    }
+    for(uint32_t i=0; i<batch.instance_count; i++)
+    {
+        if(batcher.GetInstanceItem(batch.first_instance + i) != items[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE(EmptyQueueHasNoBatches)
+{
+    InstanceBatcher batcher;
+    Batch(batcher, {});
+    TEST_CHECK(batcher.GetBatches().empty());
+    TEST_CHECK(batcher.GetStats().draws_before == 0 && batcher.GetStats().draws_after == 0);
+}
+
+TEST_CASE(SharedMeshMaterialAndPsoBecomeOneDraw)
+{
+    // submitted out of depth order, the batch lists them front to back
+    InstanceBatcher batcher;
+    Batch(batcher, {
+        { RenderPass::k_opaque, 1, 2, 3, 0.5f },
+        { RenderPass::k_opaque, 1, 2, 3, 0.1f },
+        { RenderPass::k_opaque, 1, 2, 3, 0.9f },
+    });
+
+    TEST_CHECK(batcher.GetBatches().size() == 1);
+    TEST_CHECK(IsBatchOf(batcher, batcher.GetBatches()[0], { 1, 0, 2 }));
+    TEST_CHECK(batcher.GetStats().draws_before == 3);
+    TEST_CHECK(batcher.GetStats().draws_after == 1);
+    TEST_CHECK(batcher.GetStats().instanced_draws == 1);
+}
+
+TEST_CASE(AnyDifferentKeyFieldSplitsTheBatch)
+{
+    InstanceBatcher batcher;
+    Batch(batcher, {
+        { RenderPass::k_opaque, 1, 2, 3, 0.1f },
+        { RenderPass::k_opaque, 1, 2, 4, 0.2f },   // mesh
+        { RenderPass::k_opaque, 1, 5, 3, 0.3f },   // material
+        { RenderPass::k_opaque, 6, 2, 3, 0.4f },   // pso
+        { RenderPass::k_transparent, 1, 2, 3, 0.5f },
+    });
+
+    TEST_CHECK(batcher.GetBatches().size() == 5);
+    TEST_CHECK(batcher.GetStats().draws_after == 5);
+    TEST_CHECK(batcher.GetStats().instanced_draws == 0);
+    for(const InstanceBatch& batch : batcher.GetBatches())
+    {
+        TEST_CHECK(batch.instance_count == 1 && !batch.b_instanced);
+    }
+}
+
+TEST_CASE(TextureOverridesAreDrawnAlone)
+{
+    InstanceBatcher batcher;
+    Batch(batcher, {
+        { RenderPass::k_opaque, 1, 2, 3, 0.1f },
+        { RenderPass::k_opaque, 1, 2, 3, 0.2f, 0, true },
+        { RenderPass::k_opaque, 1, 2, 3, 0.3f },
+        { RenderPass::k_opaque, 1, 2, 3, 0.4f },
+    });
+
+    const std::vector<InstanceBatch>& batches = batcher.GetBatches();
+    TEST_CHECK(batches.size() == 3);
+    TEST_CHECK(IsBatchOf(batcher, batches[0], { 0 }));
+    TEST_CHECK(IsBatchOf(batcher, batches[1], { 1 }));
+    TEST_CHECK(IsBatchOf(batcher, batches[2], { 2, 3 }));
+}
+
+TEST_CASE(DifferentParametersAreKeptApart)
+{
+    // same template, so the same sort key fields, but the overrides differ
+    InstanceBatcher batcher;
+    Batch(batcher, {
+        { RenderPass::k_opaque, 1, 2, 3, 0.1f, 7 },
+        { RenderPass::k_opaque, 1, 2, 3, 0.2f, 7 },
+        { RenderPass::k_opaque, 1, 2, 3, 0.3f, 8 },
+        { RenderPass::k_opaque, 1, 2, 3, 0.4f, 8 },
+        { RenderPass::k_opaque, 1, 2, 3, 0.5f, 7 },
+    });
+
+    const std::vector<InstanceBatch>& batches = batcher.GetBatches();
+    TEST_CHECK(batches.size() == 3);
+    TEST_CHECK(IsBatchOf(batcher, batches[0], { 0, 1 }));
+    TEST_CHECK(IsBatchOf(batcher, batches[1], { 2, 3 }));
+    TEST_CHECK(IsBatchOf(batcher, batches[2], { 4 }));
+}
+
+TEST_CASE(MaxInstancesSplitsLongRuns)
+{
+    std::vector<TestDraw> draws;
+    for(uint32_t i=0; i<10; i++)
+    {
+        draws.push_back({ RenderPass::k_opaque, 1, 2, 3, i * 0.05f });
+    }
+
+    InstanceBatcher batcher;
+    Batch(batcher, draws, 4);
+    const std::vector<InstanceBatch>& batches = batcher.GetBatches();
+    TEST_CHECK(batches.size() == 3);
+    TEST_CHECK(IsBatchOf(batcher, batches[0], { 0, 1, 2, 3 }));
+    TEST_CHECK(IsBatchOf(batcher, batches[1], { 4, 5, 6, 7 }));
+    TEST_CHECK(IsBatchOf(batcher, batches[2], { 8, 9 }));
+}
+
+TEST_CASE(TransparentDrawsMergeOnlyWhenAdjacentBackToFront)
+{
+    // back to front: 3 (0.9), 1 (0.7), 0 (0.5), 2 (0.3), item 1 uses another mesh so 3 and 0 cannot merge
+    InstanceBatcher batcher;
+    Batch(batcher, {
+        { RenderPass::k_transparent, 1, 2, 3, 0.5f },
+        { RenderPass::k_transparent, 1, 2, 4, 0.7f },
+        { RenderPass::k_transparent, 1, 2, 3, 0.3f },
+        { RenderPass::k_transparent, 1, 2, 3, 0.9f },
+    });
+
+    const std::vector<InstanceBatch>& batches = batcher.GetBatches();
+    TEST_CHECK(batches.size() == 3);
+    TEST_CHECK(IsBatchOf(batcher, batches[0], { 3 }));
+    TEST_CHECK(IsBatchOf(batcher, batches[1], { 1 }));
+    TEST_CHECK(IsBatchOf(batcher, batches[2], { 0, 2 }));
+}
+
+TEST_CASE(CrateSceneDrawCallReduction)
+{
+    // the BoxApp scene: a grid of crates and a few spheres, one pso and template, some crates tinted
+    std::vector<TestDraw> draws;
+    for(uint32_t i=0; i<1000; i++)
+    {
+        draws.push_back({ RenderPass::k_opaque, 0, 0, 1, (i % 97) / 97.0f, i % 100 == 0 ? 1u : 0u });
+    }
+    for(uint32_t i=0; i<24; i++)
+    {
+        draws.push_back({ RenderPass::k_opaque, 0, 0, 2, i / 24.0f });
+    }
+    draws.push_back({ RenderPass::k_opaque, 0, 0, 3, 0.5f, 0, true });
+
+    InstanceBatcher batcher;
+    Batch(batcher, draws);
+    const InstanceBatchStats& stats = batcher.GetStats();
+    TEST_CHECK(stats.draws_before == 1025);
+    TEST_CHECK(stats.draws_after < 30);
+
+    uint32_t instances = 0;
+    for(const InstanceBatch& batch : batcher.GetBatches())
+    {
+        instances += batch.instance_count;
+    }
+    TEST_CHECK(instances == 1025);
+
+    printf("    %llu draws -> %llu draws, %llu of them instanced\n",
+        (unsigned long long)stats.draws_before, (unsigned long long)stats.draws_after, (unsigned long long)stats.instanced_draws);
+}
+
+int main() { return RunTests(); }
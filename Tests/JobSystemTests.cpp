@@ -0,0 +1,297 @@
+// JobSystem jobs, counters, dependencies and ParallelFor, with more workers than a small machine has cores
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Test.h"
+#include "Utility/JobSystem.h"
+
+static const unsigned int k_worker_count = 4;
+
+TEST_CASE(EveryJobRunsOnce)
+{
+    JobSystem job_system(k_worker_count);
+    std::vector<std::atomic<int>> runs(10000);
+    JobCounter counter;
+    for(uint32_t i=0; i<runs.size(); i++)
+    {
+        job_system.Run([&runs, i]() { runs[i]++; }, &counter);
+    }
+    job_system.Wait(&counter);
+
+    TEST_CHECK(counter.IsDone());
+    bool b_all_once = true;
+    for(std::atomic<int>& run : runs)
+    {
+        b_all_once &= run.load() == 1;
+    }
+    TEST_CHECK(b_all_once);
+}
+
+TEST_CASE(LargeCallablesRunAndAreFreed)
+{
+    // larger than Job::k_storage_size, kept behind a pointer
+    JobSystem job_system(k_worker_count);
+    std::atomic<uint64_t> sum{ 0 };
+    JobCounter counter;
+    for(uint64_t i=0; i<1000; i++)
+    {
+        uint64_t values[16] = { i };
+        static_assert(sizeof(values) > Job::k_storage_size, "the callable has to exceed the inline storage");
+        job_system.Run([&sum, values]() { sum += values[0]; }, &counter);
+    }
+    job_system.Wait(&counter);
+    TEST_CHECK(sum.load() == 999 * 1000 / 2);
+}
+
+TEST_CASE(WorkersWakeForJobsRunFromOtherThreads)
+{
+    // nobody helps through Wait, so a sleeping worker has to pick the job up
+    JobSystem job_system(k_worker_count);
+    for(int round=0; round<3; round++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        std::atomic<bool> b_ran{ false };
+        JobCounter counter;
+        job_system.Run([&b_ran]() { b_ran = true; }, &counter);
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while(!counter.IsDone() && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        TEST_CHECK(b_ran.load());
+        // done, but the counter's last user may still hold its lock
+        job_system.Wait(&counter);
+    }
+}
+
+TEST_CASE(DependentJobsStartAfterTheirDependency)
+{
+    JobSystem job_system(k_worker_count);
+    std::atomic<int> first_done{ 0 };
+    std::atomic<int> early_starts{ 0 };
+    JobCounter first, second;
+    for(int i=0; i<8; i++)
+    {
+        job_system.Run([&first_done]()
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            first_done++;
+        }, &first);
+    }
+    for(int i=0; i<100; i++)
+    {
+        job_system.Run([&first_done, &early_starts]() { early_starts += first_done.load() == 8 ? 0 : 1; }, &second, &first);
+    }
+    job_system.Wait(&second);
+
+    TEST_CHECK(first.IsDone());
+    TEST_CHECK(first_done.load() == 8);
+    TEST_CHECK(early_starts.load() == 0);
+
+    // a dependency that is already done does not hold the job back
+    JobCounter third;
+    std::atomic<bool> b_ran{ false };
+    job_system.Run([&b_ran]() { b_ran = true; }, &third, &first);
+    job_system.Wait(&third);
+    TEST_CHECK(b_ran.load());
+}
+
+TEST_CASE(DependencyChainsRunInOrder)
+{
+    // each link waits on the one before, scheduled from whichever thread finished it
+    JobSystem job_system(k_worker_count);
+    const int link_count = 200;
+    std::vector<JobCounter> counters(link_count);
+    std::vector<int> order;
+    std::mutex order_mutex;
+    for(int i=0; i<link_count; i++)
+    {
+        job_system.Run([&order, &order_mutex, i]()
+        {
+            std::lock_guard<std::mutex> lock(order_mutex);
+            order.push_back(i);
+        }, &counters[i], i > 0 ? &counters[i - 1] : nullptr);
+    }
+    job_system.Wait(&counters[link_count - 1]);
+
+    bool b_in_order = (int)order.size() == link_count;
+    for(int i=0; b_in_order && i<link_count; i++)
+    {
+        b_in_order = order[i] == i;
+    }
+    TEST_CHECK(b_in_order);
+}
+
+TEST_CASE(CounterIsReusedOnceDone)
+{
+    JobSystem job_system(k_worker_count);
+    JobCounter counter;
+    std::atomic<int> total{ 0 };
+    bool b_counts_match = true;
+    for(int round=1; round<=50; round++)
+    {
+        for(int i=0; i<round; i++)
+        {
+            job_system.Run([&total]() { total++; }, &counter);
+        }
+        job_system.Wait(&counter);
+        b_counts_match &= counter.IsDone() && total.load() == round * (round + 1) / 2;
+
+        // and as a dependency again, after it was reused
+        JobCounter dependent;
+        std::atomic<bool> b_ran{ false };
+        job_system.Run([&b_ran]() { b_ran = true; }, &dependent, &counter);
+        job_system.Wait(&dependent);
+        b_counts_match &= b_ran.load();
+    }
+    TEST_CHECK(b_counts_match);
+}
+
+TEST_CASE(ParallelForCoversEveryIndexOnce)
+{
+    JobSystem job_system(k_worker_count);
+    const uint32_t counts[] = { 0, 1, 255, 256, 257, 1000, 100003 };
+    const uint32_t grains[] = { 0, 1, 64, 256, 1 << 20 };
+    for(uint32_t count : counts)
+    {
+        for(uint32_t grain : grains)
+        {
+            std::vector<std::atomic<int>> hits(count);
+            job_system.ParallelFor(count, grain, [&hits](uint32_t begin, uint32_t end)
+            {
+                for(uint32_t i=begin; i<end; i++)
+                {
+                    hits[i]++;
+                }
+            });
+            bool b_all_once = true;
+            for(std::atomic<int>& hit : hits)
+            {
+                b_all_once &= hit.load() == 1;
+            }
+            TEST_CHECK(b_all_once);
+        }
+    }
+}
+
+TEST_CASE(NestedParallelForCoversEveryIndexOnce)
+{
+    // inner loops are started from workers and wait there, running other jobs meanwhile
+    JobSystem job_system(k_worker_count);
+    const uint32_t outer_count = 64;
+    const uint32_t inner_count = 5000;
+    std::vector<std::atomic<int>> hits(outer_count * inner_count);
+    job_system.ParallelFor(outer_count, 1, [&](uint32_t outer_begin, uint32_t outer_end)
+    {
+        for(uint32_t outer=outer_begin; outer<outer_end; outer++)
+        {
+            job_system.ParallelFor(inner_count, 16, [&hits, outer, inner_count](uint32_t begin, uint32_t end)
+            {
+                for(uint32_t i=begin; i<end; i++)
+                {
+                    hits[outer * inner_count + i]++;
+                }
+            });
+        }
+    });
+
+    bool b_all_once = true;
+    for(std::atomic<int>& hit : hits)
+    {
+        b_all_once &= hit.load() == 1;
+    }
+    TEST_CHECK(b_all_once);
+}
+
+TEST_CASE(FullDequeRunsJobsInline)
+{
+    // more jobs than a worker's deque holds, all run from one job a worker picked up
+    JobSystem job_system(k_worker_count);
+    const int job_count = (int)WorkStealingDeque::k_capacity * 3;
+    std::atomic<int> runs{ 0 };
+    JobCounter outer, inner;
+    job_system.Run([&]()
+    {
+        for(int i=0; i<job_count; i++)
+        {
+            job_system.Run([&runs]() { runs++; }, &inner);
+        }
+    }, &outer);
+    // not through Wait, this thread would take the job itself and push to the injection queue
+    while(!outer.IsDone())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    job_system.Wait(&outer);
+    job_system.Wait(&inner);
+    TEST_CHECK(runs.load() == job_count);
+}
+
+TEST_CASE(WorkStealingDequeHandsOutEveryJobOnce)
+{
+    // the owner pushes and pops while thieves steal, every job has to come out exactly once
+    WorkStealingDeque deque;
+    const int job_count = 200000;
+    std::vector<Job> jobs(job_count);
+    std::vector<std::atomic<int>> taken(job_count);
+    std::atomic<bool> b_done{ false };
+    auto take = [&](Job* job) { taken[job - jobs.data()]++; };
+
+    std::vector<std::thread> thieves;
+    for(int i=0; i<3; i++)
+    {
+        thieves.emplace_back([&]()
+        {
+            while(!b_done)
+            {
+                if(Job* job = deque.Steal())
+                {
+                    take(job);
+                }
+            }
+        });
+    }
+
+    for(int i=0; i<job_count; i++)
+    {
+        while(!deque.Push(&jobs[i]))
+        {
+            if(Job* job = deque.Pop())
+            {
+                take(job);
+            }
+        }
+        if(i % 3 == 0)
+        {
+            if(Job* job = deque.Pop())
+            {
+                take(job);
+            }
+        }
+    }
+    while(Job* job = deque.Pop())
+    {
+        take(job);
+    }
+    b_done = true;
+    for(std::thread& thief : thieves)
+    {
+        thief.join();
+    }
+
+    bool b_all_once = true;
+    for(std::atomic<int>& count : taken)
+    {
+        b_all_once &= count.load() == 1;
+    }
+    TEST_CHECK(b_all_once);
+    TEST_CHECK(deque.GetSize() == 0);
+}
+
+int main()
+{
+    return RunTests();
+}
@@ -0,0 +1,214 @@
+// LODSelector level choice against hand computed projected errors, the world scale of the objects and the triangle budget
+#include "Test.h"
+#include "Renderer/LODSelector.h"
+
+// 90 degrees over 1000 pixels puts 500 pixels on one unit at distance one, so one pixel of error is 0.002 per unit of distance
+static const float k_fov_y = 1.5707963f;
+static const float k_viewport_height = 1000.0f;
+
+// unit boxes with levels of 1000, 500, 100 and 10 triangles and errors of 0, 0.5, 1.5 and 3 mesh space units
+struct TestLODChain
+{
+    Mesh meshes[Mesh::k_max_lods];
+
+    TestLODChain()
+    {
+        const uint32_t triangle_counts[Mesh::k_max_lods] = { 1000, 500, 100, 10 };
+        const float errors[Mesh::k_max_lods] = { 0.0f, 0.5f, 1.5f, 3.0f };
+        std::vector<Vertex> vertices;
+        for(int corner=0; corner<8; corner++)
+        {
+            Vertex vertex;
+            vertex.Position = DirectX::XMFLOAT3((corner & 1) ? 0.5f : -0.5f, (corner & 2) ? 0.5f : -0.5f, (corner & 4) ? 0.5f : -0.5f);
+            vertices.push_back(vertex);
+        }
+        for(uint32_t level=0; level<Mesh::k_max_lods; level++)
+        {
+            meshes[level].SetVerticesCPU(vertices);
+            meshes[level].SetIndicesCPU(std::vector<uint16_t>(triangle_counts[level] * 3, 0));
+            meshes[level].SetGeometricError(errors[level]);
+            if(level > 0)
+            {
+                meshes[0].AddLOD(&meshes[level]);
+            }
+        }
+    }
+};
+
+static RenderView MakeView()
+{
+    RenderView view;
+    view.position = Vector3::Zero;
+    view.fov_y = k_fov_y;
+    view.viewport_height = k_viewport_height;
+    return view;
+}
+
+static std::vector<uint32_t> AllIndices(const RenderProxyList& proxies)
+{
+    std::vector<uint32_t> indices(proxies.GetCount());
+    for(uint32_t i=0; i<proxies.GetCount(); i++)
+    {
+        indices[i] = i;
+    }
+    return indices;
+}
+
+TEST_CASE(ScreenScaleIsPixelsPerUnitAtDistanceOne)
+{
+    TEST_CHECK_NEAR(LODSelector::GetScreenScale(k_fov_y, k_viewport_height), 500.0f, 1e-3f);
+}
+
+TEST_CASE(FartherObjectsTakeCoarserLevels)
+{
+    TestLODChain chain;
+    RenderProxyList proxies;
+    // allowed errors around 0.2, 1.2, 2 and 8
+    const float distances[] = { 100.0f, 600.0f, 1000.0f, 4000.0f };
+    for(float distance : distances)
+    {
+        proxies.Add(proxies.GetCount(), Matrix::CreateTranslation(0.0f, 0.0f, distance), &chain.meshes[0], nullptr, 0);
+    }
+
+    LODSettings settings;
+    settings.hysteresis = 0.0f;
+    LODSelector selector;
+    selector.SetSettings(settings);
+    std::vector<uint32_t> indices = AllIndices(proxies);
+    selector.Select(MakeView(), proxies, indices.data(), (uint32_t)indices.size());
+
+    TEST_CHECK(selector.GetLevel(0) == 0);
+    TEST_CHECK(selector.GetLevel(1) == 1);
+    TEST_CHECK(selector.GetLevel(2) == 2);
+    TEST_CHECK(selector.GetLevel(3) == 3);
+    TEST_CHECK(selector.GetMesh(2) == &chain.meshes[2]);
+    TEST_CHECK(selector.GetStats().triangles == 1000 + 500 + 100 + 10);
+}
+
+TEST_CASE(ScaledObjectsTakeFinerLevels)
+{
+    // the same mesh at the same distance, its errors grow with the largest axis scale of the world matrix
+    TestLODChain chain;
+    RenderProxyList proxies;
+    const Vector3 scales[] = { Vector3(1.0f, 1.0f, 1.0f), Vector3(2.0f, 2.0f, 2.0f), Vector3(10.0f, 10.0f, 10.0f), Vector3(1.0f, 3.0f, 1.0f) };
+    for(const Vector3& scale : scales)
+    {
+        proxies.Add(proxies.GetCount(), Matrix::CreateScale(scale) * Matrix::CreateTranslation(0.0f, 0.0f, 1000.0f), &chain.meshes[0], nullptr, 0);
+    }
+
+    LODSettings settings;
+    settings.hysteresis = 0.0f;
+    LODSelector selector;
+    selector.SetSettings(settings);
+    std::vector<uint32_t> indices = AllIndices(proxies);
+    selector.Select(MakeView(), proxies, indices.data(), (uint32_t)indices.size());
+
+    // allowed errors just under 2, the scaled errors of levels 1 and 2 are 0.5 and 1.5, 1 and 3, 5 and 15, 1.5 and 4.5
+    TEST_CHECK(selector.GetLevel(0) == 2);
+    TEST_CHECK(selector.GetLevel(1) == 1);
+    TEST_CHECK(selector.GetLevel(2) == 0);
+    TEST_CHECK(selector.GetLevel(3) == 1);
+}
+
+TEST_CASE(HysteresisDelaysCoarsening)
+{
+    TestLODChain chain;
+    RenderProxyList proxies;
+    proxies.Add(0, Matrix::CreateTranslation(0.0f, 0.0f, 900.0f), &chain.meshes[0], nullptr, 0);
+    uint32_t index = 0;
+
+    // allowed error about 1.8, level 2's 1.5 is under it but over 0.75 of it so coarsening stops at level 1
+    LODSelector selector;
+    selector.Select(MakeView(), proxies, &index, 1);
+    TEST_CHECK(selector.GetLevel(0) == 1);
+
+    // allowed error about 2.2, now 1.5 is under the margin
+    proxies.Clear();
+    proxies.Add(0, Matrix::CreateTranslation(0.0f, 0.0f, 1100.0f), &chain.meshes[0], nullptr, 0);
+    selector.Select(MakeView(), proxies, &index, 1);
+    TEST_CHECK(selector.GetLevel(0) == 2);
+
+    // back at 900 level 2's error is still allowed, refining only happens past the threshold itself
+    proxies.Clear();
+    proxies.Add(0, Matrix::CreateTranslation(0.0f, 0.0f, 900.0f), &chain.meshes[0], nullptr, 0);
+    selector.Select(MakeView(), proxies, &index, 1);
+    TEST_CHECK(selector.GetLevel(0) == 2);
+}
+
+TEST_CASE(HysteresisFollowsObjectsWhenProxiesShift)
+{
+    // at 1100 an object coarsens to level 2, at 900 a new one stops at level 1 and one coming from 1100 keeps level 2
+    TestLODChain chain;
+    RenderProxyList proxies;
+    proxies.Add(3, Matrix::CreateTranslation(0.0f, 0.0f, 1100.0f), &chain.meshes[0], nullptr, 0);
+    proxies.Add(8, Matrix::CreateTranslation(0.0f, 0.0f, 900.0f), &chain.meshes[0], nullptr, 0);
+    LODSelector selector;
+    std::vector<uint32_t> indices = AllIndices(proxies);
+    selector.Select(MakeView(), proxies, indices.data(), (uint32_t)indices.size());
+    TEST_CHECK(selector.GetLevel(0) == 2);
+    TEST_CHECK(selector.GetLevel(1) == 1);
+
+    // object 3 left the view, object 8 moved to index 0 and must not take over object 3's level
+    proxies.Clear();
+    proxies.Add(8, Matrix::CreateTranslation(0.0f, 0.0f, 900.0f), &chain.meshes[0], nullptr, 0);
+    indices = AllIndices(proxies);
+    selector.Select(MakeView(), proxies, indices.data(), (uint32_t)indices.size());
+    TEST_CHECK(selector.GetLevel(0) == 1);
+
+    // a new object in front of them and object 3 back at 900, every object keeps its own history
+    proxies.Clear();
+    proxies.Add(1, Matrix::CreateTranslation(0.0f, 0.0f, 900.0f), &chain.meshes[0], nullptr, 0);
+    proxies.Add(3, Matrix::CreateTranslation(0.0f, 0.0f, 900.0f), &chain.meshes[0], nullptr, 0);
+    proxies.Add(8, Matrix::CreateTranslation(0.0f, 0.0f, 900.0f), &chain.meshes[0], nullptr, 0);
+    indices = AllIndices(proxies);
+    selector.Select(MakeView(), proxies, indices.data(), (uint32_t)indices.size());
+    TEST_CHECK(selector.GetLevel(0) == 1);
+    TEST_CHECK(selector.GetLevel(1) == 2);
+    TEST_CHECK(selector.GetLevel(2) == 1);
+}
+
+TEST_CASE(TriangleBudgetCoarsensTheFollowingFrames)
+{
+    // 100 objects around distance 100 all take level 0, 100k triangles
+    TestLODChain chain;
+    RenderProxyList proxies;
+    for(int i=0; i<100; i++)
+    {
+        proxies.Add((uint32_t)i, Matrix::CreateTranslation((float)(i - 50), 0.0f, 100.0f), &chain.meshes[0], nullptr, 0);
+    }
+    std::vector<uint32_t> indices = AllIndices(proxies);
+
+    LODSettings settings;
+    settings.triangle_budget = 20000;
+    LODSelector selector;
+    selector.SetSettings(settings);
+    selector.Select(MakeView(), proxies, indices.data(), (uint32_t)indices.size());
+    TEST_CHECK(selector.GetStats().triangles == 100000);
+    TEST_CHECK(selector.GetStats().threshold_scale == 1.0f);
+
+    // the threshold scale grows each frame over the budget until level 2 fits in it
+    bool b_within_budget = false;
+    for(int frame=0; frame<30 && !b_within_budget; frame++)
+    {
+        selector.Select(MakeView(), proxies, indices.data(), (uint32_t)indices.size());
+        b_within_budget = selector.GetStats().triangles <= settings.triangle_budget;
+    }
+    TEST_CHECK(b_within_budget);
+    TEST_CHECK(selector.GetStats().threshold_scale > 1.0f);
+    TEST_CHECK(selector.GetStats().level_counts[0] == 0);
+
+    // without a budget the scale decays back and the finest levels return
+    settings.triangle_budget = 0;
+    selector.SetSettings(settings);
+    for(int frame=0; frame<60; frame++)
+    {
+        selector.Select(MakeView(), proxies, indices.data(), (uint32_t)indices.size());
+    }
+    TEST_CHECK(selector.GetStats().threshold_scale == 1.0f);
+    TEST_CHECK(selector.GetStats().triangles == 100000);
+}
+
+int main()
+{
+    return RunTests();
+}
@@ -0,0 +1,84 @@
+// NameTable reference counting, released names give their index and storage to the next ones
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "Utility/NameTable.h"
+
+TEST_CASE(SameStringSharesOneEntry)
+{
+    NameTable table;
+    NameIndex a = table.Intern("crate");
+    NameIndex b = table.Intern(std::string("crate"));
+    TEST_CHECK(a == b);
+    TEST_CHECK(std::string(table.GetString(a)) == "crate");
+    TEST_CHECK(table.GetCount() == 1);
+    TEST_CHECK(table.Intern("sphere") != a);
+    TEST_CHECK(table.GetCount() == 2);
+}
+
+TEST_CASE(NameStaysUntilTheLastRelease)
+{
+    NameTable table;
+    NameIndex first = table.Intern("crate");
+    table.Intern("crate");
+    table.Release(first);
+    TEST_CHECK(table.GetCount() == 1);
+    TEST_CHECK(std::string(table.GetString(first)) == "crate");
+
+    table.Release(first);
+    TEST_CHECK(table.GetCount() == 0);
+
+    // the freed index comes back with a new string
+    NameIndex next = table.Intern("sphere");
+    TEST_CHECK(next == first);
+    TEST_CHECK(std::string(table.GetString(next)) == "sphere");
+}
+
+TEST_CASE(ChurnKeepsTheTableAtItsLiveSize)
+{
+    // projectiles with unique names, 100 alive at a time
+    NameTable table;
+    const uint32_t live_count = 100;
+    std::vector<NameIndex> live;
+    for(uint32_t i=0; i<100000; i++)
+    {
+        live.push_back(table.Intern("projectile_" + std::to_string(i)));
+        if(live.size() > live_count)
+        {
+            table.Release(live.front());
+            live.erase(live.begin());
+        }
+    }
+    TEST_CHECK(table.GetCount() == live_count);
+    TEST_CHECK(table.GetStorageSize() <= 64 * 1024);
+    TEST_CHECK(std::string(table.GetString(live.back())) == "projectile_99999");
+}
+
+TEST_CASE(LongNamesAreFreedOnRelease)
+{
+    NameTable table;
+    std::string long_name(1000, 'x');
+    NameIndex index = table.Intern(long_name);
+    TEST_CHECK(std::string(table.GetString(index)) == long_name);
+    TEST_CHECK(table.GetStorageSize() == long_name.size() + 1);
+
+    table.Release(index);
+    TEST_CHECK(table.GetStorageSize() == 0);
+    TEST_CHECK(table.GetCount() == 0);
+}
+
+TEST_CASE(FreedStorageIsReusedByNamesOfTheSameSizeClass)
+{
+    NameTable table;
+    NameIndex a = table.Intern("abcdefghij");      // 11 bytes, the 16 byte class
+    const char* a_storage = table.GetString(a);
+    table.Release(a);
+    NameIndex b = table.Intern("0123456789abcd");  // 15 bytes, same class
+    TEST_CHECK(table.GetString(b) == a_storage);
+    TEST_CHECK(std::string(table.GetString(b)) == "0123456789abcd");
+}
+
+int main()
+{
+    return RunTests();
+}
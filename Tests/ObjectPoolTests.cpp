@@ -0,0 +1,225 @@
+// ObjectPool slots and generational handles, destroyed objects never resolve again and stale handles change nothing
+#include <stdexcept>
+#include <vector>
+#include "Test.h"
+#include "Utility/ObjectPool.h"
+
+// counts its constructions and destructions, so leaks and double destructions show up
+struct Tracked
+{
+    static int s_alive;
+
+    int value;
+
+    explicit Tracked(int in_value) : value(in_value)
+    {
+        if(value < 0)
+        {
+            throw std::runtime_error("negative value");
+        }
+        s_alive++;
+    }
+    ~Tracked() { s_alive--; }
+
+    Tracked(const Tracked&) = delete;
+    Tracked& operator=(const Tracked&) = delete;
+};
+
+int Tracked::s_alive = 0;
+
+TEST_CASE(CreatedObjectsResolveUntilDestroyed)
+{
+    ObjectPool<Tracked, 4> pool;
+    PoolHandle<Tracked> a = pool.Create(1);
+    PoolHandle<Tracked> b = pool.Create(2);
+    TEST_CHECK(a.IsValid() && b.IsValid() && a != b);
+    TEST_CHECK(pool.Get(a)->value == 1);
+    TEST_CHECK(pool.Get(b)->value == 2);
+    TEST_CHECK(pool.GetCount() == 2);
+    TEST_CHECK(Tracked::s_alive == 2);
+
+    pool.Destroy(a);
+    TEST_CHECK(pool.Get(a) == nullptr);
+    TEST_CHECK(!pool.IsAlive(a));
+    TEST_CHECK(pool.Get(b)->value == 2);
+    TEST_CHECK(pool.GetCount() == 1);
+    TEST_CHECK(Tracked::s_alive == 1);
+
+    // default and out of range handles resolve to nothing
+    TEST_CHECK(!PoolHandle<Tracked>().IsValid());
+    TEST_CHECK(pool.Get(PoolHandle<Tracked>()) == nullptr);
+    PoolHandle<Tracked> out_of_range;
+    out_of_range.index = 1000;
+    TEST_CHECK(pool.Get(out_of_range) == nullptr);
+
+    pool.Clear();
+    TEST_CHECK(Tracked::s_alive == 0);
+}
+
+TEST_CASE(ReusedSlotTakesANewGeneration)
+{
+    ObjectPool<Tracked, 4> pool;
+    PoolHandle<Tracked> old_handle = pool.Create(1);
+    pool.Destroy(old_handle);
+
+    // the freed slot is reused first, the old handle must not see its new owner
+    PoolHandle<Tracked> new_handle = pool.Create(2);
+    TEST_CHECK(new_handle.index == old_handle.index);
+    TEST_CHECK(new_handle.generation != old_handle.generation);
+    TEST_CHECK(new_handle != old_handle);
+    TEST_CHECK(pool.Get(old_handle) == nullptr);
+    TEST_CHECK(pool.Get(new_handle)->value == 2);
+
+    // many reuses of the same slot never repeat a generation
+    std::vector<uint32_t> generations;
+    for(int i=0; i<100; i++)
+    {
+        PoolHandle<Tracked> handle = pool.Create(i);
+        generations.push_back(handle.generation);
+        pool.Destroy(handle);
+    }
+    bool b_increasing = true;
+    for(size_t i=1; i<generations.size(); i++)
+    {
+        b_increasing &= generations[i] > generations[i - 1];
+    }
+    TEST_CHECK(b_increasing);
+    pool.Clear();
+}
+
+TEST_CASE(StaleDestroyLeavesTheNewOwnerAlone)
+{
+    ObjectPool<Tracked, 4> pool;
+    PoolHandle<Tracked> old_handle = pool.Create(1);
+    pool.Destroy(old_handle);
+    PoolHandle<Tracked> new_handle = pool.Create(2);
+
+    // destroying twice, once the slot is reused and once while it is free again
+    pool.Destroy(old_handle);
+    TEST_CHECK(pool.Get(new_handle) != nullptr);
+    TEST_CHECK(pool.Get(new_handle)->value == 2);
+    TEST_CHECK(pool.GetCount() == 1);
+    TEST_CHECK(Tracked::s_alive == 1);
+
+    pool.Destroy(new_handle);
+    pool.Destroy(new_handle);
+    pool.Destroy(old_handle);
+    TEST_CHECK(pool.GetCount() == 0);
+    TEST_CHECK(Tracked::s_alive == 0);
+
+    // the slot went on the free list once, so two creates take two different slots
+    PoolHandle<Tracked> c = pool.Create(3);
+    PoolHandle<Tracked> d = pool.Create(4);
+    TEST_CHECK(c.index != d.index);
+    TEST_CHECK(pool.Get(c)->value == 3 && pool.Get(d)->value == 4);
+    pool.Clear();
+}
+
+TEST_CASE(ObjectsStayInPlaceWhileSlabsAreAdded)
+{
+    ObjectPool<Tracked, 4> pool;
+    std::vector<PoolHandle<Tracked>> handles;
+    std::vector<Tracked*> addresses;
+    for(int i=0; i<4; i++)
+    {
+        handles.push_back(pool.Create(i));
+        addresses.push_back(pool.Get(handles.back()));
+    }
+    TEST_CHECK(pool.GetSlabCount() == 1);
+
+    for(int i=4; i<40; i++)
+    {
+        handles.push_back(pool.Create(i));
+        addresses.push_back(pool.Get(handles.back()));
+    }
+    TEST_CHECK(pool.GetSlabCount() == 10);
+
+    bool b_in_place = true;
+    for(size_t i=0; i<handles.size(); i++)
+    {
+        b_in_place &= pool.Get(handles[i]) == addresses[i] && addresses[i]->value == (int)i;
+    }
+    TEST_CHECK(b_in_place);
+
+    // churn under the peak reuses the slots without adding slabs
+    for(int round=0; round<1000; round++)
+    {
+        pool.Destroy(handles[round % handles.size()]);
+        handles[round % handles.size()] = pool.Create(round);
+    }
+    TEST_CHECK(pool.GetSlabCount() == 10);
+    TEST_CHECK(pool.GetCount() == 40);
+    pool.Clear();
+}
+
+TEST_CASE(ClearAndForEachSeeOnlyAliveObjects)
+{
+    std::vector<PoolHandle<Tracked>> handles;
+    {
+        ObjectPool<Tracked, 4> pool;
+        for(int i=0; i<10; i++)
+        {
+            handles.push_back(pool.Create(i));
+        }
+        for(int i=0; i<10; i+=2)
+        {
+            pool.Destroy(handles[i]);
+        }
+
+        int sum = 0;
+        int visited = 0;
+        pool.ForEach([&](Tracked& tracked) { sum += tracked.value; visited++; });
+        TEST_CHECK(visited == 5);
+        TEST_CHECK(sum == 1 + 3 + 5 + 7 + 9);
+
+        // Clear keeps the slabs, every handle goes stale
+        pool.Clear();
+        TEST_CHECK(pool.GetCount() == 0);
+        TEST_CHECK(pool.GetSlabCount() == 3);
+        TEST_CHECK(Tracked::s_alive == 0);
+        bool b_all_stale = true;
+        for(PoolHandle<Tracked> handle : handles)
+        {
+            b_all_stale &= pool.Get(handle) == nullptr;
+        }
+        TEST_CHECK(b_all_stale);
+
+        // the destructor destroys what is left
+        pool.Create(1);
+        pool.Create(2);
+        TEST_CHECK(Tracked::s_alive == 2);
+    }
+    TEST_CHECK(Tracked::s_alive == 0);
+}
+
+TEST_CASE(ThrowingConstructorKeepsTheSlotFree)
+{
+    ObjectPool<Tracked, 4> pool;
+    PoolHandle<Tracked> a = pool.Create(1);
+    bool b_threw = false;
+    try
+    {
+        pool.Create(-1);
+    }
+    catch(const std::runtime_error&)
+    {
+        b_threw = true;
+    }
+    TEST_CHECK(b_threw);
+    TEST_CHECK(pool.GetCount() == 1);
+
+    // the slot the failed create was given is handed out next
+    PoolHandle<Tracked> b = pool.Create(2);
+    TEST_CHECK(b.index == a.index + 1);
+    TEST_CHECK(pool.Get(a)->value == 1 && pool.Get(b)->value == 2);
+    int visited = 0;
+    pool.ForEach([&](Tracked&) { visited++; });
+    TEST_CHECK(visited == 2);
+    pool.Clear();
+    TEST_CHECK(Tracked::s_alive == 0);
+}
+
+int main()
+{
+    return RunTests();
+}
@@ -0,0 +1,212 @@
+// Shader::BindParameters on a headless device: no heap allocation once the draw loop is warm,
+// and only the root parameters changed since the last bind are set again
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "Test.h"
+#include "TempDirectory.h"
+#include "D3DRHI/HeadlessDevice.h"
+#include "D3DRHI/DescriptorManager.h"
+#include "Material/Shader.h"
+#include "Material/ShaderCache.h"
+
+// every operator new of the process goes through here, the driver allocates on its own heap
+static std::atomic<uint64_t> s_new_calls{0};
+
+void* operator new(size_t size)
+{
+    s_new_calls++;
+    void* memory = malloc(size > 0 ? size : 1);
+    if(memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    s_new_calls++;
+    void* memory = _aligned_malloc(size > 0 ? size : 1, (size_t)alignment);
+    if(memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { _aligned_free(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { _aligned_free(memory); }
+
+// cbPerObject fits in root constants, cbPerFrame is a root descriptor and the textures share one table
+static const char* const k_shader_source = R"(
+cbuffer cbPerObject : register(b0)
+{
+    float4x4 gWorldViewProj;
+};
+cbuffer cbPerFrame : register(b1)
+{
+    float4x4 gViewProj;
+    float4 gTime;
+};
+Texture2D gDiffuseMap : register(t0);
+Texture2D gNormalMap : register(t1);
+SamplerState gsamPointWrap : register(s0);
+
+float4 VS(float3 pos : POSITION) : SV_POSITION
+{
+    return mul(mul(float4(pos, 1.0f), gWorldViewProj), gViewProj) * gTime;
+}
+
+float4 PS(float4 pos : SV_POSITION) : SV_Target
+{
+    return gDiffuseMap.Sample(gsamPointWrap, pos.xy) + gNormalMap.Sample(gsamPointWrap, pos.xy);
+}
+)";
+
+struct BindingScene
+{
+    TempDirectory directory{"ShaderBindingTests"};
+    HeadlessDevice headless_device;
+    std::unique_ptr<Shader> shader;
+    std::unique_ptr<DescriptorCacheGPU> descriptor_cache;
+    std::unique_ptr<DescriptorManager> descriptor_manager;
+    std::unique_ptr<ShaderResourceView> srvs[3];
+    std::unique_ptr<D3D12ConstantBuffer> frame_cbs[2];
+
+    ShaderParamHandle object_cb_handle;
+    ShaderParamHandle frame_cb_handle;
+    ShaderParamHandle diffuse_map_handle;
+    ShaderParamHandle normal_map_handle;
+
+    BindingScene()
+    {
+        ShaderCache::SetCacheDirectory("");
+        ID3D12Device* device = headless_device.GetDevice();
+
+        ShaderInfo shader_info;
+        shader_info.shader_name = "Binding";
+        shader_info.file_name = directory.WriteFile("binding.hlsl", k_shader_source);
+        shader_info.b_create_VS = true;
+        shader_info.b_create_PS = true;
+        shader = std::make_unique<Shader>(shader_info, device);
+
+        descriptor_cache = std::make_unique<DescriptorCacheGPU>(device);
+        descriptor_manager = std::make_unique<DescriptorManager>(device, 16, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+        // null descriptors, nothing is drawn
+        D3D12_SHADER_RESOURCE_VIEW_DESC srv_desc = {};
+        srv_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+        srv_desc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+        srv_desc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        srv_desc.Texture2D.MipLevels = 1;
+        for(auto& srv : srvs)
+        {
+            srv = std::make_unique<ShaderResourceView>(srv_desc, nullptr, device, descriptor_manager.get());
+        }
+        for(auto& frame_cb : frame_cbs)
+        {
+            frame_cb = std::make_unique<D3D12ConstantBuffer>(device, 256);
+        }
+
+        object_cb_handle = shader->GetParameterHandle("cbPerObject");
+        frame_cb_handle = shader->GetParameterHandle("cbPerFrame");
+        diffuse_map_handle = shader->GetParameterHandle("gDiffuseMap");
+        normal_map_handle = shader->GetParameterHandle("gNormalMap");
+    }
+
+    void BeginCommandList()
+    {
+        headless_device.BeginCommandList();
+        ID3D12DescriptorHeap* heaps[] = { descriptor_cache->GetCachedCbvSrvUavDescriptorHeap() };
+        headless_device.GetCommandList()->SetDescriptorHeaps(_countof(heaps), heaps);
+    }
+
+    // one draw's worth of parameter changes, every root parameter changes from one draw to the next
+    void Draw(uint32_t draw)
+    {
+        Matrix world_view_proj = Matrix::CreateTranslation((float)draw, 0.0f, 0.0f);
+        shader->SetConstants(object_cb_handle, &world_view_proj, sizeof(world_view_proj));
+        shader->SetParameter(frame_cb_handle, frame_cbs[draw & 1].get());
+        shader->SetParameter(diffuse_map_handle, srvs[draw & 1].get());
+        shader->SetParameter(normal_map_handle, srvs[2].get());
+        shader->BindParameters(headless_device.GetCommandList(), descriptor_cache.get());
+    }
+};
+
+TEST_CASE(ParametersAreLaidOutAsExpected)
+{
+    BindingScene scene;
+    TEST_CHECK(scene.shader->IsRootConstants(scene.object_cb_handle));
+    TEST_CHECK(scene.frame_cb_handle.kind == ShaderParamKind::k_cbv && !scene.shader->IsRootConstants(scene.frame_cb_handle));
+    TEST_CHECK(scene.diffuse_map_handle.kind == ShaderParamKind::k_srv);
+    TEST_CHECK(scene.normal_map_handle.kind == ShaderParamKind::k_srv);
+    TEST_CHECK(scene.shader->GetRootSignatureLayout().params.size() == 3);
+}
+
+TEST_CASE(BindParametersDoesNotAllocateInSteadyState)
+{
+    BindingScene scene;
+    scene.BeginCommandList();
+
+    // the first binds may size the parameters' srv lists
+    const uint32_t k_warm_up_draws = 4;
+    for(uint32_t draw=0; draw<k_warm_up_draws; draw++)
+    {
+        scene.Draw(draw);
+    }
+
+    // two descriptors appended per draw, well inside DescriptorCacheGPU's heap
+    Shader::ResetBindingStats();
+    uint64_t new_calls_before = s_new_calls;
+    const uint32_t k_steady_draws = 256;
+    for(uint32_t draw=k_warm_up_draws; draw<k_warm_up_draws + k_steady_draws; draw++)
+    {
+        scene.Draw(draw);
+    }
+    uint64_t new_calls = s_new_calls - new_calls_before;
+
+    TEST_CHECK(new_calls == 0);
+    TEST_CHECK(Shader::GetBindingStats().root_param_updates == 3 * k_steady_draws);
+    scene.headless_device.ExecuteCommandList();
+}
+
+TEST_CASE(BindParametersSkipsCleanRootParameters)
+{
+    BindingScene scene;
+    scene.BeginCommandList();
+    scene.Draw(0);
+
+    // nothing changed
+    Shader::ResetBindingStats();
+    scene.shader->BindParameters(scene.headless_device.GetCommandList(), scene.descriptor_cache.get());
+    TEST_CHECK(Shader::GetBindingStats().root_param_updates == 0);
+    TEST_CHECK(Shader::GetBindingStats().eliminated_root_param_updates == 3);
+
+    // same values written again
+    Shader::ResetBindingStats();
+    Matrix world_view_proj = Matrix::CreateTranslation(0.0f, 0.0f, 0.0f);
+    scene.shader->SetConstants(scene.object_cb_handle, &world_view_proj, sizeof(world_view_proj));
+    scene.shader->SetParameter(scene.frame_cb_handle, scene.frame_cbs[0].get());
+    scene.shader->SetParameter(scene.diffuse_map_handle, scene.srvs[0].get());
+    scene.shader->BindParameters(scene.headless_device.GetCommandList(), scene.descriptor_cache.get());
+    TEST_CHECK(Shader::GetBindingStats().root_param_updates == 0);
+
+    // only the frame cbuffer changed
+    Shader::ResetBindingStats();
+    scene.shader->SetParameter(scene.frame_cb_handle, scene.frame_cbs[1].get());
+    scene.shader->BindParameters(scene.headless_device.GetCommandList(), scene.descriptor_cache.get());
+    TEST_CHECK(Shader::GetBindingStats().root_param_updates == 1);
+    TEST_CHECK(Shader::GetBindingStats().eliminated_root_param_updates == 2);
+
+    // a reset descriptor cache makes the tables stale, the root arguments are all set again
+    Shader::ResetBindingStats();
+    scene.descriptor_cache->ResetCachedHeap();
+    scene.shader->BindParameters(scene.headless_device.GetCommandList(), scene.descriptor_cache.get());
+    TEST_CHECK(Shader::GetBindingStats().root_param_updates == 3);
+    scene.headless_device.ExecuteCommandList();
+}
+
+int main() { return RunTests(); }
@@ -0,0 +1,184 @@
+// include graph and file watcher tests against temp files, see ShaderHotReloader
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include "Test.h"
+#include "TempDirectory.h"
+#include "Material/ShaderDependencyGraph.h"
+#include "Utility/FileWatcher.h"
+
+static bool Contains(const std::vector<std::string>& files, const std::string& file)
+{
+    return std::find(files.begin(), files.end(), FileWatcher::NormalizePath(file)) != files.end();
+}
+
+TEST_CASE(ParseIncludesResolvesRelativeToTheIncludingFile)
+{
+    TempDirectory directory("ShaderDependencyGraphTests");
+    std::string light = directory.WriteFile("sub/light.hlsl",
+        "#include \"../common.hlsl\"\n"
+        "  #  include <shadow.hlsl>\n"
+        "// #include \"commented.hlsl\"\n"
+        "float4 Light() { return 0; }\n");
+
+    std::vector<std::string> includes = ShaderDependencyGraph::ParseIncludes(light);
+    TEST_CHECK(includes.size() == 2);
+    TEST_CHECK(Contains(includes, directory.GetFilePath("common.hlsl")));
+    TEST_CHECK(Contains(includes, directory.GetFilePath("sub/shadow.hlsl")));
+    TEST_CHECK(ShaderDependencyGraph::ParseIncludes(directory.GetFilePath("missing.hlsl")).empty());
+}
+
+TEST_CASE(ScanRootFileReturnsTheIncludeClosure)
+{
+    TempDirectory directory("ShaderDependencyGraphTests");
+    std::string root = directory.WriteFile("color.hlsl", "#include \"common.hlsl\"\n#include \"sub/light.hlsl\"\n");
+    directory.WriteFile("common.hlsl", "#define PI 3.14159\n");
+    directory.WriteFile("sub/light.hlsl", "#include \"../common.hlsl\"\n#include \"brdf.hlsl\"\n");
+
+    ShaderDependencyGraph graph;
+    std::vector<std::string> closure = graph.ScanRootFile(root);
+    // common.hlsl is included twice but listed once, the missing brdf.hlsl is still tracked so creating it triggers a reload
+    TEST_CHECK(closure.size() == 4);
+    TEST_CHECK(!closure.empty() && closure[0] == FileWatcher::NormalizePath(root));
+    TEST_CHECK(Contains(closure, directory.GetFilePath("common.hlsl")));
+    TEST_CHECK(Contains(closure, directory.GetFilePath("sub/light.hlsl")));
+    TEST_CHECK(Contains(closure, directory.GetFilePath("sub/brdf.hlsl")));
+}
+
+TEST_CASE(ScanRootFileStopsAtIncludeCycles)
+{
+    TempDirectory directory("ShaderDependencyGraphTests");
+    std::string root = directory.WriteFile("a.hlsl", "#include \"b.hlsl\"\n");
+    directory.WriteFile("b.hlsl", "#include \"c.hlsl\"\n");
+    directory.WriteFile("c.hlsl", "#include \"a.hlsl\"\n#include \"c.hlsl\"\n");
+
+    ShaderDependencyGraph graph;
+    std::vector<std::string> closure = graph.ScanRootFile(root);
+    TEST_CHECK(closure.size() == 3);
+    TEST_CHECK(Contains(graph.GetAffectedRootFiles(directory.GetFilePath("c.hlsl")), root));
+}
+
+TEST_CASE(GetAffectedRootFilesFollowsSharedIncludes)
+{
+    TempDirectory directory("ShaderDependencyGraphTests");
+    std::string color = directory.WriteFile("color.hlsl", "#include \"common.hlsl\"\n");
+    std::string blur = directory.WriteFile("blur.hlsl", "#include \"common.hlsl\"\n#include \"kernel.hlsl\"\n");
+    std::string common = directory.WriteFile("common.hlsl", "");
+    std::string kernel = directory.WriteFile("kernel.hlsl", "");
+
+    ShaderDependencyGraph graph;
+    graph.ScanRootFile(color);
+    graph.ScanRootFile(blur);
+
+    std::vector<std::string> affected = graph.GetAffectedRootFiles(common);
+    TEST_CHECK(affected.size() == 2 && Contains(affected, color) && Contains(affected, blur));
+    affected = graph.GetAffectedRootFiles(kernel);
+    TEST_CHECK(affected.size() == 1 && Contains(affected, blur));
+    affected = graph.GetAffectedRootFiles(color);
+    TEST_CHECK(affected.size() == 1 && Contains(affected, color));
+    TEST_CHECK(graph.GetAffectedRootFiles(directory.GetFilePath("unrelated.hlsl")).empty());
+
+    // an edit dropping the include is picked up by the rescan
+    directory.WriteFile("blur.hlsl", "#include \"common.hlsl\"\n");
+    graph.ScanRootFile(blur);
+    TEST_CHECK(graph.GetAffectedRootFiles(kernel).empty());
+
+    graph.RemoveRootFile(blur);
+    affected = graph.GetAffectedRootFiles(common);
+    TEST_CHECK(affected.size() == 1 && Contains(affected, color));
+    graph.RemoveRootFile(color);
+    TEST_CHECK(graph.GetAffectedRootFiles(common).empty());
+}
+
+// collects the callbacks of a FileWatcher, which arrive on its thread
+class ChangeRecorder
+{
+public:
+    void OnChange(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_changes.push_back(path);
+        m_condition.notify_all();
+    }
+
+    bool WaitFor(const std::string& path, std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        return m_condition.wait_for(lock, timeout, [&]() { return Contains(m_changes, path); });
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_changes.clear();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::vector<std::string> m_changes;
+};
+
+// the write time is moved forward as well, so the polling fallback sees the change with coarse timestamps
+static void ModifyFile(const TempDirectory& directory, const std::string& relative_path, const std::string& content)
+{
+    std::string path = directory.WriteFile(relative_path, content);
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() + std::chrono::seconds(2));
+}
+
+TEST_CASE(FileWatcherReportsWritesToWatchedFiles)
+{
+    TempDirectory directory("ShaderDependencyGraphTests");
+    std::string watched = directory.WriteFile("color.hlsl", "");
+    std::string other = directory.WriteFile("other.hlsl", "");
+
+    ChangeRecorder recorder;
+    FileWatcher watcher([&recorder](const std::string& path) { recorder.OnChange(path); }, std::chrono::milliseconds(20));
+    watcher.WatchFile(watched);
+    watcher.WatchFile(watched);
+
+    ModifyFile(directory, "color.hlsl", "float4 VS() : SV_Position { return 0; }");
+    TEST_CHECK(recorder.WaitFor(watched, std::chrono::seconds(5)));
+
+    // files next to a watched one share its directory watch but are not reported
+    ModifyFile(directory, "other.hlsl", "changed");
+    TEST_CHECK(!recorder.WaitFor(other, std::chrono::milliseconds(300)));
+
+    // editors saving through a temp file renamed over the original
+    recorder.Clear();
+    std::string temp = directory.WriteFile("color.hlsl.tmp", "float4 PS() : SV_Target { return 1; }");
+    std::filesystem::rename(temp, watched);
+    std::filesystem::last_write_time(watched, std::filesystem::file_time_type::clock::now() + std::chrono::seconds(4));
+    TEST_CHECK(recorder.WaitFor(watched, std::chrono::seconds(5)));
+
+    recorder.Clear();
+    watcher.UnwatchFile(watched);
+    ModifyFile(directory, "color.hlsl", "unwatched");
+    TEST_CHECK(!recorder.WaitFor(watched, std::chrono::milliseconds(300)));
+}
+
+TEST_CASE(FileWatcherDrivesTheAffectedRootFiles)
+{
+    // the hot reloader's flow: a changed include maps to the roots to recompile
+    TempDirectory directory("ShaderDependencyGraphTests");
+    std::string color = directory.WriteFile("color.hlsl", "#include \"common.hlsl\"\n");
+    std::string common = directory.WriteFile("common.hlsl", "");
+
+    ShaderDependencyGraph graph;
+    ChangeRecorder recorder;
+    FileWatcher watcher([&recorder](const std::string& path) { recorder.OnChange(path); }, std::chrono::milliseconds(20));
+    for(const std::string& file : graph.ScanRootFile(color))
+    {
+        watcher.WatchFile(file);
+    }
+
+    ModifyFile(directory, "common.hlsl", "#define PI 3.14159\n");
+    TEST_CHECK(recorder.WaitFor(common, std::chrono::seconds(5)));
+    std::vector<std::string> affected = graph.GetAffectedRootFiles(common);
+    TEST_CHECK(affected.size() == 1 && Contains(affected, color));
+}
+
+int main()
+{
+    return RunTests();
+}
@@ -0,0 +1,208 @@
+// ShaderReflectionBlobWriter -> Finish -> ShaderReflectionBlobView::Parse round trips, and blobs that
+// Parse has to reject because the shader cache file was truncated or is not a blob at all
+#include <cstring>
+#include "Test.h"
+#include "TempDirectory.h"
+#include "Material/ShaderReflectionBlob.h"
+#include "Utility/MappedFile.h"
+
+// two cbuffers sharing a variable name, a texture, a uav and a sampler
+static std::vector<char> WriteTestBlob()
+{
+    ShaderReflectionBlobWriter writer;
+    writer.AddCbParam("cbPerObject", 0, 0, 80);
+    writer.AddCbVariable("gWorldViewProj", 0, 64, 8, 0, 64);
+    writer.AddCbVariable("gColor", 64, 16, 4, 0, 16);
+    writer.AddParam(ReflectedParamKind::k_srv, "gDiffuseMap", 0, 1, 0);
+    writer.AddCbParam("cbPerFrame", 1, 2, 208);
+    writer.AddCbVariable("gColor", 0, 16, 4, 0, 16);
+    writer.AddCbVariable("gWeights", 16, 52, 1, 4, 16);
+    writer.AddParam(ReflectedParamKind::k_uav, "gOutput", 3, 2, 1);
+    writer.AddParam(ReflectedParamKind::k_sampler, "gsamLinear", 0, 1, 0);
+    return writer.Finish();
+}
+
+static ShaderReflectionBlobHeader* GetHeader(std::vector<char>& blob)
+{
+    return reinterpret_cast<ShaderReflectionBlobHeader*>(blob.data());
+}
+
+static ReflectedParam* GetParams(std::vector<char>& blob)
+{
+    return reinterpret_cast<ReflectedParam*>(blob.data() + sizeof(ShaderReflectionBlobHeader));
+}
+
+static ReflectedCbVariable* GetVariables(std::vector<char>& blob)
+{
+    return reinterpret_cast<ReflectedCbVariable*>(blob.data() + sizeof(ShaderReflectionBlobHeader) + GetHeader(blob)->param_count * sizeof(ReflectedParam));
+}
+
+static void CheckTestBlob(const ShaderReflectionBlobView& view)
+{
+    TEST_CHECK(view.GetParamCount() == 5);
+
+    const ReflectedParam& per_object = view.GetParam(0);
+    TEST_CHECK(strcmp(view.GetString(per_object.name), "cbPerObject") == 0);
+    TEST_CHECK(per_object.kind == ReflectedParamKind::k_cbv);
+    TEST_CHECK(per_object.bind_point == 0 && per_object.bind_count == 1 && per_object.register_space == 0);
+    TEST_CHECK(per_object.cb_size == 80);
+    TEST_CHECK(per_object.first_variable == 0 && per_object.variable_count == 2);
+
+    const ReflectedCbVariable& world_view_proj = view.GetVariable(per_object.first_variable);
+    TEST_CHECK(strcmp(view.GetString(world_view_proj.name), "gWorldViewProj") == 0);
+    TEST_CHECK(world_view_proj.offset == 0 && world_view_proj.size == 64 && world_view_proj.type == 8);
+    TEST_CHECK(world_view_proj.elements == 0 && world_view_proj.element_stride == 64);
+
+    const ReflectedParam& diffuse_map = view.GetParam(1);
+    TEST_CHECK(strcmp(view.GetString(diffuse_map.name), "gDiffuseMap") == 0);
+    TEST_CHECK(diffuse_map.kind == ReflectedParamKind::k_srv);
+    TEST_CHECK(diffuse_map.variable_count == 0);
+
+    const ReflectedParam& per_frame = view.GetParam(2);
+    TEST_CHECK(strcmp(view.GetString(per_frame.name), "cbPerFrame") == 0);
+    TEST_CHECK(per_frame.bind_point == 1 && per_frame.register_space == 2 && per_frame.cb_size == 208);
+    TEST_CHECK(per_frame.first_variable == 2 && per_frame.variable_count == 2);
+
+    const ReflectedCbVariable& weights = view.GetVariable(per_frame.first_variable + 1);
+    TEST_CHECK(strcmp(view.GetString(weights.name), "gWeights") == 0);
+    TEST_CHECK(weights.offset == 16 && weights.size == 52 && weights.type == 1);
+    TEST_CHECK(weights.elements == 4 && weights.element_stride == 16);
+
+    const ReflectedParam& output = view.GetParam(3);
+    TEST_CHECK(strcmp(view.GetString(output.name), "gOutput") == 0);
+    TEST_CHECK(output.kind == ReflectedParamKind::k_uav);
+    TEST_CHECK(output.bind_point == 3 && output.bind_count == 2 && output.register_space == 1);
+
+    TEST_CHECK(view.GetParam(4).kind == ReflectedParamKind::k_sampler);
+}
+
+TEST_CASE(RoundTripKeepsEveryField)
+{
+    std::vector<char> blob = WriteTestBlob();
+    ShaderReflectionBlobView view;
+    TEST_CHECK(view.Parse(blob.data(), blob.size()));
+    CheckTestBlob(view);
+}
+
+TEST_CASE(RoundTripThroughAMappedFile)
+{
+    // the way the shader cache loads a .refl file
+    TempDirectory directory("ShaderReflectionBlobTests");
+    std::vector<char> blob = WriteTestBlob();
+    std::string path = directory.WriteFile("stage.refl", std::string(blob.data(), blob.size()));
+
+    MappedFile file;
+    TEST_CHECK(file.Open(path));
+    ShaderReflectionBlobView view;
+    TEST_CHECK(view.Parse(file.GetData(), file.GetSize()));
+    CheckTestBlob(view);
+}
+
+TEST_CASE(StringsAreInternedOnce)
+{
+    std::vector<char> blob = WriteTestBlob();
+    ShaderReflectionBlobView view;
+    TEST_CHECK(view.Parse(blob.data(), blob.size()));
+
+    // gColor is in both cbuffers
+    TEST_CHECK(view.GetVariable(1).name == view.GetVariable(2).name);
+    const char* names[] = { "cbPerObject", "gWorldViewProj", "gColor", "gDiffuseMap", "cbPerFrame", "gWeights", "gOutput", "gsamLinear" };
+    size_t string_table_size = 0;
+    for(const char* name : names)
+    {
+        string_table_size += strlen(name) + 1;
+    }
+    TEST_CHECK(GetHeader(blob)->string_table_size == string_table_size);
+}
+
+TEST_CASE(EmptyBlobRoundTrips)
+{
+    std::vector<char> blob = ShaderReflectionBlobWriter().Finish();
+    TEST_CHECK(blob.size() == sizeof(ShaderReflectionBlobHeader));
+
+    ShaderReflectionBlobView view;
+    TEST_CHECK(view.Parse(blob.data(), blob.size()));
+    TEST_CHECK(view.GetParamCount() == 0);
+}
+
+TEST_CASE(ParseRejectsTruncatedBlobs)
+{
+    std::vector<char> blob = WriteTestBlob();
+    ShaderReflectionBlobView view;
+    TEST_CHECK(!view.Parse(nullptr, blob.size()));
+    for(size_t size=0; size<blob.size(); size++)
+    {
+        if(!TEST_CHECK(!view.Parse(blob.data(), size)))
+        {
+            printf("    truncated to %zu bytes\n", size);
+        }
+    }
+
+    // trailing bytes mean the counts do not describe the file either
+    blob.push_back('\0');
+    TEST_CHECK(!view.Parse(blob.data(), blob.size()));
+}
+
+TEST_CASE(ParseRejectsForeignBlobs)
+{
+    ShaderReflectionBlobView view;
+
+    std::vector<char> blob = WriteTestBlob();
+    GetHeader(blob)->magic ^= 1;
+    TEST_CHECK(!view.Parse(blob.data(), blob.size()));
+
+    blob = WriteTestBlob();
+    GetHeader(blob)->version = ShaderReflectionBlobHeader::k_version + 1;
+    TEST_CHECK(!view.Parse(blob.data(), blob.size()));
+
+    // e.g. a bytecode file read as reflection
+    std::vector<char> garbage(256, 'x');
+    TEST_CHECK(!view.Parse(garbage.data(), garbage.size()));
+}
+
+TEST_CASE(ParseRejectsCorruptBlobs)
+{
+    ShaderReflectionBlobView view;
+
+    std::vector<char> blob = WriteTestBlob();
+    GetHeader(blob)->param_count = 0xFFFFFFFF;
+    TEST_CHECK(!view.Parse(blob.data(), blob.size()));
+
+    blob = WriteTestBlob();
+    GetParams(blob)[1].name = GetHeader(blob)->string_table_size;
+    TEST_CHECK(!view.Parse(blob.data(), blob.size()));
+
+    blob = WriteTestBlob();
+    GetParams(blob)[1].kind = (ReflectedParamKind)7;
+    TEST_CHECK(!view.Parse(blob.data(), blob.size()));
+
+    blob = WriteTestBlob();
+    GetParams(blob)[2].variable_count = 3;
+    TEST_CHECK(!view.Parse(blob.data(), blob.size()));
+
+    blob = WriteTestBlob();
+    GetParams(blob)[0].first_variable = 0xFFFFFFFF;
+    TEST_CHECK(!view.Parse(blob.data(), blob.size()));
+
+    blob = WriteTestBlob();
+    GetVariables(blob)[3].name = 0x7FFFFFFF;
+    TEST_CHECK(!view.Parse(blob.data(), blob.size()));
+
+    // GetString hands out c strings, the table has to end with a terminator
+    blob = WriteTestBlob();
+    blob.back() = 'x';
+    TEST_CHECK(!view.Parse(blob.data(), blob.size()));
+}
+
+TEST_CASE(FailedParseKeepsThePreviousBlob)
+{
+    std::vector<char> blob = WriteTestBlob();
+    ShaderReflectionBlobView view;
+    TEST_CHECK(view.Parse(blob.data(), blob.size()));
+
+    std::vector<char> truncated(blob.begin(), blob.end() - 1);
+    TEST_CHECK(!view.Parse(truncated.data(), truncated.size()));
+    CheckTestBlob(view);
+}
+
+int main() { return RunTests(); }
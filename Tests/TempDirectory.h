@@ -0,0 +1,42 @@
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// unique directory under the system temp path, removed with everything in it on destruction
+class TempDirectory
+{
+public:
+    explicit TempDirectory(const std::string& prefix)
+    {
+        auto ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+        m_path = std::filesystem::temp_directory_path() / (prefix + "-" + std::to_string(ticks));
+        std::filesystem::create_directories(m_path);
+    }
+
+    ~TempDirectory()
+    {
+        std::error_code error;
+        std::filesystem::remove_all(m_path, error);
+    }
+
+    TempDirectory(const TempDirectory&) = delete;
+    TempDirectory& operator=(const TempDirectory&) = delete;
+
+    // writes (or overwrites) a file relative to the directory, creating sub directories, returns its path
+    std::string WriteFile(const std::string& relative_path, const std::string& content) const
+    {
+        std::filesystem::path path = m_path / relative_path;
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        stream << content;
+        return path.lexically_normal().string();
+    }
+
+    std::string GetFilePath(const std::string& relative_path) const { return (m_path / relative_path).lexically_normal().string(); }
+    const std::filesystem::path& GetPath() const { return m_path; }
+
+private:
+    std::filesystem::path m_path;
+};
@@ -0,0 +1,75 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// minimal runner for the test targets, each target is one executable run by xmake test
+// TEST_CASE defines and registers a case, failed TEST_CHECKs are printed and the case carries on
+// main returns RunTests(), which is non-zero when any check failed
+
+struct TestCase
+{
+    const char* name;
+    void (*func)();
+};
+
+inline std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> s_cases;
+    return s_cases;
+}
+
+inline int& GetTestFailureCount()
+{
+    static int s_failure_count = 0;
+    return s_failure_count;
+}
+
+struct TestRegistrar
+{
+    TestRegistrar(const char* name, void (*func)()) { GetTestCases().push_back({ name, func }); }
+};
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static TestRegistrar s_test_registrar_##name(#name, name); \
+    static void name()
+
+#define TEST_CHECK(condition) CheckTest((condition), #condition, __FILE__, __LINE__)
+#define TEST_CHECK_NEAR(value, expected, tolerance) CheckTestNear((double)(value), (double)(expected), (double)(tolerance), #value, __FILE__, __LINE__)
+
+inline bool CheckTest(bool b_passed, const char* expression, const char* file, int line)
+{
+    if(!b_passed)
+    {
+        printf("    %s(%d): check failed: %s\n", file, line, expression);
+        GetTestFailureCount()++;
+    }
+    return b_passed;
+}
+
+inline bool CheckTestNear(double value, double expected, double tolerance, const char* expression, const char* file, int line)
+{
+    bool b_passed = std::fabs(value - expected) <= tolerance;
+    if(!b_passed)
+    {
+        printf("    %s(%d): %s is %g, expected %g +- %g\n", file, line, expression, value, expected, tolerance);
+        GetTestFailureCount()++;
+    }
+    return b_passed;
+}
+
+inline int RunTests()
+{
+    int failed_cases = 0;
+    for(const TestCase& test_case : GetTestCases())
+    {
+        int failures_before = GetTestFailureCount();
+        test_case.func();
+        bool b_passed = GetTestFailureCount() == failures_before;
+        failed_cases += b_passed ? 0 : 1;
+        printf("[%s] %s\n", b_passed ? "pass" : "FAIL", test_case.name);
+    }
+    printf("%d of %d test cases passed\n", (int)GetTestCases().size() - failed_cases, (int)GetTestCases().size());
+    return failed_cases == 0 ? 0 : 1;
+}
@@ -0,0 +1,400 @@
+// Transform's quaternion rotation against the Euler matrices it replaced, composition, inverses and the batch kernels
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "Test.h"
+#include "Math/Transform.h"
+#include "Scene/SceneHierarchy.h"
+
+// S * R * T with the rotation from Rotator degrees, GetTransformMatrixLH before the rotation became a quaternion
+static Matrix GetEulerMatrix(const Vector3& location, const Rotator& rotator, const Vector3& scale)
+{
+    return Matrix::CreateScale(scale)
+        * Matrix::CreateFromYawPitchRoll(Math::DegreesToRadians(rotator.Yaw), Math::DegreesToRadians(rotator.Pitch), Math::DegreesToRadians(rotator.Roll))
+        * Matrix::CreateTranslation(location);
+}
+
+// largest difference of the elements, relative to the largest element of each row of expected and at least 1
+static float GetMatrixError(const Matrix& matrix, const Matrix& expected)
+{
+    const float* values = &matrix._11;
+    const float* expected_values = &expected._11;
+    float max_error = 0.0f;
+    for(int row=0; row<4; row++)
+    {
+        float row_scale = 1.0f;
+        for(int column=0; column<4; column++)
+        {
+            row_scale = std::max(row_scale, std::abs(expected_values[row * 4 + column]));
+        }
+        for(int column=0; column<4; column++)
+        {
+            max_error = std::max(max_error, std::abs(values[row * 4 + column] - expected_values[row * 4 + column]) / row_scale);
+        }
+    }
+    return max_error;
+}
+
+static float GetDistance(const Vector3& a, const Vector3& b)
+{
+    return std::sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z));
+}
+
+// row vectors, the point takes the translation and the vector does not
+static Vector3 MultiplyPoint(const Vector3& p, const Matrix& m)
+{
+    return Vector3(p.x * m._11 + p.y * m._21 + p.z * m._31 + m._41, p.x * m._12 + p.y * m._22 + p.z * m._32 + m._42, p.x * m._13 + p.y * m._23 + p.z * m._33 + m._43);
+}
+
+static Vector3 MultiplyVector(const Vector3& v, const Matrix& m)
+{
+    return Vector3(v.x * m._11 + v.y * m._21 + v.z * m._31, v.x * m._12 + v.y * m._22 + v.z * m._32, v.x * m._13 + v.y * m._23 + v.z * m._33);
+}
+
+// fixed seed so every run tests the same transforms
+class RandomTransforms
+{
+public:
+    float Next(float min, float max) { return std::uniform_real_distribution<float>(min, max)(m_random); }
+
+    Rotator NextRotator() { return Rotator(Next(-720.0f, 720.0f), Next(-720.0f, 720.0f), Next(-720.0f, 720.0f)); }
+
+    Transform Next(bool b_uniform_scale)
+    {
+        Transform transform;
+        transform.Location = Vector3(Next(-100.0f, 100.0f), Next(-100.0f, 100.0f), Next(-100.0f, 100.0f));
+        transform.SetRotator(NextRotator());
+        float scale = Next(0.1f, 10.0f);
+        transform.Scale = b_uniform_scale ? Vector3(scale, scale, scale) : Vector3(scale, Next(0.1f, 10.0f), Next(0.1f, 10.0f));
+        return transform;
+    }
+
+    Quaternion NextRotation()
+    {
+        Quaternion q(Next(-1.0f, 1.0f), Next(-1.0f, 1.0f), Next(-1.0f, 1.0f), Next(-1.0f, 1.0f));
+        q.Normalize();
+        return q;
+    }
+
+private:
+    std::mt19937 m_random{ 1234 };
+};
+
+TEST_CASE(QuaternionMatrixMatchesEulerMatrix)
+{
+    // every axis over +-720 degrees in steps of 30, so +-90 and +-270 pitch (gimbal lock) are in
+    float max_error = 0.0f;
+    for(float roll=-720.0f; roll<=720.0f; roll+=30.0f)
+    {
+        for(float pitch=-720.0f; pitch<=720.0f; pitch+=30.0f)
+        {
+            for(float yaw=-720.0f; yaw<=720.0f; yaw+=30.0f)
+            {
+                Rotator rotator(roll, pitch, yaw);
+                Transform transform;
+                transform.SetRotator(rotator);
+                max_error = std::max(max_error, GetMatrixError(transform.GetTransformMatrixLH(), GetEulerMatrix(Vector3::Zero, rotator, Vector3::One)));
+            }
+        }
+    }
+    TEST_CHECK(max_error < 2e-6f);
+
+    // with locations and non uniform scales, off the 30 degree grid
+    RandomTransforms random;
+    max_error = 0.0f;
+    for(int i=0; i<1000; i++)
+    {
+        Rotator rotator = random.NextRotator();
+        Transform transform(Vector3(random.Next(-100.0f, 100.0f), random.Next(-100.0f, 100.0f), random.Next(-100.0f, 100.0f)),
+            Transform::RotatorToQuaternion(rotator), Vector3(random.Next(0.1f, 10.0f), random.Next(0.1f, 10.0f), random.Next(0.1f, 10.0f)));
+        max_error = std::max(max_error, GetMatrixError(transform.GetTransformMatrixLH(), GetEulerMatrix(transform.Location, rotator, transform.Scale)));
+    }
+    TEST_CHECK(max_error < 2e-6f);
+}
+
+TEST_CASE(RotatorRoundTripKeepsTheRotation)
+{
+    // the angles may come back different, pitch folded into [-90, 90] and the roll into the yaw at gimbal lock,
+    // the rotation they describe has to stay the same
+    float max_error = 0.0f;
+    bool b_pitch_in_range = true;
+    for(float roll=-720.0f; roll<=720.0f; roll+=30.0f)
+    {
+        for(float pitch=-720.0f; pitch<=720.0f; pitch+=15.0f)
+        {
+            for(float yaw=-720.0f; yaw<=720.0f; yaw+=30.0f)
+            {
+                Rotator rotator(roll, pitch, yaw);
+                Rotator round_trip = Transform::QuaternionToRotator(Transform::RotatorToQuaternion(rotator));
+                b_pitch_in_range &= round_trip.Pitch >= -90.0f && round_trip.Pitch <= 90.0f;
+                max_error = std::max(max_error, GetMatrixError(GetEulerMatrix(Vector3::Zero, round_trip, Vector3::One), GetEulerMatrix(Vector3::Zero, rotator, Vector3::One)));
+            }
+        }
+    }
+    TEST_CHECK(b_pitch_in_range);
+    TEST_CHECK(max_error < 1e-5f);
+}
+
+TEST_CASE(CompositionMatchesMatrixProductUnderUniformParentScale)
+{
+    // children may scale non uniformly, parents scale uniformly, three levels
+    RandomTransforms random;
+    float max_error = 0.0f;
+    for(int i=0; i<1000; i++)
+    {
+        Transform child = random.Next(false);
+        Transform parent = random.Next(true);
+        Transform grandparent = random.Next(true);
+        Transform world = child * parent * grandparent;
+        Matrix expected = child.GetTransformMatrixLH() * parent.GetTransformMatrixLH() * grandparent.GetTransformMatrixLH();
+        max_error = std::max(max_error, GetMatrixError(world.GetTransformMatrixLH(), expected));
+    }
+    TEST_CHECK(max_error < 1e-5f);
+}
+
+TEST_CASE(NonUniformParentScaleDropsTheShear)
+{
+    Transform parent(Vector3(1.0f, 2.0f, 3.0f), Transform::RotatorToQuaternion(Rotator(10.0f, 20.0f, 30.0f)), Vector3(1.0f, 3.0f, 0.5f));
+    Transform child(Vector3(2.0f, -1.0f, 4.0f), Transform::RotatorToQuaternion(Rotator(45.0f, 0.0f, 60.0f)), Vector3(2.0f, 2.0f, 2.0f));
+    Transform world = child * parent;
+    Matrix world_matrix = world.GetTransformMatrixLH();
+    Matrix product = child.GetTransformMatrixLH() * parent.GetTransformMatrixLH();
+
+    // the child's origin is placed by the full parent matrix and the scales multiply per axis
+    TEST_CHECK(GetDistance(world.Location, MultiplyPoint(child.Location, parent.GetTransformMatrixLH())) < 1e-5f);
+    TEST_CHECK(GetDistance(world.Location, Vector3(product._41, product._42, product._43)) < 1e-5f);
+    TEST_CHECK(GetDistance(world.Scale, Vector3(2.0f, 6.0f, 1.0f)) < 1e-6f);
+
+    // the axes stay orthogonal with those lengths, where the matrix product shears them
+    Vector3 axes[3] = { Vector3(world_matrix._11, world_matrix._12, world_matrix._13),
+        Vector3(world_matrix._21, world_matrix._22, world_matrix._23), Vector3(world_matrix._31, world_matrix._32, world_matrix._33) };
+    Vector3 product_axes[3] = { Vector3(product._11, product._12, product._13),
+        Vector3(product._21, product._22, product._23), Vector3(product._31, product._32, product._33) };
+    const float scales[3] = { world.Scale.x, world.Scale.y, world.Scale.z };
+    float max_dot = 0.0f;
+    float max_product_dot = 0.0f;
+    for(int a=0; a<3; a++)
+    {
+        TEST_CHECK_NEAR(GetDistance(axes[a], Vector3::Zero), scales[a], 1e-5f);
+        for(int b=a + 1; b<3; b++)
+        {
+            max_dot = std::max(max_dot, std::abs(axes[a].x * axes[b].x + axes[a].y * axes[b].y + axes[a].z * axes[b].z));
+            max_product_dot = std::max(max_product_dot, std::abs(product_axes[a].x * product_axes[b].x + product_axes[a].y * product_axes[b].y + product_axes[a].z * product_axes[b].z));
+        }
+    }
+    TEST_CHECK(max_dot < 1e-5f);
+    TEST_CHECK(max_product_dot > 0.1f);
+
+    // a child not rotated against its parent has no shear to drop, both agree even with non uniform scales
+    Transform unrotated_child(Vector3(2.0f, -1.0f, 4.0f), Quaternion::Identity, Vector3(1.0f, 2.0f, 3.0f));
+    TEST_CHECK(GetMatrixError((unrotated_child * parent).GetTransformMatrixLH(), unrotated_child.GetTransformMatrixLH() * parent.GetTransformMatrixLH()) < 1e-5f);
+
+    // SceneHierarchy composes the same way
+    SceneHierarchy hierarchy;
+    SceneNodeID parent_node = hierarchy.CreateNode();
+    SceneNodeID child_node = hierarchy.CreateNode(parent_node);
+    hierarchy.SetLocalTransform(parent_node, parent);
+    hierarchy.SetLocalTransform(child_node, child);
+    hierarchy.UpdateWorldMatrices();
+    TEST_CHECK(GetMatrixError(hierarchy.GetWorldMatrix(child_node), world_matrix) < 1e-5f);
+    TEST_CHECK(GetDistance(hierarchy.GetWorldTransform(child_node).Location, world.Location) < 1e-5f);
+}
+
+TEST_CASE(InverseRoundTrips)
+{
+    // errors are relative to the largest value on the way, locations of 100 under a scale of 0.1 pass through 1000
+    RandomTransforms random;
+    float max_matrix_error = 0.0f;
+    float max_position_error = 0.0f;
+    float max_identity_error = 0.0f;
+    for(int i=0; i<1000; i++)
+    {
+        // uniform scale, where Inverse is exact
+        Transform transform = random.Next(true);
+        Transform inverse = transform.Inverse();
+        float magnitude = std::max(1.0f, GetDistance(transform.Location, Vector3::Zero) / std::min(transform.Scale.x, 1.0f));
+        max_matrix_error = std::max(max_matrix_error, GetMatrixError(inverse.GetTransformMatrixLH(), transform.GetTransformMatrixLH().Invert()));
+        max_identity_error = std::max(max_identity_error, GetMatrixError((transform * inverse).GetTransformMatrixLH(), Matrix::Identity) / magnitude);
+        max_identity_error = std::max(max_identity_error, GetMatrixError((inverse * transform).GetTransformMatrixLH(), Matrix::Identity) / magnitude);
+
+        Vector3 position(random.Next(-100.0f, 100.0f), random.Next(-100.0f, 100.0f), random.Next(-100.0f, 100.0f));
+        Vector3 transformed = transform.TransformPosition(position);
+        magnitude = (GetDistance(transformed, Vector3::Zero) + GetDistance(transform.Location, Vector3::Zero)) / transform.Scale.x;
+        max_position_error = std::max(max_position_error, GetDistance(inverse.TransformPosition(transformed), position) / magnitude);
+
+        // the inverse transforms undo non uniform scales too
+        Transform non_uniform = random.Next(false);
+        float min_scale = std::min({ non_uniform.Scale.x, non_uniform.Scale.y, non_uniform.Scale.z });
+        transformed = non_uniform.TransformPosition(position);
+        magnitude = (GetDistance(transformed, Vector3::Zero) + GetDistance(non_uniform.Location, Vector3::Zero)) / min_scale;
+        max_position_error = std::max(max_position_error, GetDistance(non_uniform.InverseTransformPosition(transformed), position) / magnitude);
+        transformed = non_uniform.TransformVector(position);
+        magnitude = GetDistance(transformed, Vector3::Zero) / min_scale;
+        max_position_error = std::max(max_position_error, GetDistance(non_uniform.InverseTransformVector(transformed), position) / magnitude);
+    }
+    TEST_CHECK(max_matrix_error < 1e-5f);
+    TEST_CHECK(max_identity_error < 5e-6f);
+    TEST_CHECK(max_position_error < 5e-6f);
+}
+
+TEST_CASE(TransformPositionAndVectorMatchTheMatrix)
+{
+    RandomTransforms random;
+    float max_error = 0.0f;
+    for(int i=0; i<1000; i++)
+    {
+        Transform transform = random.Next(false);
+        Matrix matrix = transform.GetTransformMatrixLH();
+        Vector3 v(random.Next(-10.0f, 10.0f), random.Next(-10.0f, 10.0f), random.Next(-10.0f, 10.0f));
+        // relative to the size of the result
+        max_error = std::max(max_error, GetDistance(transform.TransformPosition(v), MultiplyPoint(v, matrix)) / 1000.0f);
+        max_error = std::max(max_error, GetDistance(transform.TransformVector(v), MultiplyVector(v, matrix)) / 1000.0f);
+        max_error = std::max(max_error, GetDistance(Transform::RotateVector(transform.Rotation, v), MultiplyVector(v, Transform(Vector3::Zero, transform.Rotation, Vector3::One).GetTransformMatrixLH())) / 10.0f);
+    }
+    TEST_CHECK(max_error < 1e-6f);
+}
+
+TEST_CASE(BatchesMatchTheirPerObjectVersions)
+{
+    // counts around the 8 and 4 wide steps, so the avx2 / sse2 bodies and the scalar tails all run
+    RandomTransforms random;
+    for(uint32_t count : { 1u, 3u, 4u, 5u, 7u, 8u, 9u, 12u, 15u, 16u, 17u, 37u })
+    {
+        std::vector<float> soa[10];
+        std::vector<Transform> transforms;
+        std::vector<float> degrees[3];
+        std::vector<Rotator> rotators;
+        for(uint32_t i=0; i<count; i++)
+        {
+            Transform transform = random.Next(false);
+            const float values[10] = { transform.Location.x, transform.Location.y, transform.Location.z,
+                transform.Rotation.x, transform.Rotation.y, transform.Rotation.z, transform.Rotation.w,
+                transform.Scale.x, transform.Scale.y, transform.Scale.z };
+            for(int j=0; j<10; j++)
+            {
+                soa[j].push_back(values[j]);
+            }
+            transforms.push_back(transform);
+
+            Rotator rotator = random.NextRotator();
+            degrees[0].push_back(rotator.Roll);
+            degrees[1].push_back(rotator.Pitch);
+            degrees[2].push_back(rotator.Yaw);
+            rotators.push_back(rotator);
+        }
+
+        TransformArrays arrays;
+        arrays.location_x = soa[0].data();
+        arrays.location_y = soa[1].data();
+        arrays.location_z = soa[2].data();
+        arrays.rotation_x = soa[3].data();
+        arrays.rotation_y = soa[4].data();
+        arrays.rotation_z = soa[5].data();
+        arrays.rotation_w = soa[6].data();
+        arrays.scale_x = soa[7].data();
+        arrays.scale_y = soa[8].data();
+        arrays.scale_z = soa[9].data();
+        std::vector<Matrix> matrices(count);
+        Transform::GetTransformMatricesLH(arrays, count, matrices.data());
+        std::vector<Quaternion> rotations(count);
+        Transform::RotatorsToQuaternions(degrees[0].data(), degrees[1].data(), degrees[2].data(), count, rotations.data());
+
+        float max_matrix_error = 0.0f;
+        float max_rotation_error = 0.0f;
+        for(uint32_t i=0; i<count; i++)
+        {
+            max_matrix_error = std::max(max_matrix_error, GetMatrixError(matrices[i], transforms[i].GetTransformMatrixLH()));
+            Quaternion expected = Transform::RotatorToQuaternion(rotators[i]);
+            max_rotation_error = std::max({ max_rotation_error, std::abs(rotations[i].x - expected.x), std::abs(rotations[i].y - expected.y),
+                std::abs(rotations[i].z - expected.z), std::abs(rotations[i].w - expected.w) });
+        }
+        TEST_CHECK(max_matrix_error < 1e-6f);
+        TEST_CHECK(max_rotation_error < 1e-6f);
+    }
+}
+
+TEST_CASE(InterpolationMatchesExactSlerp)
+{
+    RandomTransforms random;
+    float max_slerp_error = 0.0f;
+    float max_nlerp_error = 0.0f;
+    for(uint32_t count : { 1u, 2u, 3u, 4u, 5u, 7u, 8u, 9u, 103u })
+    {
+        std::vector<Quaternion> from(count), to(count), slerps(count), nlerps(count);
+        std::vector<float> t(count);
+        for(uint32_t i=0; i<count; i++)
+        {
+            from[i] = random.NextRotation();
+            // near and far pairs, both hemispheres, and the end points
+            to[i] = i % 5 == 0 ? Quaternion(-from[i].x, -from[i].y, -from[i].z + 1e-3f, -from[i].w) : random.NextRotation();
+            to[i].Normalize();
+            t[i] = i % 7 == 0 ? 0.0f : i % 7 == 1 ? 1.0f : random.Next(0.0f, 1.0f);
+        }
+        Transform::SlerpRotations(from.data(), to.data(), t.data(), count, slerps.data());
+        Transform::NlerpRotations(from.data(), to.data(), t.data(), count, nlerps.data());
+
+        for(uint32_t i=0; i<count; i++)
+        {
+            // in double, the shortest path
+            const double a[4] = { from[i].x, from[i].y, from[i].z, from[i].w };
+            double b[4] = { to[i].x, to[i].y, to[i].z, to[i].w };
+            double dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+            if(dot < 0.0)
+            {
+                dot = -dot;
+                for(double& value : b)
+                {
+                    value = -value;
+                }
+            }
+            double angle = std::acos(std::min(dot, 1.0));
+            double from_weight = angle < 1e-9 ? 1.0 - t[i] : std::sin((1.0 - t[i]) * angle) / std::sin(angle);
+            double to_weight = angle < 1e-9 ? t[i] : std::sin(t[i] * angle) / std::sin(angle);
+            double lerp[4];
+            double lerp_length = 0.0;
+            for(int c=0; c<4; c++)
+            {
+                lerp[c] = a[c] * (1.0 - t[i]) + b[c] * t[i];
+                lerp_length += lerp[c] * lerp[c];
+            }
+            lerp_length = std::sqrt(lerp_length);
+
+            const float* slerp = &slerps[i].x;
+            const float* nlerp = &nlerps[i].x;
+            for(int c=0; c<4; c++)
+            {
+                max_slerp_error = std::max(max_slerp_error, (float)std::abs(slerp[c] - (a[c] * from_weight + b[c] * to_weight)));
+                max_nlerp_error = std::max(max_nlerp_error, (float)std::abs(nlerp[c] - lerp[c] / lerp_length));
+            }
+        }
+    }
+    TEST_CHECK(max_slerp_error < 1e-6f);
+    TEST_CHECK(max_nlerp_error < 1e-6f);
+}
+
+TEST_CASE(DeepChainsKeepUnitRotations)
+{
+    // every level turns a little, the world rotations are products of thousands of quaternions
+    const uint32_t depth = 5000;
+    SceneHierarchy hierarchy;
+    SceneNodeID node = k_invalid_scene_node;
+    Transform local(Vector3(0.0f, 0.0f, 0.01f), Transform::RotatorToQuaternion(Rotator(0.7f, 1.3f, 2.1f)), Vector3::One);
+    for(uint32_t i=0; i<depth; i++)
+    {
+        node = hierarchy.CreateNode(node);
+        hierarchy.SetLocalTransform(node, local);
+    }
+    hierarchy.UpdateWorldMatrices();
+
+    TEST_CHECK_NEAR(hierarchy.GetWorldTransform(node).Rotation.Length(), 1.0f, 1e-6f);
+    const Matrix& world = hierarchy.GetWorldMatrix(node);
+    TEST_CHECK_NEAR(GetDistance(Vector3(world._11, world._12, world._13), Vector3::Zero), 1.0f, 1e-5f);
+    TEST_CHECK_NEAR(GetDistance(Vector3(world._21, world._22, world._23), Vector3::Zero), 1.0f, 1e-5f);
+    TEST_CHECK_NEAR(GetDistance(Vector3(world._31, world._32, world._33), Vector3::Zero), 1.0f, 1e-5f);
+}
+
+int main()
+{
+    return RunTests();
+}
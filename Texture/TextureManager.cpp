@@ -1,10 +1,10 @@
 #include "TextureManager.h"
 
-Texture *TextureManager::GetTexture(const std::string &name)
+Texture *TextureManager::GetTexture(NameID name)
 {
-    Texture* ret = m_textures[name].get();
-    assert(ret);
-    return ret;
+    std::unique_ptr<Texture>* texture = m_textures.Find(name);
+    assert(texture);
+    return texture->get();
 }
 
 void TextureManager::LoadTextureFromFile(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList)
@@ -18,7 +18,7 @@ void TextureManager::LoadTextureFromFile(ID3D12Device* device, ID3D12GraphicsCom
 		cmdList, filepath.c_str(),
 		woodCrateTex->Resource, m_upload_buffers[0]));
 
-    m_textures[name] = std::move(woodCrateTex);
+    m_textures.Insert(NameID::Register(name), std::move(woodCrateTex));
 }
 
 void TextureManager::ReleaseUploadBuffer()
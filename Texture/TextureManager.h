@@ -1,5 +1,4 @@
 #pragma once
-#include <unordered_map>
 #include <string>
 #include <windows.h>
 #include <wrl.h>
@@ -7,6 +6,8 @@
 #include <memory>
 #include "Texture.h"
 #include <vector>
+#include "Utility/NameID.h"
+#include "Utility/FlatHashMap.h"
 
 class TextureManager
 {
@@ -14,13 +15,13 @@ public:
     TextureManager() = default;
     ~TextureManager() = default;
 
-    Texture* GetTexture(const std::string& name);
+    Texture* GetTexture(NameID name);
     void LoadTextureFromFile(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList); // called when init
     void ReleaseUploadBuffer(); // called between init and runtime
 
 
 private:
-    std::unordered_map<std::string, std::unique_ptr<Texture>> m_textures;
+    FlatHashMap<NameID, std::unique_ptr<Texture>> m_textures;
     std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> m_upload_buffers;
     
 };
\ No newline at end of file
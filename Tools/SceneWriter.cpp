@@ -0,0 +1,73 @@
+// writes a generated scene file for BoxApp::LoadScene, then maps it back and reports the load time
+// usage: SceneWriter <path> [object count]
+// objects are groups of one root and k_group_size - 1 children on a square grid, alternating box and sphere meshes
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "Scene/SceneFile.h"
+
+static const uint32_t k_group_size = 8;
+static const float k_spacing = 4.0f;
+
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        printf("usage: SceneWriter <path> [object count]\n");
+        return 1;
+    }
+    std::string path = argv[1];
+    uint32_t object_count = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : 1000;
+
+    auto write_begin = std::chrono::steady_clock::now();
+    SceneFileWriter writer;
+    uint32_t group_count = (object_count + k_group_size - 1) / k_group_size;
+    uint32_t grid_size = (uint32_t)std::ceil(std::sqrt((float)group_count));
+    uint32_t root = SceneFileView::k_no_parent;
+    for(uint32_t i=0; i<object_count; i++)
+    {
+        Transform transform;
+        uint32_t parent = SceneFileView::k_no_parent;
+        uint32_t group_object = i % k_group_size;
+        if(group_object == 0)
+        {
+            uint32_t group = i / k_group_size;
+            transform.Location = Vector3((group % grid_size) * k_spacing * 2.0f, -8.0f, 40.0f + (group / grid_size) * k_spacing * 2.0f);
+        }
+        else
+        {
+            // children ring around their root
+            float angle = group_object * 6.2831853f / (k_group_size - 1);
+            transform.Location = Vector3(std::cos(angle) * k_spacing, 2.0f, std::sin(angle) * k_spacing);
+            transform.Scale = Vector3(0.5f, 0.5f, 0.5f);
+            parent = root;
+        }
+
+        uint32_t object = writer.AddObject("object_" + std::to_string(i), parent, transform, (i % 2) ? "sphere" : "box", "default");
+        if(group_object == 0)
+        {
+            root = object;
+        }
+    }
+    if(!writer.Write(path))
+    {
+        printf("cannot write %s\n", path.c_str());
+        return 1;
+    }
+    auto write_end = std::chrono::steady_clock::now();
+
+    SceneFile scene_file;
+    if(!scene_file.Open(path))
+    {
+        printf("cannot load %s back\n", path.c_str());
+        return 1;
+    }
+    auto load_end = std::chrono::steady_clock::now();
+
+    printf("%u objects, written in %.1f ms, mapped and validated in %.1f ms\n", scene_file.GetView().GetObjectCount(),
+        std::chrono::duration<double, std::milli>(write_end - write_begin).count(),
+        std::chrono::duration<double, std::milli>(load_end - write_end).count());
+    return 0;
+}
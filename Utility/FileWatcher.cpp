@@ -0,0 +1,188 @@
+#include "FileWatcher.h"
+#include <vector>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+FileWatcher::FileWatcher(ChangeCallback callback, std::chrono::milliseconds poll_interval):
+    m_callback(std::move(callback)),
+    m_poll_interval(poll_interval)
+{
+#if defined(__linux__)
+    m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    m_thread = std::thread(&FileWatcher::ThreadLoop, this);
+}
+
+FileWatcher::~FileWatcher()
+{
+    m_stop = true;
+    m_thread.join();
+
+#if defined(__linux__)
+    if(m_inotify_fd >= 0)
+    {
+        close(m_inotify_fd);
+    }
+#endif
+}
+
+std::string FileWatcher::NormalizePath(const std::string& path)
+{
+    std::error_code error;
+    std::filesystem::path absolute_path = std::filesystem::absolute(path, error);
+    if(error)
+    {
+        return std::filesystem::path(path).lexically_normal().string();
+    }
+    return absolute_path.lexically_normal().string();
+}
+
+void FileWatcher::WatchFile(const std::string& path)
+{
+    std::string normalized_path = NormalizePath(path);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_files.find(normalized_path) != m_files.end())
+    {
+        return;
+    }
+
+    std::error_code error;
+    auto write_time = std::filesystem::last_write_time(normalized_path, error);
+    m_files[normalized_path] = error ? std::filesystem::file_time_type::min() : write_time;
+
+#if defined(__linux__)
+    AddDirectoryWatch(std::filesystem::path(normalized_path).parent_path());
+#endif
+}
+
+void FileWatcher::UnwatchFile(const std::string& path)
+{
+    // directory watches are kept, events for files no longer in m_files are ignored
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files.erase(NormalizePath(path));
+}
+
+void FileWatcher::ThreadLoop()
+{
+    while(!m_stop)
+    {
+#if defined(__linux__)
+        if(m_inotify_fd >= 0)
+        {
+            // wake up at least once per interval to check m_stop
+            pollfd poll_fd = { m_inotify_fd, POLLIN, 0 };
+            int ready = poll(&poll_fd, 1, (int)m_poll_interval.count());
+            if(ready > 0 && (poll_fd.revents & POLLIN))
+            {
+                ReadInotifyEvents();
+            }
+            continue;
+        }
+#endif
+        // fallback when no change notification api is available
+        std::this_thread::sleep_for(m_poll_interval);
+        PollWriteTimes();
+    }
+}
+
+void FileWatcher::PollWriteTimes()
+{
+    std::vector<std::string> changed_files;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(auto& pair : m_files)
+        {
+            std::error_code error;
+            auto write_time = std::filesystem::last_write_time(pair.first, error);
+            if(!error && write_time != pair.second)
+            {
+                pair.second = write_time;
+                changed_files.push_back(pair.first);
+            }
+        }
+    }
+
+    // invoke outside the lock so the callback may watch new files
+    for(const std::string& path : changed_files)
+    {
+        m_callback(path);
+    }
+}
+
+#if defined(__linux__)
+void FileWatcher::AddDirectoryWatch(const std::filesystem::path& directory)
+{
+    if(m_inotify_fd < 0)
+    {
+        return;
+    }
+
+    for(const auto& pair : m_watched_directories)
+    {
+        if(pair.second == directory.string())
+        {
+            return;
+        }
+    }
+
+    // watch the directory rather than the file, editors often save by renaming a temp file over it
+    int watch_descriptor = inotify_add_watch(m_inotify_fd, directory.string().c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if(watch_descriptor >= 0)
+    {
+        m_watched_directories[watch_descriptor] = directory.string();
+    }
+}
+
+void FileWatcher::ReadInotifyEvents()
+{
+    alignas(inotify_event) char buffer[4096];
+    std::vector<std::string> changed_files;
+
+    while(true)
+    {
+        ssize_t length = read(m_inotify_fd, buffer, sizeof(buffer));
+        if(length <= 0)
+        {
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(char* ptr = buffer; ptr < buffer + length; )
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            auto directory = m_watched_directories.find(event->wd);
+            if(event->len == 0 || directory == m_watched_directories.end())
+            {
+                continue;
+            }
+
+            std::string path = (std::filesystem::path(directory->second) / event->name).lexically_normal().string();
+            auto file = m_files.find(path);
+            if(file == m_files.end())
+            {
+                continue;
+            }
+
+            std::error_code error;
+            auto write_time = std::filesystem::last_write_time(path, error);
+            if(!error)
+            {
+                file->second = write_time;
+            }
+            changed_files.push_back(path);
+        }
+    }
+
+    for(const std::string& path : changed_files)
+    {
+        m_callback(path);
+    }
+}
+#endif
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// watches a set of files on a background thread and reports writes through a callback
+// linux uses inotify on the parent directories, other platforms poll the write time
+// the callback is invoked on the watcher thread
+class FileWatcher
+{
+public:
+    typedef std::function<void(const std::string& path)> ChangeCallback;
+
+    FileWatcher() = delete;
+    FileWatcher(ChangeCallback callback, std::chrono::milliseconds poll_interval = std::chrono::milliseconds(250));
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // path is normalized with NormalizePath, watching the same file twice is a no-op
+    void WatchFile(const std::string& path);
+    void UnwatchFile(const std::string& path);
+
+    // absolute, lexically normal path, used as key by the watcher and its users
+    static std::string NormalizePath(const std::string& path);
+
+private:
+    void ThreadLoop();
+    void PollWriteTimes();
+#if defined(__linux__)
+    void AddDirectoryWatch(const std::filesystem::path& directory);
+    void ReadInotifyEvents();
+#endif
+
+private:
+    ChangeCallback m_callback;
+    std::chrono::milliseconds m_poll_interval;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::filesystem::file_time_type> m_files; // path -> last seen write time
+
+#if defined(__linux__)
+    int m_inotify_fd = -1;
+    std::unordered_map<int, std::string> m_watched_directories; // watch descriptor -> directory
+#endif
+
+    std::atomic<bool> m_stop{ false };
+    std::thread m_thread;
+};
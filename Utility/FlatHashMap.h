@@ -0,0 +1,206 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// open addressing hash map with linear probing, keys and values in flat arrays
+// the capacity is a power of two kept under 3/4 full, the slot is the top bits of hash * 2^64/phi
+// so keys whose hash is weak in the low bits still spread, erasing shifts the following entries back
+// instead of leaving tombstones
+// values move when the map grows or an entry is erased, keep pointers to stable storage instead of taking their address
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class FlatHashMap
+{
+public:
+    FlatHashMap() = default;
+    ~FlatHashMap() = default;
+
+    // nullptr if the key is missing
+    Value* Find(const Key& key)
+    {
+        uint32_t slot = FindSlot(key);
+        return slot == k_not_found ? nullptr : &m_values[slot];
+    }
+
+    const Value* Find(const Key& key) const
+    {
+        uint32_t slot = FindSlot(key);
+        return slot == k_not_found ? nullptr : &m_values[slot];
+    }
+
+    bool Contains(const Key& key) const { return FindSlot(key) != k_not_found; }
+
+    // overwrites the value of an existing key
+    Value& Insert(const Key& key, Value value)
+    {
+        Value& stored = FindOrAdd(key);
+        stored = std::move(value);
+        return stored;
+    }
+
+    // a missing key is added with a default constructed value
+    Value& FindOrAdd(const Key& key)
+    {
+        if((m_count + 1) * 4 > GetCapacity() * 3)
+        {
+            Rehash(GetCapacity() == 0 ? k_min_capacity : GetCapacity() * 2);
+        }
+
+        uint32_t mask = GetCapacity() - 1;
+        for(uint32_t slot = GetIdealSlot(key); ; slot = (slot + 1) & mask)
+        {
+            if(!m_occupied[slot])
+            {
+                m_occupied[slot] = 1;
+                m_keys[slot] = key;
+                m_values[slot] = Value();
+                m_count++;
+                return m_values[slot];
+            }
+            if(m_keys[slot] == key)
+            {
+                return m_values[slot];
+            }
+        }
+    }
+
+    // returns false if the key was missing
+    bool Erase(const Key& key)
+    {
+        uint32_t slot = FindSlot(key);
+        if(slot == k_not_found)
+        {
+            return false;
+        }
+
+        // move back every following entry of the run that may go in the hole
+        uint32_t mask = GetCapacity() - 1;
+        uint32_t hole = slot;
+        for(uint32_t next = (hole + 1) & mask; m_occupied[next]; next = (next + 1) & mask)
+        {
+            uint32_t ideal = GetIdealSlot(m_keys[next]);
+            // ideal is cyclically outside (hole, next], so the entry is still reachable from it at the hole
+            if(((next - ideal) & mask) >= ((next - hole) & mask))
+            {
+                m_keys[hole] = std::move(m_keys[next]);
+                m_values[hole] = std::move(m_values[next]);
+                hole = next;
+            }
+        }
+        m_occupied[hole] = 0;
+        m_values[hole] = Value();
+        m_count--;
+        return true;
+    }
+
+    void Clear()
+    {
+        m_keys.clear();
+        m_values.clear();
+        m_occupied.clear();
+        m_count = 0;
+        m_shift = 64;
+    }
+
+    void Reserve(uint32_t count)
+    {
+        uint32_t capacity = k_min_capacity;
+        while(count * 4 > capacity * 3)
+        {
+            capacity *= 2;
+        }
+        if(capacity > GetCapacity())
+        {
+            Rehash(capacity);
+        }
+    }
+
+    uint32_t GetCount() const { return m_count; }
+    bool IsEmpty() const { return m_count == 0; }
+
+    // func(const Key&, Value&) for each entry, in no particular order
+    template<typename Func>
+    void ForEach(Func func)
+    {
+        for(uint32_t slot=0; slot<GetCapacity(); slot++)
+        {
+            if(m_occupied[slot])
+            {
+                func(static_cast<const Key&>(m_keys[slot]), m_values[slot]);
+            }
+        }
+    }
+
+private:
+    static const uint32_t k_not_found = 0xffffffff;
+    static const uint32_t k_min_capacity = 16;
+
+    uint32_t GetCapacity() const { return (uint32_t)m_occupied.size(); }
+
+    uint32_t GetIdealSlot(const Key& key) const
+    {
+        return (uint32_t)(((uint64_t)Hash()(key) * 0x9e3779b97f4a7c15ull) >> m_shift);
+    }
+
+    uint32_t FindSlot(const Key& key) const
+    {
+        if(m_count == 0)
+        {
+            return k_not_found;
+        }
+
+        uint32_t mask = GetCapacity() - 1;
+        for(uint32_t slot = GetIdealSlot(key); m_occupied[slot]; slot = (slot + 1) & mask)
+        {
+            if(m_keys[slot] == key)
+            {
+                return slot;
+            }
+        }
+        return k_not_found;
+    }
+
+    void Rehash(uint32_t capacity)
+    {
+        assert((capacity & (capacity - 1)) == 0);
+
+        std::vector<Key> keys(capacity);
+        std::vector<Value> values(capacity);
+        std::vector<uint8_t> occupied(capacity, 0);
+        keys.swap(m_keys);
+        values.swap(m_values);
+        occupied.swap(m_occupied);
+
+        m_shift = 64;
+        for(uint32_t size = capacity; size > 1; size >>= 1)
+        {
+            m_shift--;
+        }
+
+        uint32_t mask = capacity - 1;
+        for(uint32_t old_slot=0; old_slot<occupied.size(); old_slot++)
+        {
+            if(!occupied[old_slot])
+            {
+                continue;
+            }
+            uint32_t slot = GetIdealSlot(keys[old_slot]);
+            while(m_occupied[slot])
+            {
+                slot = (slot + 1) & mask;
+            }
+            m_occupied[slot] = 1;
+            m_keys[slot] = std::move(keys[old_slot]);
+            m_values[slot] = std::move(values[old_slot]);
+        }
+    }
+
+private:
+    std::vector<Key> m_keys;
+    std::vector<Value> m_values;
+    std::vector<uint8_t> m_occupied;
+    uint32_t m_count = 0;
+    uint32_t m_shift = 64;  // 64 - log2(capacity)
+};
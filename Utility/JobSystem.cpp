@@ -0,0 +1,369 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <cassert>
+
+// worker index of the current thread in the job system it belongs to
+static thread_local JobSystem* t_job_system = nullptr;
+static thread_local int t_worker_index = -1;
+
+bool WorkStealingDeque::Push(Job* job)
+{
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    int64_t top = m_top.load(std::memory_order_acquire);
+    if(bottom - top >= k_capacity)
+    {
+        return false;
+    }
+
+    m_jobs[bottom & (k_capacity - 1)].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+}
+
+Job* WorkStealingDeque::Pop()
+{
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_relaxed);
+
+    if(top > bottom)
+    {
+        // empty
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = m_jobs[bottom & (k_capacity - 1)].load(std::memory_order_relaxed);
+    if(top == bottom)
+    {
+        // last job, race the thieves for it
+        if(!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            job = nullptr;
+        }
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* WorkStealingDeque::Steal()
+{
+    int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = m_bottom.load(std::memory_order_acquire);
+    if(top >= bottom)
+    {
+        return nullptr;
+    }
+
+    Job* job = m_jobs[top & (k_capacity - 1)].load(std::memory_order_relaxed);
+    if(!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    {
+        return nullptr;
+    }
+    return job;
+}
+
+JobSystem::JobSystem(unsigned int worker_count)
+{
+    if(worker_count == 0)
+    {
+        worker_count = 1;
+    }
+
+    // create every deque before a worker may try to steal from it
+    for(unsigned int i=0; i<worker_count; i++)
+    {
+        m_workers.push_back(std::make_unique<Worker>());
+        m_workers.back()->free_jobs.reserve(2 * k_job_batch);
+    }
+    for(unsigned int i=0; i<worker_count; i++)
+    {
+        m_workers[i]->thread = std::thread(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_stop = true;
+    }
+    m_sleep_condition.notify_all();
+
+    for(auto& worker : m_workers)
+    {
+        worker->thread.join();
+    }
+
+    // jobs still queued never ran, their counters are left unfinished, the pool's blocks free the jobs themselves
+    for(Job* job : m_injection_queue)
+    {
+        job->destroy(job->storage);
+    }
+    for(auto& worker : m_workers)
+    {
+        while(Job* job = worker->deque.Pop())
+        {
+            job->destroy(job->storage);
+        }
+    }
+}
+
+JobSystem& JobSystem::GetDefault()
+{
+    unsigned int thread_count = std::thread::hardware_concurrency();
+    static JobSystem job_system(thread_count > 1 ? thread_count - 1 : 1);
+    return job_system;
+}
+
+int JobSystem::GetCurrentWorkerIndex() const
+{
+    return t_job_system == this ? t_worker_index : -1;
+}
+
+Job* JobSystem::AllocateJob()
+{
+    int worker_index = GetCurrentWorkerIndex();
+    std::vector<Job*>* free_jobs = worker_index >= 0 ? &m_workers[worker_index]->free_jobs : nullptr;
+    if(!free_jobs || free_jobs->empty())
+    {
+        std::lock_guard<std::mutex> lock(m_job_pool_mutex);
+        if(m_free_jobs.size() < k_job_batch)
+        {
+            m_job_blocks.push_back(std::make_unique<Job[]>(k_job_batch));
+            for(size_t i=0; i<k_job_batch; i++)
+            {
+                m_free_jobs.push_back(&m_job_blocks.back()[i]);
+            }
+        }
+        if(!free_jobs)
+        {
+            Job* job = m_free_jobs.back();
+            m_free_jobs.pop_back();
+            return job;
+        }
+        free_jobs->insert(free_jobs->end(), m_free_jobs.end() - k_job_batch, m_free_jobs.end());
+        m_free_jobs.resize(m_free_jobs.size() - k_job_batch);
+    }
+
+    Job* job = free_jobs->back();
+    free_jobs->pop_back();
+    return job;
+}
+
+void JobSystem::FreeJob(Job* job)
+{
+    int worker_index = GetCurrentWorkerIndex();
+    if(worker_index < 0)
+    {
+        std::lock_guard<std::mutex> lock(m_job_pool_mutex);
+        m_free_jobs.push_back(job);
+        return;
+    }
+
+    // jobs stolen from other workers pile up here, the surplus goes back to the shared list
+    std::vector<Job*>& free_jobs = m_workers[worker_index]->free_jobs;
+    free_jobs.push_back(job);
+    if(free_jobs.size() >= 2 * k_job_batch)
+    {
+        std::lock_guard<std::mutex> lock(m_job_pool_mutex);
+        m_free_jobs.insert(m_free_jobs.end(), free_jobs.end() - k_job_batch, free_jobs.end());
+        free_jobs.resize(free_jobs.size() - k_job_batch);
+    }
+}
+
+void JobSystem::Submit(Job* job, JobCounter* counter, JobCounter* dependency)
+{
+    job->counter = counter;
+    if(counter)
+    {
+        counter->m_value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if(dependency)
+    {
+        // Execute decrements and drains the waiters under the same lock
+        std::lock_guard<std::mutex> lock(dependency->m_mutex);
+        if(!dependency->IsDone())
+        {
+            dependency->m_waiters.emplace_back(this, job);
+            return;
+        }
+    }
+    Schedule(job);
+}
+
+void JobSystem::Schedule(Job* job)
+{
+    // counted before the job is visible, so a thread taking it right away never drives the count below zero
+    m_pending_jobs.fetch_add(1);
+
+    int worker_index = GetCurrentWorkerIndex();
+    if(worker_index >= 0)
+    {
+        if(!m_workers[worker_index]->deque.Push(job))
+        {
+            // deque full, keep the job on this thread
+            m_pending_jobs.fetch_sub(1);
+            Execute(job);
+            return;
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(m_injection_mutex);
+        m_injection_queue.push_back(job);
+    }
+
+    if(m_sleeping_workers.load() > 0)
+    {
+        // taking the lock orders the notify after a worker's last check of m_pending_jobs
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_sleep_condition.notify_one();
+    }
+}
+
+Job* JobSystem::FindJob()
+{
+    int worker_index = GetCurrentWorkerIndex();
+    Job* job = nullptr;
+    if(worker_index >= 0)
+    {
+        job = m_workers[worker_index]->deque.Pop();
+    }
+
+    if(!job && m_pending_jobs.load(std::memory_order_relaxed) > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_injection_mutex);
+        if(!m_injection_queue.empty())
+        {
+            job = m_injection_queue.front();
+            m_injection_queue.pop_front();
+        }
+    }
+
+    // steal, starting after our own deque so thieves spread over the victims
+    unsigned int worker_count = (unsigned int)m_workers.size();
+    unsigned int start = worker_index >= 0 ? worker_index + 1 : 0;
+    for(unsigned int i=0; !job && i<worker_count; i++)
+    {
+        unsigned int victim = (start + i) % worker_count;
+        if(victim != (unsigned int)worker_index)
+        {
+            job = m_workers[victim]->deque.Steal();
+        }
+    }
+
+    if(job)
+    {
+        m_pending_jobs.fetch_sub(1);
+    }
+    return job;
+}
+
+void JobSystem::Execute(Job* job)
+{
+    job->run(job->storage);
+
+    JobCounter* counter = job->counter;
+    FreeJob(job);
+    if(!counter)
+    {
+        return;
+    }
+
+    // the counter is only touched under its lock, Wait takes the lock before returning
+    // so a counter living on the waiter's stack is not released while we still use it
+    std::vector<std::pair<JobSystem*, Job*>> waiters;
+    {
+        std::lock_guard<std::mutex> lock(counter->m_mutex);
+        if(counter->m_value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            waiters.swap(counter->m_waiters);
+        }
+    }
+    for(auto& waiter : waiters)
+    {
+        waiter.first->Schedule(waiter.second);
+    }
+}
+
+void JobSystem::Wait(JobCounter* counter)
+{
+    while(!counter->IsDone())
+    {
+        if(Job* job = FindJob())
+        {
+            Execute(job);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    std::lock_guard<std::mutex> lock(counter->m_mutex);
+}
+
+void JobSystem::WorkerLoop(unsigned int worker_index)
+{
+    t_job_system = this;
+    t_worker_index = (int)worker_index;
+
+    while(!m_stop)
+    {
+        if(Job* job = FindJob())
+        {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_sleeping_workers.fetch_add(1);
+        m_sleep_condition.wait(lock, [this]() { return m_stop || m_pending_jobs.load() > 0; });
+        m_sleeping_workers.fetch_sub(1);
+    }
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t min_grain, const std::function<void(uint32_t begin, uint32_t end)>& func)
+{
+    if(count == 0)
+    {
+        return;
+    }
+
+    min_grain = std::max(min_grain, 1u);
+    uint32_t thread_count = GetWorkerCount() + 1;
+    uint32_t coarse_grain = std::max(min_grain, count / (4 * thread_count));
+    if(count <= min_grain)
+    {
+        func(0, count);
+        return;
+    }
+
+    JobCounter counter;
+    RunRange(0, count, coarse_grain, min_grain, func, &counter);
+    Wait(&counter);
+}
+
+void JobSystem::RunRange(uint32_t begin, uint32_t end, uint32_t coarse_grain, uint32_t min_grain,
+    const std::function<void(uint32_t, uint32_t)>& func, JobCounter* counter)
+{
+    // split off the upper half while the range is coarse, or while nobody has anything to steal from us
+    while(end - begin > min_grain)
+    {
+        int worker_index = GetCurrentWorkerIndex();
+        bool b_starving = worker_index >= 0 && m_workers[worker_index]->deque.GetSize() == 0;
+        if(end - begin <= coarse_grain && !b_starving)
+        {
+            break;
+        }
+
+        uint32_t middle = begin + (end - begin) / 2;
+        Run([=, &func]() { RunRange(middle, end, coarse_grain, min_grain, func, counter); }, counter);
+        end = middle;
+    }
+    func(begin, end);
+}
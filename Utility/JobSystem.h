@@ -0,0 +1,168 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class JobSystem;
+
+// jobs come from the JobSystem's pool and keep small callables inline, so running one does not allocate
+struct Job
+{
+    static const size_t k_storage_size = 64;
+
+    void (*run)(void* storage) = nullptr;       // calls the callable, then destroys it
+    void (*destroy)(void* storage) = nullptr;   // destroys it without calling, for jobs that never ran
+    class JobCounter* counter = nullptr;        // decremented when the job finished
+    alignas(16) unsigned char storage[k_storage_size];
+
+    template<typename Func>
+    void SetFunc(Func&& func)
+    {
+        typedef typename std::decay<Func>::type FuncType;
+        if constexpr(sizeof(FuncType) <= k_storage_size && alignof(FuncType) <= 16)
+        {
+            new(storage) FuncType(std::forward<Func>(func));
+            run = [](void* p) { FuncType* f = (FuncType*)p; (*f)(); f->~FuncType(); };
+            destroy = [](void* p) { ((FuncType*)p)->~FuncType(); };
+        }
+        else
+        {
+            // too large, only a pointer to it is kept inline
+            *(FuncType**)storage = new FuncType(std::forward<Func>(func));
+            run = [](void* p) { FuncType* f = *(FuncType**)p; (*f)(); delete f; };
+            destroy = [](void* p) { delete *(FuncType**)p; };
+        }
+    }
+};
+
+// number of unfinished jobs, incremented by JobSystem::Run and decremented as they finish
+// jobs may also wait on a counter, they are scheduled once it drops to zero
+// a counter can be reused once it reached zero
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    ~JobCounter() = default;
+
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone() const { return m_value.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<int> m_value{ 0 };
+    // guards m_waiters and the decrement in Execute, so it is taken once by every counted job,
+    // Wait takes it too before returning so the counter outlives its last use
+    std::mutex m_mutex;
+    std::vector<std::pair<JobSystem*, Job*>> m_waiters;
+};
+
+// fixed capacity Chase-Lev deque, the owner pushes and pops at the bottom, other threads steal from the top
+class WorkStealingDeque
+{
+public:
+    static const int64_t k_capacity = 4096;
+
+    WorkStealingDeque() = default;
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // owner thread only, false when full
+    bool Push(Job* job);
+    Job* Pop();
+    // any thread
+    Job* Steal();
+    int64_t GetSize() const { return m_bottom.load(std::memory_order_relaxed) - m_top.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<int64_t> m_top{ 0 };
+    alignas(64) std::atomic<int64_t> m_bottom{ 0 };
+    std::atomic<Job*> m_jobs[k_capacity];
+};
+
+// work stealing job system for short cpu bound jobs, long running or blocking work belongs in ThreadPool
+// each worker owns a WorkStealingDeque, jobs run from a worker go to its own deque and idle workers steal
+// jobs run from other threads go to a shared injection queue
+// threads waiting on a counter run pending jobs in the meantime instead of blocking
+class JobSystem
+{
+public:
+    JobSystem() = delete;
+    explicit JobSystem(unsigned int worker_count);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // hardware threads minus one worker, the waiting thread takes the last core
+    static JobSystem& GetDefault();
+
+    unsigned int GetWorkerCount() const { return (unsigned int)m_workers.size(); }
+
+    // func() is run once, counter may be nullptr, the job starts once dependency (if any) is done
+    template<typename Func>
+    void Run(Func&& func, JobCounter* counter = nullptr, JobCounter* dependency = nullptr)
+    {
+        Job* job = AllocateJob();
+        job->SetFunc(std::forward<Func>(func));
+        Submit(job, counter, dependency);
+    }
+    // runs pending jobs on the calling thread until the counter is done
+    void Wait(JobCounter* counter);
+
+    // func(begin, end) over [0, count), returns when every range finished
+    // ranges start at about count / (4 * threads) and are split further down to min_grain
+    // while a worker's deque is empty, so imbalanced work is stolen in smaller pieces
+    void ParallelFor(uint32_t count, uint32_t min_grain, const std::function<void(uint32_t begin, uint32_t end)>& func);
+
+private:
+    static const size_t k_job_batch = 64;   // jobs moved at once between a worker's free list and the shared one
+
+    struct Worker
+    {
+        WorkStealingDeque deque;
+        std::thread thread;
+        std::vector<Job*> free_jobs;        // only touched by the worker's own thread
+    };
+
+    void WorkerLoop(unsigned int worker_index);
+    Job* AllocateJob();
+    void FreeJob(Job* job);
+    void Submit(Job* job, JobCounter* counter, JobCounter* dependency);
+    void Schedule(Job* job);
+    Job* FindJob();
+    void Execute(Job* job);
+    void RunRange(uint32_t begin, uint32_t end, uint32_t coarse_grain, uint32_t min_grain,
+        const std::function<void(uint32_t, uint32_t)>& func, JobCounter* counter);
+    int GetCurrentWorkerIndex() const;
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    std::mutex m_injection_mutex;
+    std::deque<Job*> m_injection_queue;
+
+    // job pool, threads other than the workers use the shared free list directly
+    std::mutex m_job_pool_mutex;
+    std::vector<Job*> m_free_jobs;
+    std::vector<std::unique_ptr<Job[]>> m_job_blocks;
+
+    // idle workers sleep until a job is scheduled
+    std::atomic<int> m_pending_jobs{ 0 };
+    std::atomic<int> m_sleeping_workers{ 0 };
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_sleep_condition;
+    std::atomic<bool> m_stop{ false };
+};
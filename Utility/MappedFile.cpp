@@ -0,0 +1,116 @@
+#include "MappedFile.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#if defined(_WIN32)
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(m_file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(m_file, &file_size) || file_size.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(m_mapping == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    m_data = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if(m_data == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    m_size = (size_t)file_size.QuadPart;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if(m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if(m_mapping != nullptr)
+    {
+        CloseHandle(m_mapping);
+    }
+    if(m_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(m_file);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+}
+#else
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    m_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(m_fd < 0)
+    {
+        return false;
+    }
+
+    struct stat file_stat;
+    if(fstat(m_fd, &file_stat) != 0 || file_stat.st_size == 0)
+    {
+        Close();
+        return false;
+    }
+
+    void* data = mmap(nullptr, (size_t)file_stat.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if(data == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+
+    m_data = data;
+    m_size = (size_t)file_stat.st_size;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if(m_data != nullptr)
+    {
+        munmap(const_cast<void*>(m_data), m_size);
+    }
+    if(m_fd >= 0)
+    {
+        close(m_fd);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_fd = -1;
+}
+#endif
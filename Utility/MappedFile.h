@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+// read only memory mapping of a whole file
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // returns false if the file does not exist or is empty
+    bool Open(const std::string& path);
+    void Close();
+
+    const void* GetData() const { return m_data; }
+    size_t GetSize() const { return m_size; }
+    bool IsOpen() const { return m_data != nullptr; }
+
+private:
+    const void* m_data = nullptr;
+    size_t m_size = 0;
+
+#if defined(_WIN32)
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
@@ -0,0 +1,30 @@
+#include "NameID.h"
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include "FlatHashMap.h"
+#include "NameTable.h"
+
+static std::mutex s_registered_names_mutex;
+static FlatHashMap<NameID, NameIndex> s_registered_names; // into NameTable::GetDefault
+
+NameID NameID::Register(std::string_view str)
+{
+    NameID name(str);
+
+    std::lock_guard<std::mutex> lock(s_registered_names_mutex);
+    if(const NameIndex* index = s_registered_names.Find(name))
+    {
+        assert(str == NameTable::GetDefault().GetString(*index)); // two names with the same hash
+        return name;
+    }
+    s_registered_names.Insert(name, NameTable::GetDefault().Intern(str));
+    return name;
+}
+
+const char* NameID::GetString() const
+{
+    std::lock_guard<std::mutex> lock(s_registered_names_mutex);
+    const NameIndex* index = s_registered_names.Find(*this);
+    return index ? NameTable::GetDefault().GetString(*index) : nullptr;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// 64 bit FNV-1a hash of a name, used as key by the resource registries instead of the string itself
+// string literals are hashed at compile time when the NameID is constexpr, and usually folded otherwise
+// runtime strings are hashed once where they enter, lookups then compare 64 bit values only
+// Register keeps the string in NameTable::GetDefault for GetString and asserts against collisions
+class NameID
+{
+public:
+    constexpr NameID() = default;
+    template<size_t N>
+    constexpr NameID(const char (&str)[N]): m_hash(Hash(str, Length(str, N - 1))) {}
+    NameID(const std::string& str): m_hash(Hash(str.data(), str.size())) {}
+    constexpr explicit NameID(std::string_view str): m_hash(Hash(str.data(), str.size())) {}
+
+    // registries call it when a name is added, lookups do not need it
+    static NameID Register(std::string_view str);
+    // nullptr if the name was never registered
+    const char* GetString() const;
+
+    constexpr uint64_t GetHash() const { return m_hash; }
+    constexpr bool IsValid() const { return m_hash != 0; }
+    constexpr bool operator==(const NameID& other) const { return m_hash == other.m_hash; }
+    constexpr bool operator!=(const NameID& other) const { return m_hash != other.m_hash; }
+
+    static constexpr uint64_t Hash(const char* str, size_t size)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for(size_t i=0; i<size; i++)
+        {
+            hash ^= (uint8_t)str[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+private:
+    // a char array may hold a shorter string
+    static constexpr size_t Length(const char* str, size_t max_size)
+    {
+        size_t size = 0;
+        while(size < max_size && str[size] != '\0')
+        {
+            size++;
+        }
+        return size;
+    }
+
+private:
+    uint64_t m_hash = 0;
+};
+
+namespace std
+{
+    template<>
+    struct hash<NameID>
+    {
+        size_t operator()(const NameID& name) const { return (size_t)name.GetHash(); }
+    };
+}
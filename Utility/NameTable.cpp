@@ -0,0 +1,114 @@
+#include "NameTable.h"
+#include <cassert>
+#include <cstring>
+
+NameTable& NameTable::GetDefault()
+{
+    static NameTable table;
+    return table;
+}
+
+NameIndex NameTable::Intern(std::string_view name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(const NameIndex* found = m_indices.Find(name))
+    {
+        m_entries[*found].ref_count++;
+        return *found;
+    }
+
+    NameIndex index;
+    if(!m_free_indices.empty())
+    {
+        index = m_free_indices.back();
+        m_free_indices.pop_back();
+    }
+    else
+    {
+        index = (NameIndex)m_entries.size();
+        m_entries.emplace_back();
+    }
+
+    Entry& entry = m_entries[index];
+    entry.string = Store(name, entry.own_storage);
+    entry.size = (uint32_t)name.size();
+    entry.ref_count = 1;
+    m_indices.Insert(std::string_view(entry.string, name.size()), index);
+    return index;
+}
+
+void NameTable::Release(NameIndex index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry& entry = m_entries[index];
+    assert(entry.ref_count > 0);
+    if(--entry.ref_count > 0)
+    {
+        return;
+    }
+
+    m_indices.Erase(std::string_view(entry.string, entry.size));
+    if(entry.own_storage)
+    {
+        m_own_storage_size -= entry.size + 1;
+        entry.own_storage.reset();
+    }
+    else
+    {
+        m_free_storage[GetSizeClass(entry.size)].push_back(const_cast<char*>(entry.string));
+    }
+    entry.string = nullptr;
+    m_free_indices.push_back(index);
+}
+
+const char* NameTable::GetString(NameIndex index) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    assert(m_entries[index].ref_count > 0);
+    return m_entries[index].string;
+}
+
+uint32_t NameTable::GetCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (uint32_t)(m_entries.size() - m_free_indices.size());
+}
+
+size_t NameTable::GetStorageSize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_blocks.size() * k_block_size + m_own_storage_size;
+}
+
+char* NameTable::Store(std::string_view name, std::unique_ptr<char[]>& own_storage)
+{
+    char* dest;
+    uint32_t size_class = GetSizeClass(name.size());
+    if(size_class >= k_size_class_count)
+    {
+        own_storage = std::make_unique<char[]>(name.size() + 1);
+        m_own_storage_size += name.size() + 1;
+        dest = own_storage.get();
+    }
+    else if(!m_free_storage[size_class].empty())
+    {
+        dest = m_free_storage[size_class].back();
+        m_free_storage[size_class].pop_back();
+    }
+    else
+    {
+        // the whole size class is taken, so a freed slot fits any later name of the class
+        size_t capacity = (size_t)(size_class + 1) * k_size_class_step;
+        if(m_block_used + capacity > k_block_size)
+        {
+            m_blocks.push_back(std::make_unique<char[]>(k_block_size));
+            m_block_used = 0;
+        }
+        dest = m_blocks.back().get() + m_block_used;
+        m_block_used += capacity;
+    }
+
+    memcpy(dest, name.data(), name.size());
+    dest[name.size()] = '\0';
+    return dest;
+}
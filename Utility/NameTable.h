@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "FlatHashMap.h"
+
+// index of a string interned in a NameTable
+typedef uint32_t NameIndex;
+
+// each distinct string is stored once, null terminated, in large character blocks that never move,
+// so interning a known name allocates nothing and the returned strings stay valid while the name is referenced
+// every Intern adds a reference and Release drops one, a name without references is removed and its index and
+// storage are reused by the next names, so tables of transient names stay at the size of their peak live set
+// thread safe
+class NameTable
+{
+public:
+    NameTable() = default;
+    ~NameTable() = default;
+
+    NameTable(const NameTable&) = delete;
+    NameTable& operator=(const NameTable&) = delete;
+
+    static NameTable& GetDefault();
+
+    NameIndex Intern(std::string_view name);
+    void Release(NameIndex index);
+    const char* GetString(NameIndex index) const;
+    // names currently referenced
+    uint32_t GetCount() const;
+    // bytes of character storage, in use or free for reuse
+    size_t GetStorageSize() const;
+
+private:
+    static const size_t k_block_size = 64 * 1024;
+    static const uint32_t k_size_class_step = 16;
+    static const uint32_t k_size_class_count = 16;     // strings up to 256 bytes with their terminator share the blocks
+
+    struct Entry
+    {
+        const char* string = nullptr;
+        uint32_t size = 0;
+        uint32_t ref_count = 0;
+        std::unique_ptr<char[]> own_storage;            // strings too long for the size classes
+    };
+
+    static uint32_t GetSizeClass(size_t size) { return (uint32_t)((size + k_size_class_step) / k_size_class_step) - 1; }
+    char* Store(std::string_view name, std::unique_ptr<char[]>& own_storage);
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    size_t m_block_used = k_block_size;
+    size_t m_own_storage_size = 0;
+    std::vector<char*> m_free_storage[k_size_class_count];
+    std::vector<Entry> m_entries;
+    std::vector<NameIndex> m_free_indices;
+    FlatHashMap<std::string_view, NameIndex> m_indices; // views into the storage of the referenced names, no node per name
+};
@@ -0,0 +1,143 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// index of a slot in an ObjectPool<T>, the generation tells a destroyed object from its slot's next owner
+template<typename T>
+struct PoolHandle
+{
+    static const uint32_t k_invalid_index = 0xffffffff;
+
+    uint32_t index = k_invalid_index;
+    uint32_t generation = 0;
+
+    bool IsValid() const { return index != k_invalid_index; }
+    bool operator==(const PoolHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const PoolHandle& other) const { return !(*this == other); }
+};
+
+// objects of one type constructed in place in fixed size slabs, so creating and destroying them
+// only allocates when every slab is full, and objects never move while they are alive
+// freed slots are reused last in first out, their generation is increased so stale handles resolve to nullptr
+template<typename T, uint32_t SlabSize = 256>
+class ObjectPool
+{
+public:
+    ObjectPool() = default;
+    ~ObjectPool() { Clear(); }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    template<typename... Args>
+    PoolHandle<T> Create(Args&&... args)
+    {
+        if(m_free_slots.empty())
+        {
+            AddSlab();
+        }
+        uint32_t index = m_free_slots.back();
+        new(GetSlot(index)) T(std::forward<Args>(args)...);
+        m_free_slots.pop_back();    // after the constructor, which may throw
+        m_alive[index] = 1;
+        m_count++;
+
+        PoolHandle<T> handle;
+        handle.index = index;
+        handle.generation = m_generations[index];
+        return handle;
+    }
+
+    // stale handles are ignored
+    void Destroy(PoolHandle<T> handle)
+    {
+        T* object = Get(handle);
+        if(object == nullptr)
+        {
+            return;
+        }
+        object->~T();
+        m_alive[handle.index] = 0;
+        m_generations[handle.index]++;
+        m_free_slots.push_back(handle.index);
+        m_count--;
+    }
+
+    // nullptr if the object was destroyed
+    T* Get(PoolHandle<T> handle) const
+    {
+        if(handle.index >= m_generations.size() || !m_alive[handle.index] || m_generations[handle.index] != handle.generation)
+        {
+            return nullptr;
+        }
+        return GetSlot(handle.index);
+    }
+
+    bool IsAlive(PoolHandle<T> handle) const { return Get(handle) != nullptr; }
+    uint32_t GetCount() const { return m_count; }
+    uint32_t GetSlabCount() const { return (uint32_t)m_slabs.size(); }
+
+    // destroys every object, the slabs are kept
+    void Clear()
+    {
+        for(uint32_t index=0; index<m_alive.size(); index++)
+        {
+            if(m_alive[index])
+            {
+                PoolHandle<T> handle;
+                handle.index = index;
+                handle.generation = m_generations[index];
+                Destroy(handle);
+            }
+        }
+    }
+
+    // func(T&) for each alive object, in slot order
+    template<typename Func>
+    void ForEach(Func func)
+    {
+        for(uint32_t index=0; index<m_alive.size(); index++)
+        {
+            if(m_alive[index])
+            {
+                func(*GetSlot(index));
+            }
+        }
+    }
+
+private:
+    struct alignas(T) Storage
+    {
+        unsigned char bytes[sizeof(T)];
+    };
+
+    T* GetSlot(uint32_t index) const
+    {
+        return std::launder(reinterpret_cast<T*>(&m_slabs[index / SlabSize][index % SlabSize]));
+    }
+
+    void AddSlab()
+    {
+        uint32_t first_index = (uint32_t)m_slabs.size() * SlabSize;
+        m_slabs.push_back(std::make_unique<Storage[]>(SlabSize));
+        m_generations.resize(first_index + SlabSize, 0);
+        m_alive.resize(first_index + SlabSize, 0);
+
+        // lowest index on top of the free list
+        for(uint32_t i=SlabSize; i-->0; )
+        {
+            m_free_slots.push_back(first_index + i);
+        }
+    }
+
+private:
+    std::vector<std::unique_ptr<Storage[]>> m_slabs;
+    std::vector<uint32_t> m_generations;
+    std::vector<uint8_t> m_alive;
+    std::vector<uint32_t> m_free_slots;
+    uint32_t m_count = 0;
+};
@@ -0,0 +1,58 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int thread_count)
+{
+    if(thread_count == 0)
+    {
+        thread_count = 1;
+    }
+
+    m_workers.reserve(thread_count);
+    for(unsigned int i=0; i<thread_count; i++)
+    {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_condition.notify_all();
+
+    for(std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::GetDefault()
+{
+    static ThreadPool pool(std::thread::hardware_concurrency());
+    return pool;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    while(true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+
+            // drain the queue before quitting so no future is left without a value
+            if(m_stop && m_jobs.empty())
+            {
+                return;
+            }
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop();
+        }
+
+        job();
+    }
+}
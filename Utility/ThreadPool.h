@@ -0,0 +1,55 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <queue>
+#include <vector>
+
+// fixed size pool of worker threads, jobs are started in submission order (FIFO)
+// but may finish in any order, so callers must join the futures in a fixed order
+// when the result has to be deterministic
+class ThreadPool
+{
+public:
+    ThreadPool() = delete;
+    explicit ThreadPool(unsigned int thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    template<typename F>
+    auto Submit(F&& job) -> std::future<decltype(job())>
+    {
+        using ReturnType = decltype(job());
+
+        // std::function needs a copyable callable, so the task lives in a shared_ptr
+        auto task = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<F>(job));
+        std::future<ReturnType> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.emplace([task]() { (*task)(); });
+        }
+        m_condition.notify_one();
+
+        return result;
+    }
+
+    unsigned int GetThreadCount() const { return (unsigned int)m_workers.size(); }
+
+    // shared pool sized to the hardware, used by shader compilation and other background work
+    static ThreadPool& GetDefault();
+
+private:
+    void WorkerLoop();
+
+private:
+    std::vector<std::thread> m_workers;
+    std::queue<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop = false;
+};
@@ -29,7 +29,7 @@ target("RenderEngineCdh")
     -- add_files("./Engine/*.cpp")
     -- add_headerfiles("./Engine/*.h")
 
-    -- add_files("./Utility/*.cpp")
+    add_files("./Utility/*.cpp")
     add_headerfiles("./Utility/*.h")
 
     add_files("D3DRHI/*.cpp")
@@ -47,17 +47,309 @@ target("RenderEngineCdh")
     add_files("./Math/*.cpp")
     add_headerfiles("./Math/*.h")
 
+    add_files("./ECS/*.cpp")
+    add_headerfiles("./ECS/*.h")
+
+    add_files("./Scene/*.cpp")
+    add_headerfiles("./Scene/*.h")
+
     add_files("./Component/*.cpp")
     add_headerfiles("./Component/*.h")
 
     add_files("./GameObject/*.cpp")
     add_headerfiles("./GameObject/*.h")
 
+    add_files("./Renderer/*.cpp")
+    add_headerfiles("./Renderer/*.h")
+
     after_build(function (target)
         os.cp("./Shaders/*.hlsl", "$(buildir)/Shaders/") -- temp copy to specific dir
         os.cp("./Resources/Textures/*.dds", "$(buildir)/Textures/") -- temp copy to specific dir
     end)
-    
+
+-- writes generated scene files, see BoxApp::LoadScene
+target("SceneWriter")
+    set_kind("binary")
+    add_includedirs(".")
+    add_files("./Tools/SceneWriter.cpp")
+    add_files("./Scene/SceneFile.cpp")
+    add_files("./Utility/MappedFile.cpp")
+    add_files("./Math/*.cpp")
+
+-- benchmarks print a table and are only built on demand: xmake build -g benchmarks, then xmake run <target> [scale]
+target("ShaderCompileBenchmark")
+    set_kind("binary")
+    set_default(false)
+    set_group("benchmarks")
+    add_includedirs(".")
+    add_files("./Benchmarks/ShaderCompileBenchmark.cpp")
+    add_files("./Utility/ThreadPool.cpp")
+
+target("RenderQueueBenchmark")
+    set_kind("binary")
+    set_default(false)
+    set_group("benchmarks")
+    add_includedirs(".")
+    add_files("./Benchmarks/RenderQueueBenchmark.cpp")
+    add_files("./Renderer/RenderQueue.cpp")
+
+target("ECSIterationBenchmark")
+    set_kind("binary")
+    set_default(false)
+    set_group("benchmarks")
+    add_includedirs(".")
+    add_files("./Benchmarks/ECSIterationBenchmark.cpp")
+    add_files("./ECS/*.cpp")
+    add_files("./Scene/SceneHierarchy.cpp")
+    add_files("./Utility/JobSystem.cpp")
+    add_files("./Math/*.cpp")
+
+target("SceneHierarchyBenchmark")
+    set_kind("binary")
+    set_default(false)
+    set_group("benchmarks")
+    add_includedirs(".")
+    add_files("./Benchmarks/SceneHierarchyBenchmark.cpp")
+    add_files("./Scene/SceneHierarchy.cpp")
+    add_files("./Utility/JobSystem.cpp")
+    add_files("./Math/*.cpp")
+
+target("OctreeBenchmark")
+    set_kind("binary")
+    set_default(false)
+    set_group("benchmarks")
+    add_includedirs(".")
+    add_files("./Benchmarks/OctreeBenchmark.cpp")
+    add_files("./Scene/LooseOctree.cpp")
+    add_files("./Math/*.cpp")
+
+target("CullingBenchmark")
+    set_kind("binary")
+    set_default(false)
+    set_group("benchmarks")
+    add_includedirs(".")
+    add_files("./Benchmarks/CullingBenchmark.cpp")
+    add_files("./Renderer/FrustumCuller.cpp")
+    add_files("./Utility/JobSystem.cpp")
+    add_files("./Math/*.cpp")
+
+target("OcclusionBenchmark")
+    set_kind("binary")
+    set_default(false)
+    set_group("benchmarks")
+    add_includedirs(".")
+    add_files("./Benchmarks/OcclusionBenchmark.cpp")
+    add_files("./Renderer/OcclusionCuller.cpp")
+    add_files("./Renderer/FrustumCuller.cpp")
+    add_files("./Utility/JobSystem.cpp")
+    add_files("./Math/*.cpp")
+
+target("SceneLoadBenchmark")
+    set_kind("binary")
+    set_default(false)
+    set_group("benchmarks")
+    add_includedirs(".")
+    add_files("./Benchmarks/SceneLoadBenchmark.cpp")
+    add_files("./Scene/SceneFile.cpp")
+    add_files("./Scene/SceneHierarchy.cpp")
+    add_files("./Utility/MappedFile.cpp")
+    add_files("./Utility/JobSystem.cpp")
+    add_files("./Math/*.cpp")
+
+target("LookupBenchmark")
+    set_kind("binary")
+    set_default(false)
+    set_group("benchmarks")
+    add_includedirs(".")
+    add_files("./Benchmarks/LookupBenchmark.cpp")
+    add_files("./Utility/NameID.cpp")
+    add_files("./Utility/NameTable.cpp")
+
+target("TransformBenchmark")
+    set_kind("binary")
+    set_default(false)
+    set_group("benchmarks")
+    add_includedirs(".")
+    add_files("./Benchmarks/TransformBenchmark.cpp")
+    add_files("./Math/*.cpp")
+
+target("JobSystemBenchmark")
+    set_kind("binary")
+    set_default(false)
+    set_group("benchmarks")
+    add_includedirs(".")
+    add_files("./Benchmarks/JobSystemBenchmark.cpp")
+    add_files("./Utility/JobSystem.cpp")
+
+-- engine sources for the targets needing a d3d12 device, everything the app links but BoxApp and WinMain
+function add_engine_files()
+    for _, dir in ipairs({"Common", "Utility", "D3DRHI", "Texture", "Mesh", "Material", "Math", "ECS", "Scene", "Component", "GameObject", "Renderer"}) do
+        add_files("./" .. dir .. "/*.cpp")
+    end
+end
+
+if is_plat("windows") then
+    target("ParameterBindingBenchmark")
+        set_kind("binary")
+        set_default(false)
+        set_group("benchmarks")
+        add_includedirs(".")
+        add_files("./Benchmarks/ParameterBindingBenchmark.cpp")
+        add_engine_files()
+
+    target("FramePipelineBenchmark")
+        set_kind("binary")
+        set_default(false)
+        set_group("benchmarks")
+        add_includedirs(".")
+        add_files("./Benchmarks/FramePipelineBenchmark.cpp")
+        add_engine_files()
+
+    -- GeometryGenerator's vertices come with the d3d12 input layout
+    target("BVHBenchmark")
+        set_kind("binary")
+        set_default(false)
+        set_group("benchmarks")
+        add_includedirs(".")
+        add_files("./Benchmarks/BVHBenchmark.cpp")
+        add_files("./Mesh/GeometryGenerator.cpp")
+        add_files("./Scene/BVH.cpp")
+        add_files("./Scene/MeshBVH.cpp")
+        add_files("./Scene/SceneBVH.cpp")
+        add_files("./Utility/JobSystem.cpp")
+        add_files("./Math/*.cpp")
+
+    target("ObjectPoolBenchmark")
+        set_kind("binary")
+        set_default(false)
+        set_group("benchmarks")
+        add_includedirs(".")
+        add_files("./Benchmarks/ObjectPoolBenchmark.cpp")
+        add_files("./GameObject/GameObject.cpp")
+        add_files("./Component/*.cpp")
+        add_files("./ECS/*.cpp")
+        add_files("./Scene/SceneHierarchy.cpp")
+        add_files("./Utility/JobSystem.cpp")
+        add_files("./Utility/NameTable.cpp")
+        add_files("./Math/*.cpp")
+end
+
+-- tests are only built on demand and run with xmake test, the portable ones also run on linux
+target("ShaderDependencyGraphTests")
+    set_kind("binary")
+    set_default(false)
+    set_group("tests")
+    add_includedirs(".")
+    add_files("./Tests/ShaderDependencyGraphTests.cpp")
+    add_files("./Material/ShaderDependencyGraph.cpp")
+    add_files("./Utility/FileWatcher.cpp")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
+    add_tests("default")
+
+target("ShaderReflectionBlobTests")
+    set_kind("binary")
+    set_default(false)
+    set_group("tests")
+    add_includedirs(".")
+    add_files("./Tests/ShaderReflectionBlobTests.cpp")
+    add_files("./Material/ShaderReflectionBlob.cpp")
+    add_files("./Utility/MappedFile.cpp")
+    add_tests("default")
+
+target("InstanceBatcherTests")
+    set_kind("binary")
+    set_default(false)
+    set_group("tests")
+    add_includedirs(".")
+    add_files("./Tests/InstanceBatcherTests.cpp")
+    add_files("./Renderer/InstanceBatcher.cpp")
+    add_files("./Renderer/RenderQueue.cpp")
+    add_tests("default")
+
+target("NameTableTests")
+    set_kind("binary")
+    set_default(false)
+    set_group("tests")
+    add_includedirs(".")
+    add_files("./Tests/NameTableTests.cpp")
+    add_files("./Utility/NameTable.cpp")
+    add_tests("default")
+
+target("ObjectPoolTests")
+    set_kind("binary")
+    set_default(false)
+    set_group("tests")
+    add_includedirs(".")
+    add_files("./Tests/ObjectPoolTests.cpp")
+    add_tests("default")
+
+target("JobSystemTests")
+    set_kind("binary")
+    set_default(false)
+    set_group("tests")
+    add_includedirs(".")
+    add_files("./Tests/JobSystemTests.cpp")
+    add_files("./Utility/JobSystem.cpp")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
+    add_tests("default")
+
+if is_plat("windows") then
+    target("ShaderBindingTests")
+        set_kind("binary")
+        set_default(false)
+        set_group("tests")
+        add_includedirs(".")
+        add_files("./Tests/ShaderBindingTests.cpp")
+        add_engine_files()
+        add_tests("default")
+
+    target("CbLayoutTests")
+        set_kind("binary")
+        set_default(false)
+        set_group("tests")
+        add_includedirs(".")
+        add_files("./Tests/CbLayoutTests.cpp")
+        add_engine_files()
+        add_tests("default")
+
+    target("LODSelectorTests")
+        set_kind("binary")
+        set_default(false)
+        set_group("tests")
+        add_includedirs(".")
+        add_files("./Tests/LODSelectorTests.cpp")
+        add_engine_files()
+        add_tests("default")
+
+    -- Math wraps DirectXMath and includes Windows.h
+    target("BVHTests")
+        set_kind("binary")
+        set_default(false)
+        set_group("tests")
+        add_includedirs(".")
+        add_files("./Tests/BVHTests.cpp")
+        add_files("./Scene/BVH.cpp")
+        add_files("./Scene/MeshBVH.cpp")
+        add_files("./Scene/SceneBVH.cpp")
+        add_files("./Math/*.cpp")
+        add_tests("default")
+
+    target("TransformTests")
+        set_kind("binary")
+        set_default(false)
+        set_group("tests")
+        add_includedirs(".")
+        add_files("./Tests/TransformTests.cpp")
+        add_files("./Scene/SceneHierarchy.cpp")
+        add_files("./Utility/JobSystem.cpp")
+        add_files("./Math/*.cpp")
+        add_tests("default")
+end
+
 
 --
 -- If you want to known more usage about xmake, please see https://xmake.io